@@ -143,6 +143,9 @@ static const wxChar ScreenDPI[] = wxT( "ScreenDPI" );
 static const wxChar EnableVariantsUI[] = wxT( "EnableVariantsUI" );
 static const wxChar EnableUseAuiPerspective[] = wxT( "EnableUseAuiPerspective" );
 static const wxChar HistoryLockStaleTimeout[] = wxT( "HistoryLockStaleTimeout" );
+static const wxChar EnableLexerSnapshots[] = wxT( "EnableLexerSnapshots" );
+static const wxChar LexerSnapshotCacheSize[] = wxT( "LexerSnapshotCacheSize" );
+static const wxChar LiveIncrementalDRC[] = wxT( "LiveIncrementalDRC" );
 
 } // namespace AC_KEYS
 
@@ -335,6 +338,9 @@ ADVANCED_CFG::ADVANCED_CFG()
 
     m_EnableUseAuiPerspective = false;
     m_HistoryLockStaleTimeout = 300; // 5 minutes default
+    m_EnableLexerSnapshots = false;
+    m_LexerSnapshotCacheSize = 256;
+    m_LiveIncrementalDRC = false;
 
     loadFromConfigFile();
 }
@@ -650,6 +656,18 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
                                                           &m_HistoryLockStaleTimeout, m_HistoryLockStaleTimeout, 10,
                                                           86400 ) ); // 10 seconds to 24 hours
 
+    m_entries.push_back( std::make_unique<PARAM_CFG_BOOL>( true, AC_KEYS::EnableLexerSnapshots,
+                                                           &m_EnableLexerSnapshots,
+                                                           m_EnableLexerSnapshots ) );
+
+    m_entries.push_back( std::make_unique<PARAM_CFG_INT>( true, AC_KEYS::LexerSnapshotCacheSize,
+                                                          &m_LexerSnapshotCacheSize,
+                                                          m_LexerSnapshotCacheSize, 1, 65536 ) );
+
+    m_entries.push_back( std::make_unique<PARAM_CFG_BOOL>( true, AC_KEYS::LiveIncrementalDRC,
+                                                           &m_LiveIncrementalDRC,
+                                                           m_LiveIncrementalDRC ) );
+
     // Special case for trace mask setting...we just grab them and set them immediately
     // Because we even use wxLogTrace inside of advanced config
     m_entries.push_back( std::make_unique<PARAM_CFG_WXSTRING>( true, AC_KEYS::TraceMasks, &m_traceMasks, wxS( "" ) ) );
@@ -23,6 +23,7 @@
  */
 
 #include <fast_float/fast_float.h>
+#include <algorithm>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>         // bsearch()
@@ -48,6 +49,12 @@ void DSNLEXER::init()
     commentsAreTokens = false;
     SetKnowsBar( true );    // default since version 20240706
     curOffset = 0;
+
+    m_replay = nullptr;
+    m_replayNext = 0;
+    m_replayEnd = 0;
+    m_replayNumber = nullptr;
+    m_recorder = nullptr;
 }
 
 
@@ -193,6 +200,13 @@ bool DSNLEXER::SyncLineReaderWith( DSNLEXER& aLexer )
     curText = aLexer.curText;
     curOffset = aLexer.curOffset;
 
+    // The position in a snapshot being replayed is shared the same way
+    m_replay = aLexer.m_replay;
+    m_replayNext = aLexer.m_replayNext;
+    m_replayEnd = aLexer.m_replayEnd;
+    m_replayNumber = aLexer.m_replayNumber;
+    m_recorder = aLexer.m_recorder;
+
     return true;
 }
 
@@ -538,8 +552,50 @@ static bool isNumber( const char* cp, const char* limit )
 }
 
 
+void DSNLEXER::SetReplay( const LEXER_SNAPSHOT* aSnapshot, size_t aFirst, size_t aLast )
+{
+    m_replay = aSnapshot;
+    m_replayNumber = nullptr;
+
+    if( aSnapshot )
+    {
+        m_replayEnd = std::min( aLast, aSnapshot->GetTokenCount() );
+        m_replayNext = std::min( aFirst, m_replayEnd );
+    }
+    else
+    {
+        m_replayNext = 0;
+        m_replayEnd = 0;
+    }
+}
+
+
+int DSNLEXER::replayTok()
+{
+    prevTok = curTok;
+    curSeparator.clear();
+    curOffset = 0;
+
+    if( m_replayNext < m_replayEnd )
+    {
+        curTok = m_replay->GetToken( m_replayNext++, curText, m_replayNumber );
+    }
+    else
+    {
+        curTok = DSN_EOF;
+        curText.clear();
+        m_replayNumber = nullptr;
+    }
+
+    return curTok;
+}
+
+
 int DSNLEXER::NextTok()
 {
+    if( m_replay )
+        return replayTok();
+
     const char*   cur  = next;
     const char*   head = cur;
 
@@ -832,6 +888,9 @@ exit:   // single point of exit, no returns elsewhere please.
 
     next = head;
 
+    if( m_recorder && curTok != DSN_EOF )
+        m_recorder->Add( curTok, curText, reader->LineNumber() );
+
     return curTok;
 }
 
@@ -861,6 +920,10 @@ wxArrayString* DSNLEXER::ReadCommentLines()
 
 double DSNLEXER::parseDouble()
 {
+    // A replayed token which was parsed when the snapshot was taken has its value already
+    if( m_replayNumber )
+        return *m_replayNumber;
+
     // Use fast_float::from_chars which is designed to be locale independent and significantly
     // faster than strtod and std::from_chars
     const std::string& str = CurStr();
@@ -875,5 +938,8 @@ double DSNLEXER::parseDouble()
                            CurLineNumber(), CurOffset() );
     }
 
+    if( m_recorder )
+        m_recorder->SetNumber( str, dval );
+
     return dval;
 }
@@ -24,8 +24,6 @@
 #define wxUSE_BASE64 1
 #include <wx/base64.h>
 
-#include <fmt/format.h>
-
 #include <kiid.h>
 #include <richio.h>
 #include <string_utils.h>
@@ -94,219 +92,223 @@ void FormatStreamData( OUTPUTFORMATTER& aOut, const wxStreamBuffer& aStream )
  *  )
  * )
  */
-void Prettify( std::string& aSource, FORMAT_MODE aMode )
-{
-    // Configuration
-    const char quoteChar = '"';
-    const char indentChar = '\t';
-    const int  indentSize = 1;
+// In order to visually compress PCB files, it is helpful to special-case long lists of (xy ...)
+// lists, which we allow to exist on a single line until we reach column 99.
+static constexpr int XY_SPECIAL_CASE_COLUMN_LIMIT = 99;
 
-    // In order to visually compress PCB files, it is helpful to special-case long lists of (xy ...)
-    // lists, which we allow to exist on a single line until we reach column 99.
-    const int  xySpecialCaseColumnLimit = 99;
+// If whitespace occurs inside a list after this threshold, it will be converted into a newline
+// and the indentation will be increased.  This is mainly used for image and group objects,
+// which contain potentially long sets of string tokens within a single list.
+static constexpr int CONSECUTIVE_TOKEN_WRAP_THRESHOLD = 72;
 
-    // If whitespace occurs inside a list after this threshold, it will be converted into a newline
-    // and the indentation will be increased.  This is mainly used for image and group objects,
-    // which contain potentially long sets of string tokens within a single list.
-    const int  consecutiveTokenWrapThreshold = 72;
+static constexpr char QUOTE_CHAR = '"';
+static constexpr char INDENT_CHAR = '\t';
+static constexpr int  INDENT_SIZE = 1;
 
-    const bool textSpecialCase = aMode == FORMAT_MODE::COMPACT_TEXT_PROPERTIES;
-    const bool libSpecialCase  = aMode == FORMAT_MODE::LIBRARY_TABLE;
 
-    std::string formatted;
-    formatted.reserve( aSource.length() );
+static bool isWhitespace( const char aChar )
+{
+    return ( aChar == ' ' || aChar == '\t' || aChar == '\n' || aChar == '\r' );
+}
 
-    auto cursor = aSource.begin();
-    auto seek = cursor;
-
-    int  listDepth = 0;
-    int  libDepth = 0;
-    char lastNonWhitespace = 0;
-    bool inQuote = false;
-    bool hasInsertedSpace = false;
-    bool inMultiLineList = false;
-    bool inXY = false;
-    bool inShortForm = false;
-    bool inLibRow = false;
-    int  shortFormDepth = 0;
-    int  column = 0;
-    int  backslashCount = 0;    // Count of successive backslash read since any other char
-
-    auto isWhitespace = []( const char aChar )
-            {
-                return ( aChar == ' ' || aChar == '\t' || aChar == '\n' || aChar == '\r' );
-            };
 
-    auto nextNonWhitespace =
-            [&]( std::string::iterator aIt )
-            {
-                seek = aIt;
+PRETTIFIER::PRETTIFIER( FORMAT_MODE aMode ) :
+        m_textSpecialCase( aMode == FORMAT_MODE::COMPACT_TEXT_PROPERTIES ),
+        m_libSpecialCase( aMode == FORMAT_MODE::LIBRARY_TABLE ),
+        m_started( false ),
+        m_listDepth( 0 ),
+        m_libDepth( 0 ),
+        m_lastNonWhitespace( 0 ),
+        m_inQuote( false ),
+        m_hasInsertedSpace( false ),
+        m_inMultiLineList( false ),
+        m_inXY( false ),
+        m_inShortForm( false ),
+        m_inLibRow( false ),
+        m_shortFormDepth( 0 ),
+        m_column( 0 ),
+        m_backslashCount( 0 )
+{
+}
 
-                while( seek != aSource.end() && isWhitespace( *seek ) )
-                    seek++;
 
-                if( seek == aSource.end() )
-                    return (char)0;
+void PRETTIFIER::Process( const char* aSource, size_t aLength, std::string& aOut )
+{
+    if( m_pending.empty() )
+    {
+        size_t used = process( std::string_view( aSource, aLength ), false, aOut );
+        m_pending.assign( aSource + used, aLength - used );
+    }
+    else
+    {
+        m_pending.append( aSource, aLength );
 
-                return *seek;
-            };
+        size_t used = process( m_pending, false, aOut );
+        m_pending.erase( 0, used );
+    }
+}
 
-    auto isXY =
-            [&]( std::string::iterator aIt )
-            {
-                seek = aIt;
 
-                if( ++seek == aSource.end() || *seek != 'x' )
-                    return false;
+void PRETTIFIER::Finish( std::string& aOut )
+{
+    process( m_pending, true, aOut );
+    m_pending.clear();
 
-                if( ++seek == aSource.end() || *seek != 'y' )
-                    return false;
+    // newline required at end of line / file for POSIX compliance. Keeps git diffs clean.
+    aOut += '\n';
+}
 
-                if( ++seek == aSource.end() || *seek != ' ' )
-                    return false;
 
-                return true;
-            };
+size_t PRETTIFIER::process( std::string_view aSource, bool aFinal, std::string& aOut )
+{
+    size_t cursor = 0;
 
-    auto isShortForm =
-            [&]( std::string::iterator aIt )
+    auto newLine =
+            [&]( int aDepth )
             {
-                seek = aIt;
-                std::string token;
-
-                while( ++seek != aSource.end() && isalpha( *seek ) )
-                    token += *seek;
-
-                return token == "font" || token == "stroke" || token == "fill" || token == "teardrop"
-                        || token == "offset" || token == "rotate" || token == "scale";
+                aOut.push_back( '\n' );
+                aOut.append( aDepth * INDENT_SIZE, INDENT_CHAR );
             };
 
-    auto isLib =
-            [&]( std::string::iterator aIt )
+    while( cursor < aSource.size() )
+    {
+        const char c = aSource[cursor];
+
+        if( isWhitespace( c ) && !m_inQuote )
+        {
+            if( !m_hasInsertedSpace         // Only permit one space between chars
+                && m_listDepth > 0          // Do not permit spaces in outer list
+                && m_lastNonWhitespace != '(' ) // Remove extra space after start of list
             {
-                seek = aIt;
-                std::string token;
+                size_t seek = cursor;
 
-                while( ++seek != aSource.end() && isalpha( *seek ) )
-                    token += *seek;
+                while( seek < aSource.size() && isWhitespace( aSource[seek] ) )
+                    seek++;
 
-                return token == "lib";
-            };
+                // Whatever follows the whitespace decides what it turns into
+                if( seek == aSource.size() && !aFinal )
+                    break;
 
-    while( cursor != aSource.end() )
-    {
-        char next = nextNonWhitespace( cursor );
+                char next = seek < aSource.size() ? aSource[seek] : 0;
 
-        if( isWhitespace( *cursor ) && !inQuote )
-        {
-            if( !hasInsertedSpace           // Only permit one space between chars
-                && listDepth > 0            // Do not permit spaces in outer list
-                && lastNonWhitespace != '(' // Remove extra space after start of list
-                && next != ')'              // Remove extra space before end of list
-                && next != '(' )            // Remove extra space before newline
-            {
-                if( inXY || column < consecutiveTokenWrapThreshold )
+                if( next != ')'             // Remove extra space before end of list
+                    && next != '(' )        // Remove extra space before newline
                 {
-                    // Note that we only insert spaces here, no matter what kind of whitespace is
-                    // in the input.  Newlines will be inserted as needed by the logic below.
-                    formatted.push_back( ' ' );
-                    column++;
+                    if( m_inXY || m_column < CONSECUTIVE_TOKEN_WRAP_THRESHOLD )
+                    {
+                        // Note that we only insert spaces here, no matter what kind of whitespace
+                        // is in the input.  Newlines will be inserted as needed by the logic below.
+                        aOut.push_back( ' ' );
+                        m_column++;
+                    }
+                    else if( m_inShortForm || m_inLibRow )
+                    {
+                        aOut.push_back( ' ' );
+                    }
+                    else
+                    {
+                        newLine( m_listDepth );
+                        m_column = m_listDepth * INDENT_SIZE;
+                        m_inMultiLineList = true;
+                    }
+
+                    m_hasInsertedSpace = true;
                 }
-                else if( inShortForm || inLibRow )
-                {
-                    formatted.push_back( ' ' );
-                }
-                else
-                {
-                    formatted += fmt::format( "\n{}",
-                                              std::string( listDepth * indentSize, indentChar ) );
-                    column = listDepth * indentSize;
-                    inMultiLineList = true;
-                }
-
-                hasInsertedSpace = true;
             }
         }
         else
         {
-            hasInsertedSpace = false;
-
-            if( *cursor == '(' && !inQuote )
+            if( c == '(' && !m_inQuote )
             {
-                bool currentIsXY = isXY( cursor );
-                bool currentIsShortForm = textSpecialCase && isShortForm( cursor );
-                bool currentIsLib = libSpecialCase && isLib( cursor );
+                // The list's keyword decides how it is laid out
+                size_t seek = cursor + 1;
 
-                if( formatted.empty() )
+                while( seek < aSource.size() && isalpha( (unsigned char) aSource[seek] ) )
+                    seek++;
+
+                if( seek == aSource.size() && !aFinal )
+                    break;
+
+                std::string_view token = aSource.substr( cursor + 1, seek - cursor - 1 );
+
+                bool currentIsXY = token == "xy" && seek < aSource.size() && aSource[seek] == ' ';
+                bool currentIsShortForm = m_textSpecialCase
+                                          && ( token == "font" || token == "stroke"
+                                               || token == "fill" || token == "teardrop"
+                                               || token == "offset" || token == "rotate"
+                                               || token == "scale" );
+                bool currentIsLib = m_libSpecialCase && token == "lib";
+
+                if( !m_started )
                 {
-                    formatted.push_back( '(' );
-                    column++;
+                    aOut.push_back( '(' );
+                    m_column++;
                 }
-                else if( inXY && currentIsXY && column < xySpecialCaseColumnLimit )
+                else if( m_inXY && currentIsXY && m_column < XY_SPECIAL_CASE_COLUMN_LIMIT )
                 {
                     // List-of-points special case
-                    formatted += " (";
-                    column += 2;
+                    aOut += " (";
+                    m_column += 2;
                 }
-                else if( inShortForm || inLibRow )
+                else if( m_inShortForm || m_inLibRow )
                 {
-                    formatted += " (";
-                    column += 2;
+                    aOut += " (";
+                    m_column += 2;
                 }
                 else
                 {
-                    formatted += fmt::format( "\n{}(",
-                                              std::string( listDepth * indentSize, indentChar ) );
-                    column = listDepth * indentSize + 1;
+                    newLine( m_listDepth );
+                    aOut.push_back( '(' );
+                    m_column = m_listDepth * INDENT_SIZE + 1;
                 }
 
-                inXY = currentIsXY;
+                m_inXY = currentIsXY;
 
                 if( currentIsShortForm )
                 {
-                    inShortForm = true;
-                    shortFormDepth = listDepth;
+                    m_inShortForm = true;
+                    m_shortFormDepth = m_listDepth;
                 }
                 else if( currentIsLib )
                 {
-                    inLibRow = true;
-                    libDepth = listDepth;
+                    m_inLibRow = true;
+                    m_libDepth = m_listDepth;
                 }
 
-                listDepth++;
+                m_listDepth++;
             }
-            else if( *cursor == ')' && !inQuote )
+            else if( c == ')' && !m_inQuote )
             {
-                if( listDepth > 0 )
-                    listDepth--;
+                if( m_listDepth > 0 )
+                    m_listDepth--;
 
-                if( inShortForm )
+                if( m_inShortForm )
                 {
-                    formatted.push_back( ')' );
-                    column++;
+                    aOut.push_back( ')' );
+                    m_column++;
                 }
-                else if( inLibRow && listDepth == libDepth )
+                else if( m_inLibRow && m_listDepth == m_libDepth )
                 {
-                    formatted.push_back( ')' );
-                    inLibRow = false;
+                    aOut.push_back( ')' );
+                    m_inLibRow = false;
                 }
-                else if( lastNonWhitespace == ')' || inMultiLineList )
+                else if( m_lastNonWhitespace == ')' || m_inMultiLineList )
                 {
-                    formatted += fmt::format( "\n{})",
-                                              std::string( listDepth * indentSize, indentChar ) );
-                    column = listDepth * indentSize + 1;
-                    inMultiLineList = false;
+                    newLine( m_listDepth );
+                    aOut.push_back( ')' );
+                    m_column = m_listDepth * INDENT_SIZE + 1;
+                    m_inMultiLineList = false;
                 }
                 else
                 {
-                    formatted.push_back( ')' );
-                    column++;
+                    aOut.push_back( ')' );
+                    m_column++;
                 }
 
-                if( shortFormDepth == listDepth )
+                if( m_shortFormDepth == m_listDepth )
                 {
-                    inShortForm = false;
-                    shortFormDepth = 0;
+                    m_inShortForm = false;
+                    m_shortFormDepth = 0;
                 }
             }
             else
@@ -314,26 +316,39 @@ void Prettify( std::string& aSource, FORMAT_MODE aMode )
                 // The output formatter escapes double-quotes (like \")
                 // But a corner case is a sequence like \\"
                 // therefore a '\' is attached to a '"' if a odd number of '\' is detected
-                if( *cursor == '\\' )
-                    backslashCount++;
-                else if( *cursor == quoteChar && ( backslashCount & 1 ) == 0 )
-                    inQuote = !inQuote;
+                if( c == '\\' )
+                    m_backslashCount++;
+                else if( c == QUOTE_CHAR && ( m_backslashCount & 1 ) == 0 )
+                    m_inQuote = !m_inQuote;
 
-                if( *cursor != '\\' )
-                    backslashCount = 0;
+                if( c != '\\' )
+                    m_backslashCount = 0;
 
-                formatted.push_back( *cursor );
-                column++;
+                aOut.push_back( c );
+                m_column++;
             }
 
-            lastNonWhitespace = *cursor;
+            m_hasInsertedSpace = false;
+            m_lastNonWhitespace = c;
+            m_started = true;
         }
 
         ++cursor;
     }
 
-    // newline required at end of line / file for POSIX compliance. Keeps git diffs clean.
-    formatted += '\n';
+    return cursor;
+}
+
+
+void Prettify( std::string& aSource, FORMAT_MODE aMode )
+{
+    PRETTIFIER  prettifier( aMode );
+    std::string formatted;
+
+    formatted.reserve( aSource.length() );
+
+    prettifier.Process( aSource.data(), aSource.length(), formatted );
+    prettifier.Finish( formatted );
 
     aSource = std::move( formatted );
 }
@@ -27,13 +27,18 @@ JOB_PCB_DRC::JOB_PCB_DRC() :
     m_reportAllTrackErrors( false ),
     m_parity( true ),
     m_refillZones( false ),
-    m_saveBoard( false )
+    m_saveBoard( false ),
+    m_shardCount( 1 ),
+    m_shardIndex( -1 )
 {
     m_params.emplace_back( new JOB_PARAM<bool>( "parity", &m_parity, m_parity ) );
     m_params.emplace_back(
             new JOB_PARAM<bool>( "report_all_track_errors", &m_reportAllTrackErrors, m_reportAllTrackErrors ) );
     m_params.emplace_back( new JOB_PARAM<bool>( "refill_zones", &m_refillZones, m_refillZones ) );
     m_params.emplace_back( new JOB_PARAM<bool>( "save_board", &m_saveBoard, m_saveBoard ) );
+    m_params.emplace_back( new JOB_PARAM<wxString>( "profile_output", &m_profileOutputPath,
+                                                    m_profileOutputPath ) );
+    m_params.emplace_back( new JOB_PARAM<int>( "shards", &m_shardCount, m_shardCount ) );
 }
 
 
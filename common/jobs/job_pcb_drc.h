@@ -34,4 +34,9 @@ public:
 
     bool m_refillZones;
     bool m_saveBoard;
+
+    wxString m_profileOutputPath;     ///< Write a DRC_PROFILE here if not empty
+
+    int m_shardCount;                 ///< Split DRC over this many worker processes if > 1
+    int m_shardIndex;                 ///< The tile checked by a DRC worker process, or -1
 };
\ No newline at end of file
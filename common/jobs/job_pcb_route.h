@@ -0,0 +1,61 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOB_PCB_ROUTE_H
+#define JOB_PCB_ROUTE_H
+
+#include <vector>
+#include <kicommon.h>
+#include "job.h"
+
+class KICOMMON_API JOB_PCB_ROUTE : public JOB
+{
+public:
+    JOB_PCB_ROUTE();
+
+    enum class MODE
+    {
+        WALKAROUND,
+        SHOVE
+    };
+
+    enum class ORDER
+    {
+        BOARD,
+        SHORTEST_FIRST
+    };
+
+    wxString              m_filename;
+
+    /// Names of the nets to route; all nets are routed if empty
+    std::vector<wxString> m_nets;
+    MODE                  m_mode;
+    ORDER                 m_order;
+
+    /// Number of times failed connections are retried after the others are routed
+    int                   m_retries;
+
+    /// Route independent areas of the board concurrently
+    bool                  m_parallel;
+
+    /// Return a nonzero exit code if some connections could not be routed
+    bool                  m_exitCodeUnrouted;
+};
+
+#endif
@@ -0,0 +1,436 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <lexer_snapshot.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+#include <advanced_config.h>
+#include <build_version.h>
+#include <kiplatform/io.h>
+#include <mmh3_hash.h>
+#include <paths.h>
+#include <richio.h>
+
+
+static const wxChar traceLexerSnapshot[] = wxT( "KICAD_LEXER_SNAPSHOT" );
+
+
+/*
+ * A snapshot is written in the native byte order, as it never leaves the machine:
+ *
+ *   SNAPSHOT_HEADER
+ *   SNAPSHOT_TOKEN[tokenCount]
+ *   SNAPSHOT_LINE_RUN[lineRunCount]
+ *   the text pool, of poolSize bytes
+ *
+ * The pool is a sequence of SNAPSHOT_TEXT entries, each followed by its nul terminated text
+ * and padded to a multiple of 8 bytes.  Tokens refer to their entry by its offset / 8.
+ */
+
+static const char     SNAPSHOT_MAGIC[8] = { 'K', 'I', 'C', 'A', 'D', 'T', 'O', 'K' };
+static const uint32_t SNAPSHOT_VERSION = 1;
+static const uint32_t SNAPSHOT_HAS_NUMBER = 1;
+
+struct SNAPSHOT_HEADER
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t lineCount;
+    uint64_t build;         ///< hash of the version of KiCad which wrote the snapshot
+    uint64_t tokenCount;
+    uint64_t lineRunCount;
+    uint64_t poolSize;
+};
+
+struct SNAPSHOT_TOKEN
+{
+    int32_t  tok;
+    uint32_t text;
+};
+
+struct SNAPSHOT_LINE_RUN
+{
+    uint32_t firstToken;
+    uint32_t line;
+};
+
+struct SNAPSHOT_TEXT
+{
+    uint32_t length;
+    uint32_t flags;
+    double   number;
+};
+
+
+static uint64_t buildHash()
+{
+    static const uint64_t hash =
+            []()
+            {
+                MMH3_HASH mmh3;
+                mmh3.add( std::string( GetBuildVersion().ToUTF8() ) );
+                return mmh3.digest().Value64[0];
+            }();
+
+    return hash;
+}
+
+
+static size_t paddedSize( size_t aSize )
+{
+    return ( aSize + 7 ) & ~size_t( 7 );
+}
+
+
+/**
+ * Remove the snapshots used longest ago from \a aDir until the rest fit in the cache size set in
+ * the advanced config.  Opening a snapshot touches it, so its modification time is when it was
+ * last used.
+ *
+ * @param aKeep is the snapshot just written, which is never removed.
+ */
+static void pruneSnapshots( const wxString& aDir, const wxString& aKeep )
+{
+    struct CACHED_SNAPSHOT
+    {
+        wxString fileName;
+        time_t   lastUsed;
+        uint64_t size;
+    };
+
+    std::vector<CACHED_SNAPSHOT> snapshots;
+    wxArrayString                fileNames;
+    uint64_t                     total = 0;
+
+    wxDir::GetAllFiles( aDir, &fileNames, wxT( "*.tok" ), wxDIR_FILES );
+
+    for( const wxString& fileName : fileNames )
+    {
+        wxFileName  fn( fileName );
+        wxDateTime  modified;
+        wxULongLong size = fn.GetSize();
+
+        if( size == wxInvalidSize || !fn.GetTimes( nullptr, &modified, nullptr ) )
+            continue;
+
+        snapshots.push_back( { fileName, modified.GetTicks(), size.GetValue() } );
+        total += size.GetValue();
+    }
+
+    const uint64_t limit =
+            uint64_t( ADVANCED_CFG::GetCfg().m_LexerSnapshotCacheSize ) * 1024 * 1024;
+
+    if( total <= limit )
+        return;
+
+    std::sort( snapshots.begin(), snapshots.end(),
+               []( const CACHED_SNAPSHOT& aLhs, const CACHED_SNAPSHOT& aRhs )
+               {
+                   return aLhs.lastUsed < aRhs.lastUsed;
+               } );
+
+    for( const CACHED_SNAPSHOT& snapshot : snapshots )
+    {
+        if( total <= limit )
+            break;
+
+        if( snapshot.fileName == aKeep )
+            continue;
+
+        // Fails harmlessly for a snapshot another process has open on platforms which forbid
+        // removing it
+        if( wxRemoveFile( snapshot.fileName ) )
+        {
+            wxLogTrace( traceLexerSnapshot, wxT( "Removed snapshot '%s'" ), snapshot.fileName );
+            total -= snapshot.size;
+        }
+    }
+}
+
+
+LEXER_SNAPSHOT::~LEXER_SNAPSHOT()
+{
+    if( m_data )
+        KIPLATFORM::IO::UnmapFile( m_data, m_size );
+}
+
+
+bool LEXER_SNAPSHOT::IsEnabled()
+{
+    return ADVANCED_CFG::GetCfg().m_EnableLexerSnapshots;
+}
+
+
+wxString LEXER_SNAPSHOT::GetSnapshotFileName( const MMAP_LINE_READER& aReader )
+{
+    // The token numbers depend on the lexer, which goes with the file type
+    MMH3_HASH hash;
+    hash.add( std::string( wxFileName( aReader.GetSource() ).GetExt().ToUTF8() ) );
+    hash.addData( reinterpret_cast<const uint8_t*>( aReader.FileData() ),
+                  size_t( aReader.FileLength() ) );
+
+    wxFileName snapshotFile;
+
+    snapshotFile.AssignDir( PATHS::GetUserCachePath() );
+    snapshotFile.AppendDir( wxT( "lexer" ) );
+
+    if( !PATHS::EnsurePathExists( snapshotFile.GetPath() ) )
+    {
+        wxLogTrace( traceLexerSnapshot, wxT( "Failed to create snapshot directory '%s'" ),
+                    snapshotFile.GetPath() );
+        return wxEmptyString;
+    }
+
+    snapshotFile.SetName( hash.digest().ToString() );
+    snapshotFile.SetExt( wxT( "tok" ) );
+
+    return snapshotFile.GetFullPath();
+}
+
+
+std::unique_ptr<LEXER_SNAPSHOT> LEXER_SNAPSHOT::Open( const wxString& aSnapshotFile,
+                                                      const wxString& aSource )
+{
+    if( !wxFileName::FileExists( aSnapshotFile ) )
+        return nullptr;
+
+    std::unique_ptr<LEXER_SNAPSHOT> snapshot( new LEXER_SNAPSHOT( aSource ) );
+
+    snapshot->m_data = KIPLATFORM::IO::MapFile( aSnapshotFile, snapshot->m_size );
+
+    if( !snapshot->m_data || snapshot->m_size < sizeof( SNAPSHOT_HEADER ) )
+        return nullptr;
+
+    SNAPSHOT_HEADER header;
+    memcpy( &header, snapshot->m_data, sizeof( header ) );
+
+    if( memcmp( header.magic, SNAPSHOT_MAGIC, sizeof( SNAPSHOT_MAGIC ) ) != 0
+        || header.version != SNAPSHOT_VERSION || header.build != buildHash() )
+    {
+        wxLogTrace( traceLexerSnapshot, wxT( "Ignoring snapshot '%s' of another version" ),
+                    aSnapshotFile );
+        return nullptr;
+    }
+
+    size_t remaining = snapshot->m_size - sizeof( SNAPSHOT_HEADER );
+
+    if( header.tokenCount > remaining / sizeof( SNAPSHOT_TOKEN )
+        || header.lineRunCount > remaining / sizeof( SNAPSHOT_LINE_RUN )
+        || header.poolSize > remaining
+        || header.tokenCount * sizeof( SNAPSHOT_TOKEN )
+                   + header.lineRunCount * sizeof( SNAPSHOT_LINE_RUN ) + header.poolSize
+               != remaining )
+    {
+        wxLogTrace( traceLexerSnapshot, wxT( "Ignoring truncated snapshot '%s'" ), aSnapshotFile );
+        return nullptr;
+    }
+
+    snapshot->m_tokenCount = header.tokenCount;
+    snapshot->m_lineRunCount = header.lineRunCount;
+    snapshot->m_lineCount = header.lineCount;
+    snapshot->m_poolSize = header.poolSize;
+    snapshot->m_tokens = snapshot->m_data + sizeof( SNAPSHOT_HEADER );
+    snapshot->m_lineRuns = snapshot->m_tokens + header.tokenCount * sizeof( SNAPSHOT_TOKEN );
+    snapshot->m_pool = snapshot->m_lineRuns + header.lineRunCount * sizeof( SNAPSHOT_LINE_RUN );
+
+    // Make sure every text a token refers to lies within the pool, so replaying can't read
+    // outside of the mapping
+    const SNAPSHOT_TOKEN* tokens = reinterpret_cast<const SNAPSHOT_TOKEN*>( snapshot->m_tokens );
+
+    for( size_t ii = 0; ii < snapshot->m_tokenCount; ++ii )
+    {
+        size_t offset = size_t( tokens[ii].text ) * 8;
+
+        if( offset + sizeof( SNAPSHOT_TEXT ) > snapshot->m_poolSize
+            || offset + sizeof( SNAPSHOT_TEXT )
+                       + reinterpret_cast<const SNAPSHOT_TEXT*>( snapshot->m_pool + offset )->length
+                   >= snapshot->m_poolSize )
+        {
+            wxLogTrace( traceLexerSnapshot, wxT( "Ignoring corrupt snapshot '%s'" ),
+                        aSnapshotFile );
+            return nullptr;
+        }
+    }
+
+    // Keep the snapshot ahead of those which haven't been used for longer when pruning
+    wxFileName( aSnapshotFile ).Touch();
+
+    return snapshot;
+}
+
+
+int LEXER_SNAPSHOT::GetTok( size_t aIndex ) const
+{
+    wxCHECK( aIndex < m_tokenCount, 0 );
+
+    return reinterpret_cast<const SNAPSHOT_TOKEN*>( m_tokens )[aIndex].tok;
+}
+
+
+int LEXER_SNAPSHOT::GetToken( size_t aIndex, std::string& aText, const double*& aNumber ) const
+{
+    wxCHECK( aIndex < m_tokenCount, 0 );
+
+    const SNAPSHOT_TOKEN& token = reinterpret_cast<const SNAPSHOT_TOKEN*>( m_tokens )[aIndex];
+    const char*           entry = m_pool + size_t( token.text ) * 8;
+    const SNAPSHOT_TEXT*  text = reinterpret_cast<const SNAPSHOT_TEXT*>( entry );
+
+    aText.assign( entry + sizeof( SNAPSHOT_TEXT ), text->length );
+    aNumber = ( text->flags & SNAPSHOT_HAS_NUMBER ) ? &text->number : nullptr;
+
+    return token.tok;
+}
+
+
+unsigned LEXER_SNAPSHOT::GetLineNumber( size_t aIndex ) const
+{
+    const SNAPSHOT_LINE_RUN* begin = reinterpret_cast<const SNAPSHOT_LINE_RUN*>( m_lineRuns );
+    const SNAPSHOT_LINE_RUN* end = begin + m_lineRunCount;
+
+    const SNAPSHOT_LINE_RUN* run = std::upper_bound( begin, end, aIndex,
+            []( size_t aToken, const SNAPSHOT_LINE_RUN& aRun )
+            {
+                return aToken < aRun.firstToken;
+            } );
+
+    if( run == begin )
+        return 0;
+
+    return ( run - 1 )->line;
+}
+
+
+void LEXER_SNAPSHOT_WRITER::Add( int aTok, const std::string& aText, unsigned aLineNumber )
+{
+    uint32_t index = m_tokens.size() / 2;
+
+    if( m_lineRuns.empty() || m_lineRuns.back() != aLineNumber )
+    {
+        m_lineRuns.push_back( index );
+        m_lineRuns.push_back( aLineNumber );
+    }
+
+    m_tokens.push_back( static_cast<uint32_t>( aTok ) );
+    m_tokens.push_back( addText( aText ) );
+
+    m_lineCount = std::max( m_lineCount, aLineNumber );
+}
+
+
+void LEXER_SNAPSHOT_WRITER::SetNumber( const std::string& aText, double aValue )
+{
+    if( m_tokens.empty() )
+        return;
+
+    // Only the parser's current token can be parsed, which is the last one read
+    SNAPSHOT_TEXT text;
+    char*         entry = m_pool.data() + size_t( m_tokens.back() ) * 8;
+
+    memcpy( &text, entry, sizeof( text ) );
+
+    if( text.length != aText.length()
+        || memcmp( entry + sizeof( text ), aText.data(), aText.length() ) != 0 )
+    {
+        return;
+    }
+
+    text.flags |= SNAPSHOT_HAS_NUMBER;
+    text.number = aValue;
+    memcpy( entry, &text, sizeof( text ) );
+}
+
+
+uint32_t LEXER_SNAPSHOT_WRITER::addText( const std::string& aText )
+{
+    auto it = m_poolRefs.find( aText );
+
+    if( it != m_poolRefs.end() )
+        return it->second;
+
+    uint32_t      ref = m_pool.size() / 8;
+    SNAPSHOT_TEXT text = { static_cast<uint32_t>( aText.length() ), 0, 0.0 };
+
+    m_pool.resize( m_pool.size() + paddedSize( sizeof( text ) + aText.length() + 1 ), '\0' );
+
+    char* entry = m_pool.data() + size_t( ref ) * 8;
+    memcpy( entry, &text, sizeof( text ) );
+    memcpy( entry + sizeof( text ), aText.data(), aText.length() );
+
+    m_poolRefs.emplace( aText, ref );
+    return ref;
+}
+
+
+bool LEXER_SNAPSHOT_WRITER::Save( const wxString& aSnapshotFile ) const
+{
+    SNAPSHOT_HEADER header;
+
+    memcpy( header.magic, SNAPSHOT_MAGIC, sizeof( SNAPSHOT_MAGIC ) );
+    header.version = SNAPSHOT_VERSION;
+    header.lineCount = m_lineCount;
+    header.build = buildHash();
+    header.tokenCount = m_tokens.size() / 2;
+    header.lineRunCount = m_lineRuns.size() / 2;
+    header.poolSize = m_pool.size();
+
+    // Several jobs may be saving the same snapshot: each writes its own file and the last
+    // one renamed wins
+    wxFileName snapshotFile( aSnapshotFile );
+    wxString   tempFile = wxFileName::CreateTempFileName( snapshotFile.GetPathWithSep()
+                                                          + snapshotFile.GetName() );
+
+    if( tempFile.IsEmpty() )
+        return false;
+
+    bool ok;
+
+    {
+        wxFFile file( tempFile, wxT( "wb" ) );
+
+        ok = file.IsOpened()
+             && file.Write( &header, sizeof( header ) ) == sizeof( header )
+             && file.Write( m_tokens.data(), m_tokens.size() * sizeof( uint32_t ) )
+                        == m_tokens.size() * sizeof( uint32_t )
+             && file.Write( m_lineRuns.data(), m_lineRuns.size() * sizeof( uint32_t ) )
+                        == m_lineRuns.size() * sizeof( uint32_t )
+             && file.Write( m_pool.data(), m_pool.size() ) == m_pool.size()
+             && file.Close();
+    }
+
+    if( ok )
+        ok = wxRenameFile( tempFile, aSnapshotFile, true );
+
+    if( !ok )
+    {
+        wxLogTrace( traceLexerSnapshot, wxT( "Failed to write snapshot '%s'" ), aSnapshotFile );
+        wxRemoveFile( tempFile );
+        return false;
+    }
+
+    pruneSnapshots( snapshotFile.GetPath(), snapshotFile.GetFullPath() );
+    return true;
+}
@@ -26,6 +26,7 @@
 #include <cstdarg>
 #include <config.h> // HAVE_FGETC_NOLOCK
 
+#include <kiplatform/environment.h>
 #include <kiplatform/io.h>
 #include <core/ignore.h>
 #include <richio.h>
@@ -35,6 +36,7 @@
 
 #include <wx/translation.h>
 #include <wx/ffile.h>
+#include <wx/filename.h>
 
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
@@ -239,6 +241,108 @@ char* FILE_LINE_READER::ReadLine()
 }
 
 
+MMAP_LINE_READER::MMAP_LINE_READER( const wxString& aFileName, unsigned aStartingLineNumber,
+                                    unsigned aMaxLineLength ) :
+        LINE_READER( aMaxLineLength ),
+        m_data( nullptr ),
+        m_size( 0 ),
+        m_pos( 0 ),
+        m_mapped( false ),
+        m_buffer( m_line )
+{
+    // A mapped file which goes away under us takes the process with it, so only map regular
+    // local files.  Pipes, devices and the like are read in one go.
+    if( wxFileName::FileExists( aFileName ) && !KIPLATFORM::ENV::IsNetworkPath( aFileName ) )
+    {
+        m_data = KIPLATFORM::IO::MapFile( aFileName, m_size );
+        m_mapped = m_data != nullptr;
+    }
+
+    if( !m_mapped )
+    {
+        FILE* fp = KIPLATFORM::IO::SeqFOpen( aFileName, wxT( "rb" ) );
+
+        if( !fp )
+        {
+            wxString msg = wxString::Format( _( "Unable to open %s for reading." ),
+                                             aFileName.GetData() );
+            THROW_IO_ERROR( msg );
+        }
+
+        char   chunk[64 * 1024];
+        size_t count;
+
+        while( ( count = fread( chunk, 1, sizeof( chunk ), fp ) ) > 0 )
+            m_contents.append( chunk, count );
+
+        fclose( fp );
+
+        m_data = m_contents.data();
+        m_size = m_contents.size();
+    }
+
+    m_source  = aFileName;
+    m_lineNum = aStartingLineNumber;
+}
+
+
+MMAP_LINE_READER::~MMAP_LINE_READER()
+{
+    if( m_mapped )
+        KIPLATFORM::IO::UnmapFile( m_data, m_size );
+
+    // Hand the line buffer back for ~LINE_READER() to free
+    m_line = m_buffer;
+}
+
+
+char* MMAP_LINE_READER::ReadLine()
+{
+    // m_lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++m_lineNum;
+
+    m_line = m_buffer;
+    m_length = 0;
+
+    if( m_pos >= m_size )
+    {
+        m_line[0] = 0;
+        return nullptr;
+    }
+
+    const char* begin = m_data + m_pos;
+    const char* eol = static_cast<const char*>( memchr( begin, '\n', m_size - m_pos ) );
+    size_t      length = eol ? eol - begin + 1 : m_size - m_pos;
+
+    if( length >= m_maxLineLength )
+        THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+    m_pos += length;
+
+    if( eol )
+    {
+        // The line ends with a newline, which stops any look ahead by the lexer before it runs
+        // off the end of the file.
+        m_line = const_cast<char*>( begin );
+    }
+    else
+    {
+        // The last line has nothing after it, so it gets copied and nul terminated.
+        if( length + 1 > m_capacity )
+            expandCapacity( length + 1 );
+
+        m_buffer = m_line;
+        memcpy( m_line, begin, length );
+        m_line[length] = 0;
+    }
+
+    m_length = length;
+
+    return m_line;
+}
+
+
 STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ):
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_lines( aString ), m_ndx( 0 )
@@ -570,11 +674,12 @@ PRETTIFIED_FILE_OUTPUTFORMATTER::PRETTIFIED_FILE_OUTPUTFORMATTER( const wxString
                                                                   const wxChar* aMode,
                                                                   char aQuoteChar ) :
         OUTPUTFORMATTER( OUTPUTFMTBUFZ, aQuoteChar ),
-        m_mode( aFormatMode )
+        m_mode( ADVANCED_CFG::GetCfg().m_CompactSave
+                                && aFormatMode == KICAD_FORMAT::FORMAT_MODE::NORMAL
+                        ? KICAD_FORMAT::FORMAT_MODE::COMPACT_TEXT_PROPERTIES
+                        : aFormatMode ),
+        m_prettifier( m_mode )
 {
-    if( ADVANCED_CFG::GetCfg().m_CompactSave && m_mode == KICAD_FORMAT::FORMAT_MODE::NORMAL )
-        m_mode = KICAD_FORMAT::FORMAT_MODE::COMPACT_TEXT_PROPERTIES;
-
     m_fp = wxFopen( aFileName, aMode );
 
     if( !m_fp )
@@ -598,9 +703,10 @@ bool PRETTIFIED_FILE_OUTPUTFORMATTER::Finish()
     if( !m_fp )
         return false;
 
-    KICAD_FORMAT::Prettify( m_buf, m_mode );
+    flush();
+    m_prettifier.Finish( m_out );
 
-    if( fwrite( m_buf.c_str(), m_buf.length(), 1, m_fp ) != 1 )
+    if( fwrite( m_out.c_str(), m_out.length(), 1, m_fp ) != 1 )
         THROW_IO_ERROR( strerror( errno ) );
 
     fclose( m_fp );
@@ -610,7 +716,26 @@ bool PRETTIFIED_FILE_OUTPUTFORMATTER::Finish()
 }
 
 
+void PRETTIFIED_FILE_OUTPUTFORMATTER::flush()
+{
+    m_prettifier.Process( m_buf.data(), m_buf.length(), m_out );
+    m_buf.clear();
+
+    if( !m_out.empty() && fwrite( m_out.c_str(), m_out.length(), 1, m_fp ) != 1 )
+        THROW_IO_ERROR( strerror( errno ) );
+
+    m_out.clear();
+}
+
+
 void PRETTIFIED_FILE_OUTPUTFORMATTER::write( const char* aOutBuf, int aCount )
 {
+    // Formatting is done in pieces as the text comes in, so the whole file never has to be
+    // held in memory.
+    static constexpr size_t FLUSH_SIZE = 256 * 1024;
+
     m_buf.append( aOutBuf, aCount );
+
+    if( m_buf.length() >= FLUSH_SIZE )
+        flush();
 }
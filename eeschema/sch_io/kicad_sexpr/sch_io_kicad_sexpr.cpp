@@ -33,6 +33,7 @@
 #include <sch_selection.h>
 #include <font/fontconfig.h>
 #include <io/kicad/kicad_io_utils.h>
+#include <lexer_snapshot.h>
 #include <libraries/symbol_library_adapter.h>
 #include <progress_reporter.h>
 #include <schematic.h>
@@ -294,27 +295,79 @@ void SCH_IO_KICAD_SEXPR::loadHierarchy( const SCH_SHEET_PATH& aParentSheetPath,
 
 void SCH_IO_KICAD_SEXPR::loadFile( const wxString& aFileName, SCH_SHEET* aSheet )
 {
-    FILE_LINE_READER reader( aFileName );
-
-    size_t lineCount = 0;
-
     if( m_progressReporter )
     {
         m_progressReporter->Report( wxString::Format( _( "Loading %s..." ), aFileName ) );
 
         if( !m_progressReporter->KeepRefreshing() )
             THROW_IO_ERROR( _( "Open canceled by user." ) );
+    }
+
+    MMAP_LINE_READER reader( aFileName );
+
+    // Sheets appended to a schematic aren't parsed the same way, so they don't use snapshots
+    wxString snapshotFile;
+
+    if( !m_appending && LEXER_SNAPSHOT::IsEnabled() )
+        snapshotFile = LEXER_SNAPSHOT::GetSnapshotFileName( reader );
+
+    if( !snapshotFile.IsEmpty() )
+    {
+        if( std::unique_ptr<LEXER_SNAPSHOT> snapshot = LEXER_SNAPSHOT::Open( snapshotFile,
+                                                                             aFileName ) )
+        {
+            STRING_LINE_READER        replayReader( std::string(), aFileName );
+            SCH_IO_KICAD_SEXPR_PARSER parser( &replayReader, m_progressReporter,
+                                              snapshot->GetLineCount(), m_rootSheet,
+                                              m_appending );
+
+            parser.SetReplay( snapshot.get() );
+
+            try
+            {
+                parser.ParseSchematic( aSheet );
+                return;
+            }
+            catch( const IO_ERROR& ioe )
+            {
+                // A replayed token has no line text or offset to report, so read the file as
+                // text to give the error in full.  Should the snapshot have been at fault, this
+                // also replaces it.
+                wxLogTrace( traceSchPlugin, wxT( "Replaying '%s' failed: %s" ), snapshotFile,
+                            ioe.What() );
+
+                // Start again from an empty sheet, without what was replayed before the error
+                SCH_SCREEN* screen = new SCH_SCREEN( m_schematic );
+                screen->SetFileName( aSheet->GetScreen()->GetFileName() );
+                aSheet->SetScreen( screen );
+            }
+        }
+    }
+
+    size_t lineCount = 0;
 
+    if( m_progressReporter )
+    {
         while( reader.ReadLine() )
             lineCount++;
 
         reader.Rewind();
     }
 
-    SCH_IO_KICAD_SEXPR_PARSER parser( &reader, m_progressReporter, lineCount, m_rootSheet,
-                                      m_appending );
+    SCH_IO_KICAD_SEXPR_PARSER             parser( &reader, m_progressReporter, lineCount,
+                                                  m_rootSheet, m_appending );
+    std::unique_ptr<LEXER_SNAPSHOT_WRITER> recorder;
+
+    if( !snapshotFile.IsEmpty() )
+    {
+        recorder = std::make_unique<LEXER_SNAPSHOT_WRITER>();
+        parser.SetRecorder( recorder.get() );
+    }
 
     parser.ParseSchematic( aSheet );
+
+    if( recorder )
+        recorder->Save( snapshotFile );
 }
 
 
@@ -68,7 +68,7 @@ void SCH_IO_KICAD_SEXPR_LIB_CACHE::Load()
         wxLogTrace( traceSchLegacyPlugin, "Loading sexpr symbol library file '%s'",
                     m_libFileName.GetFullPath() );
 
-        FILE_LINE_READER reader( m_libFileName.GetFullPath() );
+        MMAP_LINE_READER reader( m_libFileName.GetFullPath() );
 
         SCH_IO_KICAD_SEXPR_PARSER parser( &reader );
 
@@ -97,7 +97,7 @@ void SCH_IO_KICAD_SEXPR_LIB_CACHE::Load()
 
                 try
                 {
-                    FILE_LINE_READER reader( tmp.GetFullPath() );
+                    MMAP_LINE_READER reader( tmp.GetFullPath() );
                     SCH_IO_KICAD_SEXPR_PARSER parser( &reader );
 
                     parser.ParseLib( m_symbols );
@@ -83,7 +83,6 @@ SCH_IO_KICAD_SEXPR_PARSER::SCH_IO_KICAD_SEXPR_PARSER( LINE_READER* aLineReader,
         m_bodyStyle( 1 ),
         m_appending( aIsAppending ),
         m_progressReporter( aProgressReporter ),
-        m_lineReader( aLineReader ),
         m_lastProgressLine( 0 ),
         m_lineCount( aLineCount ),
         m_rootSheet( aRootSheet ),
@@ -98,7 +97,7 @@ void SCH_IO_KICAD_SEXPR_PARSER::checkpoint()
 
     if( m_progressReporter )
     {
-        unsigned curLine = m_lineReader->LineNumber();
+        unsigned curLine = CurLineNumber();
 
         if( curLine > m_lastProgressLine + PROGRESS_DELTA )
         {
@@ -263,7 +263,6 @@ private:
     std::set<KIID>     m_uuids;
 
     PROGRESS_REPORTER* m_progressReporter;  // optional; may be nullptr
-    const LINE_READER* m_lineReader;        // for progress reporting
     unsigned           m_lastProgressLine;
     unsigned           m_lineCount;         // for progress reporting
 
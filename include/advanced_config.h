@@ -916,6 +916,40 @@ public:
      */
     int m_HistoryLockStaleTimeout;
 
+    /**
+     * Keep a binary snapshot of the tokens of each board and schematic file loaded, in the user
+     * cache directory, and replay it instead of lexing the file the next time the same file
+     * contents are loaded.  Intended for batch jobs which load the same files over and over.
+     *
+     * The snapshot has to be recorded in file order, so a board load which records one doesn't
+     * use the parallel loader and is slower than usual; replaying the snapshot is parallel again.
+     *
+     * Setting name: "EnableLexerSnapshots"
+     * Valid values: 0 or 1
+     * Default value: 0
+     */
+    bool m_EnableLexerSnapshots;
+
+    /**
+     * The most disk space the lexer snapshots may take, in megabytes.  The snapshots used
+     * longest ago are removed when a new one takes the total over this.
+     *
+     * Setting name: "LexerSnapshotCacheSize"
+     * Valid values: 1 to 65536
+     * Default value: 256
+     */
+    int m_LexerSnapshotCacheSize;
+
+    /**
+     * Re-check the items touched by each edit in the board editor as it is made, once DRC has
+     * been run on the board.  Only the tests which can be limited to a set of items are run.
+     *
+     * Setting name: "LiveIncrementalDRC"
+     * Valid values: 0 or 1
+     * Default value: 0
+     */
+    bool m_LiveIncrementalDRC;
+
     wxString m_traceMasks; ///< Trace masks for wxLogTrace, loaded from the config file.
     ///@}
 
@@ -31,6 +31,7 @@
 #include <string>
 #include <vector>
 
+#include <lexer_snapshot.h>
 #include <richio.h>
 
 #ifndef SWIG
@@ -194,6 +195,26 @@ public:
      */
     LINE_READER* PopReader();
 
+    /**
+     * Read tokens from a #LEXER_SNAPSHOT instead of the #LINE_READER.
+     *
+     * Tokens \a aFirst up to but not including \a aLast are replayed, after which #DSN_EOF
+     * is returned.
+     *
+     * @param aSnapshot is the snapshot to replay, or nullptr to read from the #LINE_READER again.
+     */
+    void SetReplay( const LEXER_SNAPSHOT* aSnapshot, size_t aFirst = 0,
+                    size_t aLast = SIZE_MAX );
+
+    bool IsReplaying() const { return m_replay != nullptr; }
+
+    /**
+     * Add every token read from now on to \a aRecorder, or stop recording if it is nullptr.
+     */
+    void SetRecorder( LEXER_SNAPSHOT_WRITER* aRecorder ) { m_recorder = aRecorder; }
+
+    bool IsRecording() const { return m_recorder != nullptr; }
+
     /**
      * Return the next token found in the input file or DSN_EOF when reaching the end of
      * file.
@@ -446,6 +467,9 @@ public:
      */
     int CurLineNumber() const
     {
+        if( m_replay )
+            return m_replay->GetLineNumber( m_replayNext ? m_replayNext - 1 : 0 );
+
         return reader->LineNumber();
     }
 
@@ -454,7 +478,13 @@ public:
      */
     const char* CurLine() const
     {
-        return (const char*)(*reader);
+        // A snapshot doesn't keep the text of the lines
+        if( m_replay )
+            return "";
+
+        // The reader's line need not be nul terminated, see #MMAP_LINE_READER
+        curLine.assign( reader->Line(), reader->Length() );
+        return curLine.c_str();
     }
 
     /**
@@ -464,6 +494,9 @@ public:
      */
     const wxString& CurSource() const
     {
+        if( m_replay )
+            return m_replay->GetSource();
+
         return reader->GetSource();
     }
 
@@ -484,6 +517,9 @@ protected:
 
     inline bool isSep( char cc );
 
+    /// NextTok() when replaying a #LEXER_SNAPSHOT.
+    int replayTok();
+
     int readLine()
     {
         if( reader )
@@ -577,8 +613,15 @@ protected:
 
     int                 curTok;                 ///< The current token obtained on last NextTok().
     std::string         curText;                ///< The text of the current token.
+    mutable std::string curLine;                ///< A nul terminated copy of the current line.
     std::string         curSeparator;           ///< The text of the separator preceeding the current text.
 
+    const LEXER_SNAPSHOT* m_replay;             ///< Snapshot to read instead of the reader, if any.
+    size_t              m_replayNext;           ///< Index of the next token to replay.
+    size_t              m_replayEnd;            ///< Index after the last token to replay.
+    const double*       m_replayNumber;         ///< Replayed value of the current token, if known.
+    LEXER_SNAPSHOT_WRITER* m_recorder;          ///< Where the tokens read go, if recording.
+
     const KEYWORD*      keywords;               ///< Table sorted by CMake for bsearch().
     unsigned            keywordCount;           ///< Count of keywords table.
     const KEYWORD_MAP*  keywordsLookup;         ///< Fast, specialized "C string" hashtable.
@@ -20,6 +20,8 @@
 #pragma once
 
 #include <optional>
+#include <string>
+#include <string_view>
 
 #include <wx/stream.h>
 #include <wx/string.h>
@@ -93,4 +95,53 @@ enum class KICOMMON_API FORMAT_MODE
  */
 KICOMMON_API void Prettify( std::string& aSource, FORMAT_MODE aMode = FORMAT_MODE::NORMAL );
 
+/**
+ * Pretty-prints s-expression text a piece at a time, following the same rules as Prettify().
+ *
+ * Only the few characters which need a look ahead to be formatted (runs of whitespace and the
+ * keyword after an open paren) are held back between calls, so the input and output can be
+ * streamed with bounded memory.
+ */
+class KICOMMON_API PRETTIFIER
+{
+public:
+    PRETTIFIER( FORMAT_MODE aMode = FORMAT_MODE::NORMAL );
+
+    /**
+     * Format the next @a aLength bytes of the source, appending whatever can be formatted so
+     * far to @a aOut.
+     */
+    void Process( const char* aSource, size_t aLength, std::string& aOut );
+
+    /**
+     * Format the rest of the source, appending it and the final newline to @a aOut.
+     */
+    void Finish( std::string& aOut );
+
+private:
+    /**
+     * @return the number of bytes of @a aSource consumed.  Everything is consumed if @a aFinal.
+     */
+    size_t process( std::string_view aSource, bool aFinal, std::string& aOut );
+
+    const bool  m_textSpecialCase;
+    const bool  m_libSpecialCase;
+
+    std::string m_pending;      ///< Source held back until its look ahead is known.
+
+    bool        m_started;      ///< True once anything has been written.
+    int         m_listDepth;
+    int         m_libDepth;
+    char        m_lastNonWhitespace;
+    bool        m_inQuote;
+    bool        m_hasInsertedSpace;
+    bool        m_inMultiLineList;
+    bool        m_inXY;
+    bool        m_inShortForm;
+    bool        m_inLibRow;
+    int         m_shortFormDepth;
+    int         m_column;
+    int         m_backslashCount;   ///< Count of successive backslashes since any other char.
+};
+
 } // namespace KICAD_FORMAT
@@ -0,0 +1,174 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LEXER_SNAPSHOT_H_
+#define LEXER_SNAPSHOT_H_
+
+#include <kicommon.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <wx/string.h>
+
+class MMAP_LINE_READER;
+
+
+/**
+ * The tokens a #DSNLEXER read from a file, kept in a flat binary file which is mapped into
+ * memory and replayed instead of lexing the file again.
+ *
+ * A snapshot holds the token numbers and texts, the line each token was found on and the
+ * value of every token which was parsed as a number, so a replaying parser skips both
+ * tokenizing and number parsing.  Snapshots live in the user cache directory, named after a
+ * hash of the contents of the file they were taken from: a file which has changed since has no
+ * snapshot and is read as text.  The token numbers belong to the lexers which read them, so
+ * snapshots written by another build of KiCad are ignored.  The snapshots used longest ago are
+ * removed when the cache grows over ADVANCED_CFG::m_LexerSnapshotCacheSize.
+ *
+ * Replaying only gives the same result as reading the file if the parser makes the same calls,
+ * so snapshots are only taken and replayed for whole files.
+ */
+class KICOMMON_API LEXER_SNAPSHOT
+{
+public:
+    ~LEXER_SNAPSHOT();
+
+    /**
+     * @return true if snapshots are enabled in the advanced config.
+     */
+    static bool IsEnabled();
+
+    /**
+     * Return the name of the snapshot of the file contents held by a reader.
+     *
+     * The name comes from the same contents the reader goes on to parse if there is no
+     * snapshot, so a file which changes while it is being loaded can't be given the snapshot
+     * of another version of it.
+     *
+     * @param aReader holds the file to find the snapshot for.
+     * @return the snapshot file name, whether it exists or not, or an empty string if the cache
+     *         directory can't be created.
+     */
+    static wxString GetSnapshotFileName( const MMAP_LINE_READER& aReader );
+
+    /**
+     * Map a snapshot into memory, and mark it as used so it is kept in the cache.
+     *
+     * @param aSnapshotFile is the snapshot, as named by GetSnapshotFileName().
+     * @param aSource is the file the snapshot was taken from, for error messages.
+     * @return the snapshot, or nullptr if it doesn't exist or wasn't written by this build.
+     */
+    static std::unique_ptr<LEXER_SNAPSHOT> Open( const wxString& aSnapshotFile,
+                                                 const wxString& aSource );
+
+    /**
+     * @return the number of tokens in the snapshot.
+     */
+    size_t GetTokenCount() const { return m_tokenCount; }
+
+    /**
+     * @return the number of lines of the file the snapshot was taken from.
+     */
+    unsigned GetLineCount() const { return m_lineCount; }
+
+    /**
+     * @return the file the snapshot was taken from.
+     */
+    const wxString& GetSource() const { return m_source; }
+
+    /**
+     * @return the token number of token \a aIndex.
+     */
+    int GetTok( size_t aIndex ) const;
+
+    /**
+     * Fetch token \a aIndex.
+     *
+     * @param aText is set to the text of the token.
+     * @param aNumber is set to the value the text was parsed to, or nullptr if it never was.
+     * @return the token number.
+     */
+    int GetToken( size_t aIndex, std::string& aText, const double*& aNumber ) const;
+
+    /**
+     * @return the line of the source file token \a aIndex was found on.
+     */
+    unsigned GetLineNumber( size_t aIndex ) const;
+
+private:
+    LEXER_SNAPSHOT( const wxString& aSource ) :
+            m_source( aSource )
+    {}
+
+    wxString    m_source;
+    const char* m_data = nullptr;
+    size_t      m_size = 0;
+
+    size_t      m_tokenCount = 0;
+    size_t      m_lineRunCount = 0;
+    unsigned    m_lineCount = 0;
+
+    const char* m_tokens = nullptr;     ///< token numbers and references to their text
+    const char* m_lineRuns = nullptr;   ///< the first token on each line with tokens
+    const char* m_pool = nullptr;       ///< texts of the tokens, each stored once
+    size_t      m_poolSize = 0;
+};
+
+
+/**
+ * Collect the tokens read by a #DSNLEXER and write them as a #LEXER_SNAPSHOT.
+ */
+class KICOMMON_API LEXER_SNAPSHOT_WRITER
+{
+public:
+    /**
+     * Add a token read from line \a aLineNumber.
+     */
+    void Add( int aTok, const std::string& aText, unsigned aLineNumber );
+
+    /**
+     * Record the value the last token added was parsed to.
+     */
+    void SetNumber( const std::string& aText, double aValue );
+
+    /**
+     * Write the snapshot.  The file is replaced at once, so readers never see part of one.
+     * Snapshots used longest ago are then removed if the cache has grown too large.
+     *
+     * @return false if the snapshot could not be written.
+     */
+    bool Save( const wxString& aSnapshotFile ) const;
+
+private:
+    /// Add \a aText to the pool if it isn't there yet.
+    uint32_t addText( const std::string& aText );
+
+    std::vector<uint32_t>                     m_tokens;    ///< pairs of token and text reference
+    std::vector<uint32_t>                     m_lineRuns;  ///< pairs of token index and line
+    unsigned                                  m_lineCount = 0;
+
+    std::vector<char>                         m_pool;
+    std::unordered_map<std::string, uint32_t> m_poolRefs;
+};
+
+#endif  // LEXER_SNAPSHOT_H_
@@ -78,7 +78,8 @@ public:
      * Read a line of text into the buffer and increments the line number counter.
      *
      * If the line is larger than the maximum length passed to the constructor, then an
-     * exception is thrown.  The line is nul terminated.
+     * exception is thrown.  The line is nul terminated, except by readers which hand out lines
+     * in place (see #MMAP_LINE_READER): use Length() rather than looking for the terminator.
      *
      * @return The beginning of the read line, or NULL if EOF.
      * @throw IO_ERROR when a line is too long.
@@ -97,7 +98,8 @@ public:
     }
 
     /**
-     * Return a pointer to the last line that was read in.
+     * Return a pointer to the last line that was read in, which need not be nul terminated
+     * (see ReadLine()).
      */
     char* Line() const
     {
@@ -219,6 +221,67 @@ protected:
 };
 
 
+/**
+ * A #LINE_READER that maps a whole file into memory and hands out its lines in place, without
+ * copying them into the line buffer.
+ *
+ * The lines returned by ReadLine() are not nul terminated (other than the last one) and must
+ * not be modified, so this is only suitable for readers which honour Length(), such as
+ * #DSNLEXER.  Files which cannot be mapped, e.g. empty files, files on network shares or
+ * anything other than a regular file, are read into memory in one go instead.
+ *
+ * @warning A mapped file which is truncated by another process while it is being read raises
+ *          SIGBUS (or an access violation on Windows) on the next access to the missing pages;
+ *          there is no way to turn that into an IO_ERROR.
+ */
+class KICOMMON_API MMAP_LINE_READER : public LINE_READER
+{
+public:
+    /**
+     * Map @a aFileName for reading.
+     *
+     * @param aFileName is the name of the file to read and to use for error reporting purposes.
+     * @param aStartingLineNumber is the initial line number to report on error.
+     * @param aMaxLineLength is the longest line that will be accepted.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened.
+     */
+    MMAP_LINE_READER( const wxString& aFileName, unsigned aStartingLineNumber = 0,
+                      unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    ~MMAP_LINE_READER();
+
+    char* ReadLine() override;
+
+    /**
+     * Go back to the start of the file and reset the line number back to zero.
+     *
+     * Line number will go to 1 on first ReadLine().
+     */
+    void Rewind()
+    {
+        m_pos = 0;
+        m_lineNum = 0;
+    }
+
+    long int FileLength() const { return (long int) m_size; }
+    long int CurPos() const     { return (long int) m_pos; }
+
+    /**
+     * @return the whole contents of the file, FileLength() bytes of it.
+     */
+    const char* FileData() const { return m_data; }
+
+protected:
+    const char* m_data;       ///< The file contents, either mapped or in m_contents.
+    size_t      m_size;
+    size_t      m_pos;        ///< Offset of the next line in m_data.
+    bool        m_mapped;
+    std::string m_contents;   ///< The file contents when it could not be mapped.
+    char*       m_buffer;     ///< The line buffer, as m_line points into m_data for most lines.
+};
+
+
 /**
  * Is a #LINE_READER that reads from a multiline 8 bit wide std::string
  */
@@ -364,6 +427,13 @@ public:
      */
     int PRINTF_FUNC Print( const char* fmt, ... );
 
+    /**
+     * Write text to the output stream as is, e.g. text made by another formatter.
+     *
+     * @throw IO_ERROR, if there is a problem outputting, such as a full disk.
+     */
+    void Write( const std::string& aText ) { write( aText.data(), (int) aText.length() ); }
+
     /**
      * Perform quote character need determination.
      *
@@ -381,6 +451,12 @@ public:
      */
     virtual const char* GetQuoteChar( const char* wrapee ) const;
 
+    /**
+     * @return the character this formatter wraps strings in, e.g. to give a formatter which
+     *         writes part of the same output the same quoting.
+     */
+    char GetQuoteCharacter() const { return quoteChar[0]; }
+
     /**
      * Check \a aWrapee input string for a need to be quoted (e.g. contains a ')' character
      * or a space), and for \" double quotes within the string that need to be escaped such
@@ -500,7 +576,7 @@ public:
     ~PRETTIFIED_FILE_OUTPUTFORMATTER();
 
     /**
-     * Performs prettification and writes the stored buffer to the file.
+     * Prettifies and writes whatever is still buffered, and closes the file.
      * @return true if the write succeeded.
      */
     bool Finish() override;
@@ -509,9 +585,16 @@ protected:
     void write( const char* aOutBuf, int aCount ) override;
 
 private:
+    /**
+     * Prettify the buffered text and write out as much of it as can be formatted.
+     */
+    void flush();
+
     FILE* m_fp;
-    std::string m_buf;
+    std::string m_buf;                      ///< Text not yet passed to the prettifier.
+    std::string m_out;                      ///< Prettified text not yet written.
     KICAD_FORMAT::FORMAT_MODE m_mode;
+    KICAD_FORMAT::PRETTIFIER  m_prettifier;
 };
 
 
@@ -40,6 +40,9 @@
 #define ARG_PARITY "--schematic-parity"
 #define ARG_ZONE_FILL "--refill-zones"
 #define ARG_SAVE_BOARD "--save-board"
+#define ARG_PROFILE "--profile"
+#define ARG_SHARDS "--shards"
+#define ARG_SHARD_INDEX "--shard-index"
 
 CLI::PCB_DRC_COMMAND::PCB_DRC_COMMAND() : COMMAND( "drc" )
 {
@@ -98,6 +101,25 @@ CLI::PCB_DRC_COMMAND::PCB_DRC_COMMAND() : COMMAND( "drc" )
     m_argParser.add_argument( ARG_SAVE_BOARD )
             .help( UTF8STDSTR( _( "Save the board after DRC, must be used with --refill-zones" ) ) )
             .flag();
+
+    m_argParser.add_argument( ARG_PROFILE )
+            .default_value( std::string() )
+            .help( UTF8STDSTR( _( "Write a JSON profile of the DRC run (time per test provider, "
+                                  "rule evaluation counts and times) to the given file" ) ) )
+            .metavar( "PROFILE_FILE" );
+
+    m_argParser.add_argument( ARG_SHARDS )
+            .default_value( 1 )
+            .scan<'i', int>()
+            .help( UTF8STDSTR( _( "Split the DRC over this many kicad-cli processes, each checking "
+                                  "one region of the board" ) ) )
+            .metavar( "COUNT" );
+
+    // Used by the processes started for --shards; not meant to be run by hand
+    m_argParser.add_argument( ARG_SHARD_INDEX )
+            .default_value( -1 )
+            .scan<'i', int>()
+            .hidden();
 }
 
 
@@ -175,6 +197,22 @@ int CLI::PCB_DRC_COMMAND::doPerform( KIWAY& aKiway )
     drcJob->m_parity = m_argParser.get<bool>( ARG_PARITY );
     drcJob->m_refillZones = m_argParser.get<bool>( ARG_ZONE_FILL );
     drcJob->m_saveBoard = m_argParser.get<bool>( ARG_SAVE_BOARD );
+    drcJob->m_profileOutputPath = From_UTF8( m_argParser.get<std::string>( ARG_PROFILE ).c_str() );
+    drcJob->m_shardCount = m_argParser.get<int>( ARG_SHARDS );
+    drcJob->m_shardIndex = m_argParser.get<int>( ARG_SHARD_INDEX );
+
+    if( drcJob->m_shardCount < 1
+        || drcJob->m_shardIndex >= drcJob->m_shardCount )
+    {
+        wxFprintf( stderr, _( "Invalid shard count\n" ) );
+        return EXIT_CODES::ERR_ARGS;
+    }
+
+    if( drcJob->m_shardCount > 1 && drcJob->m_saveBoard )
+    {
+        wxFprintf( stderr, _( "--save-board cannot be used with --shards\n" ) );
+        return EXIT_CODES::ERR_ARGS;
+    }
 
     int exitCode = aKiway.ProcessJob( KIWAY::FACE_PCB, drcJob.get() );
 
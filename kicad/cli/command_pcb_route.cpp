@@ -0,0 +1,144 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "command_pcb_route.h"
+#include "jobs/job_pcb_route.h"
+#include "cli/exit_codes.h"
+#include <string_utils.h>
+#include <wx/crt.h>
+#include <wx/tokenzr.h>
+
+#define ARG_NETS "--nets"
+#define ARG_MODE "--mode"
+#define ARG_ORDER "--order"
+#define ARG_RETRIES "--retries"
+#define ARG_NO_PARALLEL "--no-parallel"
+#define ARG_EXIT_CODE_UNROUTED "--exit-code-unrouted"
+
+CLI::PCB_ROUTE_COMMAND::PCB_ROUTE_COMMAND() :
+        COMMAND( "route" )
+{
+    addCommonArgs( true, true, false, false );
+    m_argParser.add_description( UTF8STDSTR( _( "Route the unrouted connections of the board "
+                                                "with the interactive router.  The routed board "
+                                                "is saved as <name>-routed.kicad_pcb next to the "
+                                                "input unless an output is given" ) ) );
+
+    m_argParser.add_argument( ARG_NETS )
+            .default_value( std::string() )
+            .help( UTF8STDSTR( _( "Comma separated list of nets to route; all nets are routed "
+                                  "if not given" ) ) )
+            .metavar( "NETS" );
+
+    m_argParser.add_argument( ARG_MODE )
+            .default_value( std::string( "walkaround" ) )
+            .help( UTF8STDSTR( _( "Router mode, options: walkaround, shove" ) ) )
+            .metavar( "MODE" );
+
+    m_argParser.add_argument( ARG_ORDER )
+            .default_value( std::string( "board" ) )
+            .help( UTF8STDSTR( _( "Order in which connections are routed, options: board, "
+                                  "shortest" ) ) )
+            .metavar( "ORDER" );
+
+    m_argParser.add_argument( ARG_RETRIES )
+            .default_value( 2 )
+            .scan<'i', int>()
+            .help( UTF8STDSTR( _( "Number of times connections that failed are retried after "
+                                  "the others are routed" ) ) )
+            .metavar( "COUNT" );
+
+    m_argParser.add_argument( ARG_NO_PARALLEL )
+            .help( UTF8STDSTR( _( "Route the whole board on one thread instead of routing "
+                                  "independent areas concurrently" ) ) )
+            .flag();
+
+    m_argParser.add_argument( ARG_EXIT_CODE_UNROUTED )
+            .help( UTF8STDSTR( _( "Return a nonzero exit code if some connections could not be "
+                                  "routed" ) ) )
+            .flag();
+}
+
+
+int CLI::PCB_ROUTE_COMMAND::doPerform( KIWAY& aKiway )
+{
+    std::unique_ptr<JOB_PCB_ROUTE> routeJob = std::make_unique<JOB_PCB_ROUTE>();
+
+    routeJob->m_filename = m_argInput;
+    routeJob->SetConfiguredOutputPath( m_argOutput );
+
+    if( !wxFile::Exists( routeJob->m_filename ) )
+    {
+        wxFprintf( stderr, _( "Board file does not exist or is not accessible\n" ) );
+        return EXIT_CODES::ERR_INVALID_INPUT_FILE;
+    }
+
+    wxString          nets = From_UTF8( m_argParser.get<std::string>( ARG_NETS ).c_str() );
+    wxStringTokenizer tokenizer( nets, ",", wxTOKEN_STRTOK );
+
+    while( tokenizer.HasMoreTokens() )
+        routeJob->m_nets.push_back( tokenizer.GetNextToken().Trim( true ).Trim( false ) );
+
+    wxString mode = From_UTF8( m_argParser.get<std::string>( ARG_MODE ).c_str() );
+
+    if( mode == wxS( "walkaround" ) )
+    {
+        routeJob->m_mode = JOB_PCB_ROUTE::MODE::WALKAROUND;
+    }
+    else if( mode == wxS( "shove" ) )
+    {
+        routeJob->m_mode = JOB_PCB_ROUTE::MODE::SHOVE;
+    }
+    else
+    {
+        wxFprintf( stderr, _( "Invalid router mode\n" ) );
+        return EXIT_CODES::ERR_ARGS;
+    }
+
+    wxString order = From_UTF8( m_argParser.get<std::string>( ARG_ORDER ).c_str() );
+
+    if( order == wxS( "board" ) )
+    {
+        routeJob->m_order = JOB_PCB_ROUTE::ORDER::BOARD;
+    }
+    else if( order == wxS( "shortest" ) )
+    {
+        routeJob->m_order = JOB_PCB_ROUTE::ORDER::SHORTEST_FIRST;
+    }
+    else
+    {
+        wxFprintf( stderr, _( "Invalid routing order\n" ) );
+        return EXIT_CODES::ERR_ARGS;
+    }
+
+    routeJob->m_retries = m_argParser.get<int>( ARG_RETRIES );
+
+    if( routeJob->m_retries < 0 )
+    {
+        wxFprintf( stderr, _( "Retry count must not be negative\n" ) );
+        return EXIT_CODES::ERR_ARGS;
+    }
+
+    routeJob->m_parallel = !m_argParser.get<bool>( ARG_NO_PARALLEL );
+    routeJob->m_exitCodeUnrouted = m_argParser.get<bool>( ARG_EXIT_CODE_UNROUTED );
+
+    int exitCode = aKiway.ProcessJob( KIWAY::FACE_PCB, routeJob.get() );
+
+    return exitCode;
+}
@@ -72,6 +72,7 @@
 #include "cli/command_sch_export_pythonbom.h"
 #include "cli/command_sch_export_netlist.h"
 #include "cli/command_sch_export_plot.h"
+#include "cli/command_pcb_route.h"
 #include "cli/command_pcb_upgrade.h"
 #include "cli/command_fp.h"
 #include "cli/command_fp_export.h"
@@ -124,6 +125,7 @@ static CLI::JOBSET_RUN_COMMAND           jobsetRunCmd{};
 static CLI::PCB_COMMAND                  pcbCmd{};
 static CLI::PCB_DRC_COMMAND              pcbDrcCmd{};
 static CLI::PCB_RENDER_COMMAND           pcbRenderCmd{};
+static CLI::PCB_ROUTE_COMMAND            pcbRouteCmd{};
 static CLI::PCB_UPGRADE_COMMAND          pcbUpgradeCmd{};
 static CLI::PCB_EXPORT_DRILL_COMMAND     exportPcbDrillCmd{};
 static CLI::PCB_EXPORT_DXF_COMMAND       exportPcbDxfCmd{};
@@ -236,6 +238,9 @@ static std::vector<COMMAND_ENTRY> commandStack = {
                     &exportPcb3DPDFCmd
                 }
             },
+            {
+                &pcbRouteCmd
+            },
             {
                 &pcbUpgradeCmd
             }
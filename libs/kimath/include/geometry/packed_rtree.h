@@ -0,0 +1,350 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef PACKED_RTREE_H
+#define PACKED_RTREE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <math/box2.h>
+
+
+/**
+ * A static, bulk-loaded R-tree.
+ *
+ * Items are added with their bounding boxes and then packed in one go with Build(): the
+ * leaves are sorted along a Hilbert curve and each group of NODE_SIZE consecutive entries
+ * becomes a node of the level above.  Bounding boxes are stored as separate coordinate arrays
+ * (structure-of-arrays) and node children are contiguous, so no child pointers are needed and
+ * the overlap tests run over plain int arrays which the compiler can vectorise.
+ *
+ * The tree cannot be modified after it is built; Clear() it and add everything again instead.
+ * Searching a built tree is thread-safe.
+ */
+template <class T, int NODE_SIZE = 16>
+class PACKED_RTREE
+{
+public:
+    PACKED_RTREE() :
+            m_count( 0 )
+    {}
+
+    void Clear()
+    {
+        m_minX.clear();
+        m_minY.clear();
+        m_maxX.clear();
+        m_maxY.clear();
+        m_items.clear();
+        m_levelBounds.clear();
+        m_count = 0;
+    }
+
+    void Reserve( size_t aCount )
+    {
+        m_minX.reserve( aCount );
+        m_minY.reserve( aCount );
+        m_maxX.reserve( aCount );
+        m_maxY.reserve( aCount );
+        m_items.reserve( aCount );
+    }
+
+    /**
+     * Stage an item for the next Build().
+     */
+    void Add( const BOX2I& aBox, const T& aItem )
+    {
+        m_minX.push_back( aBox.GetX() );
+        m_minY.push_back( aBox.GetY() );
+        m_maxX.push_back( aBox.GetRight() );
+        m_maxY.push_back( aBox.GetBottom() );
+        m_items.push_back( aItem );
+    }
+
+    void Add( const int aMin[2], const int aMax[2], const T& aItem )
+    {
+        m_minX.push_back( aMin[0] );
+        m_minY.push_back( aMin[1] );
+        m_maxX.push_back( aMax[0] );
+        m_maxY.push_back( aMax[1] );
+        m_items.push_back( aItem );
+    }
+
+    /**
+     * Sort the staged items and build the node levels.
+     */
+    void Build()
+    {
+        m_count = m_items.size();
+        m_levelBounds.clear();
+
+        if( m_count == 0 )
+            return;
+
+        sortLeaves();
+
+        m_levelBounds.push_back( m_count );
+
+        size_t levelStart = 0;
+        size_t levelEnd = m_count;
+
+        while( levelEnd - levelStart > 1 )
+        {
+            for( size_t ii = levelStart; ii < levelEnd; ii += NODE_SIZE )
+            {
+                size_t last = std::min<size_t>( ii + NODE_SIZE, levelEnd );
+                int    minX = *std::min_element( m_minX.begin() + ii, m_minX.begin() + last );
+                int    minY = *std::min_element( m_minY.begin() + ii, m_minY.begin() + last );
+                int    maxX = *std::max_element( m_maxX.begin() + ii, m_maxX.begin() + last );
+                int    maxY = *std::max_element( m_maxY.begin() + ii, m_maxY.begin() + last );
+
+                m_minX.push_back( minX );
+                m_minY.push_back( minY );
+                m_maxX.push_back( maxX );
+                m_maxY.push_back( maxY );
+            }
+
+            levelStart = levelEnd;
+            levelEnd = m_minX.size();
+            m_levelBounds.push_back( levelEnd );
+        }
+    }
+
+    bool IsBuilt() const { return !m_levelBounds.empty(); }
+
+    size_t size() const { return m_count; }
+    bool   empty() const { return m_count == 0; }
+
+    /**
+     * Visit every item whose box overlaps [aMin, aMax] (inclusive, as for RTree::Search).
+     *
+     * @param aVisitor is called with each item and returns false to stop the search.
+     * @return false if the search was stopped by the visitor.
+     */
+    template <class VISITOR>
+    bool Search( const int aMin[2], const int aMax[2], VISITOR&& aVisitor ) const
+    {
+        if( !IsBuilt() )
+            return true;
+
+        // (level, node) pairs still to be expanded.  Each level down adds at most NODE_SIZE
+        // entries, so the stack can't outgrow MAX_LEVELS * NODE_SIZE.
+        std::pair<int, size_t> stack[MAX_LEVELS * NODE_SIZE];
+        size_t                 stackSize = 0;
+
+        int rootLevel = (int) m_levelBounds.size() - 1;
+
+        if( !overlaps( m_levelBounds[rootLevel] - 1, aMin, aMax ) )
+            return true;
+
+        if( rootLevel == 0 )
+            return aVisitor( m_items[0] );
+
+        stack[stackSize++] = { rootLevel, m_levelBounds[rootLevel] - 1 };
+
+        while( stackSize > 0 )
+        {
+            auto [level, node] = stack[--stackSize];
+
+            size_t childLevelStart = level > 1 ? m_levelBounds[level - 2] : 0;
+            size_t childLevelEnd = m_levelBounds[level - 1];
+            size_t nodeIndex = node - m_levelBounds[level - 1];
+            size_t first = childLevelStart + nodeIndex * NODE_SIZE;
+            size_t count = std::min<size_t>( NODE_SIZE, childLevelEnd - first );
+
+            uint8_t hits[NODE_SIZE];
+            overlapsBlock( first, count, aMin, aMax, hits );
+
+            if( level == 1 )
+            {
+                for( size_t ii = 0; ii < count; ++ii )
+                {
+                    if( hits[ii] && !aVisitor( m_items[first + ii] ) )
+                        return false;
+                }
+            }
+            else
+            {
+                // Push in reverse so that children are expanded in order
+                for( size_t ii = count; ii-- > 0; )
+                {
+                    if( hits[ii] )
+                        stack[stackSize++] = { level - 1, first + ii };
+                }
+            }
+        }
+
+        return true;
+    }
+
+    template <class VISITOR>
+    bool Search( const BOX2I& aBox, VISITOR&& aVisitor ) const
+    {
+        const int min[2] = { aBox.GetX(), aBox.GetY() };
+        const int max[2] = { aBox.GetRight(), aBox.GetBottom() };
+
+        return Search( min, max, std::forward<VISITOR>( aVisitor ) );
+    }
+
+private:
+    static_assert( NODE_SIZE >= 2, "PACKED_RTREE nodes need at least two children" );
+
+    /// The number of levels a tree of SIZE_MAX items would have
+    static constexpr int maxLevels()
+    {
+        int    levels = 1;
+        size_t count = std::numeric_limits<size_t>::max();
+
+        while( count > 1 )
+        {
+            count = count / NODE_SIZE + ( count % NODE_SIZE != 0 );
+            levels++;
+        }
+
+        return levels;
+    }
+
+    static constexpr int MAX_LEVELS = maxLevels();
+
+    bool overlaps( size_t aIndex, const int aMin[2], const int aMax[2] ) const
+    {
+        return m_minX[aIndex] <= aMax[0] && m_maxX[aIndex] >= aMin[0]
+               && m_minY[aIndex] <= aMax[1] && m_maxY[aIndex] >= aMin[1];
+    }
+
+    /**
+     * Branch-free overlap test of a block of consecutive boxes.
+     */
+    void overlapsBlock( size_t aFirst, size_t aCount, const int aMin[2], const int aMax[2],
+                        uint8_t* aHits ) const
+    {
+        const int* minX = m_minX.data() + aFirst;
+        const int* minY = m_minY.data() + aFirst;
+        const int* maxX = m_maxX.data() + aFirst;
+        const int* maxY = m_maxY.data() + aFirst;
+
+        const int qMinX = aMin[0];
+        const int qMinY = aMin[1];
+        const int qMaxX = aMax[0];
+        const int qMaxY = aMax[1];
+
+        for( size_t ii = 0; ii < aCount; ++ii )
+        {
+            aHits[ii] = ( minX[ii] <= qMaxX ) & ( maxX[ii] >= qMinX )
+                        & ( minY[ii] <= qMaxY ) & ( maxY[ii] >= qMinY );
+        }
+    }
+
+    static uint32_t hilbertIndex( uint32_t aX, uint32_t aY )
+    {
+        const uint32_t n = 1 << 16;
+        uint32_t       d = 0;
+
+        for( uint32_t s = n / 2; s > 0; s /= 2 )
+        {
+            uint32_t rx = ( aX & s ) > 0;
+            uint32_t ry = ( aY & s ) > 0;
+
+            d += s * s * ( ( 3 * rx ) ^ ry );
+
+            if( ry == 0 )
+            {
+                if( rx == 1 )
+                {
+                    aX = n - 1 - aX;
+                    aY = n - 1 - aY;
+                }
+
+                std::swap( aX, aY );
+            }
+        }
+
+        return d;
+    }
+
+    void sortLeaves()
+    {
+        int64_t minX = *std::min_element( m_minX.begin(), m_minX.end() );
+        int64_t minY = *std::min_element( m_minY.begin(), m_minY.end() );
+        int64_t maxX = *std::max_element( m_maxX.begin(), m_maxX.end() );
+        int64_t maxY = *std::max_element( m_maxY.begin(), m_maxY.end() );
+        int64_t width = std::max<int64_t>( 1, maxX - minX );
+        int64_t height = std::max<int64_t>( 1, maxY - minY );
+
+        std::vector<uint32_t> keys( m_count );
+
+        for( size_t ii = 0; ii < m_count; ++ii )
+        {
+            int64_t cx = ( (int64_t) m_minX[ii] + m_maxX[ii] ) / 2;
+            int64_t cy = ( (int64_t) m_minY[ii] + m_maxY[ii] ) / 2;
+
+            keys[ii] = hilbertIndex( (uint32_t) ( ( cx - minX ) * 0xFFFF / width ),
+                                     (uint32_t) ( ( cy - minY ) * 0xFFFF / height ) );
+        }
+
+        std::vector<size_t> order( m_count );
+        std::iota( order.begin(), order.end(), 0 );
+
+        std::stable_sort( order.begin(), order.end(),
+                          [&]( size_t a, size_t b )
+                          {
+                              return keys[a] < keys[b];
+                          } );
+
+        auto permute =
+                [&]( auto& aArray )
+                {
+                    std::remove_reference_t<decltype( aArray )> sorted;
+                    sorted.reserve( aArray.size() );
+
+                    for( size_t idx : order )
+                        sorted.push_back( aArray[idx] );
+
+                    aArray = std::move( sorted );
+                };
+
+        permute( m_minX );
+        permute( m_minY );
+        permute( m_maxX );
+        permute( m_maxY );
+        permute( m_items );
+    }
+
+private:
+    // Leaf boxes come first, followed by each level of nodes up to the single root
+    std::vector<int>    m_minX;
+    std::vector<int>    m_minY;
+    std::vector<int>    m_maxX;
+    std::vector<int>    m_maxY;
+    std::vector<T>      m_items;
+
+    // End index (in the box arrays) of each level; level 0 is the leaves
+    std::vector<size_t> m_levelBounds;
+    size_t              m_count;
+};
+
+#endif // PACKED_RTREE_H
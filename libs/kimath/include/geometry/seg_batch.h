@@ -0,0 +1,131 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef SEG_BATCH_H
+#define SEG_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <geometry/seg.h>
+#include <math/vector2d.h>
+
+
+/**
+ * Batched rejection of segments which are too far from a query segment to collide with it.
+ *
+ * The kernels compare the bounding boxes of up to SEG_BATCH_SIZE segments with the bounding
+ * box of the query grown by the clearance, several segments per instruction with AVX2 or
+ * SSE4.1 when the CPU has them, and one at a time otherwise.  They only reject: the distance
+ * of the segments they keep must still be computed exactly with SEG.  A rejected segment is
+ * always further than the clearance from the query, so skipping it never changes the result
+ * of a collision test, whichever instruction set is used.
+ */
+namespace KIGEOM
+{
+
+/// Number of segments tested by one call, i.e. the number of bits in the returned masks.
+constexpr size_t SEG_BATCH_SIZE = 64;
+
+enum class SIMD_LEVEL
+{
+    SCALAR,
+    SSE4_1,
+    AVX2
+};
+
+/**
+ * @return the best instruction set for the segment kernels supported by this CPU.
+ */
+SIMD_LEVEL GetSupportedSimdLevel();
+
+/**
+ * @return the instruction set currently used by the segment kernels.
+ */
+SIMD_LEVEL GetSimdLevel();
+
+/**
+ * Select the instruction set used by the segment kernels, e.g. to compare them in tests and
+ * benchmarks.  Levels that the CPU does not support are lowered to the supported one.
+ */
+void SetSimdLevel( SIMD_LEVEL aLevel );
+
+
+/**
+ * The bounding box of a query segment grown by a clearance, clamped to the coordinate range.
+ */
+struct SEG_QUERY_BOX
+{
+    SEG_QUERY_BOX( const SEG& aSeg, int aClearance );
+
+    int32_t m_MinX;
+    int32_t m_MinY;
+    int32_t m_MaxX;
+    int32_t m_MaxY;
+};
+
+
+/**
+ * Test consecutive segments of a polyline, segment i running from aPoints[i] to aPoints[i + 1].
+ *
+ * @param aPoints is the first point; aCount + 1 points must be readable from it.
+ * @param aCount is the number of segments to test, at most SEG_BATCH_SIZE.
+ * @return a mask with bit i set if segment i may be within the clearance of the query.
+ */
+uint64_t PolylineSegmentsNear( const VECTOR2I* aPoints, size_t aCount,
+                               const SEG_QUERY_BOX& aQuery );
+
+
+/**
+ * Bounding boxes of arbitrary segments, stored as separate coordinate arrays so that they can
+ * be tested against many query segments.
+ */
+class SEG_BOXES
+{
+public:
+    void Reserve( size_t aCount );
+
+    void Add( const SEG& aSeg );
+
+    size_t Size() const { return m_minX.size(); }
+
+    /**
+     * Test the segments aFirst to aFirst + aCount - 1.
+     *
+     * @param aCount is the number of segments to test, at most SEG_BATCH_SIZE.
+     * @return a mask with bit i set if segment aFirst + i may be within the clearance of the
+     *         query.
+     */
+    uint64_t Near( size_t aFirst, size_t aCount, const SEG_QUERY_BOX& aQuery ) const;
+
+private:
+    std::vector<int32_t> m_minX;
+    std::vector<int32_t> m_minY;
+    std::vector<int32_t> m_maxX;
+    std::vector<int32_t> m_maxY;
+};
+
+} // namespace KIGEOM
+
+#endif // SEG_BATCH_H
@@ -36,6 +36,7 @@
 #include <wx/string.h>
 
 class SHAPE_LINE_CHAIN;
+class SHAPE_LINE_CHAIN_INDEX;
 class SHAPE_POLY_SET;
 
 /**
@@ -367,6 +368,12 @@ public:
 
     virtual BOX2I* GetCachedBBox() const { return nullptr; }
 
+    /**
+     * @return an index of the segments of the chain, or nullptr if queries should scan all
+     *         the segments.
+     */
+    virtual const SHAPE_LINE_CHAIN_INDEX* GetSegmentIndex() const { return nullptr; }
+
     void TransformToPolygon( SHAPE_POLY_SET& aBuffer, int aError,
                              ERROR_LOC aErrorLoc ) const override
     {}
@@ -27,6 +27,8 @@
 #define __SHAPE_LINE_CHAIN
 
 
+#include <atomic>
+
 #include <clipper2/clipper.h>
 #include <geometry/seg.h>
 #include <geometry/shape.h>
@@ -66,6 +68,77 @@ struct CLIPPER_Z_VALUE
 };
 
 
+/**
+ * Owner of the segment index of a SHAPE_LINE_CHAIN.
+ *
+ * The index is only built for long chains, once they have been queried a few times, as a few
+ * linear scans are cheaper than building it.  It is dropped whenever the chain is modified and
+ * is not copied with the chain.  Building it is thread-safe, so that a chain can be queried
+ * concurrently as long as it is not modified.
+ */
+class SHAPE_LINE_CHAIN_INDEX_CACHE
+{
+public:
+    SHAPE_LINE_CHAIN_INDEX_CACHE() :
+            m_index( nullptr ),
+            m_queries( 0 )
+    {}
+
+    SHAPE_LINE_CHAIN_INDEX_CACHE( const SHAPE_LINE_CHAIN_INDEX_CACHE& ) :
+            SHAPE_LINE_CHAIN_INDEX_CACHE()
+    {}
+
+    ~SHAPE_LINE_CHAIN_INDEX_CACHE()
+    {
+        Invalidate();
+    }
+
+    SHAPE_LINE_CHAIN_INDEX_CACHE& operator=( const SHAPE_LINE_CHAIN_INDEX_CACHE& )
+    {
+        Invalidate();
+        return *this;
+    }
+
+    /**
+     * Take over the index of a chain whose points are being moved.
+     */
+    SHAPE_LINE_CHAIN_INDEX_CACHE& operator=( SHAPE_LINE_CHAIN_INDEX_CACHE&& aOther ) noexcept
+    {
+        if( this != &aOther )
+        {
+            Invalidate();
+            m_index.store( aOther.m_index.exchange( nullptr ) );
+            m_queries.store( aOther.m_queries.exchange( 0 ) );
+        }
+
+        return *this;
+    }
+
+    /**
+     * Drop the index.  Must be called by everything that modifies the points of the chain.
+     */
+    void Invalidate()
+    {
+        if( m_index.load( std::memory_order_relaxed )
+            || m_queries.load( std::memory_order_relaxed ) )
+        {
+            release();
+        }
+    }
+
+    /**
+     * @return the index of \a aChain, building it if the chain is worth indexing, or nullptr.
+     */
+    const SHAPE_LINE_CHAIN_INDEX* Get( const SHAPE_LINE_CHAIN& aChain ) const;
+
+private:
+    void release();
+
+    mutable std::atomic<SHAPE_LINE_CHAIN_INDEX*> m_index;
+    mutable std::atomic<unsigned>                m_queries;  ///< Queries made without the index
+};
+
+
 /**
  * Represent a polyline containing arcs as well as line segments: A chain of connected line and/or
  * arc segments.
@@ -265,6 +338,7 @@ public:
             m_closed = aOther.m_closed;
             m_width = aOther.m_width;
             m_bbox = aOther.m_bbox;
+            m_segmentIndex = std::move( aOther.m_segmentIndex );
         }
 
         return *this;
@@ -277,6 +351,7 @@ public:
      */
     void Clear()
     {
+        m_segmentIndex.Invalidate();
         m_points.clear();
         m_arcs.clear();
         m_shapes.clear();
@@ -291,6 +366,7 @@ public:
      */
     void SetClosed( bool aClosed )
     {
+        m_segmentIndex.Invalidate();
         m_closed = aClosed;
         mergeFirstLastPointIfNeeded();
     }
@@ -450,10 +526,15 @@ public:
     }
 
     /**
-     * @return the vector of values indicating shape type and location.
+     * @return the vector of values indicating shape type and location, one per point.
+     *
+     * @note Chains without arcs don't store these, so this builds a copy.
      */
-    const std::vector<std::pair<ssize_t, ssize_t>>& CShapes() const
+    std::vector<std::pair<ssize_t, ssize_t>> CShapes() const
     {
+        if( m_shapes.size() != m_points.size() )
+            return std::vector<std::pair<ssize_t, ssize_t>>( m_points.size(), SHAPES_ARE_PT );
+
         return m_shapes;
     }
 
@@ -482,6 +563,11 @@ public:
         return &m_bbox;
     }
 
+    const SHAPE_LINE_CHAIN_INDEX* GetSegmentIndex() const override
+    {
+        return m_segmentIndex.Get( *this );
+    }
+
     /**
      * Reverse point order in the line chain.
      *
@@ -509,7 +595,37 @@ public:
     void ReservePoints( size_t aSize )
     {
         m_points.reserve( aSize );
-        m_shapes.reserve( aSize );
+
+        if( !m_shapes.empty() )
+            m_shapes.reserve( aSize );
+    }
+
+    /**
+     * Release the memory reserved beyond the points of the chain, e.g. once a fill has been
+     * computed and the chain won't grow anymore.
+     */
+    void ShrinkToFit()
+    {
+        compactShapes();
+        m_points.shrink_to_fit();
+        m_shapes.shrink_to_fit();
+        m_arcs.shrink_to_fit();
+    }
+
+    /**
+     * @return the number of shape entries actually stored; zero for chains without arcs, and
+     *         one per point otherwise.
+     */
+    size_t StoredShapeCount() const { return m_shapes.size(); }
+
+    /**
+     * @return the memory reserved for the points, shapes and arcs of the chain, in bytes.
+     */
+    size_t ReservedBytes() const
+    {
+        return m_points.capacity() * sizeof( VECTOR2I )
+               + m_shapes.capacity() * sizeof( std::pair<ssize_t, ssize_t> )
+               + m_arcs.capacity() * sizeof( SHAPE_ARC );
     }
 
     /**
@@ -542,8 +658,12 @@ public:
 
         if( m_points.size() == 0 || aAllowDuplication || CLastPoint() != aP )
         {
+            m_segmentIndex.Invalidate();
             m_points.push_back( aP );
-            m_shapes.push_back( SHAPES_ARE_PT );
+
+            if( !m_shapes.empty() )
+                m_shapes.push_back( SHAPES_ARE_PT );
+
             m_bbox.Merge( aP );
         }
     }
@@ -768,6 +888,8 @@ public:
 
     void Move( const VECTOR2I& aVector ) override
     {
+        m_segmentIndex.Invalidate();
+
         for( auto& pt : m_points )
             pt += aVector;
 
@@ -850,6 +972,9 @@ public:
      */
     ssize_t ArcIndex( size_t aSegment ) const
     {
+        if( aSegment >= m_shapes.size() )
+            return SHAPE_IS_PT;
+
         if( IsSharedPt( aSegment ) )
             return m_shapes[aSegment].second;
         else
@@ -932,6 +1057,9 @@ protected:
      */
     ssize_t reversedArcIndex( size_t aSegment ) const
     {
+        if( aSegment >= m_shapes.size() )
+            return SHAPE_IS_PT;
+
         if( IsSharedPt( aSegment ) )
             return m_shapes[aSegment].first;
         else
@@ -955,6 +1083,34 @@ protected:
      */
     void mergeFirstLastPointIfNeeded();
 
+    /**
+     * Allocate the shapes of a chain which has no arcs, so that they can be edited alongside the
+     * points.
+     */
+    void expandShapes()
+    {
+        if( m_shapes.empty() && m_arcs.empty() )
+            m_shapes.assign( m_points.size(), SHAPES_ARE_PT );
+    }
+
+    /**
+     * Release the shapes of a chain which has no arcs, as they are all SHAPES_ARE_PT.
+     */
+    void compactShapes()
+    {
+        if( m_arcs.empty() && !m_shapes.empty() )
+            std::vector<std::pair<ssize_t, ssize_t>>().swap( m_shapes );
+    }
+
+    /**
+     * @return true if there is one shape per point, or if the chain has no arcs and doesn't
+     *         store its shapes.
+     */
+    bool shapesMatchPoints() const
+    {
+        return m_shapes.size() == m_points.size() || ( m_shapes.empty() && m_arcs.empty() );
+    }
+
 private:
 
     static const ssize_t SHAPE_IS_PT;
@@ -977,6 +1133,9 @@ private:
      * is shared, then both the first and second element of the pair should be populated.
      *
      * The second element must always be SHAPE_IS_PT if the first element is SHAPE_IS_PT.
+     *
+     * Chains without arcs, such as zone fills, usually leave this empty rather than storing
+     * SHAPES_ARE_PT for every point.
      */
     std::vector<std::pair<ssize_t, ssize_t>> m_shapes;
 
@@ -997,6 +1156,9 @@ private:
 
     /// cached bounding box
     mutable BOX2I m_bbox;
+
+    /// segment index, built on demand by the queries on long chains
+    SHAPE_LINE_CHAIN_INDEX_CACHE m_segmentIndex;
 };
 
 
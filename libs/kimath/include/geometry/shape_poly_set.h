@@ -42,6 +42,7 @@
 #include <clipper2/clipper.h>
 #include <core/mirror.h>                // for FLIP_DIRECTION
 #include <geometry/corner_strategy.h>
+#include <geometry/packed_rtree.h>
 #include <geometry/seg.h>               // for SEG
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
@@ -558,6 +559,8 @@ public:
 
             m_polys = std::move( aOther.m_polys );
             m_triangulatedPolys = std::move( aOther.m_triangulatedPolys );
+            m_contourIndex = std::move( aOther.m_contourIndex );
+            aOther.m_contourIndex.Clear();
 
             m_hash = aOther.m_hash;
             m_hashValid = aOther.m_hashValid;
@@ -1120,6 +1123,10 @@ public:
      */
     void SimplifyOutlines( int aMaxError = 0 );
 
+    /// Release the memory reserved beyond the vertices of each outline and hole, for polygon
+    /// sets which won't be edited anymore (e.g. zone fills).  The contour index is released too.
+    void ShrinkToFit();
+
     /**
      * Convert a self-intersecting polygon to one (or more) non self-intersecting polygon(s).
      *
@@ -1236,10 +1243,12 @@ public:
      * @param  aClearance is the security distance; if \p aPoint lies closer to a vertex than
      *                    aClearance distance, then there is a collision.
      * @param aClosestVertex is the index of the closes vertex to \p aPoint.
+     * @param aUseBBoxCaches only visits the contours near \p aPoint, but the caller MUST build
+     *                       the bbox caches before calling (via BuildBBoxCaches(), below)
      * @return bool - true if there is a collision, false in any other case.
      */
     bool CollideVertex( const VECTOR2I& aPoint, VERTEX_INDEX* aClosestVertex = nullptr,
-                        int aClearance = 0 ) const;
+                        int aClearance = 0, bool aUseBBoxCaches = false ) const;
 
     /**
      * Check whether aPoint collides with any edge of any of the contours of the polygon.
@@ -1249,10 +1258,12 @@ public:
      * @param  aClearance is the security distance; if \p aPoint lies closer to a vertex than
      *                    aClearance distance, then there is a collision.
      * @param aClosestVertex is the index of the closes vertex to \p aPoint.
+     * @param aUseBBoxCaches only visits the contours near \p aPoint, but the caller MUST build
+     *                       the bbox caches before calling (via BuildBBoxCaches(), below)
      * @return bool - true if there is a collision, false in any other case.
      */
     bool CollideEdge( const VECTOR2I& aPoint, VERTEX_INDEX* aClosestVertex = nullptr,
-                      int aClearance = 0 ) const;
+                      int aClearance = 0, bool aUseBBoxCaches = false ) const;
 
     bool PointInside( const VECTOR2I& aPt, int aAccuracy = 0,
                       bool aUseBBoxCache = false ) const override;
@@ -1260,8 +1271,12 @@ public:
     /**
      * Construct BBoxCaches for Contains(), below.
      *
-     * @note These caches **must** be built before a group of calls to Contains().  They are
-     *       **not** kept up-to-date by editing actions.
+     * Besides the bounding box of each contour, this indexes the contours by their bounding
+     * boxes so that queries on sets with many polygons or holes only visit the nearby ones.
+     *
+     * @note These caches **must** be built before a group of calls to Contains().  Editing the
+     *       set drops the contour index, so the queries go back to visiting every contour until
+     *       it is built again, but the bounding boxes of the contours are **not** kept up-to-date.
      */
     void BuildBBoxCaches() const;
 
@@ -1578,12 +1593,31 @@ private:
     /// Return true if the polygon set has any holes that touch share a vertex.
     bool hasTouchingHoles( const POLYGON& aPoly ) const;
 
+    /**
+     * Collect the contours whose cached bounding boxes are within \a aMargin of \a aP, sorted
+     * by polygon and then by contour.  BuildBBoxCaches() must have been called.
+     */
+    void queryContours( const VECTOR2I& aP, int aMargin,
+                        std::vector<std::pair<int, int>>& aContours ) const;
+
+    /// Drop the contour index; called by every member which changes the contours.
+    void invalidateContourIndex()
+    {
+        if( m_contourIndex.IsBuilt() )
+            m_contourIndex.Clear();
+    }
+
     HASH_128 checksum() const;
 
 protected:
     std::vector<POLYGON>                               m_polys;
     std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> m_triangulatedPolys;
 
+    /// (polygon, contour) pairs indexed by the bounding boxes of the contours; built by
+    /// BuildBBoxCaches() and dropped by the editing members.  Edits made through the references
+    /// returned by Outline(), Hole() and Polygon() are not seen, as for the bbox caches.
+    mutable PACKED_RTREE<std::pair<int, int>> m_contourIndex;
+
     std::atomic<bool> m_triangulationValid = false;
     std::mutex  m_triangulationMutex;
 
@@ -28,6 +28,7 @@
 #include <cstdint>
 #include <iomanip>
 #include <sstream>
+#include <string>
 
 /**
  * A storage class for 128-bit hash value
@@ -53,6 +54,26 @@ struct HASH_128
         return ss.str();
     }
 
+    /**
+     * Parse a hash previously formatted by ToString().
+     *
+     * @return false (leaving the hash cleared) if \a aString isn't a valid hash.
+     */
+    bool FromString( const std::string& aString )
+    {
+        Clear();
+
+        if( aString.length() != 32
+                || aString.find_first_not_of( "0123456789ABCDEFabcdef" ) != std::string::npos )
+        {
+            return false;
+        }
+
+        Value64[0] = std::stoull( aString.substr( 0, 16 ), nullptr, 16 );
+        Value64[1] = std::stoull( aString.substr( 16, 16 ), nullptr, 16 );
+        return true;
+    }
+
 public:
     union
     {
@@ -0,0 +1,375 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <geometry/seg_batch.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+
+#if defined( __x86_64__ ) || defined( _M_X64 ) || defined( __i386__ ) || defined( _M_IX86 )
+#define SEG_BATCH_X86
+
+#include <immintrin.h>
+
+#if defined( _MSC_VER ) && !defined( __clang__ )
+#include <intrin.h>
+#define TARGET_SSE41
+#define TARGET_AVX2
+#else
+#define TARGET_SSE41 __attribute__( ( target( "sse4.1" ) ) )
+#define TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+#endif
+#endif
+
+
+namespace KIGEOM
+{
+
+static_assert( sizeof( VECTOR2I ) == 2 * sizeof( int32_t ),
+               "the polyline kernels load points as pairs of int32" );
+
+/**
+ * SEG::Collide() measures distances in floating point, which may come out slightly short for
+ * long segments.  Segments are only rejected when they are this much further away than the
+ * clearance, which is far more than the rounding error can ever be.
+ */
+static constexpr int64_t GUARD_BAND = 128;
+
+
+SIMD_LEVEL GetSupportedSimdLevel()
+{
+#if defined( SEG_BATCH_X86 )
+#if defined( _MSC_VER ) && !defined( __clang__ )
+    int info[4];
+
+    __cpuid( info, 1 );
+
+    bool sse41 = ( info[2] & ( 1 << 19 ) ) != 0;
+    bool osxsave = ( info[2] & ( 1 << 27 ) ) != 0;
+    bool avx = ( info[2] & ( 1 << 28 ) ) != 0;
+
+    // AVX registers are only usable if the OS saves them
+    if( osxsave && avx && ( _xgetbv( 0 ) & 0x6 ) == 0x6 )
+    {
+        __cpuidex( info, 7, 0 );
+
+        if( info[1] & ( 1 << 5 ) )
+            return SIMD_LEVEL::AVX2;
+    }
+
+    if( sse41 )
+        return SIMD_LEVEL::SSE4_1;
+#else
+    __builtin_cpu_init();
+
+    if( __builtin_cpu_supports( "avx2" ) )
+        return SIMD_LEVEL::AVX2;
+
+    if( __builtin_cpu_supports( "sse4.1" ) )
+        return SIMD_LEVEL::SSE4_1;
+#endif
+#endif
+
+    return SIMD_LEVEL::SCALAR;
+}
+
+
+static std::atomic<SIMD_LEVEL>& activeLevel()
+{
+    static std::atomic<SIMD_LEVEL> level( GetSupportedSimdLevel() );
+    return level;
+}
+
+
+SIMD_LEVEL GetSimdLevel()
+{
+    return activeLevel().load( std::memory_order_relaxed );
+}
+
+
+void SetSimdLevel( SIMD_LEVEL aLevel )
+{
+    activeLevel().store( std::min( aLevel, GetSupportedSimdLevel() ), std::memory_order_relaxed );
+}
+
+
+static int32_t clampCoord( int64_t aValue )
+{
+    return static_cast<int32_t>( std::clamp<int64_t>( aValue, std::numeric_limits<int32_t>::min(),
+                                                      std::numeric_limits<int32_t>::max() ) );
+}
+
+
+SEG_QUERY_BOX::SEG_QUERY_BOX( const SEG& aSeg, int aClearance )
+{
+    // SHAPE_LINE_CHAIN squares the clearance, so a negative one behaves like its opposite
+    int64_t margin = std::abs( static_cast<int64_t>( aClearance ) ) + GUARD_BAND;
+
+    // A segment is rejected when its box ends strictly before m_MinX (or starts strictly after
+    // m_MaxX), so clamping to the coordinate range can only make the test more conservative
+    m_MinX = clampCoord( std::min<int64_t>( aSeg.A.x, aSeg.B.x ) - margin );
+    m_MinY = clampCoord( std::min<int64_t>( aSeg.A.y, aSeg.B.y ) - margin );
+    m_MaxX = clampCoord( std::max<int64_t>( aSeg.A.x, aSeg.B.x ) + margin );
+    m_MaxY = clampCoord( std::max<int64_t>( aSeg.A.y, aSeg.B.y ) + margin );
+}
+
+
+static inline bool boxNear( int32_t aMinX, int32_t aMinY, int32_t aMaxX, int32_t aMaxY,
+                            const SEG_QUERY_BOX& aQuery )
+{
+    return !( aMaxX < aQuery.m_MinX || aMinX > aQuery.m_MaxX
+              || aMaxY < aQuery.m_MinY || aMinY > aQuery.m_MaxY );
+}
+
+
+static uint64_t polylineNearScalar( const VECTOR2I* aPoints, size_t aFirst, size_t aCount,
+                                    const SEG_QUERY_BOX& aQuery )
+{
+    uint64_t mask = 0;
+
+    for( size_t ii = aFirst; ii < aCount; ++ii )
+    {
+        const VECTOR2I& a = aPoints[ii];
+        const VECTOR2I& b = aPoints[ii + 1];
+
+        if( boxNear( std::min( a.x, b.x ), std::min( a.y, b.y ), std::max( a.x, b.x ),
+                     std::max( a.y, b.y ), aQuery ) )
+        {
+            mask |= uint64_t( 1 ) << ii;
+        }
+    }
+
+    return mask;
+}
+
+
+static uint64_t boxesNearScalar( const int32_t* aMinX, const int32_t* aMinY,
+                                 const int32_t* aMaxX, const int32_t* aMaxY, size_t aFirst,
+                                 size_t aCount, const SEG_QUERY_BOX& aQuery )
+{
+    uint64_t mask = 0;
+
+    for( size_t ii = aFirst; ii < aCount; ++ii )
+    {
+        if( boxNear( aMinX[ii], aMinY[ii], aMaxX[ii], aMaxY[ii], aQuery ) )
+            mask |= uint64_t( 1 ) << ii;
+    }
+
+    return mask;
+}
+
+
+#if defined( SEG_BATCH_X86 )
+
+/*
+ * The polyline kernels load points i, i+1, ... and i+1, i+2, ... as interleaved x, y pairs.
+ * The lane-wise min and max of the two loads are then the bounding boxes of segments i, i+1,
+ * ... still as x, y pairs, and a segment is far if either of its two lanes is.
+ */
+
+TARGET_SSE41
+static uint64_t polylineNearSse41( const VECTOR2I* aPoints, size_t aCount,
+                                   const SEG_QUERY_BOX& aQuery )
+{
+    const __m128i qMin = _mm_setr_epi32( aQuery.m_MinX, aQuery.m_MinY, aQuery.m_MinX,
+                                         aQuery.m_MinY );
+    const __m128i qMax = _mm_setr_epi32( aQuery.m_MaxX, aQuery.m_MaxY, aQuery.m_MaxX,
+                                         aQuery.m_MaxY );
+    uint64_t      mask = 0;
+    size_t        ii = 0;
+
+    for( ; ii + 2 <= aCount; ii += 2 )
+    {
+        __m128i p0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( aPoints + ii ) );
+        __m128i p1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( aPoints + ii + 1 ) );
+        __m128i lo = _mm_min_epi32( p0, p1 );
+        __m128i hi = _mm_max_epi32( p0, p1 );
+        __m128i outside = _mm_or_si128( _mm_cmplt_epi32( hi, qMin ),
+                                        _mm_cmpgt_epi32( lo, qMax ) );
+
+        unsigned lanes = _mm_movemask_ps( _mm_castsi128_ps( outside ) );
+        unsigned segs = ( lanes | ( lanes >> 1 ) ) & 0x5;
+
+        segs = ( segs & 0x1 ) | ( ( segs >> 1 ) & 0x2 );
+        mask |= uint64_t( ~segs & 0x3 ) << ii;
+    }
+
+    return mask | polylineNearScalar( aPoints, ii, aCount, aQuery );
+}
+
+
+TARGET_AVX2
+static uint64_t polylineNearAvx2( const VECTOR2I* aPoints, size_t aCount,
+                                  const SEG_QUERY_BOX& aQuery )
+{
+    const __m256i qMin = _mm256_setr_epi32( aQuery.m_MinX, aQuery.m_MinY, aQuery.m_MinX,
+                                            aQuery.m_MinY, aQuery.m_MinX, aQuery.m_MinY,
+                                            aQuery.m_MinX, aQuery.m_MinY );
+    const __m256i qMax = _mm256_setr_epi32( aQuery.m_MaxX, aQuery.m_MaxY, aQuery.m_MaxX,
+                                            aQuery.m_MaxY, aQuery.m_MaxX, aQuery.m_MaxY,
+                                            aQuery.m_MaxX, aQuery.m_MaxY );
+    uint64_t      mask = 0;
+    size_t        ii = 0;
+
+    for( ; ii + 4 <= aCount; ii += 4 )
+    {
+        __m256i p0 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( aPoints + ii ) );
+        __m256i p1 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( aPoints + ii + 1 ) );
+        __m256i lo = _mm256_min_epi32( p0, p1 );
+        __m256i hi = _mm256_max_epi32( p0, p1 );
+        __m256i outside = _mm256_or_si256( _mm256_cmpgt_epi32( qMin, hi ),
+                                           _mm256_cmpgt_epi32( lo, qMax ) );
+
+        unsigned lanes = _mm256_movemask_ps( _mm256_castsi256_ps( outside ) );
+        unsigned segs = ( lanes | ( lanes >> 1 ) ) & 0x55;
+
+        segs = ( segs & 0x1 ) | ( ( segs >> 1 ) & 0x2 ) | ( ( segs >> 2 ) & 0x4 )
+               | ( ( segs >> 3 ) & 0x8 );
+        mask |= uint64_t( ~segs & 0xF ) << ii;
+    }
+
+    return mask | polylineNearScalar( aPoints, ii, aCount, aQuery );
+}
+
+
+TARGET_SSE41
+static uint64_t boxesNearSse41( const int32_t* aMinX, const int32_t* aMinY,
+                                const int32_t* aMaxX, const int32_t* aMaxY, size_t aCount,
+                                const SEG_QUERY_BOX& aQuery )
+{
+    const __m128i qMinX = _mm_set1_epi32( aQuery.m_MinX );
+    const __m128i qMinY = _mm_set1_epi32( aQuery.m_MinY );
+    const __m128i qMaxX = _mm_set1_epi32( aQuery.m_MaxX );
+    const __m128i qMaxY = _mm_set1_epi32( aQuery.m_MaxY );
+    uint64_t      mask = 0;
+    size_t        ii = 0;
+
+    for( ; ii + 4 <= aCount; ii += 4 )
+    {
+        __m128i minX = _mm_loadu_si128( reinterpret_cast<const __m128i*>( aMinX + ii ) );
+        __m128i minY = _mm_loadu_si128( reinterpret_cast<const __m128i*>( aMinY + ii ) );
+        __m128i maxX = _mm_loadu_si128( reinterpret_cast<const __m128i*>( aMaxX + ii ) );
+        __m128i maxY = _mm_loadu_si128( reinterpret_cast<const __m128i*>( aMaxY + ii ) );
+
+        __m128i outside = _mm_or_si128( _mm_cmplt_epi32( maxX, qMinX ),
+                                        _mm_cmpgt_epi32( minX, qMaxX ) );
+
+        outside = _mm_or_si128( outside, _mm_cmplt_epi32( maxY, qMinY ) );
+        outside = _mm_or_si128( outside, _mm_cmpgt_epi32( minY, qMaxY ) );
+
+        unsigned lanes = _mm_movemask_ps( _mm_castsi128_ps( outside ) );
+        mask |= uint64_t( ~lanes & 0xF ) << ii;
+    }
+
+    return mask | boxesNearScalar( aMinX, aMinY, aMaxX, aMaxY, ii, aCount, aQuery );
+}
+
+
+TARGET_AVX2
+static uint64_t boxesNearAvx2( const int32_t* aMinX, const int32_t* aMinY,
+                               const int32_t* aMaxX, const int32_t* aMaxY, size_t aCount,
+                               const SEG_QUERY_BOX& aQuery )
+{
+    const __m256i qMinX = _mm256_set1_epi32( aQuery.m_MinX );
+    const __m256i qMinY = _mm256_set1_epi32( aQuery.m_MinY );
+    const __m256i qMaxX = _mm256_set1_epi32( aQuery.m_MaxX );
+    const __m256i qMaxY = _mm256_set1_epi32( aQuery.m_MaxY );
+    uint64_t      mask = 0;
+    size_t        ii = 0;
+
+    for( ; ii + 8 <= aCount; ii += 8 )
+    {
+        __m256i minX = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( aMinX + ii ) );
+        __m256i minY = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( aMinY + ii ) );
+        __m256i maxX = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( aMaxX + ii ) );
+        __m256i maxY = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( aMaxY + ii ) );
+
+        // AVX2 has no "less than" comparison for integers
+        __m256i outside = _mm256_or_si256( _mm256_cmpgt_epi32( qMinX, maxX ),
+                                           _mm256_cmpgt_epi32( minX, qMaxX ) );
+
+        outside = _mm256_or_si256( outside, _mm256_cmpgt_epi32( qMinY, maxY ) );
+        outside = _mm256_or_si256( outside, _mm256_cmpgt_epi32( minY, qMaxY ) );
+
+        unsigned lanes = _mm256_movemask_ps( _mm256_castsi256_ps( outside ) );
+        mask |= uint64_t( ~lanes & 0xFF ) << ii;
+    }
+
+    return mask | boxesNearScalar( aMinX, aMinY, aMaxX, aMaxY, ii, aCount, aQuery );
+}
+
+#endif // SEG_BATCH_X86
+
+
+uint64_t PolylineSegmentsNear( const VECTOR2I* aPoints, size_t aCount,
+                               const SEG_QUERY_BOX& aQuery )
+{
+    switch( GetSimdLevel() )
+    {
+#if defined( SEG_BATCH_X86 )
+    case SIMD_LEVEL::AVX2:   return polylineNearAvx2( aPoints, aCount, aQuery );
+    case SIMD_LEVEL::SSE4_1: return polylineNearSse41( aPoints, aCount, aQuery );
+#endif
+    default:                 return polylineNearScalar( aPoints, 0, aCount, aQuery );
+    }
+}
+
+
+void SEG_BOXES::Reserve( size_t aCount )
+{
+    m_minX.reserve( aCount );
+    m_minY.reserve( aCount );
+    m_maxX.reserve( aCount );
+    m_maxY.reserve( aCount );
+}
+
+
+void SEG_BOXES::Add( const SEG& aSeg )
+{
+    m_minX.push_back( std::min( aSeg.A.x, aSeg.B.x ) );
+    m_minY.push_back( std::min( aSeg.A.y, aSeg.B.y ) );
+    m_maxX.push_back( std::max( aSeg.A.x, aSeg.B.x ) );
+    m_maxY.push_back( std::max( aSeg.A.y, aSeg.B.y ) );
+}
+
+
+uint64_t SEG_BOXES::Near( size_t aFirst, size_t aCount, const SEG_QUERY_BOX& aQuery ) const
+{
+    const int32_t* minX = m_minX.data() + aFirst;
+    const int32_t* minY = m_minY.data() + aFirst;
+    const int32_t* maxX = m_maxX.data() + aFirst;
+    const int32_t* maxY = m_maxY.data() + aFirst;
+
+    switch( GetSimdLevel() )
+    {
+#if defined( SEG_BATCH_X86 )
+    case SIMD_LEVEL::AVX2:   return boxesNearAvx2( minX, minY, maxX, maxY, aCount, aQuery );
+    case SIMD_LEVEL::SSE4_1: return boxesNearSse41( minX, minY, maxX, maxY, aCount, aQuery );
+#endif
+    default:                 return boxesNearScalar( minX, minY, maxX, maxY, 0, aCount, aQuery );
+    }
+}
+
+} // namespace KIGEOM
@@ -23,10 +23,12 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <bit>
 #include <cmath>
 #include <limits>
 
 #include <geometry/seg.h>                         // for SEG
+#include <geometry/seg_batch.h>
 #include <geometry/shape.h>
 #include <geometry/shape_arc.h>
 #include <geometry/shape_line_chain.h>
@@ -347,26 +349,42 @@ static inline bool Collide( const SHAPE_LINE_CHAIN_BASE& aA, const SHAPE_LINE_CH
         std::sort( a_segs.begin(), a_segs.end(), seg_sort );
         std::sort( b_segs.begin(), b_segs.end(), seg_sort );
 
+        // Segments of aB whose bounding boxes are too far from a segment of aA can never collide
+        // with it, so they are rejected in batches before calling SEG::Collide()
+        KIGEOM::SEG_BOXES b_boxes;
+        b_boxes.Reserve( b_segs.size() );
+
+        for( const SEG& b_seg : b_segs )
+            b_boxes.Add( b_seg );
+
         for( const SEG& a_seg : a_segs )
         {
-            for( const SEG& b_seg : b_segs )
+            const KIGEOM::SEG_QUERY_BOX query( a_seg, aClearance );
+            bool                        done = false;
+
+            for( size_t base = 0; base < b_segs.size() && !done; base += KIGEOM::SEG_BATCH_SIZE )
             {
-                int dist = 0;
+                size_t   count = std::min( KIGEOM::SEG_BATCH_SIZE, b_segs.size() - base );
+                uint64_t candidates = b_boxes.Near( base, count, query );
 
-                if( a_seg.Collide( b_seg, aClearance, aActual || aLocation ? &dist : nullptr ) )
+                for( ; candidates && !done; candidates &= candidates - 1 )
                 {
-                    if( dist < closest_dist )
+                    const SEG& b_seg = b_segs[base + std::countr_zero( candidates )];
+                    int        dist = 0;
+
+                    if( a_seg.Collide( b_seg, aClearance,
+                                       aActual || aLocation ? &dist : nullptr ) )
                     {
-                        nearest = a_seg.NearestPoint( b_seg );
-                        closest_dist = dist;
+                        if( dist < closest_dist )
+                        {
+                            nearest = a_seg.NearestPoint( b_seg );
+                            closest_dist = dist;
+                        }
+
+                        // If we're not looking for aActual then any collision will do
+                        if( closest_dist == 0 || !aActual )
+                            done = true;
                     }
-
-                    if( closest_dist == 0 )
-                        break;
-
-                    // If we're not looking for aActual then any collision will do
-                    if( !aActual )
-                        break;
                 }
             }
         }
@@ -24,15 +24,20 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <array>
+#include <bit>
 #include <limits>
 #include <math.h>            // for hypot
 #include <map>
+#include <mutex>
 #include <string>            // for basic_string
 
 #include <clipper2/clipper.h>
 #include <core/kicad_algo.h> // for alg::run_on_pair
 #include <geometry/circle.h>
+#include <geometry/packed_rtree.h>
 #include <geometry/seg.h>    // for SEG, OPT_VECTOR2I
+#include <geometry/seg_batch.h>
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_poly_set.h>
 #include <math/box2.h>       // for BOX2I
@@ -55,6 +60,149 @@ int getArcPolygonizationMaxError()
 }
 
 
+/// Chains with fewer segments than this are always scanned
+static constexpr int INDEX_MIN_SEGMENTS = 256;
+
+/// Number of queries on a long chain which scan it before it gets indexed
+static constexpr unsigned INDEX_MIN_QUERIES = 8;
+
+
+static int clampCoord( int64_t aValue )
+{
+    return static_cast<int>( std::clamp<int64_t>( aValue, std::numeric_limits<int>::min(),
+                                                  std::numeric_limits<int>::max() ) );
+}
+
+
+/**
+ * Bounding boxes of the segments of a long chain in a packed R-tree.  Segment i is the one
+ * returned by GetSegment( i ), including the closing segment of a closed chain.
+ */
+class SHAPE_LINE_CHAIN_INDEX
+{
+public:
+    SHAPE_LINE_CHAIN_INDEX( const SHAPE_LINE_CHAIN& aChain )
+    {
+        int     count = aChain.SegmentCount();
+        int64_t extent = 0;
+
+        m_tree.Reserve( count );
+
+        for( int ii = 0; ii < count; ++ii )
+        {
+            const SEG s = aChain.CSegment( ii );
+            const int min[2] = { std::min( s.A.x, s.B.x ), std::min( s.A.y, s.B.y ) };
+            const int max[2] = { std::max( s.A.x, s.B.x ), std::max( s.A.y, s.B.y ) };
+
+            m_tree.Add( min, max, ii );
+            extent += int64_t( max[0] ) - min[0] + int64_t( max[1] ) - min[1];
+        }
+
+        m_tree.Build();
+        m_typicalSize = std::max<int64_t>( 1, extent / std::max( 1, 2 * count ) );
+    }
+
+    /**
+     * Collect the segments whose bounding boxes overlap the given box.  They are sorted so that
+     * queries visit them in the same order as a scan of the whole chain, and give the same
+     * results.
+     */
+    void Query( int64_t aMinX, int64_t aMinY, int64_t aMaxX, int64_t aMaxY,
+                std::vector<int>& aSegments ) const
+    {
+        const int min[2] = { clampCoord( aMinX ), clampCoord( aMinY ) };
+        const int max[2] = { clampCoord( aMaxX ), clampCoord( aMaxY ) };
+
+        aSegments.clear();
+
+        m_tree.Search( min, max,
+                       [&]( int aSegment )
+                       {
+                           aSegments.push_back( aSegment );
+                           return true;
+                       } );
+
+        std::sort( aSegments.begin(), aSegments.end() );
+    }
+
+    /**
+     * Collect the segments which may be less than aMargin away from aP.
+     */
+    void Query( const VECTOR2I& aP, int64_t aMargin, std::vector<int>& aSegments ) const
+    {
+        Query( aP.x - aMargin, aP.y - aMargin, aP.x + aMargin, aP.y + aMargin, aSegments );
+    }
+
+    /**
+     * Collect the segments which may be the closest to aP, i.e. at least all the segments whose
+     * distance to aP, rounded down to an int, is the smallest.
+     */
+    void QueryNearest( const SHAPE_LINE_CHAIN_BASE& aChain, const VECTOR2I& aP,
+                       std::vector<int>& aSegments ) const
+    {
+        // Grow a box around aP until it catches some segments.  The closest of them is at least
+        // as far as the closest segment of the chain.
+        for( int64_t radius = m_typicalSize; ; radius *= 2 )
+        {
+            Query( aP, radius, aSegments );
+
+            if( !aSegments.empty() )
+                break;
+        }
+
+        SEG::ecoord closest = VECTOR2I::ECOORD_MAX;
+
+        for( int segment : aSegments )
+            closest = std::min( closest, aChain.GetSegment( segment ).SquaredDistance( aP ) );
+
+        Query( aP, int64_t( std::sqrt( double( closest ) ) ) + 2, aSegments );
+    }
+
+private:
+    PACKED_RTREE<int> m_tree;
+    int64_t           m_typicalSize;   ///< Average half perimeter of the segment boxes
+};
+
+
+static std::mutex& indexBuildMutex( const SHAPE_LINE_CHAIN_INDEX_CACHE* aCache )
+{
+    static std::array<std::mutex, 16> mutexes;
+
+    return mutexes[( reinterpret_cast<uintptr_t>( aCache ) >> 6 ) % mutexes.size()];
+}
+
+
+const SHAPE_LINE_CHAIN_INDEX*
+SHAPE_LINE_CHAIN_INDEX_CACHE::Get( const SHAPE_LINE_CHAIN& aChain ) const
+{
+    if( const SHAPE_LINE_CHAIN_INDEX* index = m_index.load( std::memory_order_acquire ) )
+        return index;
+
+    if( aChain.SegmentCount() < INDEX_MIN_SEGMENTS )
+        return nullptr;
+
+    if( m_queries.fetch_add( 1, std::memory_order_relaxed ) < INDEX_MIN_QUERIES )
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock( indexBuildMutex( this ) );
+
+    if( const SHAPE_LINE_CHAIN_INDEX* index = m_index.load( std::memory_order_acquire ) )
+        return index;
+
+    SHAPE_LINE_CHAIN_INDEX* index = new SHAPE_LINE_CHAIN_INDEX( aChain );
+    m_index.store( index, std::memory_order_release );
+
+    return index;
+}
+
+
+void SHAPE_LINE_CHAIN_INDEX_CACHE::release()
+{
+    delete m_index.exchange( nullptr );
+    m_queries.store( 0 );
+}
+
+
 SHAPE_LINE_CHAIN::SHAPE_LINE_CHAIN( const std::vector<int>& aV) :
         SHAPE_LINE_CHAIN_BASE( SH_LINE_CHAIN ),
         m_accuracy( 0 ),
@@ -75,7 +223,6 @@ SHAPE_LINE_CHAIN::SHAPE_LINE_CHAIN( const std::vector<VECTOR2I>& aV, bool aClose
         m_width( 0 )
 {
     m_points = aV;
-    m_shapes = std::vector<std::pair<ssize_t, ssize_t>>( aV.size(), SHAPES_ARE_PT );
     SetClosed( aClosed );
 }
 
@@ -105,7 +252,6 @@ SHAPE_LINE_CHAIN::SHAPE_LINE_CHAIN( const Clipper2Lib::Path64&          aPath,
 {
     std::map<ssize_t, ssize_t> loadedArcs;
     m_points.reserve( aPath.size() );
-    m_shapes.reserve( aPath.size() );
 
     auto loadArc =
         [&]( ssize_t aArcIndex ) -> ssize_t
@@ -133,13 +279,25 @@ SHAPE_LINE_CHAIN::SHAPE_LINE_CHAIN( const Clipper2Lib::Path64&          aPath,
         if( idx_z < 0 || idx_z >= (int)aZValueBuffer.size() )
             continue;
 
-        m_shapes[ii].first = loadArc( aZValueBuffer[idx_z].m_FirstArcIdx );
-        m_shapes[ii].second = loadArc( aZValueBuffer[idx_z].m_SecondArcIdx );
+        const CLIPPER_Z_VALUE& zValue = aZValueBuffer[idx_z];
+
+        // Most paths have no arcs, and then don't need to store shapes at all
+        if( zValue.m_FirstArcIdx == SHAPE_IS_PT && zValue.m_SecondArcIdx == SHAPE_IS_PT )
+            continue;
+
+        if( m_shapes.empty() )
+        {
+            m_shapes.reserve( aPath.size() );
+            m_shapes.assign( m_points.size(), SHAPES_ARE_PT );
+        }
+
+        m_shapes[ii].first = loadArc( zValue.m_FirstArcIdx );
+        m_shapes[ii].second = loadArc( zValue.m_SecondArcIdx );
     }
 
     // Clipper shouldn't return duplicate contiguous points. if it did, these would be
     // removed during Append() and we would have different number of shapes to points
-    wxASSERT( m_shapes.size() == m_points.size() );
+    wxASSERT( shapesMatchPoints() );
 
     // Clipper might mess up the rotation of the indices such that an arc can be split between
     // the end point and wrap around to the start point. Lets fix the indices up now
@@ -168,7 +326,8 @@ Clipper2Lib::Path64 SHAPE_LINE_CHAIN::convertToClipper2( bool aRequiredOrientati
     {
         const VECTOR2I& vertex = input.CPoint( i );
 
-        CLIPPER_Z_VALUE z_value( input.m_shapes[i], shape_offset );
+        CLIPPER_Z_VALUE z_value( input.m_shapes.empty() ? SHAPES_ARE_PT : input.m_shapes[i],
+                                 shape_offset );
         size_t          z_value_ptr = aZValueBuffer.size();
         aZValueBuffer.push_back( z_value );
 
@@ -183,7 +342,9 @@ Clipper2Lib::Path64 SHAPE_LINE_CHAIN::convertToClipper2( bool aRequiredOrientati
 
 void SHAPE_LINE_CHAIN::fixIndicesRotation()
 {
-    wxCHECK( m_shapes.size() == m_points.size(), /*void*/ );
+    m_segmentIndex.Invalidate();
+
+    wxCHECK( shapesMatchPoints(), /*void*/ );
 
     if( m_shapes.size() <= 1 )
         return;
@@ -206,18 +367,22 @@ void SHAPE_LINE_CHAIN::fixIndicesRotation()
 
 void SHAPE_LINE_CHAIN::mergeFirstLastPointIfNeeded()
 {
+    m_segmentIndex.Invalidate();
+
     if( m_closed )
     {
         if( m_points.size() > 1 && m_points.front() == m_points.back() )
         {
-            if( ArcIndex( m_shapes.size() - 1 ) != SHAPE_IS_PT )
+            if( ArcIndex( m_points.size() - 1 ) != SHAPE_IS_PT )
             {
                 m_shapes.front().second = m_shapes.front().first;
                 m_shapes.front().first = ArcIndex( m_shapes.size() - 1 ) ;
             }
 
             m_points.pop_back();
-            m_shapes.pop_back();
+
+            if( !m_shapes.empty() )
+                m_shapes.pop_back();
 
             fixIndicesRotation();
         }
@@ -268,6 +433,8 @@ void SHAPE_LINE_CHAIN::convertArc( ssize_t aArcIndex )
 void SHAPE_LINE_CHAIN::amendArc( size_t aArcIndex, const VECTOR2I& aNewStart,
                                  const VECTOR2I& aNewEnd )
 {
+    m_segmentIndex.Invalidate();
+
     wxCHECK_MSG( aArcIndex <  m_arcs.size(), /* void */,
                  wxT( "Invalid arc index requested." ) );
 
@@ -285,7 +452,7 @@ void SHAPE_LINE_CHAIN::amendArc( size_t aArcIndex, const VECTOR2I& aNewStart,
 void SHAPE_LINE_CHAIN::splitArc( ssize_t aPtIndex, bool aCoincident )
 {
     if( aPtIndex < 0 )
-        aPtIndex += m_shapes.size();
+        aPtIndex += m_points.size();
 
     if( !IsSharedPt( aPtIndex ) && IsArcStart( aPtIndex ) )
         return; // Nothing to do
@@ -434,26 +601,51 @@ bool SHAPE_LINE_CHAIN::Collide( const VECTOR2I& aP, int aClearance, int* aActual
     SEG::ecoord clearance_sq = SEG::Square( aClearance );
     VECTOR2I    nearest;
 
+    // Returns true when no other segment needs to be checked
+    auto collideSegment =
+            [&]( size_t i ) -> bool
+            {
+                if( IsArcSegment( i ) )
+                    return false;
+
+                const SEG&  s = GetSegment( i );
+                VECTOR2I    pn = s.NearestPoint( aP );
+                SEG::ecoord dist_sq = ( pn - aP ).SquaredEuclideanNorm();
+
+                if( dist_sq < closest_dist_sq )
+                {
+                    nearest = pn;
+                    closest_dist_sq = dist_sq;
+
+                    if( closest_dist_sq == 0 )
+                        return true;
+
+                    // If we're not looking for aActual then any collision will do
+                    if( closest_dist_sq < clearance_sq && !aActual )
+                        return true;
+                }
+
+                return false;
+            };
+
     // Collide line segments
-    for( size_t i = 0; i < GetSegmentCount(); i++ )
+    if( const SHAPE_LINE_CHAIN_INDEX* index = GetSegmentIndex() )
     {
-        if( IsArcSegment( i ) )
-            continue;
+        // Segments further than the clearance from aP cannot collide with it
+        std::vector<int> segments;
+        index->Query( aP, std::abs( int64_t( aClearance ) ), segments );
 
-        const SEG&  s = GetSegment( i );
-        VECTOR2I    pn = s.NearestPoint( aP );
-        SEG::ecoord dist_sq = ( pn - aP ).SquaredEuclideanNorm();
-
-        if( dist_sq < closest_dist_sq )
+        for( int i : segments )
         {
-            nearest = pn;
-            closest_dist_sq = dist_sq;
-
-            if( closest_dist_sq == 0 )
+            if( collideSegment( i ) )
                 break;
-
-            // If we're not looking for aActual then any collision will do
-            if( closest_dist_sq < clearance_sq && !aActual )
+        }
+    }
+    else
+    {
+        for( size_t i = 0; i < GetSegmentCount(); i++ )
+        {
+            if( collideSegment( i ) )
                 break;
         }
     }
@@ -487,6 +679,8 @@ bool SHAPE_LINE_CHAIN::Collide( const VECTOR2I& aP, int aClearance, int* aActual
 
 void SHAPE_LINE_CHAIN::Rotate( const EDA_ANGLE& aAngle, const VECTOR2I& aCenter )
 {
+    m_segmentIndex.Invalidate();
+
     for( VECTOR2I& pt : m_points )
         RotatePoint( pt, aCenter, aAngle );
 
@@ -823,30 +1017,67 @@ bool SHAPE_LINE_CHAIN::Collide( const SEG& aSeg, int aClearance, int* aActual,
     SEG::ecoord clearance_sq = SEG::Square( aClearance );
     VECTOR2I    nearest;
 
-    // Collide line segments
-    for( size_t i = 0; i < GetSegmentCount(); i++ )
-    {
-        if( IsArcSegment( i ) )
-            continue;
+    // Returns true when no other segment needs to be checked
+    auto collideSegment =
+            [&]( size_t i ) -> bool
+            {
+                if( IsArcSegment( i ) )
+                    return false;
 
-        const SEG&  s = GetSegment( i );
-        SEG::ecoord dist_sq = s.SquaredDistance( aSeg );
+                const SEG&  s = GetSegment( i );
+                SEG::ecoord dist_sq = s.SquaredDistance( aSeg );
 
-        if( dist_sq < closest_dist_sq )
-        {
-            if( aLocation )
-                nearest = s.NearestPoint( aSeg );
+                if( dist_sq < closest_dist_sq )
+                {
+                    if( aLocation )
+                        nearest = s.NearestPoint( aSeg );
 
-            closest_dist_sq = dist_sq;
+                    closest_dist_sq = dist_sq;
 
-            if( closest_dist_sq == 0 )
-                break;
+                    if( closest_dist_sq == 0 )
+                        return true;
 
-            // If we're not looking for aActual then any collision will do
-            if( closest_dist_sq < clearance_sq && !aActual )
+                    // If we're not looking for aActual then any collision will do
+                    if( closest_dist_sq < clearance_sq && !aActual )
+                        return true;
+                }
+
+                return false;
+            };
+
+    // Collide line segments.  Segments whose bounding boxes are too far from aSeg can never be
+    // within the clearance, so they are skipped before computing exact distances.
+    const KIGEOM::SEG_QUERY_BOX query( aSeg, aClearance );
+
+    if( const SHAPE_LINE_CHAIN_INDEX* index = GetSegmentIndex() )
+    {
+        std::vector<int> segments;
+        index->Query( query.m_MinX, query.m_MinY, query.m_MaxX, query.m_MaxY, segments );
+
+        for( int i : segments )
+        {
+            if( collideSegment( i ) )
                 break;
         }
     }
+    else
+    {
+        const size_t lineCount = m_points.empty() ? 0 : m_points.size() - 1;
+        bool         done = false;
+
+        for( size_t base = 0; base < lineCount && !done; base += KIGEOM::SEG_BATCH_SIZE )
+        {
+            size_t   count = std::min( KIGEOM::SEG_BATCH_SIZE, lineCount - base );
+            uint64_t candidates = KIGEOM::PolylineSegmentsNear( &m_points[base], count, query );
+
+            for( ; candidates && !done; candidates &= candidates - 1 )
+                done = collideSegment( base + std::countr_zero( candidates ) );
+        }
+
+        // The closing segment of a closed chain
+        if( !done && lineCount < GetSegmentCount() )
+            collideSegment( lineCount );
+    }
 
     if( closest_dist_sq == 0 || closest_dist_sq < clearance_sq )
     {
@@ -943,6 +1174,8 @@ void SHAPE_LINE_CHAIN::ClearArcs()
 {
     for( ssize_t arcIndex = m_arcs.size() - 1; arcIndex >= 0; --arcIndex )
         convertArc( arcIndex );
+
+    compactShapes();
 }
 
 
@@ -966,6 +1199,8 @@ long long int SHAPE_LINE_CHAIN::Length() const
 
 void SHAPE_LINE_CHAIN::Mirror( const VECTOR2I& aRef, FLIP_DIRECTION aFlipDirection )
 {
+    m_segmentIndex.Invalidate();
+
     for( auto& pt : m_points )
     {
         if( aFlipDirection == FLIP_DIRECTION::LEFT_RIGHT )
@@ -981,6 +1216,8 @@ void SHAPE_LINE_CHAIN::Mirror( const VECTOR2I& aRef, FLIP_DIRECTION aFlipDirecti
 
 void SHAPE_LINE_CHAIN::Mirror( const SEG& axis )
 {
+    m_segmentIndex.Invalidate();
+
     for( auto& pt : m_points )
         pt = axis.ReflectPoint( pt );
 
@@ -993,12 +1230,14 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
 {
     Remove( aStartIndex, aEndIndex );
     Insert( aStartIndex, aP );
-    assert( m_shapes.size() == m_points.size() );
+    assert( shapesMatchPoints() );
 }
 
 
 void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE_CHAIN& aLine )
 {
+    m_segmentIndex.Invalidate();
+
     if( aEndIndex < 0 )
         aEndIndex += PointCount();
 
@@ -1044,9 +1283,19 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE
     if( newLine.PointCount() == 0 )
         return;
 
+    // Neither line has arcs: only the points need to be spliced in
+    if( m_shapes.empty() && m_arcs.empty() && newLine.m_shapes.empty() && newLine.m_arcs.empty() )
+    {
+        m_points.insert( m_points.begin() + aStartIndex, newLine.m_points.begin(),
+                         newLine.m_points.end() );
+        return;
+    }
+
+    expandShapes();
+
     // The total new arcs index is added to the new arc indices
     size_t prev_arc_count = m_arcs.size();
-    std::vector<std::pair<ssize_t, ssize_t>> new_shapes = newLine.m_shapes;
+    std::vector<std::pair<ssize_t, ssize_t>> new_shapes = newLine.CShapes();
 
     for( std::pair<ssize_t, ssize_t>& shape_pair : new_shapes )
     {
@@ -1069,7 +1318,9 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE
 
 void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
 {
-    wxCHECK( m_shapes.size() == m_points.size(), /*void*/ );
+    m_segmentIndex.Invalidate();
+
+    wxCHECK( shapesMatchPoints(), /*void*/ );
 
     // Unwrap the chain first (correctly handling removing arc at
     // end of chain coincident with start)
@@ -1108,6 +1359,13 @@ void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
         return;
     }
 
+    if( m_shapes.empty() )
+    {
+        m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
+        SetClosed( closedState );
+        return;
+    }
+
     std::set<size_t> extra_arcs;
     auto logArcIdxRemoval = [&]( ssize_t& aShapeIndex )
                             {
@@ -1153,6 +1411,7 @@ void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
     assert( m_shapes.size() == m_points.size() );
 
+    compactShapes();
     SetClosed( closedState );
 }
 
@@ -1164,6 +1423,17 @@ SEG::ecoord SHAPE_LINE_CHAIN_BASE::SquaredDistance( const VECTOR2I& aP, bool aOu
     if( IsClosed() && PointInside( aP ) && !aOutlineOnly )
         return 0;
 
+    if( const SHAPE_LINE_CHAIN_INDEX* index = GetSegmentIndex() )
+    {
+        std::vector<int> segments;
+        index->QueryNearest( *this, aP, segments );
+
+        for( int s : segments )
+            d = std::min( d, GetSegment( s ).SquaredDistance( aP ) );
+
+        return d;
+    }
+
     for( size_t s = 0; s < GetSegmentCount(); s++ )
         d = std::min( d, GetSegment( s ).SquaredDistance( aP ) );
 
@@ -1173,6 +1443,8 @@ SEG::ecoord SHAPE_LINE_CHAIN_BASE::SquaredDistance( const VECTOR2I& aP, bool aOu
 
 int SHAPE_LINE_CHAIN::Split( const VECTOR2I& aP, bool aExact )
 {
+    m_segmentIndex.Invalidate();
+
     int ii = -1;
     int min_dist = 2;
 
@@ -1261,7 +1533,7 @@ int SHAPE_LINE_CHAIN::FindSegment( const VECTOR2I& aP, int aThreshold ) const
 
 int SHAPE_LINE_CHAIN::ShapeCount() const
 {
-    wxCHECK2_MSG( m_points.size() == m_shapes.size(), return 0, "Invalid chain!" );
+    wxCHECK2_MSG( shapesMatchPoints(), return 0, "Invalid chain!" );
 
     if( m_points.size() < 2 )
         return 0;
@@ -1306,7 +1578,7 @@ int SHAPE_LINE_CHAIN::NextShape( int aPointIndex ) const
     if( aPointIndex >= lastIndex )
         return -1; // we don't want to wrap around
 
-    if( m_shapes[aPointIndex] == SHAPES_ARE_PT )
+    if( !IsPtOnArc( aPointIndex ) )
     {
         if( aPointIndex == lastIndex - 1 )
         {
@@ -1354,6 +1626,8 @@ int SHAPE_LINE_CHAIN::NextShape( int aPointIndex ) const
 
 void SHAPE_LINE_CHAIN::SetPoint( int aIndex, const VECTOR2I& aPos )
 {
+    m_segmentIndex.Invalidate();
+
     if( aIndex < 0 )
         aIndex += PointCount();
     else if( aIndex >= PointCount() )
@@ -1361,12 +1635,17 @@ void SHAPE_LINE_CHAIN::SetPoint( int aIndex, const VECTOR2I& aPos )
 
     m_points[aIndex] = aPos;
 
+    if( m_shapes.empty() )
+        return;
+
     alg::run_on_pair( m_shapes[aIndex],
         [&]( ssize_t& aIdx )
         {
             if( aIdx != SHAPE_IS_PT )
                 convertArc( aIdx );
         } );
+
+    compactShapes();
 }
 
 
@@ -1378,7 +1657,7 @@ void SHAPE_LINE_CHAIN::RemoveShape( int aPointIndex )
     if( aPointIndex >= PointCount() || aPointIndex < 0 )
         return; // Invalid index, fail gracefully
 
-    if( m_shapes[aPointIndex] == SHAPES_ARE_PT )
+    if( !IsPtOnArc( aPointIndex ) )
     {
         Remove( aPointIndex );
         return;
@@ -1480,6 +1759,8 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Slice( int aStartIndex, int aEndIndex,
                 ssize_t          arcIndex = ArcIndex( i );
                 const SHAPE_ARC& currentArc = Arc( arcIndex );
 
+                rv.expandShapes();
+
                 // Copy the points as arc points
                 for( ; i <= aEndIndex && i < numPoints; i++ )
                 {
@@ -1530,7 +1811,7 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Slice( int aStartIndex, int aEndIndex,
 
     }
 
-    wxASSERT( rv.m_points.size() == rv.m_shapes.size() );
+    wxASSERT( rv.shapesMatchPoints() );
 
     return rv;
 }
@@ -1538,13 +1819,35 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Slice( int aStartIndex, int aEndIndex,
 
 void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
 {
-    assert( m_shapes.size() == m_points.size() );
+    m_segmentIndex.Invalidate();
+
+    assert( shapesMatchPoints() );
 
     if( aOtherLine.PointCount() == 0 )
     {
         return;
     }
 
+    // Neither chain has arcs, so there are only points to append
+    if( m_shapes.empty() && m_arcs.empty() && aOtherLine.m_arcs.empty() )
+    {
+        size_t first = ( PointCount() == 0 || aOtherLine.CPoint( 0 ) != CLastPoint() ) ? 0 : 1;
+
+        for( size_t i = first; i < aOtherLine.m_points.size(); i++ )
+            m_bbox.Merge( aOtherLine.m_points[i] );
+
+        m_points.insert( m_points.end(), aOtherLine.m_points.begin() + first,
+                         aOtherLine.m_points.end() );
+
+        mergeFirstLastPointIfNeeded();
+        return;
+    }
+
+    expandShapes();
+
+    const std::pair<ssize_t, ssize_t> otherFirstShape =
+            aOtherLine.m_shapes.empty() ? SHAPES_ARE_PT : aOtherLine.m_shapes[0];
+
     size_t num_arcs = m_arcs.size();
     m_arcs.insert( m_arcs.end(), aOtherLine.m_arcs.begin(), aOtherLine.m_arcs.end() );
 
@@ -1566,16 +1869,16 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
     {
         const VECTOR2I p = aOtherLine.CPoint( 0 );
         m_points.push_back( p );
-        m_shapes.push_back( fixShapeIndices( aOtherLine.CShapes()[0] ) );
+        m_shapes.push_back( fixShapeIndices( otherFirstShape ) );
         m_bbox.Merge( p );
     }
     else if( aOtherLine.IsArcSegment( 0 ) )
     {
         // Associate the new arc shape with the last point of this chain
         if( m_shapes.back() == SHAPES_ARE_PT )
-            m_shapes.back().first = aOtherLine.CShapes()[0].first + num_arcs;
+            m_shapes.back().first = otherFirstShape.first + num_arcs;
         else
-            m_shapes.back().second = aOtherLine.CShapes()[0].first + num_arcs;
+            m_shapes.back().second = otherFirstShape.first + num_arcs;
     }
 
 
@@ -1598,7 +1901,7 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
 
     mergeFirstLastPointIfNeeded();
 
-    assert( m_shapes.size() == m_points.size() );
+    assert( shapesMatchPoints() );
 }
 
 
@@ -1610,10 +1913,13 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
 
 void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc, int aMaxError )
 {
+    m_segmentIndex.Invalidate();
+
     SHAPE_LINE_CHAIN chain = aArc.ConvertToPolyline( aMaxError );
 
     if( chain.PointCount() > 2 )
     {
+        chain.expandShapes();
         chain.m_arcs.push_back( aArc );
         chain.m_arcs.back().SetWidth( 0 );
 
@@ -1623,12 +1929,14 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc, int aMaxError )
 
     Append( chain );
 
-    assert( m_shapes.size() == m_points.size() );
+    assert( shapesMatchPoints() );
 }
 
 
 void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const VECTOR2I& aP )
 {
+    m_segmentIndex.Invalidate();
+
     if( aVertex == m_points.size() )
     {
         Append( aP );
@@ -1642,9 +1950,11 @@ void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const VECTOR2I& aP )
 
     //@todo need to check we aren't creating duplicate points
     m_points.insert( m_points.begin() + aVertex, aP );
-    m_shapes.insert( m_shapes.begin() + aVertex, SHAPES_ARE_PT );
 
-    assert( m_shapes.size() == m_points.size() );
+    if( !m_shapes.empty() )
+        m_shapes.insert( m_shapes.begin() + aVertex, SHAPES_ARE_PT );
+
+    assert( shapesMatchPoints() );
 }
 
 
@@ -1656,11 +1966,15 @@ void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const SHAPE_ARC& aArc )
 
 void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const SHAPE_ARC& aArc, int aMaxError )
 {
+    m_segmentIndex.Invalidate();
+
     wxCHECK( aVertex < m_points.size(), /* void */ );
 
     if( aVertex > 0 && IsPtOnArc( aVertex ) )
         splitArc( aVertex );
 
+    expandShapes();
+
     /// Step 1: Find the position for the new arc in the existing arc vector
     ssize_t arc_pos = m_arcs.size();
 
@@ -1928,19 +2242,36 @@ bool SHAPE_LINE_CHAIN_BASE::PointInside( const VECTOR2I& aPt, int aAccuracy,
     int  pointCount = GetPointCount();
     bool inside = false;
 
-    for( int i = 0; i < pointCount; )
-    {
-        const VECTOR2I p1 = GetPoint( i++ );
-        const VECTOR2I p2 = GetPoint( i == pointCount ? 0 : i );
-        const VECTOR2I diff = p2 - p1;
+    auto crossEdge =
+            [&]( int i )
+            {
+                const VECTOR2I p1 = GetPoint( i++ );
+                const VECTOR2I p2 = GetPoint( i == pointCount ? 0 : i );
+                const VECTOR2I diff = p2 - p1;
 
-        if( diff.y == 0 )
-            continue;
+                if( diff.y == 0 )
+                    return;
 
-        const int d = rescale( diff.x, ( aPt.y - p1.y ), diff.y );
+                const int d = rescale( diff.x, ( aPt.y - p1.y ), diff.y );
 
-        if( ( ( p1.y >= aPt.y ) != ( p2.y >= aPt.y ) ) && ( aPt.x - p1.x < d ) )
-            inside = !inside;
+                if( ( ( p1.y >= aPt.y ) != ( p2.y >= aPt.y ) ) && ( aPt.x - p1.x < d ) )
+                    inside = !inside;
+            };
+
+    if( const SHAPE_LINE_CHAIN_INDEX* index = GetSegmentIndex() )
+    {
+        // Only the edges which span the height of aPt and are not entirely on its left can cross
+        // the line
+        std::vector<int> edges;
+        index->Query( aPt.x, aPt.y, std::numeric_limits<int>::max(), aPt.y, edges );
+
+        for( int i : edges )
+            crossEdge( i );
+    }
+    else
+    {
+        for( int i = 0; i < pointCount; i++ )
+            crossEdge( i );
     }
 
     // If accuracy is <= 1 (nm) then we skip the accuracy test for performance.  Otherwise
@@ -1974,16 +2305,32 @@ int SHAPE_LINE_CHAIN_BASE::EdgeContainingPoint( const VECTOR2I& aPt, int aAccura
         return distSq <= thresholdSq ? 0 : -1;
     }
 
-    const size_t segCount = GetSegmentCount();
+    auto containsPoint =
+            [&]( int i )
+            {
+                const SEG s = GetSegment( i );
+                return s.A == aPt || s.B == aPt || s.SquaredDistance( aPt ) <= thresholdSq;
+            };
 
-    for( size_t i = 0; i < segCount; i++ )
+    if( const SHAPE_LINE_CHAIN_INDEX* index = GetSegmentIndex() )
     {
-        const SEG s = GetSegment( i );
+        std::vector<int> segments;
+        index->Query( aPt, threshold, segments );
 
-        if( s.A == aPt || s.B == aPt )
-            return i;
+        for( int i : segments )
+        {
+            if( containsPoint( i ) )
+                return i;
+        }
+
+        return -1;
+    }
 
-        if( s.SquaredDistance( aPt ) <= thresholdSq )
+    const size_t segCount = GetSegmentCount();
+
+    for( size_t i = 0; i < segCount; i++ )
+    {
+        if( containsPoint( i ) )
             return i;
     }
 
@@ -2021,12 +2368,31 @@ const std::optional<SHAPE_LINE_CHAIN::INTERSECTION> SHAPE_LINE_CHAIN::SelfInters
     for( size_t s = 0; s < segCount; s++ )
         segments[s] = CSegment( s );
 
+    const SHAPE_LINE_CHAIN_INDEX* index = GetSegmentIndex();
+    std::vector<int>              candidates;
+
     for( size_t s1 = 0; s1 < segCount; s1++ )
     {
         const SEG& cs1 = segments[s1];
 
-        for( size_t s2 = s1 + 1; s2 < segCount; s2++ )
+        if( index )
         {
+            // Only segments which touch cs1 (give or take SEG::Contains' tolerance) can intersect
+            // it.  The candidates are sorted, so they are checked in the same order as below.
+            index->Query( int64_t( std::min( cs1.A.x, cs1.B.x ) ) - 2,
+                          int64_t( std::min( cs1.A.y, cs1.B.y ) ) - 2,
+                          int64_t( std::max( cs1.A.x, cs1.B.x ) ) + 2,
+                          int64_t( std::max( cs1.A.y, cs1.B.y ) ) + 2, candidates );
+
+            candidates.erase( candidates.begin(),
+                              std::upper_bound( candidates.begin(), candidates.end(), int( s1 ) ) );
+        }
+
+        const size_t candidateCount = index ? candidates.size() : segCount - s1 - 1;
+
+        for( size_t ii = 0; ii < candidateCount; ii++ )
+        {
+            const size_t   s2 = index ? candidates[ii] : s1 + 1 + ii;
             const SEG&     cs2 = segments[s2];
             const VECTOR2I s2a = cs2.A, s2b = cs2.B;
 
@@ -2259,19 +2625,7 @@ const VECTOR2I SHAPE_LINE_CHAIN::NearestPoint( const VECTOR2I& aP,
         return { 0, 0 };
     }
 
-    int min_d = std::numeric_limits<int>::max();
-    int nearest = 0;
-
-    for( int i = 0; i < SegmentCount(); i++ )
-    {
-        int d = CSegment( i ).Distance( aP );
-
-        if( d < min_d )
-        {
-            min_d = d;
-            nearest = i;
-        }
-    }
+    int nearest = NearestSegment( aP );
 
     if( !aAllowInternalShapePoints )
     {
@@ -2340,15 +2694,30 @@ int SHAPE_LINE_CHAIN::NearestSegment( const VECTOR2I& aP ) const
     int min_d = std::numeric_limits<int>::max();
     int nearest = 0;
 
-    for( int i = 0; i < SegmentCount(); i++ )
+    auto checkSegment =
+            [&]( int i )
+            {
+                int d = CSegment( i ).Distance( aP );
+
+                if( d < min_d )
+                {
+                    min_d = d;
+                    nearest = i;
+                }
+            };
+
+    if( const SHAPE_LINE_CHAIN_INDEX* index = GetSegmentIndex() )
     {
-        int d = CSegment( i ).Distance( aP );
+        std::vector<int> segments;
+        index->QueryNearest( *this, aP, segments );
 
-        if( d < min_d )
-        {
-            min_d = d;
-            nearest = i;
-        }
+        for( int i : segments )
+            checkSegment( i );
+    }
+    else
+    {
+        for( int i = 0; i < SegmentCount(); i++ )
+            checkSegment( i );
     }
 
     return nearest;
@@ -2418,10 +2787,14 @@ SHAPE* SHAPE_LINE_CHAIN::Clone() const
 
 bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
 {
+    m_segmentIndex.Invalidate();
+
     size_t n_pts;
     size_t n_arcs;
 
     m_points.clear();
+    m_shapes.clear();
+    m_arcs.clear();
     aStream >> n_pts;
 
     // Rough sanity check, just make sure the loop bounds aren't absolutely outlandish
@@ -2460,6 +2833,8 @@ bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
         m_arcs.emplace_back( pc, p0, EDA_ANGLE( angle, DEGREES_T ) );
     }
 
+    compactShapes();
+
     return true;
 }
 
@@ -2515,6 +2890,8 @@ double SHAPE_LINE_CHAIN::Area( bool aAbsolute ) const
 
 void SHAPE_LINE_CHAIN::RemoveDuplicatePoints()
 {
+    m_segmentIndex.Invalidate();
+
     std::vector<VECTOR2I> pts_unique;
     std::vector<std::pair<ssize_t, ssize_t>> shapes_unique;
 
@@ -2531,6 +2908,8 @@ void SHAPE_LINE_CHAIN::RemoveDuplicatePoints()
         return;
     }
 
+    expandShapes();
+
     int i = 0;
 
     while( i < PointCount() )
@@ -2571,15 +2950,21 @@ void SHAPE_LINE_CHAIN::RemoveDuplicatePoints()
         m_points.push_back( p0 );
         m_shapes.push_back( shapes_unique[ii] );
     }
+
+    compactShapes();
 }
 
 
 
 void SHAPE_LINE_CHAIN::Simplify( int aTolerance )
 {
+    m_segmentIndex.Invalidate();
+
     if( PointCount() < 3 )
         return;
 
+    expandShapes();
+
     std::vector<VECTOR2I> new_points;
     std::vector<std::pair<ssize_t, ssize_t>> new_shapes;
 
@@ -2667,6 +3052,7 @@ void SHAPE_LINE_CHAIN::Simplify( int aTolerance )
     m_shapes.clear();
     m_points = std::move( new_points );
     m_shapes = std::move( new_shapes );
+    compactShapes();
 }
 
 
@@ -2701,6 +3087,8 @@ void SHAPE_LINE_CHAIN::Split( const VECTOR2I& aStart, const VECTOR2I& aEnd, SHAP
 
 SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify2( bool aRemoveColinear )
 {
+    m_segmentIndex.Invalidate();
+
     std::vector<VECTOR2I> pts_unique;
     std::vector<std::pair<ssize_t, ssize_t>> shapes_unique;
 
@@ -2717,6 +3105,8 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify2( bool aRemoveColinear )
         return *this;
     }
 
+    expandShapes();
+
     int i = 0;
     int np = PointCount();
 
@@ -2780,6 +3170,7 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify2( bool aRemoveColinear )
         {
             m_points.push_back( pts_unique[np - 1] );
             m_shapes.push_back( shapes_unique[np - 1] );
+            compactShapes();
             return *this;
         }
 
@@ -2797,6 +3188,8 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify2( bool aRemoveColinear )
 
     assert( m_points.size() == m_shapes.size() );
 
+    compactShapes();
+
     return *this;
 }
 
@@ -3046,6 +3439,9 @@ bool SHAPE_LINE_CHAIN::IsArcSegment( size_t aSegment ) const
      * but without a shared vertex.  Here there is a segment between the end of the first arc
      * and the start of the second arc.
      */
+    if( m_shapes.empty() )
+        return false;
+
     size_t nextIdx = aSegment + 1;
 
     if( nextIdx > m_shapes.size() - 1 )
@@ -238,6 +238,8 @@ bool SHAPE_POLY_SET::GetGlobalIndex( SHAPE_POLY_SET::VERTEX_INDEX aRelativeIndic
 
 int SHAPE_POLY_SET::NewOutline()
 {
+    invalidateContourIndex();
+
     SHAPE_LINE_CHAIN empty_path;
     POLYGON          poly;
 
@@ -250,6 +252,8 @@ int SHAPE_POLY_SET::NewOutline()
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    invalidateContourIndex();
+
     SHAPE_LINE_CHAIN empty_path;
 
     empty_path.SetClosed( true );
@@ -267,6 +271,8 @@ int SHAPE_POLY_SET::NewHole( int aOutline )
 
 int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDuplication )
 {
+    invalidateContourIndex();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -291,6 +297,8 @@ int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDu
 int SHAPE_POLY_SET::Append( const SHAPE_ARC& aArc, int aOutline, int aHole,
                             std::optional<int> aMaxError )
 {
+    invalidateContourIndex();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -317,6 +325,8 @@ int SHAPE_POLY_SET::Append( const SHAPE_ARC& aArc, int aOutline, int aHole,
 
 void SHAPE_POLY_SET::InsertVertex( int aGlobalIndex, const VECTOR2I& aNewVertex )
 {
+    invalidateContourIndex();
+
     VERTEX_INDEX index;
 
     if( aGlobalIndex < 0 )
@@ -547,6 +557,8 @@ bool SHAPE_POLY_SET::IsSelfIntersecting() const
 
 int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 {
+    invalidateContourIndex();
+
     POLYGON poly;
 
     poly.push_back( aOutline );
@@ -565,6 +577,8 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 
 int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 {
+    invalidateContourIndex();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -584,6 +598,8 @@ int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 
 int SHAPE_POLY_SET::AddPolygon( const POLYGON& apolygon )
 {
+    invalidateContourIndex();
+
     m_polys.push_back( apolygon );
 
     return m_polys.size() - 1;
@@ -635,6 +651,8 @@ void SHAPE_POLY_SET::GetArcs( std::vector<SHAPE_ARC>& aArcBuffer ) const
 
 void SHAPE_POLY_SET::ClearArcs()
 {
+    invalidateContourIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( size_t i = 0; i < poly.size(); i++ )
@@ -1166,6 +1184,8 @@ void SHAPE_POLY_SET::importTree( Clipper2Lib::PolyTree64&            tree,
                                  const std::vector<CLIPPER_Z_VALUE>& aZValueBuffer,
                                  const std::vector<SHAPE_ARC>&       aArcBuffer )
 {
+    invalidateContourIndex();
+
     m_polys.clear();
 
     for( const std::unique_ptr<Clipper2Lib::PolyPath64>& n : tree )
@@ -1177,6 +1197,8 @@ void SHAPE_POLY_SET::importPaths( Clipper2Lib::Paths64&              aPath,
                                  const std::vector<CLIPPER_Z_VALUE>& aZValueBuffer,
                                  const std::vector<SHAPE_ARC>&       aArcBuffer )
 {
+    invalidateContourIndex();
+
     m_polys.clear();
     POLYGON path;
 
@@ -1664,6 +1686,8 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
 void SHAPE_POLY_SET::Fracture()
 {
+    invalidateContourIndex();
+
     Simplify();    // remove overlapping holes/degeneracy
 
     for( POLYGON& paths : m_polys )
@@ -1913,6 +1937,8 @@ bool SHAPE_POLY_SET::isExteriorWaist( const SEG& aSegA, const SEG& aSegB ) const
 
 void SHAPE_POLY_SET::splitCollinearOutlines()
 {
+    invalidateContourIndex();
+
     for( size_t polyIdx = 0; polyIdx < m_polys.size(); ++polyIdx )
     {
         bool changed = true;
@@ -2035,6 +2061,8 @@ void SHAPE_POLY_SET::Simplify()
 
 void SHAPE_POLY_SET::SimplifyOutlines( int aTolerance )
 {
+    invalidateContourIndex();
+
     for( POLYGON& paths : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : paths )
@@ -2045,6 +2073,23 @@ void SHAPE_POLY_SET::SimplifyOutlines( int aTolerance )
 }
 
 
+void SHAPE_POLY_SET::ShrinkToFit()
+{
+    for( POLYGON& paths : m_polys )
+    {
+        for( SHAPE_LINE_CHAIN& path : paths )
+            path.ShrinkToFit();
+
+        paths.shrink_to_fit();
+    }
+
+    m_polys.shrink_to_fit();
+
+    // Clear() would keep the capacity; BuildBBoxCaches() rebuilds the index if it's needed again
+    m_contourIndex = PACKED_RTREE<std::pair<int, int>>();
+}
+
+
 int SHAPE_POLY_SET::NormalizeAreaOutlines()
 {
     // We are expecting only one main outline, but this main outline can have holes
@@ -2113,6 +2158,8 @@ const std::string SHAPE_POLY_SET::Format( bool aCplusPlus ) const
 
 bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
 {
+    invalidateContourIndex();
+
     std::string tmp;
 
     aStream >> tmp;
@@ -2350,6 +2397,8 @@ bool SHAPE_POLY_SET::Collide( const SHAPE* aShape, int aClearance, int* aActual,
 
 void SHAPE_POLY_SET::RemoveAllContours()
 {
+    invalidateContourIndex();
+
     m_polys.clear();
     m_triangulatedPolys.clear();
     m_triangulationValid = false;
@@ -2358,6 +2407,8 @@ void SHAPE_POLY_SET::RemoveAllContours()
 
 void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 {
+    invalidateContourIndex();
+
     // Default polygon is the last one
     if( aPolygonIdx < 0 )
         aPolygonIdx += m_polys.size();
@@ -2368,6 +2419,8 @@ void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 
 void SHAPE_POLY_SET::RemoveOutline( int aOutlineIdx )
 {
+    invalidateContourIndex();
+
     m_polys.erase( m_polys.begin() + aOutlineIdx );
 }
 
@@ -2433,12 +2486,16 @@ int SHAPE_POLY_SET::RemoveNullSegments()
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
+    invalidateContourIndex();
+
     m_polys.erase( m_polys.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::DeletePolygonAndTriangulationData( int aIdx, bool aUpdateHash )
 {
+    invalidateContourIndex();
+
     m_polys.erase( m_polys.begin() + aIdx );
 
     if( m_triangulationValid )
@@ -2471,6 +2528,8 @@ void SHAPE_POLY_SET::UpdateTriangulationDataHash()
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    invalidateContourIndex();
+
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
 }
 
@@ -2483,7 +2542,7 @@ void SHAPE_POLY_SET::Append( const VECTOR2I& aP, int aOutline, int aHole )
 
 bool SHAPE_POLY_SET::CollideVertex( const VECTOR2I& aPoint,
                                     SHAPE_POLY_SET::VERTEX_INDEX* aClosestVertex,
-                                    int aClearance ) const
+                                    int aClearance, bool aUseBBoxCaches ) const
 {
     // Shows whether there was a collision
     bool collision = false;
@@ -2493,6 +2552,38 @@ bool SHAPE_POLY_SET::CollideVertex( const VECTOR2I& aPoint,
     ecoord      distance_squared;
     ecoord      clearance_squared = SEG::Square( aClearance );
 
+    if( aUseBBoxCaches && m_contourIndex.IsBuilt() )
+    {
+        // Contours are visited in the same order as by the iterator, so ties are resolved the
+        // same way
+        std::vector<std::pair<int, int>> contours;
+        queryContours( aPoint, aClearance, contours );
+
+        for( const auto& [polygonIdx, contourIdx] : contours )
+        {
+            const SHAPE_LINE_CHAIN& contour = m_polys[polygonIdx][contourIdx];
+
+            for( int vertexIdx = 0; vertexIdx < contour.PointCount(); vertexIdx++ )
+            {
+                distance_squared = ( contour.CPoint( vertexIdx ) - aPoint ).SquaredEuclideanNorm();
+
+                if( distance_squared <= clearance_squared )
+                {
+                    if( !aClosestVertex )
+                        return true;
+
+                    collision = true;
+                    clearance_squared = distance_squared;
+                    aClosestVertex->m_polygon = polygonIdx;
+                    aClosestVertex->m_contour = contourIdx;
+                    aClosestVertex->m_vertex = vertexIdx;
+                }
+            }
+        }
+
+        return collision;
+    }
+
     for( CONST_ITERATOR iterator = CIterateWithHoles(); iterator; iterator++ )
     {
         // Get the difference vector between current vertex and aPoint
@@ -2523,12 +2614,42 @@ bool SHAPE_POLY_SET::CollideVertex( const VECTOR2I& aPoint,
 
 bool SHAPE_POLY_SET::CollideEdge( const VECTOR2I& aPoint,
                                   SHAPE_POLY_SET::VERTEX_INDEX* aClosestVertex,
-                                  int aClearance ) const
+                                  int aClearance, bool aUseBBoxCaches ) const
 {
     // Shows whether there was a collision
     bool   collision = false;
     ecoord clearance_squared = SEG::Square( aClearance );
 
+    if( aUseBBoxCaches && m_contourIndex.IsBuilt() )
+    {
+        std::vector<std::pair<int, int>> contours;
+        queryContours( aPoint, aClearance, contours );
+
+        for( const auto& [polygonIdx, contourIdx] : contours )
+        {
+            const SHAPE_LINE_CHAIN& contour = m_polys[polygonIdx][contourIdx];
+
+            for( int segmentIdx = 0; segmentIdx < contour.SegmentCount(); segmentIdx++ )
+            {
+                ecoord distance_squared = contour.CSegment( segmentIdx ).SquaredDistance( aPoint );
+
+                if( distance_squared <= clearance_squared )
+                {
+                    if( !aClosestVertex )
+                        return true;
+
+                    collision = true;
+                    clearance_squared = distance_squared;
+                    aClosestVertex->m_polygon = polygonIdx;
+                    aClosestVertex->m_contour = contourIdx;
+                    aClosestVertex->m_vertex = segmentIdx;
+                }
+            }
+        }
+
+        return collision;
+    }
+
     for( CONST_SEGMENT_ITERATOR iterator = CIterateSegmentsWithHoles(); iterator; iterator++ )
     {
         const SEG currentSegment = *iterator;
@@ -2556,13 +2677,48 @@ bool SHAPE_POLY_SET::CollideEdge( const VECTOR2I& aPoint,
 
 void SHAPE_POLY_SET::BuildBBoxCaches() const
 {
+    m_contourIndex.Clear();
+
     for( int polygonIdx = 0; polygonIdx < OutlineCount(); polygonIdx++ )
     {
-        COutline( polygonIdx ).GenerateBBoxCache();
+        for( int contourIdx = 0; contourIdx < (int) m_polys[polygonIdx].size(); contourIdx++ )
+        {
+            const SHAPE_LINE_CHAIN& contour = m_polys[polygonIdx][contourIdx];
 
-        for( int holeIdx = 0; holeIdx < HoleCount( polygonIdx ); holeIdx++ )
-            CHole( polygonIdx, holeIdx ).GenerateBBoxCache();
+            contour.GenerateBBoxCache();
+            m_contourIndex.Add( *contour.GetCachedBBox(), { polygonIdx, contourIdx } );
+        }
     }
+
+    m_contourIndex.Build();
+}
+
+
+void SHAPE_POLY_SET::queryContours( const VECTOR2I& aP, int aMargin,
+                                    std::vector<std::pair<int, int>>& aContours ) const
+{
+    int64_t   margin = std::max( aMargin, 0 );
+    const int min[2] = { (int) std::max<int64_t>( INT_MIN, aP.x - margin ),
+                         (int) std::max<int64_t>( INT_MIN, aP.y - margin ) };
+    const int max[2] = { (int) std::min<int64_t>( INT_MAX, aP.x + margin ),
+                         (int) std::min<int64_t>( INT_MAX, aP.y + margin ) };
+
+    aContours.clear();
+
+    m_contourIndex.Search( min, max,
+                           [&]( const std::pair<int, int>& aContour )
+                           {
+                               // Don't trip over contours which have been removed since
+                               if( aContour.first < (int) m_polys.size()
+                                       && aContour.second < (int) m_polys[aContour.first].size() )
+                               {
+                                   aContours.push_back( aContour );
+                               }
+
+                               return true;
+                           } );
+
+    std::sort( aContours.begin(), aContours.end() );
 }
 
 
@@ -2576,6 +2732,21 @@ bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex, int aAccur
     if( aSubpolyIndex >= 0 )
         return containsSingle( aP, aSubpolyIndex, aAccuracy, aUseBBoxCaches );
 
+    // Only the polygons whose outlines are around aP can contain it
+    if( aUseBBoxCaches && m_contourIndex.IsBuilt() )
+    {
+        std::vector<std::pair<int, int>> contours;
+        queryContours( aP, aAccuracy, contours );
+
+        for( const auto& [polygonIdx, contourIdx] : contours )
+        {
+            if( contourIdx == 0 && containsSingle( aP, polygonIdx, aAccuracy, true ) )
+                return true;
+        }
+
+        return false;
+    }
+
     // In any other case, check it against all polygons in the set
     for( int polygonIdx = 0; polygonIdx < OutlineCount(); polygonIdx++ )
     {
@@ -2601,6 +2772,8 @@ void SHAPE_POLY_SET::RemoveVertex( int aGlobalIndex )
 
 void SHAPE_POLY_SET::RemoveVertex( VERTEX_INDEX aIndex )
 {
+    invalidateContourIndex();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].Remove( aIndex.m_vertex );
 }
 
@@ -2618,6 +2791,8 @@ void SHAPE_POLY_SET::SetVertex( int aGlobalIndex, const VECTOR2I& aPos )
 
 void SHAPE_POLY_SET::SetVertex( const VERTEX_INDEX& aIndex, const VECTOR2I& aPos )
 {
+    invalidateContourIndex();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].SetPoint( aIndex.m_vertex, aPos );
 }
 
@@ -2628,6 +2803,24 @@ bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, int
     // Check that the point is inside the outline
     if( m_polys[aSubpolyIndex][0].PointInside( aP, aAccuracy ) )
     {
+        // Only the holes whose bounding boxes contain the point can contain it
+        if( aUseBBoxCaches && m_contourIndex.IsBuilt() && HoleCount( aSubpolyIndex ) > 0 )
+        {
+            std::vector<std::pair<int, int>> contours;
+            queryContours( aP, 0, contours );
+
+            for( const auto& [polygonIdx, contourIdx] : contours )
+            {
+                if( polygonIdx == aSubpolyIndex && contourIdx > 0
+                        && m_polys[polygonIdx][contourIdx].PointInside( aP, 1, true ) )
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
         // Check that the point is not in any of the holes
         for( int holeIdx = 0; holeIdx < HoleCount( aSubpolyIndex ); holeIdx++ )
         {
@@ -2648,6 +2841,8 @@ bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, int
 
 void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 {
+    invalidateContourIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -2664,6 +2859,8 @@ void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 
 void SHAPE_POLY_SET::Mirror( const VECTOR2I& aRef, FLIP_DIRECTION aFlipDirection )
 {
+    invalidateContourIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -2677,6 +2874,8 @@ void SHAPE_POLY_SET::Mirror( const VECTOR2I& aRef, FLIP_DIRECTION aFlipDirection
 
 void SHAPE_POLY_SET::Rotate( const EDA_ANGLE& aAngle, const VECTOR2I& aCenter )
 {
+    invalidateContourIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -2884,6 +3083,7 @@ SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
     m_polys = aOther.m_polys;
 
     m_triangulatedPolys.clear();
+    m_contourIndex.Clear();
 
     if( aOther.IsTriangulationUpToDate() )
     {
@@ -3272,6 +3472,8 @@ SHAPE_POLY_SET::TRIANGULATED_POLYGON::~TRIANGULATED_POLYGON()
 
 void SHAPE_POLY_SET::Scale( double aScaleFactorX, double aScaleFactorY, const VECTOR2I& aCenter )
 {
+    invalidateContourIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -39,6 +39,21 @@ namespace IO
      */
     FILE* SeqFOpen( const wxString& aPath, const wxString& mode );
 
+    /**
+     * Maps a file read-only into memory, hinting that it will be read sequentially.
+     *
+     * @param aPath is the file to map.
+     * @param aSize is set to the length of the file on success.
+     * @return the start of the mapping, or nullptr if the file cannot be mapped (which includes
+     *         empty files).  A non-null result must be released with UnmapFile().
+     */
+    const char* MapFile( const wxString& aPath, size_t& aSize );
+
+    /**
+     * Releases a mapping made by MapFile().
+     */
+    void UnmapFile( const char* aData, size_t aSize );
+
     /**
      * Duplicates the file security data from one file to another ensuring that they are
      * the same between both.  This assumes that the user has permission to set #aDest
@@ -25,12 +25,53 @@
 #include <wx/string.h>
 #include <wx/filename.h>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 FILE* KIPLATFORM::IO::SeqFOpen( const wxString& aPath, const wxString& aMode )
 {
     return wxFopen( aPath, aMode );
 }
 
 
+const char* KIPLATFORM::IO::MapFile( const wxString& aPath, size_t& aSize )
+{
+    int fd = open( aPath.fn_str(), O_RDONLY );
+
+    if( fd == -1 )
+        return nullptr;
+
+    struct stat fileStat;
+    void*       data = MAP_FAILED;
+
+    if( fstat( fd, &fileStat ) == 0 && S_ISREG( fileStat.st_mode ) && fileStat.st_size > 0 )
+    {
+        data = mmap( nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+        if( data != MAP_FAILED )
+            posix_madvise( data, fileStat.st_size, POSIX_MADV_SEQUENTIAL );
+    }
+
+    // The mapping keeps its own reference to the file
+    close( fd );
+
+    if( data == MAP_FAILED )
+        return nullptr;
+
+    aSize = fileStat.st_size;
+    return static_cast<const char*>( data );
+}
+
+
+void KIPLATFORM::IO::UnmapFile( const char* aData, size_t aSize )
+{
+    if( aData )
+        munmap( const_cast<char*>( aData ), aSize );
+}
+
+
 bool KIPLATFORM::IO::DuplicatePermissions(const wxString& sourceFilePath, const wxString& destFilePath)
 {
     NSString *sourcePath = [NSString stringWithUTF8String:sourceFilePath.utf8_str()];
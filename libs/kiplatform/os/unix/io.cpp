@@ -25,6 +25,7 @@
 #include <wx/filename.h>
 
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -44,6 +45,40 @@ FILE* KIPLATFORM::IO::SeqFOpen( const wxString& aPath, const wxString& aMode )
     return fp;
 }
 
+const char* KIPLATFORM::IO::MapFile( const wxString& aPath, size_t& aSize )
+{
+    int fd = open( aPath.fn_str(), O_RDONLY );
+
+    if( fd == -1 )
+        return nullptr;
+
+    struct stat fileStat;
+    void*       data = MAP_FAILED;
+
+    if( fstat( fd, &fileStat ) == 0 && S_ISREG( fileStat.st_mode ) && fileStat.st_size > 0 )
+    {
+        data = mmap( nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+        if( data != MAP_FAILED )
+            posix_madvise( data, fileStat.st_size, POSIX_MADV_SEQUENTIAL );
+    }
+
+    // The mapping keeps its own reference to the file
+    close( fd );
+
+    if( data == MAP_FAILED )
+        return nullptr;
+
+    aSize = fileStat.st_size;
+    return static_cast<const char*>( data );
+}
+
+void KIPLATFORM::IO::UnmapFile( const char* aData, size_t aSize )
+{
+    if( aData )
+        munmap( const_cast<char*>( aData ), aSize );
+}
+
 bool KIPLATFORM::IO::DuplicatePermissions( const wxString &aSrc, const wxString &aDest )
 {
     struct stat sourceStat;
@@ -70,6 +70,51 @@ FILE* KIPLATFORM::IO::SeqFOpen( const wxString& aPath, const wxString& aMode )
 #endif
 }
 
+const char* KIPLATFORM::IO::MapFile( const wxString& aPath, size_t& aSize )
+{
+    HANDLE hFile = CreateFileW( aPath.wc_str(),
+                                GENERIC_READ,
+                                FILE_SHARE_READ,
+                                NULL,
+                                OPEN_EXISTING,
+                                FILE_FLAG_SEQUENTIAL_SCAN,
+                                NULL );
+
+    if( hFile == INVALID_HANDLE_VALUE )
+        return nullptr;
+
+    LARGE_INTEGER fileSize;
+    const char*   data = nullptr;
+
+    // Empty files cannot be mapped
+    if( GetFileSizeEx( hFile, &fileSize ) && fileSize.QuadPart > 0
+            && static_cast<ULONGLONG>( fileSize.QuadPart ) <= SIZE_MAX )
+    {
+        HANDLE hMapping = CreateFileMappingW( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+
+        if( hMapping )
+        {
+            data = static_cast<const char*>( MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 ) );
+
+            // The view keeps its own references to the mapping and the file
+            CloseHandle( hMapping );
+        }
+    }
+
+    CloseHandle( hFile );
+
+    if( data )
+        aSize = static_cast<size_t>( fileSize.QuadPart );
+
+    return data;
+}
+
+void KIPLATFORM::IO::UnmapFile( const char* aData, size_t aSize )
+{
+    if( aData )
+        UnmapViewOfFile( aData );
+}
+
 bool KIPLATFORM::IO::DuplicatePermissions( const wxString &aSrc, const wxString &aDest )
 {
     bool retval = false;
@@ -42,6 +42,7 @@
 #include <drc/drc_item.h>
 #include <layer_ids.h>
 #include <project.h>
+#include <router/pns_batch_router.h>
 #include <tool/tool_manager.h>
 #include <tools/pcb_actions.h>
 #include <tools/pcb_selection_tool.h>
@@ -101,6 +102,7 @@ API_HANDLER_PCB::API_HANDLER_PCB( PCB_EDIT_FRAME* aFrame ) :
     registerHandler<GetNetClassForNets, NetClassForNetsResponse>(
             &API_HANDLER_PCB::handleGetNetClassForNets );
     registerHandler<RefillZones, Empty>( &API_HANDLER_PCB::handleRefillZones );
+    registerHandler<RouteNets, RouteNetsResponse>( &API_HANDLER_PCB::handleRouteNets );
 
     registerHandler<SaveDocumentToString, SavedDocumentResponse>(
             &API_HANDLER_PCB::handleSaveDocumentToString );
@@ -1491,6 +1493,55 @@ HANDLER_RESULT<Empty> API_HANDLER_PCB::handleRefillZones( const HANDLER_CONTEXT<
 }
 
 
+HANDLER_RESULT<RouteNetsResponse> API_HANDLER_PCB::handleRouteNets(
+        const HANDLER_CONTEXT<RouteNets>& aCtx )
+{
+    if( std::optional<ApiResponseStatus> busy = checkForBusy() )
+        return tl::unexpected( *busy );
+
+    HANDLER_RESULT<bool> documentValidation = validateDocument( aCtx.Request.board() );
+
+    if( !documentValidation )
+        return tl::unexpected( documentValidation.error() );
+
+    BOARD*              board = frame()->GetBoard();
+    const NETINFO_LIST& nets = board->GetNetInfo();
+    std::set<int>       netCodes;
+
+    for( const board::types::Net& net : aCtx.Request.nets() )
+    {
+        NETINFO_ITEM* netInfo = nets.GetNetItem( wxString::FromUTF8( net.name() ) );
+
+        if( !netInfo )
+        {
+            ApiResponseStatus e;
+            e.set_status( ApiStatusCode::AS_BAD_REQUEST );
+            e.set_error_message( fmt::format( "net '{}' does not exist", net.name() ) );
+            return tl::unexpected( e );
+        }
+
+        netCodes.insert( netInfo->GetNetCode() );
+    }
+
+    PNS_BATCH_ROUTER router( board, frame()->GetToolManager(), nullptr );
+
+    router.SetNets( netCodes );
+    router.SetMode( aCtx.Request.mode() == BatchRouterMode::BRM_SHOVE ? PNS::RM_Shove
+                                                                      : PNS::RM_Walkaround );
+    router.SetOrder( aCtx.Request.shortest_first() ? PNS_BATCH_ROUTER::ORDER::SHORTEST_FIRST
+                                                   : PNS_BATCH_ROUTER::ORDER::BOARD );
+    router.SetParallel( aCtx.Request.parallel() );
+
+    PNS_BATCH_ROUTER::RESULT result = router.Run();
+
+    RouteNetsResponse response;
+    response.set_routed( result.m_Routed );
+    response.set_failed( result.m_Failed );
+
+    return response;
+}
+
+
 HANDLER_RESULT<SavedDocumentResponse> API_HANDLER_PCB::handleSaveDocumentToString(
         const HANDLER_CONTEXT<SaveDocumentToString>& aCtx )
 {
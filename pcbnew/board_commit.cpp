@@ -27,6 +27,7 @@
 #include <pgm_base.h>
 #include <settings/settings_manager.h>
 #include <board.h>
+#include <board_design_settings.h>
 #include <footprint.h>
 #include <lset.h>
 #include <pcb_group.h>
@@ -35,6 +36,8 @@
 #include <tool/tool_manager.h>
 #include <tools/pcb_selection_tool.h>
 #include <tools/zone_filler_tool.h>
+#include <tools/drc_tool.h>
+#include <drc/drc_engine.h>
 #include <view/view.h>
 #include <board_commit.h>
 #include <tools/pcb_tool_base.h>
@@ -129,13 +132,14 @@ COMMIT& BOARD_COMMIT::Stage( const PICKED_ITEMS_LIST& aItems, UNDO_REDO aModFlag
 }
 
 
-void BOARD_COMMIT::propagateDamage( BOARD_ITEM* aChangedItem, std::vector<ZONE*>* aStaleZones,
+void BOARD_COMMIT::propagateDamage( BOARD_ITEM* aChangedItem, STALE_ZONES* aStaleZones,
                                     std::vector<BOX2I>& aStaleRuleAreas )
 {
     wxCHECK( aChangedItem, /* void */ );
 
+    // A changed zone must be refilled in full
     if( aStaleZones && aChangedItem->Type() == PCB_ZONE_T )
-        aStaleZones->push_back( static_cast<ZONE*>( aChangedItem ) );
+        ( *aStaleZones )[ static_cast<ZONE*>( aChangedItem ) ] = std::nullopt;
 
     aChangedItem->RunOnChildren( std::bind( &BOARD_COMMIT::propagateDamage, this, _1, aStaleZones, aStaleRuleAreas ),
                                  RECURSE_MODE::NO_RECURSE );
@@ -153,7 +157,9 @@ void BOARD_COMMIT::propagateDamage( BOARD_ITEM* aChangedItem, std::vector<ZONE*>
 
     if( aStaleZones )
     {
-        if( damageLayers.test( Edge_Cuts ) || damageLayers.test( Margin ) )
+        bool outlineDamage = damageLayers.test( Edge_Cuts ) || damageLayers.test( Margin );
+
+        if( outlineDamage )
             damageLayers = LSET::PhysicalLayersMask();
         else
             damageLayers &= LSET::AllCuMask();
@@ -165,8 +171,22 @@ void BOARD_COMMIT::propagateDamage( BOARD_ITEM* aChangedItem, std::vector<ZONE*>
                 if( zone->GetIsRuleArea() )
                     continue;
 
-                if( ( zone->GetLayerSet() & damageLayers ).any() && zone->GetBoundingBox().Intersects( damageBBox ) )
-                    aStaleZones->push_back( zone );
+                if( ( zone->GetLayerSet() & damageLayers ).none()
+                        || !zone->GetBoundingBox().Intersects( damageBBox ) )
+                {
+                    continue;
+                }
+
+                // Other items only damage the zone around themselves (but the board outline
+                // is clipped against as a whole)
+                auto it = aStaleZones->find( zone );
+
+                if( outlineDamage )
+                    ( *aStaleZones )[ zone ] = std::nullopt;
+                else if( it == aStaleZones->end() )
+                    ( *aStaleZones )[ zone ] = damageBBox;
+                else if( it->second )
+                    it->second->Merge( damageBBox );
             }
         }
     }
@@ -192,8 +212,8 @@ void BOARD_COMMIT::Push( const wxString& aMessage, int aCommitFlags )
     bool                     updateBoardBoundingBox = false;
     std::vector<BOARD_ITEM*> staleTeardropPadsAndVias;
     std::set<PCB_TRACK*>     staleTeardropTracks;
-    std::vector<ZONE*>       staleZonesStorage;
-    std::vector<ZONE*>*      staleZones = nullptr;
+    STALE_ZONES              staleZonesStorage;
+    STALE_ZONES*             staleZones = nullptr;
     std::vector<BOX2I>       staleRuleAreas;
 
     if( Empty() )
@@ -201,6 +221,26 @@ void BOARD_COMMIT::Push( const wxString& aMessage, int aCommitFlags )
 
     undoList.SetDescription( aMessage );
 
+    // Queue the items for live DRC while the commit still knows what it is changing.  Commits
+    // which skip undo are DRC's own markers and other bookkeeping.
+    DRC_TOOL* drcTool = nullptr;
+
+    if( m_isBoardEditor && !( aCommitFlags & SKIP_UNDO ) )
+        drcTool = m_toolMgr->GetTool<DRC_TOOL>();
+
+    if( drcTool && drcTool->CanRunIncrementalTests() )
+    {
+        std::vector<BOARD_ITEM*> changedItems;
+        std::set<KIID>           removedItems;
+
+        GetStagedItems( changedItems, removedItems );
+        drcTool->QueueIncrementalTests( changedItems, removedItems );
+    }
+    else
+    {
+        drcTool = nullptr;
+    }
+
     TEARDROP_MANAGER                   teardropMgr( board, m_toolMgr );
     std::shared_ptr<CONNECTIVITY_DATA> connectivity = board->GetConnectivity();
 
@@ -579,6 +619,9 @@ void BOARD_COMMIT::Push( const wxString& aMessage, int aCommitFlags )
     if( bulkAddedItems.size() > 0 || bulkRemovedItems.size() > 0 || itemsChanged.size() > 0 )
         board->OnItemsCompositeUpdate( bulkAddedItems, bulkRemovedItems, itemsChanged );
 
+    if( std::shared_ptr<DRC_ENGINE> drcEngine = board->GetDesignSettings().m_DRCEngine )
+        drcEngine->InvalidateRuleCache();
+
     if( frame )
     {
         if( !( aCommitFlags & SKIP_UNDO ) )
@@ -599,14 +642,17 @@ void BOARD_COMMIT::Push( const wxString& aMessage, int aCommitFlags )
     {
         ZONE_FILLER_TOOL* zoneFillerTool = m_toolMgr->GetTool<ZONE_FILLER_TOOL>();
 
-        for( ZONE* zone : *staleZones )
-            zoneFillerTool->DirtyZone( zone );
+        for( const auto& [ zone, damage ] : *staleZones )
+            zoneFillerTool->DirtyZone( zone, damage );
 
         m_toolMgr->PostAction( PCB_ACTIONS::zoneFillDirty );
     }
 
     m_toolMgr->PostAction( PCB_ACTIONS::rehatchShapes );
 
+    if( drcTool )
+        m_toolMgr->PostAction( PCB_ACTIONS::runIncrementalDRC );
+
     if( selectedModified )
         m_toolMgr->ProcessEvent( EVENTS::SelectedItemsModified );
 
@@ -631,6 +677,35 @@ void BOARD_COMMIT::Push( const wxString& aMessage, int aCommitFlags )
 }
 
 
+void BOARD_COMMIT::GetStagedItems( std::vector<BOARD_ITEM*>& aChangedItems,
+                                   std::set<KIID>& aRemovedItems ) const
+{
+    for( const COMMIT_LINE& entry : m_entries )
+    {
+        if( !entry.m_item || !entry.m_item->IsBOARD_ITEM() )
+            continue;
+
+        BOARD_ITEM* boardItem = static_cast<BOARD_ITEM*>( entry.m_item );
+
+        if( ( entry.m_type & CHT_TYPE ) == CHT_REMOVE )
+        {
+            aRemovedItems.insert( boardItem->m_Uuid );
+
+            boardItem->RunOnChildren(
+                    [&]( BOARD_ITEM* child )
+                    {
+                        aRemovedItems.insert( child->m_Uuid );
+                    },
+                    RECURSE_MODE::RECURSE );
+        }
+        else
+        {
+            aChangedItems.push_back( boardItem );
+        }
+    }
+}
+
+
 EDA_ITEM* BOARD_COMMIT::undoLevelItem( EDA_ITEM* aItem ) const
 {
     // Easiest way to disallow both a parent and one of its children appearing in the list
@@ -779,6 +854,9 @@ void BOARD_COMMIT::Revert()
     if( bulkAddedItems.size() > 0 || bulkRemovedItems.size() > 0 || itemsChanged.size() > 0 )
         board->OnItemsCompositeUpdate( bulkAddedItems, bulkRemovedItems, itemsChanged );
 
+    if( std::shared_ptr<DRC_ENGINE> drcEngine = board->GetDesignSettings().m_DRCEngine )
+        drcEngine->InvalidateRuleCache();
+
     if( m_isBoardEditor )
     {
         connectivity->RecalculateRatsnest();
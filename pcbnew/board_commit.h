@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include <map>
+#include <optional>
 #include <commit.h>
 
 class BOARD_ITEM;
@@ -71,12 +73,28 @@ public:
 
     static EDA_ITEM* MakeImage( EDA_ITEM* aItem );
 
+    /**
+     * Gather the board items staged in this commit.
+     *
+     * Must be called before Push(), which clears the staged changes.  Removed items are
+     * reported by id (including their children) as the push may free them.
+     *
+     * @param aChangedItems is filled with the items added or modified.
+     * @param aRemovedItems is filled with the ids of the items removed.
+     */
+    void GetStagedItems( std::vector<BOARD_ITEM*>& aChangedItems,
+                         std::set<KIID>& aRemovedItems ) const;
+
 private:
     EDA_ITEM* undoLevelItem( EDA_ITEM* aItem ) const override;
 
     EDA_ITEM* makeImage( EDA_ITEM* aItem ) const override;
 
-    void propagateDamage( BOARD_ITEM* aItem, std::vector<ZONE*>* aStaleZones,
+    /// Zones needing a refill, mapped to the damaged area (or std::nullopt if the whole zone
+    /// needs refilling).
+    using STALE_ZONES = std::map<ZONE*, std::optional<BOX2I>>;
+
+    void propagateDamage( BOARD_ITEM* aItem, STALE_ZONES* aStaleZones,
                           std::vector<BOX2I>& aStaleRuleAreas );
 
 private:
@@ -242,6 +242,28 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
 
     m_itemList.RemoveInvalidItems( garbage );
 
+    for( CN_ITEM* item : garbage )
+    {
+        // Whatever the removed item connected may now be split apart
+        for( CN_ITEM* neighbour : item->ConnectedItems() )
+        {
+            if( neighbour->Valid() )
+            {
+                m_ratsnestSeeds.insert( neighbour );
+                m_propagationSeeds.insert( neighbour );
+            }
+        }
+
+        if( auto it = m_ratsnestClusterOf.find( item ); it != m_ratsnestClusterOf.end() )
+        {
+            m_staleRatsnestClusters.insert( it->second );
+            m_ratsnestClusterOf.erase( it );
+        }
+
+        m_ratsnestSeeds.erase( item );
+        m_propagationSeeds.erase( item );
+    }
+
     for( CN_ITEM* item : garbage )
         delete item;
 
@@ -258,6 +280,12 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
                       return aItem->Dirty();
                   } );
 
+    for( CN_ITEM* item : dirtyItems )
+    {
+        m_ratsnestSeeds.insert( item );
+        m_propagationSeeds.insert( item );
+    }
+
     if( m_progressReporter )
     {
         m_progressReporter->SetMaxProgress( dirtyItems.size() );
@@ -325,18 +353,13 @@ CN_CONNECTIVITY_ALGO::SearchClusters( CLUSTER_SEARCH_MODE aMode, bool aExcludeZo
 {
     bool withinAnyNet = ( aMode != CSM_PROPAGATE );
 
-    std::deque<CN_ITEM*> Q;
-    std::set<CN_ITEM*> item_set;
-
-    CLUSTERS clusters;
+    std::vector<CN_ITEM*> seeds;
 
     if( m_itemList.IsDirty() )
         searchConnections();
 
-    std::set<CN_ITEM*> visited;
-
     auto addToSearchList =
-            [&item_set, withinAnyNet, aSingleNet, &aExcludeZones]( CN_ITEM *aItem )
+            [&seeds, withinAnyNet, aSingleNet, &aExcludeZones]( CN_ITEM *aItem )
             {
                 if( withinAnyNet && aItem->Net() <= 0 )
                     return;
@@ -350,27 +373,55 @@ CN_CONNECTIVITY_ALGO::SearchClusters( CLUSTER_SEARCH_MODE aMode, bool aExcludeZo
                 if( aExcludeZones && aItem->Parent()->Type() == PCB_ZONE_T )
                     return;
 
-                item_set.insert( aItem );
+                seeds.push_back( aItem );
             };
 
     std::for_each( m_itemList.begin(), m_itemList.end(), addToSearchList );
+    std::sort( seeds.begin(), seeds.end() );
+
+    if( m_progressReporter && m_progressReporter->IsCancelled() )
+        return CLUSTERS();
+
+    CLUSTERS clusters = searchClustersFrom( seeds, aMode, aExcludeZones );
 
     if( m_progressReporter && m_progressReporter->IsCancelled() )
         return CLUSTERS();
 
-    while( !item_set.empty() )
+    std::sort( clusters.begin(), clusters.end(),
+               []( const std::shared_ptr<CN_CLUSTER>& a, const std::shared_ptr<CN_CLUSTER>& b )
+               {
+                   return a->OriginNet() < b->OriginNet();
+               } );
+
+    return clusters;
+}
+
+
+CN_CONNECTIVITY_ALGO::CLUSTERS
+CN_CONNECTIVITY_ALGO::searchClustersFrom( const std::vector<CN_ITEM*>& aSeeds,
+                                          CLUSTER_SEARCH_MODE aMode, bool aExcludeZones,
+                                          std::unordered_set<CN_ITEM*>* aVisited )
+{
+    bool withinAnyNet = ( aMode != CSM_PROPAGATE );
+
+    std::deque<CN_ITEM*>         Q;
+    std::unordered_set<CN_ITEM*> localVisited;
+    std::unordered_set<CN_ITEM*>& visited = aVisited ? *aVisited : localVisited;
+    CLUSTERS                     clusters;
+
+    for( CN_ITEM* root : aSeeds )
     {
-        std::shared_ptr<CN_CLUSTER> cluster = std::make_shared<CN_CLUSTER>();
-        CN_ITEM*                    root;
-        auto                        it = item_set.begin();
+        if( visited.contains( root ) || !root->Valid() )
+            continue;
 
-        while( it != item_set.end() && visited.contains( *it ) )
-            it = item_set.erase( item_set.begin() );
+        if( withinAnyNet && root->Net() <= 0 )
+            continue;
 
-        if( it == item_set.end() )
-            break;
+        if( aExcludeZones && root->Parent()->Type() == PCB_ZONE_T )
+            continue;
+
+        std::shared_ptr<CN_CLUSTER> cluster = std::make_shared<CN_CLUSTER>();
 
-        root = *it;
         visited.insert( root );
 
         Q.clear();
@@ -402,16 +453,123 @@ CN_CONNECTIVITY_ALGO::SearchClusters( CLUSTER_SEARCH_MODE aMode, bool aExcludeZo
         clusters.push_back( std::move( cluster ) );
     }
 
-    if( m_progressReporter && m_progressReporter->IsCancelled() )
-        return CLUSTERS();
+    return clusters;
+}
 
-    std::sort( clusters.begin(), clusters.end(),
+
+void CN_CONNECTIVITY_ALGO::updateRatsnestClusters()
+{
+    if( m_itemList.IsDirty() )
+        searchConnections();
+
+    if( !m_ratsnestClustersValid )
+    {
+        m_ratsnestClusters = SearchClusters( CSM_RATSNEST );
+        m_ratsnestClusterOf.clear();
+
+        for( const std::shared_ptr<CN_CLUSTER>& cluster : m_ratsnestClusters )
+        {
+            for( CN_ITEM* item : *cluster )
+                m_ratsnestClusterOf[ item ] = cluster.get();
+        }
+
+        m_staleRatsnestClusters.clear();
+        m_ratsnestSeeds.clear();
+        m_ratsnestClustersValid = !( m_progressReporter && m_progressReporter->IsCancelled() );
+        return;
+    }
+
+    // Clusters which lost an item must be split again.  So must those in a dirty net whose
+    // items changed net (net propagation does this without re-adding the items).
+    std::unordered_set<CN_CLUSTER*> affected = std::move( m_staleRatsnestClusters );
+    std::vector<CN_ITEM*>           seeds( m_ratsnestSeeds.begin(), m_ratsnestSeeds.end() );
+
+    m_staleRatsnestClusters.clear();
+    m_ratsnestSeeds.clear();
+
+    for( const std::shared_ptr<CN_CLUSTER>& cluster : m_ratsnestClusters )
+    {
+        if( affected.contains( cluster.get() ) || !IsNetDirty( cluster->OriginNet() ) )
+            continue;
+
+        for( CN_ITEM* item : *cluster )
+        {
+            if( !item->Valid() || item->Net() != cluster->OriginNet() )
+            {
+                affected.insert( cluster.get() );
+                break;
+            }
+        }
+    }
+
+    if( seeds.empty() && affected.empty() )
+        return;
+
+    std::unordered_set<CN_CLUSTER*> pending = affected;
+    std::unordered_set<CN_ITEM*>    visited;
+    CLUSTERS                        updated;
+
+    while( !seeds.empty() || !pending.empty() )
+    {
+        // Stale clusters may still reference deleted items, so only look their items up
+        // (without dereferencing them) to find the survivors.
+        for( const std::shared_ptr<CN_CLUSTER>& cluster : m_ratsnestClusters )
+        {
+            if( !pending.contains( cluster.get() ) )
+                continue;
+
+            for( CN_ITEM* item : *cluster )
+            {
+                auto it = m_ratsnestClusterOf.find( item );
+
+                if( it != m_ratsnestClusterOf.end() && it->second == cluster.get() )
+                {
+                    seeds.push_back( item );
+                    m_ratsnestClusterOf.erase( it );
+                }
+            }
+        }
+
+        pending.clear();
+        std::sort( seeds.begin(), seeds.end() );
+
+        CLUSTERS found = searchClustersFrom( seeds, CSM_RATSNEST, false, &visited );
+        seeds.clear();
+
+        // A cluster reached by the search is merged into a new one.  Usually the search covers
+        // all of it, but an item which changed net leaves the rest behind to be searched again.
+        for( const std::shared_ptr<CN_CLUSTER>& cluster : found )
+        {
+            for( CN_ITEM* item : *cluster )
+            {
+                auto it = m_ratsnestClusterOf.find( item );
+
+                if( it != m_ratsnestClusterOf.end() && !affected.contains( it->second ) )
+                {
+                    affected.insert( it->second );
+                    pending.insert( it->second );
+                }
+
+                m_ratsnestClusterOf[ item ] = cluster.get();
+            }
+        }
+
+        std::move( found.begin(), found.end(), std::back_inserter( updated ) );
+    }
+
+    std::erase_if( m_ratsnestClusters,
+                   [&]( const std::shared_ptr<CN_CLUSTER>& cluster )
+                   {
+                       return affected.contains( cluster.get() );
+                   } );
+
+    std::move( updated.begin(), updated.end(), std::back_inserter( m_ratsnestClusters ) );
+
+    std::sort( m_ratsnestClusters.begin(), m_ratsnestClusters.end(),
                []( const std::shared_ptr<CN_CLUSTER>& a, const std::shared_ptr<CN_CLUSTER>& b )
                {
                    return a->OriginNet() < b->OriginNet();
                } );
-
-    return clusters;
 }
 
 
@@ -638,7 +796,15 @@ void CN_CONNECTIVITY_ALGO::propagateConnections( BOARD_COMMIT* aCommit )
 void CN_CONNECTIVITY_ALGO::PropagateNets( BOARD_COMMIT* aCommit )
 {
     updateJumperPads();
-    m_connClusters = SearchClusters( CSM_PROPAGATE );
+
+    if( m_itemList.IsDirty() )
+        searchConnections();
+
+    std::vector<CN_ITEM*> seeds( m_propagationSeeds.begin(), m_propagationSeeds.end() );
+    std::sort( seeds.begin(), seeds.end() );
+    m_propagationSeeds.clear();
+
+    m_connClusters = searchClustersFrom( seeds, CSM_PROPAGATE, true );
     propagateConnections( aCommit );
 }
 
@@ -701,7 +867,7 @@ void CN_CONNECTIVITY_ALGO::FillIsolatedIslandsMap( std::map<ZONE*, std::map<PCB_
 
 const CN_CONNECTIVITY_ALGO::CLUSTERS& CN_CONNECTIVITY_ALGO::GetClusters()
 {
-    m_ratsnestClusters = SearchClusters( CSM_RATSNEST );
+    updateRatsnestClusters();
     return m_ratsnestClusters;
 }
 
@@ -941,6 +1107,12 @@ void CN_CONNECTIVITY_ALGO::Clear()
     m_itemMap.clear();
     m_itemList.Clear();
 
+    m_ratsnestClustersValid = false;
+    m_ratsnestClusterOf.clear();
+    m_staleRatsnestClusters.clear();
+    m_ratsnestSeeds.clear();
+    m_propagationSeeds.clear();
+
 }
 
 void CN_CONNECTIVITY_ALGO::SetProgressReporter( PROGRESS_REPORTER* aReporter )
@@ -42,6 +42,8 @@
 #include <functional>
 #include <vector>
 #include <deque>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <connectivity/connectivity_rtree.h>
 #include <connectivity/connectivity_data.h>
@@ -267,6 +269,10 @@ public:
 
     /**
      * Propagate nets from pads to other items in clusters.
+     *
+     * Only clusters containing items added, or which lost a connection, since the previous
+     * call are searched; the nets of all other clusters were settled by earlier calls.
+     *
      * @param aCommit is used to store undo information for items modified by the call.
      */
     void PropagateNets( BOARD_COMMIT* aCommit = nullptr );
@@ -277,6 +283,13 @@ public:
     void FillIsolatedIslandsMap( std::map<ZONE*, std::map<PCB_LAYER_ID, ISOLATED_ISLANDS>>& aMap,
                                  bool aConnectivityAlreadyRebuilt );
 
+    /**
+     * Return the ratsnest clusters (connected items sharing a net).
+     *
+     * The clusters are kept between calls and updated incrementally: clusters touched by
+     * added items are merged, and only clusters which lost an item (or whose items changed
+     * net) are split again.
+     */
     const CLUSTERS& GetClusters();
 
     const CN_LIST& ItemList() const
@@ -309,6 +322,19 @@ public:
 private:
     void searchConnections();
 
+    /**
+     * Breadth-first search for the clusters containing \a aSeeds.  Each cluster is reported
+     * once, however many seeds it contains.
+     *
+     * @param aVisited optionally shares the visited items between searches, so that items
+     *                 already placed in a cluster by an earlier search are skipped.
+     */
+    CLUSTERS searchClustersFrom( const std::vector<CN_ITEM*>& aSeeds, CLUSTER_SEARCH_MODE aMode,
+                                 bool aExcludeZones,
+                                 std::unordered_set<CN_ITEM*>* aVisited = nullptr );
+
+    void updateRatsnestClusters();
+
     void propagateConnections( BOARD_COMMIT* aCommit = nullptr );
 
     template <class Container, class BItem>
@@ -332,6 +358,14 @@ private:
     std::vector<std::shared_ptr<CN_CLUSTER>>              m_ratsnestClusters;
     std::vector<bool>                                     m_dirtyNets;
 
+    // Incremental cluster search state.  Items are recorded as seeds when they are added, and
+    // their neighbours when they are removed; the ratsnest clusters of removed items are stale.
+    bool                                                  m_ratsnestClustersValid = false;
+    std::unordered_map<const CN_ITEM*, CN_CLUSTER*>       m_ratsnestClusterOf;
+    std::unordered_set<CN_CLUSTER*>                       m_staleRatsnestClusters;
+    std::unordered_set<CN_ITEM*>                          m_ratsnestSeeds;
+    std::unordered_set<CN_ITEM*>                          m_propagationSeeds;
+
     bool                                                  m_isLocal;
     std::shared_ptr<CONNECTIVITY_DATA>                    m_globalConnectivityData;
 
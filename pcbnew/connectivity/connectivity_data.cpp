@@ -190,21 +190,45 @@ void CONNECTIVITY_DATA::updateRatsnest()
                 return aNet->IsDirty() && aNet->GetNodeCount() > 0;
             } );
 
-    thread_pool& tp = GetKiCadThreadPool();
+    // The cost of a net grows with its node count, so a plain split of the net list can leave
+    // one worker with a giant net (such as GND) plus its share of the rest.  Queue the largest
+    // nets first so they start immediately and idle workers drain the smaller ones around them;
+    // small nets are batched to keep the per-task overhead down.
+    std::sort( dirty_nets.begin(), dirty_nets.end(),
+               []( const RN_NET* a, const RN_NET* b )
+               {
+                   return a->GetNodeCount() > b->GetNodeCount();
+               } );
+
+    const size_t minNodesPerTask = 256;
+
+    thread_pool&                   tp = GetKiCadThreadPool();
+    std::vector<std::future<void>> returns;
+    size_t                         ii = 0;
+
+    while( ii < dirty_nets.size() )
+    {
+        size_t first = ii;
+        size_t nodes = 0;
 
-    auto results = tp.submit_loop( 0, dirty_nets.size(),
-                            [&]( const int ii )
-                            {
-                                dirty_nets[ii]->UpdateNet();
-                            } );
-    results.wait();
+        do
+        {
+            nodes += dirty_nets[ii++]->GetNodeCount();
+        } while( ii < dirty_nets.size() && nodes < minNodesPerTask );
 
-    auto results2 = tp.submit_loop( 0, dirty_nets.size(),
-                            [&]( const int ii )
-                            {
-                                dirty_nets[ii]->OptimizeRNEdges();
-                            } );
-    results2.wait();
+        returns.emplace_back( tp.submit_task(
+                [&dirty_nets, first, last = ii]()
+                {
+                    for( size_t jj = first; jj < last; ++jj )
+                    {
+                        dirty_nets[jj]->UpdateNet();
+                        dirty_nets[jj]->OptimizeRNEdges();
+                    }
+                } ) );
+    }
+
+    for( const std::future<void>& ret : returns )
+        ret.wait();
 
 #ifdef PROFILE
     rnUpdate.Show();
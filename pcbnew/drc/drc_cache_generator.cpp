@@ -31,8 +31,187 @@
 #include <drc/drc_engine.h>
 #include <drc/drc_rtree.h>
 #include <drc/drc_cache_generator.h>
+#include <hash.h>
 #include <mutex>
 
+
+static void addToCopperTree( DRC_RTREE* aTree, BOARD_ITEM* aItem, const LSET& aBoardCopperLayers,
+                             int aLargestClearance )
+{
+    LSET copperLayers = aItem->GetLayerSet() & aBoardCopperLayers;
+
+    // Special-case pad holes which pierce all the copper layers
+    if( aItem->Type() == PCB_PAD_T )
+    {
+        PAD* pad = static_cast<PAD*>( aItem );
+
+        if( pad->HasHole() )
+            copperLayers = aBoardCopperLayers;
+    }
+
+    copperLayers.RunOnLayers(
+            [&]( PCB_LAYER_ID layer )
+            {
+                aTree->Insert( aItem, layer, aLargestClearance );
+            } );
+}
+
+
+/// The types of item indexed in the copper item tree.
+static const std::vector<KICAD_T> s_copperTreeTypes = {
+    PCB_TRACE_T, PCB_ARC_T, PCB_VIA_T,
+    PCB_PAD_T,
+    PCB_SHAPE_T,
+    PCB_FIELD_T, PCB_TEXT_T, PCB_TEXTBOX_T,
+    PCB_TABLE_T, PCB_TABLECELL_T,
+    PCB_DIMENSION_T,
+    PCB_BARCODE_T
+};
+
+
+/**
+ * @return true if a full run indexes \a aItem in the copper item tree, i.e. if
+ *         DRC_TEST_PROVIDER::forEachGeometryItem() visits it for s_copperTreeTypes.
+ */
+static bool isCopperTreeItem( const BOARD_ITEM* aItem, const LSET& aBoardCopperLayers )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+        // Pad holes pierce all the copper layers
+        if( static_cast<const PAD*>( aItem )->HasHole() )
+            return true;
+
+        break;
+
+    case PCB_TRACE_T:
+    case PCB_ARC_T:
+    case PCB_VIA_T:
+    case PCB_FIELD_T:
+    case PCB_SHAPE_T:
+    case PCB_TEXT_T:
+    case PCB_TEXTBOX_T:
+        break;
+
+    case PCB_TABLE_T:
+    case PCB_TABLECELL_T:
+    case PCB_BARCODE_T:
+        // Only gathered from the board itself
+        if( aItem->GetParentFootprint() )
+            return false;
+
+        break;
+
+    default:
+        if( BaseType( aItem->Type() ) != PCB_DIMENSION_T )
+            return false;
+
+        break;
+    }
+
+    return ( aItem->GetLayerSet() & aBoardCopperLayers ).any();
+}
+
+
+size_t DRC_CACHE_GENERATOR::ZoneSignature( ZONE* aZone )
+{
+    BOX2I  bbox = aZone->GetBoundingBox();
+    size_t seed = hash_val( aZone->m_Uuid, static_cast<const BASE_SET&>( aZone->GetLayerSet() ),
+                            bbox.GetX(), bbox.GetY(), bbox.GetRight(), bbox.GetBottom() );
+
+    aZone->GetLayerSet().RunOnLayers(
+            [&]( PCB_LAYER_ID layer )
+            {
+                HASH_128 fillHash = aZone->GetHashValue( layer );
+                hash_combine( seed, fillHash.Value64[0], fillHash.Value64[1] );
+            } );
+
+    return seed;
+}
+
+
+void DRC_CACHE_GENERATOR::indexItem( DRC_RTREE* aTree, BOARD_ITEM* aItem,
+                                     const LSET& aBoardCopperLayers, int aLargestClearance )
+{
+    addToCopperTree( aTree, aItem, aBoardCopperLayers, aLargestClearance );
+
+    m_index->m_Items[ aItem->m_Uuid ] = aItem;
+
+    // Footprints and tables are never indexed themselves, but may lose children which must
+    // then be dropped from the tree
+    BOARD_ITEM_CONTAINER* owner = aItem->GetParent();
+
+    if( owner && owner->Type() != PCB_T )
+    {
+        m_index->m_Items[ owner->m_Uuid ] = owner;
+        m_index->m_Children[ owner ][ aItem->m_Uuid ] = aItem;
+    }
+}
+
+
+void DRC_CACHE_GENERATOR::updateCopperTree( const LSET& aBoardCopperLayers, int aLargestClearance )
+{
+    std::unordered_set<const BOARD_ITEM*> stale;
+
+    // Items are matched by identity only: the removed ones may have been freed already.
+    auto dropItem =
+            [&]( const BOARD_ITEM* aItem )
+            {
+                stale.insert( aItem );
+
+                auto children = m_index->m_Children.find( aItem );
+
+                if( children == m_index->m_Children.end() )
+                    return;
+
+                for( const auto& [ id, child ] : children->second )
+                {
+                    stale.insert( child );
+
+                    if( auto it = m_index->m_Items.find( id ); it != m_index->m_Items.end()
+                                                               && it->second == child )
+                    {
+                        m_index->m_Items.erase( it );
+                    }
+                }
+
+                m_index->m_Children.erase( children );
+            };
+
+    for( const KIID& id : m_removedItems )
+    {
+        if( auto it = m_index->m_Items.find( id ); it != m_index->m_Items.end() )
+        {
+            dropItem( it->second );
+            m_index->m_Items.erase( it );
+        }
+    }
+
+    for( BOARD_ITEM* item : m_changedItems )
+    {
+        dropItem( item );
+
+        // A copy put back in place of the indexed item (by undo, for instance)
+        if( auto it = m_index->m_Items.find( item->m_Uuid ); it != m_index->m_Items.end()
+                                                             && it->second != item )
+        {
+            dropItem( it->second );
+        }
+    }
+
+    m_incrementalTree->Remove( stale );
+
+    for( BOARD_ITEM* item : m_changedItems )
+    {
+        if( isCopperTreeItem( item, aBoardCopperLayers ) )
+            indexItem( m_incrementalTree.get(), item, aBoardCopperLayers, aLargestClearance );
+    }
+
+    std::unique_lock<std::shared_mutex> writeLock( m_board->m_CachesMutex );
+    m_board->m_CopperItemRTreeCache = m_incrementalTree;
+}
+
+
 bool DRC_CACHE_GENERATOR::Run()
 {
     m_board = m_drcEngine->GetBoard();
@@ -55,6 +234,13 @@ bool DRC_CACHE_GENERATOR::Run()
     largestClearance = std::min( largestClearance, INT_MAX / 3 );
     largestPhysicalClearance = std::min( largestPhysicalClearance, INT_MAX / 3 );
 
+    // The tree's inflated bboxes are only good for the clearance they were built with
+    if( m_incrementalTree && ( m_incrementalTreeClearance != largestClearance || !m_index ) )
+        m_incrementalTree.reset();
+
+    if( !m_incrementalTree )
+        m_index = std::make_shared<DRC_COPPER_TREE_INDEX>();
+
     std::set<ZONE*> allZones;
 
     auto cacheBBoxes =
@@ -118,28 +304,14 @@ bool DRC_CACHE_GENERATOR::Run()
                 return true;
             };
 
-    auto addToCopperTree =
+    auto addItem =
             [&]( BOARD_ITEM* item ) -> bool
             {
                 if( m_drcEngine->IsCancelled() )
                     return false;
 
-                LSET copperLayers = item->GetLayerSet() & boardCopperLayers;
-
-                // Special-case pad holes which pierce all the copper layers
-                if( item->Type() == PCB_PAD_T )
-                {
-                    PAD* pad = static_cast<PAD*>( item );
-
-                    if( pad->HasHole() )
-                        copperLayers = boardCopperLayers;
-                }
-
-                copperLayers.RunOnLayers(
-                        [&]( PCB_LAYER_ID layer )
-                        {
-                            m_board->m_CopperItemRTreeCache->Insert( item, layer, largestClearance );
-                        } );
+                indexItem( m_board->m_CopperItemRTreeCache.get(), item, boardCopperLayers,
+                           largestClearance );
 
                 done.fetch_add( 1 );
                 return true;
@@ -148,35 +320,37 @@ bool DRC_CACHE_GENERATOR::Run()
     if( !reportPhase( _( "Gathering copper items..." ) ) )
         return false;   // DRC cancelled
 
-    static const std::vector<KICAD_T> itemTypes = {
-        PCB_TRACE_T, PCB_ARC_T, PCB_VIA_T,
-        PCB_PAD_T,
-        PCB_SHAPE_T,
-        PCB_FIELD_T, PCB_TEXT_T, PCB_TEXTBOX_T,
-        PCB_TABLE_T, PCB_TABLECELL_T,
-        PCB_DIMENSION_T,
-        PCB_BARCODE_T
-    };
+    std::future_status status;
 
-    forEachGeometryItem( itemTypes, boardCopperLayers, countItems );
+    if( m_incrementalTree )
+    {
+        updateCopperTree( boardCopperLayers, largestClearance );
+    }
+    else
+    {
+        forEachGeometryItem( s_copperTreeTypes, boardCopperLayers, countItems );
 
-    std::future<void> retn = tp.submit_task(
-            [&]()
-            {
-                std::unique_lock<std::shared_mutex> writeLock( m_board->m_CachesMutex );
+        std::future<void> retn = tp.submit_task(
+                [&]()
+                {
+                    std::unique_lock<std::shared_mutex> writeLock( m_board->m_CachesMutex );
 
-                if( !m_board->m_CopperItemRTreeCache )
-                    m_board->m_CopperItemRTreeCache = std::make_shared<DRC_RTREE>();
+                    if( !m_board->m_CopperItemRTreeCache )
+                        m_board->m_CopperItemRTreeCache = std::make_shared<DRC_RTREE>();
 
-                forEachGeometryItem( itemTypes, boardCopperLayers, addToCopperTree );
-            } );
+                    forEachGeometryItem( s_copperTreeTypes, boardCopperLayers, addItem );
 
-    std::future_status status = retn.wait_for( std::chrono::milliseconds( 250 ) );
+                    // The tree is read-only for the rest of a full run, so search a packed copy
+                    m_board->m_CopperItemRTreeCache->Pack();
+                } );
 
-    while( status != std::future_status::ready )
-    {
-        reportProgress( done, count );
         status = retn.wait_for( std::chrono::milliseconds( 250 ) );
+
+        while( status != std::future_status::ready )
+        {
+            reportProgress( done, count );
+            status = retn.wait_for( std::chrono::milliseconds( 250 ) );
+        }
     }
 
     if( !reportPhase( _( "Tessellating copper zones..." ) ) )
@@ -185,10 +359,24 @@ bool DRC_CACHE_GENERATOR::Run()
     // Cache zone bounding boxes, triangulation, copper zone rtrees, and footprint courtyards
     // before we start.
 
-    for( FOOTPRINT* footprint : m_board->Footprints() )
+    if( m_incrementalTree )
+    {
+        for( BOARD_ITEM* item : m_changedItems )
+        {
+            if( item->Type() == PCB_FOOTPRINT_T )
+            {
+                static_cast<FOOTPRINT*>( item )->BuildCourtyardCaches();
+                static_cast<FOOTPRINT*>( item )->BuildNetTieCache();
+            }
+        }
+    }
+    else
     {
-        footprint->BuildCourtyardCaches();
-        footprint->BuildNetTieCache();
+        for( FOOTPRINT* footprint : m_board->Footprints() )
+        {
+            footprint->BuildCourtyardCaches();
+            footprint->BuildNetTieCache();
+        }
     }
 
     std::vector<std::future<size_t>> returns;
@@ -206,7 +394,7 @@ bool DRC_CACHE_GENERATOR::Run()
 
                 if( !aZone->GetIsRuleArea() && aZone->IsOnCopperLayer() )
                 {
-                   std::unique_ptr<DRC_RTREE> rtree = std::make_unique<DRC_RTREE>();
+                   std::shared_ptr<DRC_RTREE> rtree = std::make_shared<DRC_RTREE>();
 
                    aZone->GetLayerSet().RunOnLayers(
                            [&]( PCB_LAYER_ID layer )
@@ -215,6 +403,8 @@ bool DRC_CACHE_GENERATOR::Run()
                                    rtree->Insert( aZone, layer );
                            } );
 
+                   rtree->Pack();
+
                    {
                        std::unique_lock<std::shared_mutex> writeLock( m_board->m_CachesMutex );
                        m_board->m_CopperZoneRTreeCache[ aZone ] = std::move( rtree );
@@ -226,8 +416,36 @@ bool DRC_CACHE_GENERATOR::Run()
                 return 1;
             };
 
+    // Zones no longer on the board are dropped from the signatures
+    std::unordered_map<const ZONE*, size_t> zoneSignatures;
+
     for( ZONE* zone : allZones )
     {
+        size_t signature = ZoneSignature( zone );
+        auto   prev = m_index->m_ZoneSignatures.find( zone );
+        bool   unchanged = prev != m_index->m_ZoneSignatures.end() && prev->second == signature;
+
+        zoneSignatures[ zone ] = signature;
+
+        // An incremental run only re-tessellates the zones which are in the commit or have been
+        // refilled since.  (Zones are few enough to check them all.)
+        if( m_incrementalTree && !m_changedItems.count( zone ) )
+        {
+            auto tree = m_incrementalZoneTrees.find( zone );
+            bool needsTree = !zone->GetIsRuleArea() && zone->IsOnCopperLayer();
+
+            if( unchanged && ( !needsTree || tree != m_incrementalZoneTrees.end() ) )
+            {
+                if( needsTree )
+                {
+                    std::unique_lock<std::shared_mutex> writeLock( m_board->m_CachesMutex );
+                    m_board->m_CopperZoneRTreeCache[ zone ] = tree->second;
+                }
+
+                continue;
+            }
+        }
+
         returns.emplace_back( tp.submit_task(
                 [cache_zones, zone]
                 {
@@ -235,6 +453,8 @@ bool DRC_CACHE_GENERATOR::Run()
                 } ) );
     }
 
+    m_index->m_ZoneSignatures = std::move( zoneSignatures );
+
     done.store( 1 );
 
     for( const std::future<size_t>& ret : returns )
@@ -248,6 +468,11 @@ bool DRC_CACHE_GENERATOR::Run()
         }
     }
 
+    // Incremental providers work off the board's live connectivity; leave the (expensive)
+    // rebuild and island search to full runs.
+    if( m_incrementalTree )
+        return !m_drcEngine->IsCancelled();
+
     m_board->m_ZoneIsolatedIslandsMap.clear();
 
     for( ZONE* zone : m_board->Zones() )
@@ -28,15 +28,104 @@
 
 #include <drc/drc_test_provider.h>
 
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+class DRC_RTREE;
+class ZONE;
+
+
+/**
+ * What a copper item tree holds, kept alongside it so an incremental run can find the entries
+ * of the items in a commit without walking the board.
+ */
+struct DRC_COPPER_TREE_INDEX
+{
+    /// The indexed items, and the footprints (or tables) owning them, by id.
+    std::unordered_map<KIID, const BOARD_ITEM*>         m_Items;
+
+    /// The indexed children of each footprint or table, by id.
+    std::unordered_map<const BOARD_ITEM*,
+                       std::unordered_map<KIID, const BOARD_ITEM*>> m_Children;
+
+    /// The signatures of the copper zones when their trees were built (see ZoneSignature()).
+    std::unordered_map<const ZONE*, size_t>             m_ZoneSignatures;
+};
+
 
 class DRC_CACHE_GENERATOR : public DRC_TEST_PROVIDER
 {
 public:
     DRC_CACHE_GENERATOR() :
-            DRC_TEST_PROVIDER()
+            DRC_TEST_PROVIDER(),
+            m_incrementalTreeClearance( 0 )
     {}
 
     virtual ~DRC_CACHE_GENERATOR() = default;
 
     virtual bool Run() override;
+
+    /**
+     * Switch the generator to incremental mode.
+     *
+     * Rather than rebuilding the copper item tree from scratch, aCopperTree (built with a worst
+     * clearance of aTreeClearance by a previous run, and described by aIndex) is patched: the
+     * entries of the changed and removed items, and of the children their footprints had when
+     * they were indexed, are dropped and the changed items are indexed again.  Only the items
+     * of the commit are visited, so the tree must have seen every change made since it was
+     * built (undo and redo queue their items too).  The copper zone trees in aZoneTrees are
+     * reused for zones which aren't in the commit and whose fills haven't changed.
+     * Board-wide caches which the incremental providers don't use (connectivity, isolated
+     * islands) are left alone.
+     *
+     * If the worst clearance has changed since the tree was built Run() falls back to a full
+     * rebuild.
+     */
+    void SetIncrementalUpdate( std::shared_ptr<DRC_RTREE> aCopperTree, int aTreeClearance,
+                               std::unordered_map<ZONE*, std::shared_ptr<DRC_RTREE>> aZoneTrees,
+                               std::shared_ptr<DRC_COPPER_TREE_INDEX> aIndex,
+                               const std::unordered_set<BOARD_ITEM*>& aChangedItems,
+                               const std::set<KIID>& aRemovedItems )
+    {
+        m_incrementalTree = std::move( aCopperTree );
+        m_incrementalTreeClearance = aTreeClearance;
+        m_incrementalZoneTrees = std::move( aZoneTrees );
+        m_index = std::move( aIndex );
+        m_changedItems = aChangedItems;
+        m_removedItems = aRemovedItems;
+    }
+
+    /**
+     * @return true if the last Run() patched the incremental tree rather than rebuilding it.
+     */
+    bool WasIncremental() const { return m_incrementalTree != nullptr; }
+
+    /**
+     * @return the index of the copper item tree built or patched by the last Run(), to be
+     *         handed to the next incremental run.
+     */
+    std::shared_ptr<DRC_COPPER_TREE_INDEX> TakeIndex() { return std::move( m_index ); }
+
+    /**
+     * Hash the properties of a zone which decide what its DRC tree holds: its layers, bounding
+     * box and fills.
+     */
+    static size_t ZoneSignature( ZONE* aZone );
+
+private:
+    void updateCopperTree( const LSET& aBoardCopperLayers, int aLargestClearance );
+
+    /// Add an item to the copper tree and record it in the index.
+    void indexItem( DRC_RTREE* aTree, BOARD_ITEM* aItem, const LSET& aBoardCopperLayers,
+                    int aLargestClearance );
+
+private:
+    std::shared_ptr<DRC_RTREE>             m_incrementalTree;
+    int                                    m_incrementalTreeClearance;
+    std::unordered_set<BOARD_ITEM*>        m_changedItems;
+    std::set<KIID>                         m_removedItems;
+    std::shared_ptr<DRC_COPPER_TREE_INDEX> m_index;
+
+    std::unordered_map<ZONE*, std::shared_ptr<DRC_RTREE>> m_incrementalZoneTrees;
 };
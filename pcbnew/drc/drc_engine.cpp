@@ -23,7 +23,10 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cmath>
 #include <wx/log.h>
 #include <reporter.h>
 #include <common.h>
@@ -38,8 +41,10 @@
 #include <drc/drc_test_provider.h>
 #include <drc/drc_item.h>
 #include <drc/drc_cache_generator.h>
+#include <board_commit.h>
 #include <footprint.h>
 #include <pad.h>
+#include <pcb_marker.h>
 #include <pcb_track.h>
 #include <pcb_shape.h>
 #include <core/profile.h>
@@ -48,6 +53,12 @@
 #include <project/project_file.h>
 #include <project/tuning_profiles.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
 
 // wxListBox's performance degrades horrifically with very large datasets.  It's not clear
 // they're useful to the user anyway.
@@ -65,6 +76,72 @@
 static const wxChar* traceDrcProfile = wxT( "KICAD_DRC_PROFILE" );
 
 
+static uint64_t elapsedNs( const std::chrono::steady_clock::time_point& aStart )
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now()
+                                                                 - aStart ).count();
+}
+
+
+/**
+ * @return the CPU time used so far by all threads of the process, in milliseconds.
+ */
+static double processCpuMsecs()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+
+    if( !GetProcessTimes( GetCurrentProcess(), &creation, &exit, &kernel, &user ) )
+        return 0.0;
+
+    auto toMsecs =
+            []( const FILETIME& aTime )
+            {
+                ULARGE_INTEGER t;
+                t.LowPart = aTime.dwLowDateTime;
+                t.HighPart = aTime.dwHighDateTime;
+                return t.QuadPart / 1e4;     // 100ns units
+            };
+
+    return toMsecs( kernel ) + toMsecs( user );
+#else
+    struct rusage usage;
+
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 )
+        return 0.0;
+
+    return ( usage.ru_utime.tv_sec + usage.ru_stime.tv_sec ) * 1e3
+           + ( usage.ru_utime.tv_usec + usage.ru_stime.tv_usec ) / 1e3;
+#endif
+}
+
+
+/**
+ * Measures one stage of a profiled DRC run.
+ */
+class DRC_STAGE_TIMER
+{
+public:
+    DRC_STAGE_TIMER() :
+            m_cpuStart( processCpuMsecs() ),
+            m_queriesStart( DRC_RTREE::GetQueryCount() )
+    {}
+
+    void Stop( DRC_PROFILE::STAGE_STATS& aStats )
+    {
+        m_timer.Stop();
+        aStats.m_WallMs = m_timer.msecs();
+        aStats.m_CpuMs = processCpuMsecs() - m_cpuStart;
+        aStats.m_RTreeQueries = DRC_RTREE::GetQueryCount() - m_queriesStart;
+    }
+
+private:
+    PROF_TIMER m_timer;
+    double     m_cpuStart;
+    uint64_t   m_queriesStart;
+};
+
+
 void drcPrintDebugMessage( int level, const wxString& msg, const char *function, int line )
 {
     wxString valueStr;
@@ -89,12 +166,21 @@ DRC_ENGINE::DRC_ENGINE( BOARD* aBoard, BOARD_DESIGN_SETTINGS *aSettings ) :
         m_reportAllTrackErrors( false ),
         m_testFootprints( false ),
         m_logReporter( nullptr ),
-        m_progressReporter( nullptr )
+        m_progressReporter( nullptr ),
+        m_incrementalTreeClearance( 0 ),
+        m_incrementalRun( false ),
+        m_shardRun( false ),
+        m_ruleCacheEnabled( false ),
+        m_ruleCacheGeneration( 0 ),
+        m_ruleCacheHits( 0 ),
+        m_ruleCacheMisses( 0 )
 {
     m_errorLimits.resize( DRCE_LAST + 1 );
 
     for( int ii = DRCE_FIRST; ii <= DRCE_LAST; ++ii )
         m_errorLimits[ii] = ERROR_LIMIT;
+
+    InvalidateRuleCache();
 }
 
 
@@ -725,6 +811,220 @@ void DRC_ENGINE::compileRules()
             m_constraintMap[ constraint.m_Type ]->push_back( engineConstraint );
         }
     }
+
+    buildRuleCacheInfo();
+}
+
+
+void DRC_ENGINE::buildRuleCacheInfo()
+{
+    m_ruleCacheInfo.clear();
+
+    for( const auto& [ constraintType, ruleset ] : m_constraintMap )
+    {
+        RULE_CACHE_INFO& info = m_ruleCacheInfo[ constraintType ];
+        int              bit = 0;
+
+        // Disallow constraints depend on the item type and layers; assertions are reported
+        // per-item.  Neither is worth caching.
+        info.cacheable = constraintType != DISALLOW_CONSTRAINT
+                            && constraintType != ASSERTION_CONSTRAINT;
+
+        for( DRC_ENGINE_CONSTRAINT* c : *ruleset )
+        {
+            if( !c->condition || c->condition->GetExpression().IsEmpty() )
+                continue;
+
+            if( !c->condition->IsSingleItem() || bit >= 64 )
+            {
+                info.cacheable = false;
+                break;
+            }
+
+            if( c->condition->RefersToBOnly() )
+                info.bOnlyMask |= uint64_t( 1 ) << bit;
+
+            bit++;
+        }
+    }
+}
+
+
+/// While a cacheable resolution is computed, the per-rule profile counters it increments are
+/// collected here so that hits on the cached resolution can count them too.
+static thread_local std::vector<std::atomic<uint64_t>*>* s_profileCounts = nullptr;
+
+
+static void countRuleStat( std::atomic<uint64_t>& aCounter )
+{
+    aCounter.fetch_add( 1, std::memory_order_relaxed );
+
+    if( s_profileCounts )
+        s_profileCounts->push_back( &aCounter );
+}
+
+
+/// Rule cache generations are unique across engines, so a thread's cache can't be mistaken
+/// for another engine's.
+static std::atomic<uint64_t> s_ruleCacheGenerations( 0 );
+
+
+void DRC_ENGINE::InvalidateRuleCache()
+{
+    m_ruleCacheGeneration.store( ++s_ruleCacheGenerations, std::memory_order_release );
+}
+
+
+DRC_ENGINE::RULE_CACHE& DRC_ENGINE::threadRuleCache()
+{
+    // Entries left behind by an older generation may refer to freed items; they are only
+    // dropped, never read.
+    static thread_local RULE_CACHE cache;
+    uint64_t generation = m_ruleCacheGeneration.load( std::memory_order_acquire );
+
+    if( cache.generation != generation )
+    {
+        cache.itemOutcomes.clear();
+        cache.resolutions.clear();
+        cache.generation = generation;
+    }
+
+    return cache;
+}
+
+
+void DRC_ENGINE::SetRuleCacheEnabled( bool aEnabled )
+{
+    InvalidateRuleCache();
+
+    if( aEnabled && !m_ruleCacheEnabled )
+    {
+        m_ruleCacheHits = 0;
+        m_ruleCacheMisses = 0;
+    }
+
+    m_ruleCacheEnabled = aEnabled;
+}
+
+
+bool DRC_ENGINE::evaluateCondition( const DRC_ENGINE_CONSTRAINT* aConstraint, const BOARD_ITEM* a,
+                                    const BOARD_ITEM* b, PCB_LAYER_ID aLayer, REPORTER* aReporter )
+{
+    DRC_RULE_CONDITION* condition = aConstraint->condition;
+    int                 type = aConstraint->constraint.m_Type;
+
+    if( !aConstraint->profile )
+        return condition->EvaluateFor( a, b, type, aLayer, aReporter );
+
+    auto start = std::chrono::steady_clock::now();
+    bool result = condition->EvaluateFor( a, b, type, aLayer, aReporter );
+
+    aConstraint->profile->m_ConditionEvals.fetch_add( 1, std::memory_order_relaxed );
+    aConstraint->profile->m_ConditionNs.fetch_add( elapsedNs( start ), std::memory_order_relaxed );
+
+    return result;
+}
+
+
+uint64_t DRC_ENGINE::getConditionOutcomes( RULE_CACHE& aCache, DRC_CONSTRAINT_T aConstraintType,
+                                           const BOARD_ITEM* aItem, PCB_LAYER_ID aLayer )
+{
+    ITEM_OUTCOMES_KEY key{ aItem, aConstraintType, aLayer };
+
+    if( auto it = aCache.itemOutcomes.find( key ); it != aCache.itemOutcomes.end() )
+        return it->second;
+
+    uint64_t outcomes = 0;
+    int      bit = 0;
+
+    for( DRC_ENGINE_CONSTRAINT* c : *m_constraintMap[ aConstraintType ] )
+    {
+        if( !c->condition || c->condition->GetExpression().IsEmpty() )
+            continue;
+
+        bool result;
+
+        if( c->profile )
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            result = c->condition->EvaluateForItem( aItem, aConstraintType, aLayer );
+
+            c->profile->m_ConditionEvals.fetch_add( 1, std::memory_order_relaxed );
+            c->profile->m_ConditionNs.fetch_add( elapsedNs( start ), std::memory_order_relaxed );
+        }
+        else
+        {
+            result = c->condition->EvaluateForItem( aItem, aConstraintType, aLayer );
+        }
+
+        if( result )
+            outcomes |= uint64_t( 1 ) << bit;
+
+        bit++;
+    }
+
+    aCache.itemOutcomes[ key ] = outcomes;
+
+    return outcomes;
+}
+
+
+bool DRC_ENGINE::resolveCachedRules( DRC_CONSTRAINT_T aConstraintType, const BOARD_ITEM* a,
+                                     const BOARD_ITEM* b, PCB_LAYER_ID aLayer, int aFlags,
+                                     const std::function<void()>& aResolver,
+                                     DRC_CONSTRAINT& aConstraint )
+{
+    if( !m_ruleCacheEnabled || !a )
+        return false;
+
+    auto infoIt = m_ruleCacheInfo.find( aConstraintType );
+
+    if( infoIt == m_ruleCacheInfo.end() || !infoIt->second.cacheable )
+        return false;
+
+    // Conditions are commutative, so for a pair each condition is satisfied if it is satisfied
+    // by either item.  Without a B item, conditions on B are evaluated against nothing.
+    RULE_CACHE& cache = threadRuleCache();
+    uint64_t    outcomes = getConditionOutcomes( cache, aConstraintType, a, aLayer );
+    uint64_t    bOnlyMask = infoIt->second.bOnlyMask;
+
+    if( b )
+    {
+        outcomes |= getConditionOutcomes( cache, aConstraintType, b, aLayer );
+    }
+    else if( bOnlyMask )
+    {
+        uint64_t noB = getConditionOutcomes( cache, aConstraintType, nullptr, aLayer );
+        outcomes = ( outcomes & ~bOnlyMask ) | ( noB & bOnlyMask );
+    }
+
+    RESOLUTION_KEY key{ aConstraintType, aLayer, aFlags, outcomes };
+
+    if( auto it = cache.resolutions.find( key ); it != cache.resolutions.end() )
+    {
+        aConstraint = it->second.constraint;
+
+        for( std::atomic<uint64_t>* counter : it->second.profileCounts )
+            counter->fetch_add( 1, std::memory_order_relaxed );
+
+        m_ruleCacheHits.fetch_add( 1, std::memory_order_relaxed );
+        return true;
+    }
+
+    m_ruleCacheMisses.fetch_add( 1, std::memory_order_relaxed );
+
+    CACHED_RESOLUTION                    resolution;
+    std::vector<std::atomic<uint64_t>*>* outerCounts = s_profileCounts;
+
+    s_profileCounts = m_profile ? &resolution.profileCounts : nullptr;
+    aResolver();
+    s_profileCounts = outerCounts;
+
+    resolution.constraint = aConstraint;
+    cache.resolutions.emplace( key, std::move( resolution ) );
+
+    return true;
 }
 
 
@@ -742,6 +1042,9 @@ void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
 
     m_rules.clear();
     m_rulesValid = false;
+    m_incrementalTree.reset();
+    m_incrementalZoneTrees.clear();
+    m_incrementalIndex.reset();
 
     for( std::pair<DRC_CONSTRAINT_T, std::vector<DRC_ENGINE_CONSTRAINT*>*> pair : m_constraintMap )
     {
@@ -752,6 +1055,8 @@ void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
     }
 
     m_constraintMap.clear();
+    m_ruleCacheInfo.clear();
+    InvalidateRuleCache();
 
     m_board->IncrementTimeStamp();  // Clear board-level caches
 
@@ -795,40 +1100,83 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aT
     m_reportAllTrackErrors = aReportAllTrackErrors;
     m_testFootprints = aTestFootprints;
 
-    for( int ii = DRCE_FIRST; ii <= DRCE_LAST; ++ii )
-    {
-        if( m_designSettings->Ignore( ii ) )
-            m_errorLimits[ ii ] = 0;
-        else if( ii == DRCE_CLEARANCE || ii == DRCE_UNCONNECTED_ITEMS )
-            m_errorLimits[ ii ] = EXTENDED_ERROR_LIMIT;
-        else
-            m_errorLimits[ ii ] = ERROR_LIMIT;
-    }
+    resetErrorLimits();
 
     DRC_TEST_PROVIDER::Init();
 
+    startProfiling();
+
+    DRC_STAGE_TIMER totalTimer;
+    DRC_STAGE_TIMER cacheTimer;
+
     m_board->IncrementTimeStamp();      // Invalidate all caches...
 
     DRC_CACHE_GENERATOR cacheGenerator;
     cacheGenerator.SetDRCEngine( this );
 
     if( !cacheGenerator.Run() )         // ... and regenerate them.
+    {
+        stopProfiling();
         return;
+    }
+
+    m_incrementalIndex = cacheGenerator.TakeIndex();
+
+    if( m_profile )
+        cacheTimer.Stop( m_profile->m_CacheGeneration );
 
     // Recompute component classes
     m_board->GetComponentClassManager().ForceComponentClassRecalculation();
 
     int timestamp = m_board->GetTimeStamp();
 
+    SetRuleCacheEnabled( true );
+
     for( DRC_TEST_PROVIDER* provider : m_testProviders )
     {
+        // Shards run the providers which can be limited to a region separately
+        if( m_shardRun && !provider->GetIncrementalErrorCodes().empty() )
+            continue;
+
         if( m_logReporter )
-            m_logReporter->Report( wxString::Format( wxT( "Run DRC provider: '%s'" ), provider->GetName() ) );
+        {
+            m_logReporter->Report( wxString::Format( wxT( "Run DRC provider: '%s'" ),
+                                                     provider->GetName() ) );
+        }
 
-        if( !provider->RunTests( aUnits ) )
+        DRC_STAGE_TIMER providerTimer;
+        bool            completed = provider->RunTests( aUnits );
+
+        if( m_profile )
+        {
+            DRC_PROFILE::STAGE_STATS& stats = m_profile->m_Providers.emplace_back();
+            stats.m_Name = provider->GetName();
+            providerTimer.Stop( stats );
+        }
+
+        if( !completed )
             break;
     }
 
+    if( m_profile )
+    {
+        m_profile->m_RuleCacheHits = m_ruleCacheHits.load();
+        m_profile->m_RuleCacheMisses = m_ruleCacheMisses.load();
+        totalTimer.Stop( m_profile->m_Total );
+    }
+
+    stopProfiling();
+    SetRuleCacheEnabled( false );
+
+    wxLogTrace( traceDrcProfile, "Rule cache: %llu hits, %llu misses",
+                (unsigned long long) m_ruleCacheHits.load(),
+                (unsigned long long) m_ruleCacheMisses.load() );
+
+    // Keep the copper item and zone trees around so that incremental runs can patch them
+    m_incrementalTree = m_board->m_CopperItemRTreeCache;
+    m_incrementalTreeClearance = m_board->m_DRCMaxClearance;
+    m_incrementalZoneTrees = m_board->m_CopperZoneRTreeCache;
+
     timer.Stop();
     wxLogTrace( traceDrcProfile, "DRC took %0.3f ms", timer.msecs() );
 
@@ -838,6 +1186,318 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aT
 }
 
 
+void DRC_ENGINE::RunShardTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aTestFootprints,
+                                int aShardIndex, int aShardCount )
+{
+    BOX2I                    boardBox = m_board->GetBoundingBox();
+    std::vector<BOARD_ITEM*> ownedItems;
+
+    auto claim =
+            [&]( BOARD_ITEM* aItem )
+            {
+                if( GetShardIndex( boardBox, aItem->GetBoundingBox().Centre(), aShardCount )
+                        == aShardIndex )
+                {
+                    ownedItems.push_back( aItem );
+                }
+            };
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+        claim( track );
+
+    for( ZONE* zone : m_board->Zones() )
+        claim( zone );
+
+    for( BOARD_ITEM* item : m_board->Drawings() )
+        claim( item );
+
+    // Footprints can be large; share out their pads and graphics instead
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+        footprint->RunOnChildren( claim, RECURSE_MODE::NO_RECURSE );
+
+    m_reportAllTrackErrors = aReportAllTrackErrors;
+    m_testFootprints = aTestFootprints;
+
+    if( aShardIndex == 0 )
+    {
+        m_shardRun = true;
+        RunTests( aUnits, aReportAllTrackErrors, aTestFootprints );
+        m_shardRun = false;
+    }
+
+    // The scope of an incremental run is the given items plus everything within the worst
+    // clearance of them, which is exactly a shard's tile and its overlap margin.
+    RunIncrementalTests( aUnits, ownedItems, {}, nullptr );
+}
+
+
+int DRC_ENGINE::GetShardIndex( const BOX2I& aBoardBox, const VECTOR2I& aPoint, int aShardCount )
+{
+    if( aShardCount <= 1 )
+        return 0;
+
+    // A grid of roughly square tiles; the last row may have fewer (wider) tiles
+    int cols = (int) std::ceil( std::sqrt( (double) aShardCount ) );
+    int rows = ( aShardCount + cols - 1 ) / cols;
+
+    auto fraction =
+            []( int aValue, int aOrigin, int aSize )
+            {
+                if( aSize <= 0 )
+                    return 0.0;
+
+                return std::clamp( ( (double) aValue - aOrigin ) / aSize, 0.0, 1.0 );
+            };
+
+    double fx = fraction( aPoint.x, aBoardBox.GetX(), aBoardBox.GetWidth() );
+    double fy = fraction( aPoint.y, aBoardBox.GetY(), aBoardBox.GetHeight() );
+
+    int row = std::min( rows - 1, (int) ( fy * rows ) );
+    int rowStart = row * cols;
+    int rowCount = std::min( cols, aShardCount - rowStart );
+    int col = std::min( rowCount - 1, (int) ( fx * rowCount ) );
+
+    return rowStart + col;
+}
+
+
+void DRC_ENGINE::SetProfilingEnabled( bool aEnabled )
+{
+    // Cached resolutions hold on to the profile's counters
+    InvalidateRuleCache();
+
+    if( !aEnabled )
+        m_profile.reset();
+    else if( !m_profile )
+        m_profile = std::make_unique<DRC_PROFILE>();
+}
+
+
+void DRC_ENGINE::startProfiling()
+{
+    if( !m_profile )
+        return;
+
+    InvalidateRuleCache();
+    m_profile->Reset();
+
+    for( const std::shared_ptr<DRC_RULE>& rule : m_rules )
+    {
+        DRC_PROFILE::RULE_STATS* stats = m_profile->AddRule( rule.get() );
+
+        stats->m_Name = rule->m_Name;
+        stats->m_Implicit = rule->IsImplicit();
+
+        if( rule->m_Condition )
+            stats->m_Condition = rule->m_Condition->GetExpression();
+    }
+
+    for( const auto& [constraintType, ruleset] : m_constraintMap )
+    {
+        for( DRC_ENGINE_CONSTRAINT* c : *ruleset )
+            c->profile = m_profile->GetRuleStats( c->parentRule.get() );
+    }
+
+    DRC_RTREE::SetQueryCounting( true );
+}
+
+
+void DRC_ENGINE::stopProfiling()
+{
+    if( !m_profile )
+        return;
+
+    for( const auto& [constraintType, ruleset] : m_constraintMap )
+    {
+        for( DRC_ENGINE_CONSTRAINT* c : *ruleset )
+            c->profile = nullptr;
+    }
+
+    DRC_RTREE::SetQueryCounting( false );
+}
+
+
+void DRC_ENGINE::RunIncrementalTests( EDA_UNITS aUnits,
+                                      const std::vector<BOARD_ITEM*>& aChangedItems,
+                                      const std::set<KIID>& aRemovedItems, BOARD_COMMIT* aCommit )
+{
+    PROF_TIMER                      timer;
+    std::unordered_set<BOARD_ITEM*> changedItems;
+    std::set<int>                   errorCodes;
+
+    SetUserUnits( aUnits );
+
+    for( BOARD_ITEM* item : aChangedItems )
+    {
+        changedItems.insert( item );
+
+        item->RunOnChildren(
+                [&]( BOARD_ITEM* child )
+                {
+                    changedItems.insert( child );
+                },
+                RECURSE_MODE::RECURSE );
+    }
+
+    m_incrementalChanged = aRemovedItems;
+
+    for( BOARD_ITEM* item : changedItems )
+        m_incrementalChanged.insert( item->m_Uuid );
+
+    for( DRC_TEST_PROVIDER* provider : m_testProviders )
+    {
+        std::set<int> providerCodes = provider->GetIncrementalErrorCodes();
+        errorCodes.insert( providerCodes.begin(), providerCodes.end() );
+    }
+
+    // Retire the markers which are about to be regenerated
+    if( aCommit )
+    {
+        for( PCB_MARKER* marker : m_board->Markers() )
+        {
+            std::shared_ptr<RC_ITEM> rcItem = marker->GetRCItem();
+
+            if( marker->GetMarkerType() != MARKER_BASE::MARKER_DRC
+                    || !errorCodes.count( rcItem->GetErrorCode() ) )
+            {
+                continue;
+            }
+
+            for( const KIID& id : rcItem->GetIDs() )
+            {
+                if( m_incrementalChanged.count( id ) )
+                {
+                    aCommit->Remove( marker );
+                    break;
+                }
+            }
+        }
+    }
+
+    resetErrorLimits();
+
+    DRC_TEST_PROVIDER::Init();
+
+    m_board->IncrementTimeStamp();      // Invalidate all caches...
+
+    DRC_CACHE_GENERATOR cacheGenerator;
+    cacheGenerator.SetDRCEngine( this );
+
+    if( m_incrementalTree )
+    {
+        cacheGenerator.SetIncrementalUpdate( m_incrementalTree, m_incrementalTreeClearance,
+                                             std::move( m_incrementalZoneTrees ),
+                                             std::move( m_incrementalIndex ), changedItems,
+                                             aRemovedItems );
+    }
+
+    m_incrementalZoneTrees.clear();
+
+    if( !cacheGenerator.Run() )         // ... and regenerate (or patch) them.
+    {
+        m_incrementalTree.reset();
+        m_incrementalIndex.reset();
+        return;
+    }
+
+    m_incrementalIndex = cacheGenerator.TakeIndex();
+
+    m_board->GetComponentClassManager().ForceComponentClassRecalculation();
+
+    m_incrementalTree = m_board->m_CopperItemRTreeCache;
+    m_incrementalTreeClearance = m_board->m_DRCMaxClearance;
+    m_incrementalZoneTrees = m_board->m_CopperZoneRTreeCache;
+
+    // The scope is the changed items plus anything close enough to them to be in violation.
+    // Zones aren't in the copper item tree, so everything under them is a potential neighbour.
+    LSET boardCopperLayers = LSET::AllCuMask( m_board->GetCopperLayerCount() );
+    int  maxClearance = m_board->m_DRCMaxClearance;
+
+    m_incrementalScope.clear();
+
+    for( BOARD_ITEM* item : changedItems )
+    {
+        m_incrementalScope.insert( item );
+
+        LSET copperLayers = item->GetLayerSet() & boardCopperLayers;
+
+        if( item->Type() == PCB_PAD_T && static_cast<PAD*>( item )->HasHole() )
+            copperLayers = boardCopperLayers;
+
+        if( item->Type() == PCB_ZONE_T )
+        {
+            BOX2I bbox = item->GetBoundingBox();
+            bbox.Inflate( maxClearance );
+
+            for( PCB_LAYER_ID layer : copperLayers )
+            {
+                for( DRC_RTREE::ITEM_WITH_SHAPE* neighbour :
+                     m_incrementalTree->Overlapping( layer, bbox ) )
+                {
+                    m_incrementalScope.insert( neighbour->parent );
+                }
+            }
+        }
+        else
+        {
+            for( PCB_LAYER_ID layer : copperLayers )
+            {
+                m_incrementalTree->QueryColliding( item, layer, layer, nullptr,
+                        [&]( BOARD_ITEM* neighbour ) -> bool
+                        {
+                            m_incrementalScope.insert( neighbour );
+                            return true;
+                        },
+                        maxClearance );
+            }
+        }
+    }
+
+    int timestamp = m_board->GetTimeStamp();
+
+    m_incrementalRun = true;
+    SetRuleCacheEnabled( true );
+
+    for( DRC_TEST_PROVIDER* provider : m_testProviders )
+    {
+        if( provider->GetIncrementalErrorCodes().empty() )
+            continue;
+
+        if( m_logReporter )
+            m_logReporter->Report( wxString::Format( wxT( "Run incremental DRC provider: '%s'" ),
+                                                     provider->GetName() ) );
+
+        if( !provider->RunTests( aUnits ) )
+            break;
+    }
+
+    m_incrementalRun = false;
+    SetRuleCacheEnabled( false );
+
+    timer.Stop();
+    wxLogTrace( traceDrcProfile, "Incremental DRC of %zu items (%zu in scope) took %0.3f ms",
+                changedItems.size(), m_incrementalScope.size(), timer.msecs() );
+
+    m_incrementalChanged.clear();
+
+    wxASSERT( timestamp == m_board->GetTimeStamp() );
+}
+
+
+void DRC_ENGINE::resetErrorLimits()
+{
+    for( int ii = DRCE_FIRST; ii <= DRCE_LAST; ++ii )
+    {
+        if( m_designSettings->Ignore( ii ) )
+            m_errorLimits[ ii ] = 0;
+        else if( ii == DRCE_CLEARANCE || ii == DRCE_UNCONNECTED_ITEMS )
+            m_errorLimits[ ii ] = EXTENDED_ERROR_LIMIT;
+        else
+            m_errorLimits[ ii ] = ERROR_LIMIT;
+    }
+}
+
+
 #define REPORT( s ) { if( aReporter ) { aReporter->Report( s ); } }
 
 DRC_CONSTRAINT DRC_ENGINE::EvalZoneConnection( const BOARD_ITEM* a, const BOARD_ITEM* b,
@@ -883,6 +1543,9 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintType, const BO
      * kills performance when running bulk DRC tests (where aReporter is nullptr).
      */
 
+    if( m_profile )
+        m_profile->m_EvalRulesCalls.fetch_add( 1, std::memory_order_relaxed );
+
     const BOARD_CONNECTED_ITEM* ac = a && a->IsConnected() ? static_cast<const BOARD_CONNECTED_ITEM*>( a ) : nullptr;
     const BOARD_CONNECTED_ITEM* bc = b && b->IsConnected() ? static_cast<const BOARD_CONNECTED_ITEM*>( b ) : nullptr;
 
@@ -920,6 +1583,9 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintType, const BO
     auto applyConstraint =
             [&]( const DRC_ENGINE_CONSTRAINT* c )
             {
+                if( c->profile )
+                    countRuleStat( c->profile->m_Applied );
+
                 if( c->constraint.m_Value.HasMin() )
                 {
                     if( c->parentRule && c->parentRule->IsImplicit() )
@@ -1213,6 +1879,9 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintType, const BO
             {
                 bool implicit = c->parentRule && c->parentRule->IsImplicit();
 
+                if( c->profile )
+                    countRuleStat( c->profile->m_Checks );
+
                 REPORT( "" )
 
                 switch( c->constraint.m_Type )
@@ -1584,7 +2253,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintType, const BO
                                                   EscapeHTML( c->condition->GetExpression() ) ) )
                     }
 
-                    if( c->condition->EvaluateFor( a, b, c->constraint.m_Type, aLayer, aReporter ) )
+                    if( evaluateCondition( c, a, b, aLayer, aReporter ) )
                     {
                         if( aReporter )
                         {
@@ -1617,8 +2286,29 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintType, const BO
     {
         std::vector<DRC_ENGINE_CONSTRAINT*>* ruleset = m_constraintMap[ aConstraintType ];
 
-        for( DRC_ENGINE_CONSTRAINT* rule : *ruleset )
-            processConstraint( rule );
+        auto processRuleset =
+                [&]()
+                {
+                    for( DRC_ENGINE_CONSTRAINT* rule : *ruleset )
+                        processConstraint( rule );
+                };
+
+        // Outside of the condition outcomes, these are the only properties of the items which
+        // processConstraint() looks at.
+        int flags = ( a_is_non_copper ? 0x01 : 0 ) | ( b_is_non_copper ? 0x02 : 0 )
+                        | ( b ? 0 : 0x04 );
+
+        if( aConstraintType == HOLE_TO_HOLE_CONSTRAINT
+                && ( ( a && a->HasDrilledHole() ) || ( b && b->HasDrilledHole() ) ) )
+        {
+            flags |= 0x08;
+        }
+
+        if( aReporter || !resolveCachedRules( aConstraintType, a, b, aLayer, flags, processRuleset,
+                                              constraint ) )
+        {
+            processRuleset();
+        }
     }
 
     if( constraint.GetParentRule() && !constraint.GetParentRule()->IsImplicit() )
@@ -1900,8 +2590,7 @@ void DRC_ENGINE::ProcessAssertions( const BOARD_ITEM* a,
                     REPORT( wxString::Format( _( "Checking rule condition '%s'." ),
                                               EscapeHTML( c->condition->GetExpression() ) ) )
 
-                    if( c->condition->EvaluateFor( a, nullptr, c->constraint.m_Type,
-                                                   a->GetLayer(), aReporter ) )
+                    if( evaluateCondition( c, a, nullptr, a->GetLayer(), aReporter ) )
                     {
                         REPORT( _( "Rule applied." ) )
                         testAssertion( c );
@@ -1938,6 +2627,25 @@ void DRC_ENGINE::ReportViolation( const std::shared_ptr<DRC_ITEM>& aItem, const
 {
     static std::mutex globalLock;
 
+    // Incremental runs re-test the neighbours of changed items too, but violations between
+    // two unchanged items are already on the board.
+    if( m_incrementalRun )
+    {
+        bool involvesChange = false;
+
+        for( const KIID& id : aItem->GetIDs() )
+        {
+            if( m_incrementalChanged.count( id ) )
+            {
+                involvesChange = true;
+                break;
+            }
+        }
+
+        if( !involvesChange )
+            return;
+    }
+
     m_errorLimits[ aItem->GetErrorCode() ] -= 1;
 
     if( m_violationHandler )
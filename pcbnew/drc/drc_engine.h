@@ -23,26 +23,35 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <set>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 
+#include <hash.h>
+#include <kiid.h>
 #include <units_provider.h>
 #include <pcb_shape.h>
 #include <lset.h>
 #include <drc/drc_rule.h>
+#include <drc/drc_profile.h>
 
 
 class BOARD_COMMIT;
 class BOARD_DESIGN_SETTINGS;
 class DRC_TEST_PROVIDER;
 class DRC_TEST_PROVIDER_CREEPAGE;
+class DRC_RTREE;
+struct DRC_COPPER_TREE_INDEX;
 class PCB_EDIT_FRAME;
 class DS_PROXY_VIEW_ITEM;
 class BOARD_ITEM;
 class BOARD;
 class PCB_MARKER;
 class NETCLASS;
+class ZONE;
 class NETLIST;
 class NETINFO_ITEM;
 class PROGRESS_REPORTER;
@@ -93,7 +102,13 @@ public:
     DRC_ENGINE( const DRC_ENGINE& ) = delete;
     DRC_ENGINE& operator=( const DRC_ENGINE& ) = delete;
 
-    void SetBoard( BOARD* aBoard ) { m_board = aBoard; }
+    void SetBoard( BOARD* aBoard )
+    {
+        m_board = aBoard;
+        m_incrementalTree.reset();
+        m_incrementalZoneTrees.clear();
+        m_incrementalIndex.reset();
+    }
     BOARD* GetBoard() const { return m_board; }
 
     void SetDesignSettings( BOARD_DESIGN_SETTINGS* aSettings ) { m_designSettings = aSettings; }
@@ -153,8 +168,121 @@ public:
     void RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aTestFootprints,
                    BOARD_COMMIT* aCommit = nullptr );
 
+    /**
+     * Re-check only the items touched by a commit.
+     *
+     * Only providers which return a non-empty GetIncrementalErrorCodes() are run.  Their tests
+     * are limited to the changed items and the copper items within the worst clearance of
+     * them, and only violations involving a changed (or removed) item are reported.  Existing
+     * markers with one of those error codes which refer to a changed or removed item are
+     * staged for removal in aCommit so the new results replace them.
+     *
+     * The copper item tree kept from the previous run is patched from aChangedItems and
+     * aRemovedItems rather than rebuilt (it is built from scratch if there isn't one yet), and
+     * only the changed zones are tessellated.  Items modified without being passed here keep
+     * their old tree entries, so every board change must reach the engine (BOARD_COMMIT and
+     * undo/redo both queue theirs to the DRC tool).  The options last passed to RunTests() are
+     * reused.
+     *
+     * @param aChangedItems are the items added or modified by the commit.  Footprints cover
+     *                      all their children.
+     * @param aRemovedItems are the ids of the items removed by the commit (including children).
+     */
+    void RunIncrementalTests( EDA_UNITS aUnits, const std::vector<BOARD_ITEM*>& aChangedItems,
+                              const std::set<KIID>& aRemovedItems, BOARD_COMMIT* aCommit );
+
+    /**
+     * @return true if a previous run has left a copper item tree for RunIncrementalTests() to
+     *         patch.
+     */
+    bool HasIncrementalTree() const { return m_incrementalTree != nullptr; }
+
+    /**
+     * Run one shard of a DRC split across several processes.
+     *
+     * The board is divided into aShardCount tiles (see GetShardIndex()) and this shard checks
+     * the items whose centre lies in tile aShardIndex against everything within the worst
+     * clearance of them, using the providers which can be limited to a set of items (see
+     * DRC_TEST_PROVIDER::GetIncrementalErrorCodes()).  The remaining providers run over the
+     * whole board in shard 0.
+     *
+     * Violations between items in different tiles are reported by each of their shards, so
+     * merged results must be de-duplicated.
+     */
+    void RunShardTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aTestFootprints,
+                        int aShardIndex, int aShardCount );
+
+    /**
+     * @return the index of the tile containing aPoint when aBoardBox is split into aShardCount
+     *         tiles.  Points outside the box belong to the nearest tile.
+     */
+    static int GetShardIndex( const BOX2I& aBoardBox, const VECTOR2I& aPoint, int aShardCount );
+
+    /**
+     * @return false if an incremental run is in progress and aItem is neither one of the
+     *         changed items nor a neighbour of one.
+     */
+    bool IsInIncrementalScope( const BOARD_ITEM* aItem ) const
+    {
+        return !m_incrementalRun || m_incrementalScope.count( aItem );
+    }
+
+    /**
+     * @return the items tested by the last RunIncrementalTests(): the changed items and the
+     *         copper items near them.  The items may have been freed since, so they are only
+     *         good for comparing against.
+     */
+    const std::unordered_set<const BOARD_ITEM*>& GetIncrementalScope() const
+    {
+        return m_incrementalScope;
+    }
+
     bool IsErrorLimitExceeded( int error_code );
 
+    struct RULE_CACHE_STATS
+    {
+        uint64_t m_Hits = 0;
+        uint64_t m_Misses = 0;
+    };
+
+    /**
+     * Enable (or disable and flush) memoization of rule resolution in EvalRules().
+     *
+     * While enabled, rulesets whose conditions each depend on a single item are resolved once
+     * per distinct combination of condition outcomes.  An item's outcomes are keyed on the item
+     * itself, so they are only good until the board is next edited (see InvalidateRuleCache()).
+     * RunTests() enables the cache for the duration of the run.
+     */
+    void SetRuleCacheEnabled( bool aEnabled );
+
+    /**
+     * Drop the cached rule outcomes and resolutions.
+     *
+     * BOARD_COMMIT and undo/redo call this when they change the board.  Code which edits items
+     * directly while the cache is enabled must call it too.
+     */
+    void InvalidateRuleCache();
+
+    /**
+     * @return the rule cache hits and misses since the cache was last enabled.
+     */
+    RULE_CACHE_STATS GetRuleCacheStats() const
+    {
+        return { m_ruleCacheHits.load(), m_ruleCacheMisses.load() };
+    }
+
+    /**
+     * Enable (or disable) collection of a DRC_PROFILE by RunTests(): the wall and CPU time of
+     * each test provider, EvalRules() call counts and condition evaluation times per rule, and
+     * DRC_RTREE query counts.  Profiling has some overhead of its own so it's off by default.
+     */
+    void SetProfilingEnabled( bool aEnabled );
+
+    /**
+     * @return the profile of the last RunTests(), or nullptr if profiling isn't enabled.
+     */
+    const DRC_PROFILE* GetProfile() const { return m_profile.get(); }
+
     DRC_CONSTRAINT EvalRules( DRC_CONSTRAINT_T aConstraintType, const BOARD_ITEM* a,
                               const BOARD_ITEM* b, PCB_LAYER_ID aLayer,
                               REPORTER* aReporter = nullptr );
@@ -190,6 +318,20 @@ public:
 
     std::vector<DRC_TEST_PROVIDER*> GetTestProviders() const { return m_testProviders; };
 
+    /**
+     * @return the first rule with the given name, or nullptr.
+     */
+    DRC_RULE* GetRule( const wxString& aName ) const
+    {
+        for( const std::shared_ptr<DRC_RULE>& rule : m_rules )
+        {
+            if( rule->m_Name == aName )
+                return rule.get();
+        }
+
+        return nullptr;
+    }
+
     DRC_TEST_PROVIDER* GetTestProvider( const wxString& name ) const;
 
     /**
@@ -243,8 +385,102 @@ private:
         DRC_RULE_CONDITION*        condition;
         std::shared_ptr<DRC_RULE>  parentRule;
         DRC_CONSTRAINT             constraint;
+        DRC_PROFILE::RULE_STATS*   profile = nullptr;     // set while profiling
     };
 
+    bool evaluateCondition( const DRC_ENGINE_CONSTRAINT* aConstraint, const BOARD_ITEM* a,
+                            const BOARD_ITEM* b, PCB_LAYER_ID aLayer, REPORTER* aReporter );
+
+    /**
+     * Reset the profile (if profiling) and attach its rule stats to the compiled constraints.
+     */
+    void startProfiling();
+    void stopProfiling();
+
+    void resetErrorLimits();
+
+    void buildRuleCacheInfo();
+
+    /**
+     * Resolve the ruleset for aConstraintType from the rule cache.
+     *
+     * @return false if the ruleset can't be cached, in which case aConstraint is untouched.
+     */
+    bool resolveCachedRules( DRC_CONSTRAINT_T aConstraintType, const BOARD_ITEM* a,
+                             const BOARD_ITEM* b, PCB_LAYER_ID aLayer, int aFlags,
+                             const std::function<void()>& aResolver,
+                             DRC_CONSTRAINT& aConstraint );
+
+    struct RULE_CACHE;
+
+    uint64_t getConditionOutcomes( RULE_CACHE& aCache, DRC_CONSTRAINT_T aConstraintType,
+                                   const BOARD_ITEM* aItem, PCB_LAYER_ID aLayer );
+
+    struct RULE_CACHE_INFO
+    {
+        bool     cacheable = false;
+        uint64_t bOnlyMask = 0;     // outcomes of conditions which refer only to B
+    };
+
+    struct ITEM_OUTCOMES_KEY
+    {
+        const BOARD_ITEM* item;
+        DRC_CONSTRAINT_T  type;
+        PCB_LAYER_ID      layer;
+
+        bool operator==( const ITEM_OUTCOMES_KEY& aOther ) const = default;
+    };
+
+    struct ITEM_OUTCOMES_KEY_HASH
+    {
+        std::size_t operator()( const ITEM_OUTCOMES_KEY& aKey ) const
+        {
+            return hash_val( aKey.item, static_cast<int>( aKey.type ),
+                             static_cast<int>( aKey.layer ) );
+        }
+    };
+
+    struct RESOLUTION_KEY
+    {
+        DRC_CONSTRAINT_T  type;
+        PCB_LAYER_ID      layer;
+        int               flags;
+        uint64_t          outcomes;
+
+        bool operator==( const RESOLUTION_KEY& aOther ) const = default;
+    };
+
+    struct RESOLUTION_KEY_HASH
+    {
+        std::size_t operator()( const RESOLUTION_KEY& aKey ) const
+        {
+            return hash_val( static_cast<int>( aKey.type ), static_cast<int>( aKey.layer ),
+                             aKey.flags, aKey.outcomes );
+        }
+    };
+
+    /**
+     * The rule cache is kept per thread so that lookups take no lock.  A thread's cache is
+     * emptied when it was filled under an older generation (see InvalidateRuleCache()).
+     */
+    struct CACHED_RESOLUTION
+    {
+        DRC_CONSTRAINT constraint;
+
+        /// The per-rule profile counters the resolution incremented, counted again on each hit.
+        std::vector<std::atomic<uint64_t>*> profileCounts;
+    };
+
+    struct RULE_CACHE
+    {
+        uint64_t generation = 0;
+
+        std::unordered_map<ITEM_OUTCOMES_KEY, uint64_t, ITEM_OUTCOMES_KEY_HASH> itemOutcomes;
+        std::unordered_map<RESOLUTION_KEY, CACHED_RESOLUTION, RESOLUTION_KEY_HASH> resolutions;
+    };
+
+    RULE_CACHE& threadRuleCache();
+
     void loadImplicitRules();
     std::shared_ptr<DRC_RULE> createImplicitRule( const wxString& name, DRC_IMPLICIT_SOURCE aImplicitSource );
 
@@ -270,4 +506,23 @@ protected:
     PROGRESS_REPORTER*         m_progressReporter;
 
     std::shared_ptr<KIGFX::VIEW_OVERLAY> m_debugOverlay;
+
+    // Incremental DRC state (see RunIncrementalTests())
+    std::shared_ptr<DRC_RTREE>                            m_incrementalTree;
+    int                                                   m_incrementalTreeClearance;
+    std::unordered_map<ZONE*, std::shared_ptr<DRC_RTREE>> m_incrementalZoneTrees;
+    std::shared_ptr<DRC_COPPER_TREE_INDEX>                m_incrementalIndex;
+    bool                                                  m_incrementalRun;
+    bool                                                  m_shardRun;
+    std::unordered_set<const BOARD_ITEM*>                 m_incrementalScope;
+    std::set<KIID>                                        m_incrementalChanged;
+
+    // Rule resolution cache (see SetRuleCacheEnabled())
+    bool                                        m_ruleCacheEnabled;
+    std::map<DRC_CONSTRAINT_T, RULE_CACHE_INFO> m_ruleCacheInfo;
+    std::atomic<uint64_t>                       m_ruleCacheGeneration;
+    std::atomic<uint64_t>                       m_ruleCacheHits;
+    std::atomic<uint64_t>                       m_ruleCacheMisses;
+
+    std::unique_ptr<DRC_PROFILE>                                     m_profile;
 };
@@ -0,0 +1,158 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "drc_profile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#include <build_version.h>
+#include <json_common.h>
+#include <string_utils.h>
+
+
+static std::string toUtf8( const wxString& aString )
+{
+    return std::string( aString.ToUTF8() );
+}
+
+
+static nlohmann::ordered_json stageJson( const DRC_PROFILE::STAGE_STATS& aStage )
+{
+    nlohmann::ordered_json json;
+
+    if( !aStage.m_Name.IsEmpty() )
+        json["name"] = toUtf8( aStage.m_Name );
+
+    json["wall_ms"] = aStage.m_WallMs;
+    json["cpu_ms"] = aStage.m_CpuMs;
+    json["rtree_queries"] = aStage.m_RTreeQueries;
+
+    return json;
+}
+
+
+bool DRC_PROFILE::WriteJsonReport( const wxString& aFullFileName ) const
+{
+    std::ofstream jsonFileStream( aFullFileName.fn_str() );
+
+    if( !jsonFileStream.is_open() )
+        return false;
+
+    nlohmann::ordered_json root;
+
+    root["date"] = toUtf8( GetISO8601CurrentDateTime() );
+    root["kicad_version"] = toUtf8( GetMajorMinorPatchVersion() );
+    root["total"] = stageJson( m_Total );
+    root["cache_generation"] = stageJson( m_CacheGeneration );
+
+    nlohmann::ordered_json providers = nlohmann::ordered_json::array();
+
+    for( const STAGE_STATS& provider : m_Providers )
+        providers.push_back( stageJson( provider ) );
+
+    root["providers"] = providers;
+
+    nlohmann::ordered_json evalRules;
+    evalRules["calls"] = m_EvalRulesCalls.load();
+    evalRules["cache_hits"] = m_RuleCacheHits;
+    evalRules["cache_misses"] = m_RuleCacheMisses;
+    root["eval_rules"] = evalRules;
+
+    // Most expensive first; that's what anyone reading this is looking for
+    std::vector<const RULE_STATS*> rules = GetRules();
+
+    std::stable_sort( rules.begin(), rules.end(),
+                      []( const RULE_STATS* a, const RULE_STATS* b )
+                      {
+                          return a->m_ConditionNs > b->m_ConditionNs;
+                      } );
+
+    nlohmann::ordered_json rulesJson = nlohmann::ordered_json::array();
+
+    struct CONDITION_TOTALS
+    {
+        uint64_t m_Evals = 0;
+        uint64_t m_Ns = 0;
+        int      m_Rules = 0;
+    };
+
+    std::map<wxString, CONDITION_TOTALS> conditions;
+
+    for( const RULE_STATS* rule : rules )
+    {
+        nlohmann::ordered_json ruleJson;
+
+        ruleJson["name"] = toUtf8( rule->m_Name );
+        ruleJson["implicit"] = rule->m_Implicit;
+        ruleJson["condition"] = toUtf8( rule->m_Condition );
+        ruleJson["checks"] = rule->m_Checks.load();
+        ruleJson["applied"] = rule->m_Applied.load();
+        ruleJson["condition_evaluations"] = rule->m_ConditionEvals.load();
+        ruleJson["condition_ms"] = rule->m_ConditionNs.load() / 1e6;
+
+        rulesJson.push_back( ruleJson );
+
+        if( !rule->m_Condition.IsEmpty() )
+        {
+            CONDITION_TOTALS& totals = conditions[rule->m_Condition];
+            totals.m_Evals += rule->m_ConditionEvals;
+            totals.m_Ns += rule->m_ConditionNs;
+            totals.m_Rules++;
+        }
+    }
+
+    root["rules"] = rulesJson;
+
+    std::vector<std::pair<wxString, CONDITION_TOTALS>> sortedConditions( conditions.begin(),
+                                                                         conditions.end() );
+
+    std::stable_sort( sortedConditions.begin(), sortedConditions.end(),
+                      []( const auto& a, const auto& b )
+                      {
+                          return a.second.m_Ns > b.second.m_Ns;
+                      } );
+
+    nlohmann::ordered_json conditionsJson = nlohmann::ordered_json::array();
+
+    for( const auto& [expression, totals] : sortedConditions )
+    {
+        nlohmann::ordered_json conditionJson;
+
+        conditionJson["expression"] = toUtf8( expression );
+        conditionJson["rules"] = totals.m_Rules;
+        conditionJson["evaluations"] = totals.m_Evals;
+        conditionJson["ms"] = totals.m_Ns / 1e6;
+
+        conditionsJson.push_back( conditionJson );
+    }
+
+    root["conditions"] = conditionsJson;
+
+    jsonFileStream << std::setw( 4 ) << root << std::endl;
+    jsonFileStream.flush();
+    jsonFileStream.close();
+
+    return true;
+}
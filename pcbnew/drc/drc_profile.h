@@ -0,0 +1,135 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <wx/string.h>
+
+class DRC_RULE;
+
+
+/**
+ * Timings and counters collected by DRC_ENGINE::RunTests() while profiling is enabled.
+ *
+ * The rule counters are updated concurrently by the DRC threads, so they're atomics; everything
+ * else is written by the thread running the tests.
+ */
+class DRC_PROFILE
+{
+public:
+    struct STAGE_STATS
+    {
+        wxString m_Name;
+        double   m_WallMs = 0.0;
+        double   m_CpuMs = 0.0;          ///< CPU time of the whole process (all threads)
+        uint64_t m_RTreeQueries = 0;
+    };
+
+    struct RULE_STATS
+    {
+        wxString              m_Name;
+        wxString              m_Condition;          ///< Condition expression; empty if none
+        bool                  m_Implicit = false;
+        std::atomic<uint64_t> m_Checks = 0;         ///< Times the rule was considered
+        std::atomic<uint64_t> m_Applied = 0;        ///< Times the rule's constraint was applied
+        std::atomic<uint64_t> m_ConditionEvals = 0;
+        std::atomic<uint64_t> m_ConditionNs = 0;
+    };
+
+    /**
+     * Clear all measurements and forget the rules.
+     */
+    void Reset()
+    {
+        m_Total = STAGE_STATS();
+        m_CacheGeneration = STAGE_STATS();
+        m_Providers.clear();
+        m_EvalRulesCalls = 0;
+        m_RuleCacheHits = 0;
+        m_RuleCacheMisses = 0;
+        m_ruleOrder.clear();
+        m_rules.clear();
+    }
+
+    /**
+     * Start collecting stats for a rule (in rule-file order).
+     */
+    RULE_STATS* AddRule( const DRC_RULE* aRule )
+    {
+        std::unique_ptr<RULE_STATS>& stats = m_rules[aRule];
+
+        if( !stats )
+        {
+            stats = std::make_unique<RULE_STATS>();
+            m_ruleOrder.push_back( aRule );
+        }
+
+        return stats.get();
+    }
+
+    /**
+     * @return the stats of a rule added with AddRule(), or nullptr.
+     */
+    RULE_STATS* GetRuleStats( const DRC_RULE* aRule ) const
+    {
+        auto it = m_rules.find( aRule );
+        return it == m_rules.end() ? nullptr : it->second.get();
+    }
+
+    /**
+     * @return the stats of all the rules, in the order they were added.
+     */
+    std::vector<const RULE_STATS*> GetRules() const
+    {
+        std::vector<const RULE_STATS*> rules;
+
+        for( const DRC_RULE* rule : m_ruleOrder )
+            rules.push_back( m_rules.at( rule ).get() );
+
+        return rules;
+    }
+
+    /**
+     * Write the profile as JSON.  Rules are listed with the most expensive conditions first,
+     * and conditions shared by several rules are also totalled per expression.
+     */
+    bool WriteJsonReport( const wxString& aFullFileName ) const;
+
+public:
+    STAGE_STATS              m_Total;
+    STAGE_STATS              m_CacheGeneration;
+    std::vector<STAGE_STATS> m_Providers;
+
+    std::atomic<uint64_t>    m_EvalRulesCalls = 0;
+    uint64_t                 m_RuleCacheHits = 0;
+    uint64_t                 m_RuleCacheMisses = 0;
+
+private:
+    std::vector<const DRC_RULE*>                            m_ruleOrder;
+    std::map<const DRC_RULE*, std::unique_ptr<RULE_STATS>> m_rules;
+};
@@ -28,12 +28,14 @@
 #include <board_item.h>
 #include <pad.h>
 #include <pcb_field.h>
+#include <atomic>
 #include <memory>
 #include <unordered_set>
 #include <set>
 #include <vector>
 
 #include <geometry/rtree.h>
+#include <geometry/packed_rtree.h>
 #include <geometry/shape.h>
 #include <geometry/shape_segment.h>
 #include <math/vector2d.h>
@@ -71,10 +73,12 @@ public:
         const SHAPE*           shape;
         std::shared_ptr<SHAPE> shapeStorage;
         std::shared_ptr<SHAPE> parentShape;
+        BOX2I                  bbox;         ///< The (clearance-inflated) box indexed in the tree
     };
 
 private:
     using drc_rtree = RTree<ITEM_WITH_SHAPE*, int, 2, double>;
+    using drc_packed_rtree = PACKED_RTREE<ITEM_WITH_SHAPE*>;
 
 public:
     DRC_RTREE()
@@ -144,6 +148,7 @@ public:
             const int        mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
             ITEM_WITH_SHAPE* itemShape = new ITEM_WITH_SHAPE( parent, subshape, shape );
 
+            itemShape->bbox = bbox;
             m_tree[aTargetLayer]->Insert( mmin, mmax, itemShape );
             m_count++;
         }
@@ -159,9 +164,105 @@ public:
             const int        mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
             ITEM_WITH_SHAPE* itemShape = new ITEM_WITH_SHAPE( parent, hole, shape );
 
+            itemShape->bbox = bbox;
             m_tree[aTargetLayer]->Insert( mmin, mmax, itemShape );
             m_count++;
         }
+
+        m_packed.clear();
+    }
+
+    /**
+     * Build a packed, read-only copy of the index which is faster to search.  It's used by all
+     * the queries until the tree is next modified (after which searches fall back to the
+     * dynamic tree until Pack() is called again).
+     */
+    void Pack()
+    {
+        m_packed.clear();
+
+        for( const auto& [layer, tree] : m_tree )
+        {
+            if( tree->Count() == 0 )
+                continue;
+
+            drc_packed_rtree& packed = m_packed[layer];
+            packed.Reserve( tree->Count() );
+
+            for( ITEM_WITH_SHAPE* el : *tree )
+                packed.Add( el->bbox, el );
+
+            packed.Build();
+        }
+    }
+
+    bool IsPacked() const { return !m_packed.empty(); }
+
+    /**
+     * Enable counting of the searches made in all DRC_RTREEs (for DRC profiling).  It's off by
+     * default as every thread would otherwise contend for the counter.
+     */
+    static void SetQueryCounting( bool aEnable )
+    {
+        s_countQueries.store( aEnable, std::memory_order_relaxed );
+    }
+
+    static uint64_t GetQueryCount() { return s_queryCount.load( std::memory_order_relaxed ); }
+
+    /**
+     * Remove all entries belonging to the given items.
+     *
+     * Items are matched by identity only and are never dereferenced, so the set may contain
+     * items which have already been deleted from the board.
+     */
+    void Remove( const std::unordered_set<const BOARD_ITEM*>& aItems )
+    {
+        if( aItems.empty() )
+            return;
+
+        m_packed.clear();
+
+        for( auto& [_, tree] : m_tree )
+        {
+            std::vector<ITEM_WITH_SHAPE*> stale;
+
+            for( ITEM_WITH_SHAPE* el : *tree )
+            {
+                if( aItems.count( el->parent ) )
+                    stale.push_back( el );
+            }
+
+            for( ITEM_WITH_SHAPE* el : stale )
+            {
+                // The indexed rect is the subshape's bbox inflated by the worst clearance, so
+                // the bare bbox is guaranteed to overlap it.  (The shape itself is kept alive
+                // by the entry's shape storage.)
+                BOX2I     bbox = el->shape->BBox();
+                const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+                const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+                if( !tree->Remove( mmin, mmax, el ) )
+                    m_count--;
+
+                delete el;
+            }
+        }
+    }
+
+    /**
+     * Return the distinct set of items indexed in the tree (on any layer).
+     */
+    std::unordered_set<BOARD_ITEM*> GetItems() const
+    {
+        std::unordered_set<BOARD_ITEM*> items;
+
+        for( const auto& [_, tree] : m_tree )
+        {
+            for( ITEM_WITH_SHAPE* el : *tree )
+                items.insert( el->parent );
+        }
+
+        return items;
     }
 
     /**
@@ -172,6 +273,7 @@ public:
         for( auto& [_, tree] : m_tree )
             tree->RemoveAll();
 
+        m_packed.clear();
         m_count = 0;
     }
 
@@ -203,8 +305,7 @@ public:
                     return true;
                 };
 
-        if( auto it = m_tree.find( aTargetLayer ); it != m_tree.end() )
-            it->second->Search( min, max, visit );
+        search( aTargetLayer, min, max, visit );
 
         return count > 0;
     }
@@ -277,8 +378,7 @@ public:
                     return true;
                 };
 
-        if( auto it = m_tree.find( aTargetLayer ); it != m_tree.end() )
-            it->second->Search( min, max, visit );
+        search( aTargetLayer, min, max, visit );
 
         return count;
     }
@@ -326,8 +426,7 @@ public:
                     return true;
                 };
 
-        if( auto it = m_tree.find( aLayer ); it != m_tree.end() )
-            it->second->Search( min, max, visit );
+        search( aLayer, min, max, visit );
 
         if( collision )
         {
@@ -402,15 +501,10 @@ public:
 
                     return true;
                 };
-        auto it = m_tree.find( aLayer );
-
-        if( it == m_tree.end() )
-            return false;
-
         if( poly && poly->OutlineCount() == 1 && poly->HoleCount( 0 ) == 0 )
-            it->second->Search( min, max, polyVisitor );
+            search( aLayer, min, max, polyVisitor );
         else
-            it->second->Search( min, max, visitor );
+            search( aLayer, min, max, visitor );
 
         return collision;
     }
@@ -435,7 +529,7 @@ public:
                     return true;
                 };
 
-        m_tree[aLayer]->Search( min, max, visitor );
+        search( aLayer, min, max, visitor );
 
         return retval;
     }
@@ -487,10 +581,7 @@ public:
                             return true;
                         };
 
-                auto it = m_tree.find( targetLayer );
-
-                if( it != m_tree.end() )
-                    it->second->Search( min, max, visit );
+                search( targetLayer, min, max, visit );
             };
         }
 
@@ -604,8 +695,25 @@ public:
 
 
 private:
-    std::map<int, drc_rtree*> m_tree;
-    size_t                    m_count;
+    template <class VISITOR>
+    void search( int aLayer, const int aMin[2], const int aMax[2], VISITOR& aVisitor ) const
+    {
+        if( s_countQueries.load( std::memory_order_relaxed ) )
+            s_queryCount.fetch_add( 1, std::memory_order_relaxed );
+
+        if( auto packed = m_packed.find( aLayer ); packed != m_packed.end() )
+            packed->second.Search( aMin, aMax, aVisitor );
+        else if( auto it = m_tree.find( aLayer ); it != m_tree.end() )
+            it->second->Search( aMin, aMax, aVisitor );
+    }
+
+private:
+    std::map<int, drc_rtree*>       m_tree;
+    std::map<int, drc_packed_rtree> m_packed;
+    size_t                          m_count;
+
+    static inline std::atomic<bool>     s_countQueries = false;
+    static inline std::atomic<uint64_t> s_queryCount = 0;
 };
 
 
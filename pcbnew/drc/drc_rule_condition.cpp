@@ -30,7 +30,8 @@
 
 DRC_RULE_CONDITION::DRC_RULE_CONDITION( const wxString& aExpression ) :
     m_expression( aExpression ),
-    m_ucode ( nullptr )
+    m_ucode ( nullptr ),
+    m_singleItem( false )
 {
 }
 
@@ -86,6 +87,33 @@ bool DRC_RULE_CONDITION::EvaluateFor( const BOARD_ITEM* aItemA, const BOARD_ITEM
 }
 
 
+bool DRC_RULE_CONDITION::EvaluateForItem( const BOARD_ITEM* aItem, int aConstraint,
+                                          PCB_LAYER_ID aLayer )
+{
+    if( GetExpression().IsEmpty() )
+        return true;
+
+    if( !m_ucode )
+        return false;
+
+    PCBEXPR_CONTEXT ctx( aConstraint, aLayer );
+    BOARD_ITEM*     item = const_cast<BOARD_ITEM*>( aItem );
+
+    if( RefersToBOnly() )
+        ctx.SetItems( nullptr, item );
+    else
+        ctx.SetItems( item, nullptr );
+
+    return m_ucode->Run( &ctx )->AsDouble() != 0.0;
+}
+
+
+bool DRC_RULE_CONDITION::RefersToBOnly() const
+{
+    return m_ucode && m_ucode->GetItemRefs() == 0x2;
+}
+
+
 bool DRC_RULE_CONDITION::Compile( REPORTER* aReporter, int aSourceLine, int aSourceOffset )
 {
     PCBEXPR_COMPILER compiler( new PCBEXPR_UNIT_RESOLVER() );
@@ -112,6 +140,20 @@ bool DRC_RULE_CONDITION::Compile( REPORTER* aReporter, int aSourceLine, int aSou
     PCBEXPR_CONTEXT preflightContext( 0, F_Cu );
 
     bool ok = compiler.Compile( GetExpression().ToUTF8().data(), m_ucode.get(), &preflightContext );
+
+    // Functions such as intersectsCourtyard() can name the other item through a string
+    // argument, so treat any quoted 'A' or 'B' as a cross-item reference.
+    static const wxString crossRefs[] = { wxT( "'A'" ), wxT( "'B'" ),
+                                          wxT( "\"A\"" ), wxT( "\"B\"" ) };
+
+    m_singleItem = ok && m_ucode->GetItemRefs() != 0x3;
+
+    for( const wxString& crossRef : crossRefs )
+    {
+        if( GetExpression().Contains( crossRef ) )
+            m_singleItem = false;
+    }
+
     return ok;
 }
 
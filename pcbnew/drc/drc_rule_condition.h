@@ -41,14 +41,33 @@ public:
     bool EvaluateFor( const BOARD_ITEM* aItemA, const BOARD_ITEM* aItemB, int aConstraint,
                       PCB_LAYER_ID aLayer, REPORTER* aReporter = nullptr );
 
+    /**
+     * Evaluate a single-item condition (see IsSingleItem()) for one item.  The item is placed
+     * in whichever of A or B the condition refers to, so the result is the same as the
+     * corresponding half of EvaluateFor().
+     */
+    bool EvaluateForItem( const BOARD_ITEM* aItem, int aConstraint, PCB_LAYER_ID aLayer );
+
     bool Compile( REPORTER* aReporter, int aSourceLine = 0, int aSourceOffset = 0 );
 
+    /**
+     * @return true if the condition compiled and its outcome depends on at most one of the
+     *         two items (ie: it never compares A against B).
+     */
+    bool IsSingleItem() const { return m_singleItem; }
+
+    /**
+     * @return true if the condition only refers to B.
+     */
+    bool RefersToBOnly() const;
+
     void SetExpression( const wxString& aExpression ) { m_expression = aExpression; }
     wxString GetExpression() const { return m_expression; }
 
 private:
     wxString                       m_expression;
     std::unique_ptr<PCBEXPR_UCODE> m_ucode;
+    bool                           m_singleItem;
 };
 
 
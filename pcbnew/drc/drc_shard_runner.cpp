@@ -0,0 +1,326 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "drc_shard_runner.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <thread>
+#include <tuple>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+#include <wx/utils.h>
+
+#include <board.h>
+#include <board_commit.h>
+#include <board_design_settings.h>
+#include <drc/drc_engine.h>
+#include <drc/drc_item.h>
+#include <json_common.h>
+#include <pcb_marker.h>
+#include <reporter.h>
+#include <wx_filename.h>
+
+
+// Bump if the shard file contents change; workers and the coordinator are always the same build
+// but a stale file from a crashed run shouldn't be misread.
+static const int SHARD_FILE_VERSION = 1;
+
+
+static wxString kicadCliPath()
+{
+    wxFileName cli( wxStandardPaths::Get().GetExecutablePath() );
+
+#ifdef __WXMAC__
+    // On macOS, we have standalone applications inside the main bundle, so we handle that here:
+    if( cli.GetPath().Find( "/Contents/Applications/pcbnew.app/Contents/MacOS" ) != wxNOT_FOUND )
+    {
+        cli.AppendDir( wxT( ".." ) );
+        cli.AppendDir( wxT( ".." ) );
+        cli.AppendDir( wxT( ".." ) );
+        cli.AppendDir( wxT( ".." ) );
+        cli.AppendDir( wxT( "MacOS" ) );
+    }
+#else
+    if( wxGetEnv( wxT( "KICAD_RUN_FROM_BUILD_DIR" ), nullptr ) )
+    {
+        cli.RemoveLastDir();
+        cli.AppendDir( wxT( "kicad" ) );
+    }
+#endif
+
+    cli.SetName( wxT( "kicad-cli" ) );
+    cli.Normalize( FN_NORMALIZE_FLAGS );
+
+    return cli.GetFullPath();
+}
+
+
+static wxString quoteArg( const wxString& aArg )
+{
+    wxString quoted = aArg;
+
+#ifdef _WIN32
+    quoted.Replace( wxS( "\"" ), wxS( "\\\"" ) );
+    return wxS( "\"" ) + quoted + wxS( "\"" );
+#else
+    quoted.Replace( wxS( "'" ), wxS( "'\\''" ) );
+    return wxS( "'" ) + quoted + wxS( "'" );
+#endif
+}
+
+
+/**
+ * Run a command line and wait for it.  Unlike wxExecute() this can be called from any thread,
+ * which lets the workers run concurrently.
+ *
+ * @return the exit code of the command, or -1 if it didn't exit normally.
+ */
+static int runCommand( const wxString& aCommand )
+{
+#ifdef _WIN32
+    // cmd.exe strips the outer pair of quotes
+    return _wsystem( ( wxS( "\"" ) + aCommand + wxS( "\"" ) ).wc_str() );
+#else
+    int status = std::system( aCommand.utf8_str() );
+
+    return WIFEXITED( status ) ? WEXITSTATUS( status ) : -1;
+#endif
+}
+
+
+DRC_SHARD_RUNNER::DRC_SHARD_RUNNER( BOARD* aBoard, REPORTER* aReporter ) :
+        m_board( aBoard ),
+        m_reporter( aReporter )
+{
+}
+
+
+DRC_SHARD_RUNNER::~DRC_SHARD_RUNNER()
+{
+    for( const wxString& shardFile : m_shardFiles )
+    {
+        if( wxFileExists( shardFile ) )
+            wxRemoveFile( shardFile );
+    }
+}
+
+
+bool DRC_SHARD_RUNNER::Run( const wxString& aBoardPath, int aShardCount,
+                            const std::vector<wxString>& aWorkerArgs, bool aParity )
+{
+    wxString              cli = kicadCliPath();
+    std::vector<wxString> commands;
+
+    for( int ii = 0; ii < aShardCount; ++ii )
+    {
+        wxString shardFile = wxFileName::CreateTempFileName( wxT( "kicad_drc_shard" ) );
+
+        if( shardFile.IsEmpty() )
+        {
+            m_reporter->Report( _( "Unable to create DRC shard file.\n" ), RPT_SEVERITY_ERROR );
+            return false;
+        }
+
+        AddShardFile( shardFile );
+
+        wxString cmd = quoteArg( cli );
+        cmd << wxS( " pcb drc" );
+        cmd << wxString::Format( wxS( " --shards %d --shard-index %d" ), aShardCount, ii );
+        cmd << wxS( " --output " ) << quoteArg( shardFile );
+
+        if( aParity && ii == 0 )
+            cmd << wxS( " --schematic-parity" );
+
+        for( const wxString& arg : aWorkerArgs )
+            cmd << wxS( " " ) << quoteArg( arg );
+
+        cmd << wxS( " " ) << quoteArg( aBoardPath );
+
+        commands.push_back( cmd );
+    }
+
+    m_reporter->Report( wxString::Format( _( "Running DRC in %d processes\n" ), aShardCount ),
+                        RPT_SEVERITY_INFO );
+
+    std::vector<int>         results( aShardCount, -1 );
+    std::vector<std::thread> workers;
+
+    for( int ii = 0; ii < aShardCount; ++ii )
+    {
+        workers.emplace_back(
+                [&commands, &results, ii]()
+                {
+                    results[ii] = runCommand( commands[ii] );
+                } );
+    }
+
+    for( std::thread& worker : workers )
+        worker.join();
+
+    bool ok = true;
+
+    for( int ii = 0; ii < aShardCount; ++ii )
+    {
+        if( results[ii] != 0 )
+        {
+            m_reporter->Report( wxString::Format( _( "DRC shard %d failed (exit code %d)\n" ),
+                                                  ii, results[ii] ),
+                                RPT_SEVERITY_ERROR );
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+
+bool DRC_SHARD_RUNNER::MergeResults( BOARD_COMMIT& aCommit, bool aReportAllTrackErrors )
+{
+    std::shared_ptr<DRC_ENGINE> drcEngine = m_board->GetDesignSettings().m_DRCEngine;
+
+    // Violations between items of different tiles are found by both shards, possibly with the
+    // items in a different order
+    using VIOLATION_KEY = std::tuple<wxString, std::vector<KIID>, int, int, int>;
+
+    std::set<VIOLATION_KEY> seen;
+
+    for( const wxString& shardFile : m_shardFiles )
+    {
+        nlohmann::json shard;
+
+        try
+        {
+            std::ifstream stream( shardFile.fn_str() );
+            shard = nlohmann::json::parse( stream );
+        }
+        catch( const std::exception& )
+        {
+            shard = nlohmann::json();
+        }
+
+        if( !shard.is_object() || shard.value( "version", 0 ) != SHARD_FILE_VERSION )
+        {
+            m_reporter->Report( wxString::Format( _( "Unable to read DRC shard file %s\n" ),
+                                                  shardFile ),
+                                RPT_SEVERITY_ERROR );
+            return false;
+        }
+
+        for( const nlohmann::json& entry : shard.at( "markers" ) )
+        {
+            std::shared_ptr<DRC_ITEM> drcItem = DRC_ITEM::Create(
+                    wxString::FromUTF8( entry.at( "type" ).get<std::string>() ) );
+
+            if( !drcItem )
+                continue;
+
+            std::vector<KIID> ids;
+
+            for( const nlohmann::json& id : entry.at( "items" ) )
+                ids.emplace_back( wxString::FromUTF8( id.get<std::string>() ) );
+
+            VECTOR2I pos( entry.at( "x" ).get<int>(), entry.at( "y" ).get<int>() );
+            int      layer = entry.at( "layer" ).get<int>();
+
+            std::vector<KIID> sortedIds = ids;
+            std::sort( sortedIds.begin(), sortedIds.end() );
+
+            VIOLATION_KEY key( drcItem->GetSettingsKey(), sortedIds, layer,
+                               aReportAllTrackErrors ? pos.x : 0,
+                               aReportAllTrackErrors ? pos.y : 0 );
+
+            if( !seen.insert( key ).second )
+                continue;
+
+            std::string message = entry.at( "message" ).get<std::string>();
+
+            drcItem->SetErrorMessage( wxString::FromUTF8( message ) );
+            drcItem->SetItems( ids );
+
+            if( entry.contains( "rule" ) )
+            {
+                wxString ruleName = wxString::FromUTF8( entry.at( "rule" ).get<std::string>() );
+                drcItem->SetViolatingRule( drcEngine->GetRule( ruleName ) );
+            }
+
+            aCommit.Add( new PCB_MARKER( drcItem, pos, layer ) );
+        }
+    }
+
+    return true;
+}
+
+
+bool DRC_SHARD_RUNNER::WriteShard( BOARD* aBoard, const wxString& aPath )
+{
+    std::ofstream stream( aPath.fn_str() );
+
+    if( !stream.is_open() )
+        return false;
+
+    nlohmann::json markers = nlohmann::json::array();
+
+    for( PCB_MARKER* marker : aBoard->Markers() )
+    {
+        std::shared_ptr<RC_ITEM> rcItem = marker->GetRCItem();
+        nlohmann::json           entry;
+        nlohmann::json           items = nlohmann::json::array();
+
+        for( const KIID& id : rcItem->GetIDs() )
+            items.push_back( id.AsStdString() );
+
+        entry["type"] = std::string( rcItem->GetSettingsKey().ToUTF8() );
+        entry["message"] = std::string( rcItem->GetErrorMessage( false ).ToUTF8() );
+        entry["items"] = items;
+        entry["x"] = marker->GetPos().x;
+        entry["y"] = marker->GetPos().y;
+        entry["layer"] = marker->GetMarkerType() == MARKER_BASE::MARKER_DRAWING_SHEET
+                                 ? (int) LAYER_DRAWINGSHEET
+                                 : (int) marker->GetLayer();
+
+        if( DRC_ITEM* drcItem = dynamic_cast<DRC_ITEM*>( rcItem.get() ) )
+        {
+            if( drcItem->GetViolatingRule() )
+                entry["rule"] = std::string( drcItem->GetViolatingRule()->m_Name.ToUTF8() );
+        }
+
+        markers.push_back( entry );
+    }
+
+    nlohmann::json shard;
+    shard["version"] = SHARD_FILE_VERSION;
+    shard["markers"] = markers;
+
+    stream << std::setw( 1 ) << shard << std::endl;
+
+    return stream.good();
+}
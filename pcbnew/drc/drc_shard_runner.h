@@ -0,0 +1,83 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <wx/string.h>
+
+class BOARD;
+class BOARD_COMMIT;
+class REPORTER;
+
+
+/**
+ * Runs DRC as several kicad-cli worker processes, each of which checks one tile of the board
+ * (see DRC_ENGINE::RunShardTests()) and writes its markers to a shard file, and merges their
+ * results.
+ */
+class DRC_SHARD_RUNNER
+{
+public:
+    DRC_SHARD_RUNNER( BOARD* aBoard, REPORTER* aReporter );
+    ~DRC_SHARD_RUNNER();
+
+    /**
+     * Launch the workers and wait for them to finish.
+     *
+     * @param aBoardPath is the board file the workers load.
+     * @param aShardCount is the number of worker processes.
+     * @param aWorkerArgs are extra kicad-cli "pcb drc" arguments passed to every worker.
+     * @param aParity requests schematic parity checks (which are run by the first shard only).
+     * @return false if a worker couldn't be run or failed.
+     */
+    bool Run( const wxString& aBoardPath, int aShardCount, const std::vector<wxString>& aWorkerArgs,
+              bool aParity );
+
+    /**
+     * Add a shard file written by WriteShard() to those read by MergeResults().  Run() adds the
+     * files of the workers it launches.  Shard files are deleted with the runner.
+     */
+    void AddShardFile( const wxString& aPath ) { m_shardFiles.push_back( aPath ); }
+
+    /**
+     * Stage markers for the violations found by the workers in aCommit.  Violations reported by
+     * more than one shard are only added once.
+     *
+     * @param aReportAllTrackErrors must match the workers' setting; when set, violations between
+     *                              the same items at different positions are kept.
+     * @return false if a shard file couldn't be read.
+     */
+    bool MergeResults( BOARD_COMMIT& aCommit, bool aReportAllTrackErrors );
+
+    /**
+     * Write the DRC markers of aBoard to a shard file (this is the worker's side of Run()).
+     */
+    static bool WriteShard( BOARD* aBoard, const wxString& aPath );
+
+private:
+    BOARD*                m_board;
+    REPORTER*             m_reporter;
+    std::vector<wxString> m_shardFiles;
+};
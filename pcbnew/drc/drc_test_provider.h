@@ -98,6 +98,14 @@ public:
 
     virtual const wxString GetName() const;
 
+    /**
+     * Providers which limit their tests to the engine's incremental scope (see
+     * DRC_ENGINE::RunIncrementalTests()) return the error codes they can generate here.
+     * Providers which always test the whole board return an empty set and are skipped by
+     * incremental runs.
+     */
+    virtual std::set<int> GetIncrementalErrorCodes() const { return {}; }
+
 protected:
     int forEachGeometryItem( const std::vector<KICAD_T>& aTypes, const LSET& aLayers,
                              const std::function<bool(BOARD_ITEM*)>& aFunc );
@@ -126,6 +134,15 @@ protected:
 
     bool isInvisibleText( const BOARD_ITEM* aItem ) const;
 
+    /**
+     * @return false if an incremental run is in progress and aItem is neither a changed item
+     *         nor one of their neighbours.
+     */
+    bool isInScope( const BOARD_ITEM* aItem ) const
+    {
+        return m_drcEngine->IsInIncrementalScope( aItem );
+    }
+
     wxString formatMsg( const wxString& aFormatString, const wxString& aSource, double aConstraint,
                         double aActual, EDA_DATA_TYPE aDataType = EDA_DATA_TYPE::DISTANCE );
     wxString formatMsg( const wxString& aFormatString, const wxString& aSource,
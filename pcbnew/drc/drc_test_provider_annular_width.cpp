@@ -54,6 +54,11 @@ public:
     virtual bool Run() override;
 
     virtual const wxString GetName() const override { return wxT( "annular_width" ); };
+
+    virtual std::set<int> GetIncrementalErrorCodes() const override
+    {
+        return { DRCE_ANNULAR_WIDTH };
+    }
 };
 
 
@@ -284,6 +289,9 @@ bool DRC_TEST_PROVIDER_ANNULAR_WIDTH::Run()
                 if( m_drcEngine->IsErrorLimitExceeded( DRCE_ANNULAR_WIDTH ) )
                     return false;
 
+                if( !isInScope( item ) )
+                    return true;
+
                 if( item->Type() == PCB_VIA_T )
                 {
                     PCB_VIA* via = static_cast<PCB_VIA*>( item );
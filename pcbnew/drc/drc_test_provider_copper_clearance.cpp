@@ -71,6 +71,12 @@ public:
 
     virtual const wxString GetName() const override { return wxT( "clearance" ); };
 
+    virtual std::set<int> GetIncrementalErrorCodes() const override
+    {
+        return { DRCE_CLEARANCE, DRCE_HOLE_CLEARANCE, DRCE_TRACKS_CROSSING, DRCE_ZONES_INTERSECT,
+                 DRCE_SHORTING_ITEMS };
+    }
+
 private:
     /**
      * Checks for track/via/hole <-> clearance
@@ -611,6 +617,12 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackClearances()
             {
                 PCB_TRACK* track = m_board->Tracks()[trackIdx];
 
+                if( !isInScope( track ) )
+                {
+                    done.fetch_add( 1 );
+                    return;
+                }
+
                 for( PCB_LAYER_ID layer : LSET( track->GetLayerSet() & boardCopperLayers ) )
                 {
                     std::shared_ptr<SHAPE> trackShape = track->GetEffectiveShape( layer );
@@ -959,6 +971,9 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadClearances( )
 
                 for( PAD* pad : footprint->Pads() )
                 {
+                    if( !isInScope( pad ) )
+                        continue;
+
                     for( PCB_LAYER_ID layer : LSET( pad->GetLayerSet() & boardCopperLayers ) )
                     {
                         if( m_drcEngine->IsCancelled() )
@@ -1141,7 +1156,7 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testGraphicClearances()
         (void)tp.submit_task(
                 [this, item, &done, testGraphicAgainstZone, testCopperGraphic]()
                 {
-                    if( !m_drcEngine->IsCancelled() )
+                    if( !m_drcEngine->IsCancelled() && isInScope( item ) )
                     {
                         testGraphicAgainstZone( item );
 
@@ -1163,7 +1178,7 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testGraphicClearances()
                 {
                     for( BOARD_ITEM* item : footprint->GraphicalItems() )
                     {
-                        if( !m_drcEngine->IsCancelled() )
+                        if( !m_drcEngine->IsCancelled() && isInScope( item ) )
                         {
                             testGraphicAgainstZone( item );
 
@@ -1352,6 +1367,9 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testZonesToZones()
                 if( zoneA->GetIsRuleArea() || zoneB->GetIsRuleArea() )
                     continue;
 
+                if( !isInScope( zoneA ) && !isInScope( zoneB ) )
+                    continue;
+
                 // Examine a candidate zone: compare zoneB to zoneA
                 SHAPE_POLY_SET* polyA = nullptr;
                 SHAPE_POLY_SET* polyB = nullptr;
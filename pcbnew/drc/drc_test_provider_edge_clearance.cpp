@@ -92,7 +92,8 @@ void DRC_TEST_PROVIDER_EDGE_CLEARANCE::resolveSilkDisposition( BOARD_ITEM* aItem
 
         for( const SHAPE* elem : compound->Shapes() )
         {
-            SILK_DISPOSITION elem_disposition = aBoardOutline.Contains( elem->Centre() ) ? ON_BOARD : OFF_BOARD;
+            bool             inside = aBoardOutline.Contains( elem->Centre(), -1, 0, true );
+            SILK_DISPOSITION elem_disposition = inside ? ON_BOARD : OFF_BOARD;
 
             if( disposition == UNKNOWN )
             {
@@ -107,7 +108,8 @@ void DRC_TEST_PROVIDER_EDGE_CLEARANCE::resolveSilkDisposition( BOARD_ITEM* aItem
     }
     else
     {
-        disposition = aBoardOutline.Contains( aItemShape->Centre() ) ? ON_BOARD : OFF_BOARD;
+        bool inside = aBoardOutline.Contains( aItemShape->Centre(), -1, 0, true );
+        disposition = inside ? ON_BOARD : OFF_BOARD;
     }
 
     m_silkDisposition[aItem] = disposition;
@@ -22,6 +22,9 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <atomic>
+#include <future>
+
 #include <wx/dir.h>
 #include <wx/ffile.h>
 #include <wx/log.h>
@@ -39,6 +42,7 @@
 #include <io/kicad/kicad_io_utils.h>
 #include <kiface_base.h>
 #include <layer_range.h>
+#include <lexer_snapshot.h>
 #include <macros.h>
 #include <pad.h>
 #include <pcb_dimension.h>
@@ -61,6 +65,7 @@
 #include <progress_reporter.h>
 #include <reporter.h>
 #include <string_utils.h>
+#include <thread_pool.h>
 #include <trace_helpers.h>
 #include <wildcards_and_files_ext.h>
 #include <zone.h>
@@ -73,6 +78,13 @@
 using namespace PCB_KEYS_T;
 
 
+/// Boards with fewer top level items than this are formatted on a single thread.
+static const size_t PARALLEL_SAVE_MIN_ITEMS = 1000;
+
+/// Number of top level items formatted by each thread pool task.
+static const size_t PARALLEL_SAVE_BATCH_SIZE = 100;
+
+
 FP_CACHE_ENTRY::FP_CACHE_ENTRY( FOOTPRINT* aFootprint, const WX_FILENAME& aFileName ) :
         m_filename( aFileName ),
         m_footprint( aFootprint )
@@ -179,7 +191,7 @@ void FP_CACHE::Load()
             // Queue I/O errors so only files that fail to parse don't get loaded.
             try
             {
-                FILE_LINE_READER reader( fn.GetFullPath() );
+                MMAP_LINE_READER reader( fn.GetFullPath() );
                 PCB_IO_KICAD_SEXPR_PARSER       parser( &reader, nullptr, nullptr );
 
                 FOOTPRINT* footprint = dynamic_cast<FOOTPRINT*>( parser.Parse() );
@@ -269,7 +281,7 @@ bool PCB_IO_KICAD_SEXPR::CanReadBoard( const wxString& aFileName ) const
 
     try
     {
-        FILE_LINE_READER reader( aFileName );
+        MMAP_LINE_READER reader( aFileName );
         PCB_IO_KICAD_SEXPR_PARSER       parser( &reader, nullptr, m_queryUserCallback );
 
         return parser.IsValidBoardHeader();
@@ -769,35 +781,36 @@ void PCB_IO_KICAD_SEXPR::format( const BOARD* aBoard ) const
                                                                    aBoard->Generators().end() );
     formatHeader( aBoard );
 
+    std::vector<const BOARD_ITEM*> items;
+
+    items.reserve( sorted_footprints.size() + sorted_drawings.size() + sorted_points.size()
+                   + sorted_tracks.size() + sorted_zones.size() + sorted_groups.size()
+                   + sorted_generators.size() );
+
     // Save the footprints.
-    for( BOARD_ITEM* footprint : sorted_footprints )
-        Format( footprint );
+    items.insert( items.end(), sorted_footprints.begin(), sorted_footprints.end() );
 
     // Save the graphical items on the board (not owned by a footprint)
-    for( BOARD_ITEM* item : sorted_drawings )
-        Format( item );
+    items.insert( items.end(), sorted_drawings.begin(), sorted_drawings.end() );
 
     // Save the points
-    for( PCB_POINT* point : sorted_points )
-        Format( point );
+    items.insert( items.end(), sorted_points.begin(), sorted_points.end() );
 
     // Do not save PCB_MARKERs, they can be regenerated easily.
 
     // Save the tracks and vias.
-    for( PCB_TRACK* track : sorted_tracks )
-        Format( track );
+    items.insert( items.end(), sorted_tracks.begin(), sorted_tracks.end() );
 
     // Save the polygon (which are the newer technology) zones.
-    for( auto zone : sorted_zones )
-        Format( zone );
+    items.insert( items.end(), sorted_zones.begin(), sorted_zones.end() );
 
     // Save the groups
-    for( BOARD_ITEM* group : sorted_groups )
-        Format( group );
+    items.insert( items.end(), sorted_groups.begin(), sorted_groups.end() );
 
     // Save the generators
-    for( BOARD_ITEM* gen : sorted_generators )
-        Format( gen );
+    items.insert( items.end(), sorted_generators.begin(), sorted_generators.end() );
+
+    formatItems( items );
 
     // Save any embedded files
     // Consolidate the embedded models in footprints into a single map
@@ -826,6 +839,130 @@ void PCB_IO_KICAD_SEXPR::format( const BOARD* aBoard ) const
 }
 
 
+void PCB_IO_KICAD_SEXPR::formatItems( const std::vector<const BOARD_ITEM*>& aItems ) const
+{
+    if( aItems.size() < PARALLEL_SAVE_MIN_ITEMS )
+    {
+        for( const BOARD_ITEM* item : aItems )
+            Format( item );
+
+        return;
+    }
+
+    enum BATCH_OWNER
+    {
+        UNCLAIMED,
+        WORKER,
+        CALLER
+    };
+
+    struct BATCH
+    {
+        size_t             first;
+        size_t             last;
+        std::atomic<int>   owner = UNCLAIMED;
+        std::future<void>  done;
+        std::string        text;
+        std::exception_ptr error;
+    };
+
+    auto formatBatch =
+            [&]( BATCH& aBatch )
+            {
+                try
+                {
+                    PCB_IO_KICAD_SEXPR formatter( m_ctl );
+                    STRING_FORMATTER   sf( OUTPUTFMTBUFZ, m_out->GetQuoteCharacter() );
+
+                    formatter.m_board = m_board;
+                    formatter.m_out = &sf;
+
+                    for( size_t ii = aBatch.first; ii < aBatch.last; ++ii )
+                        formatter.Format( aItems[ii] );
+
+                    aBatch.text = std::move( sf.MutableString() );
+                }
+                catch( ... )
+                {
+                    aBatch.error = std::current_exception();
+                }
+            };
+
+    std::vector<std::shared_ptr<BATCH>> batches;
+
+    for( size_t first = 0; first < aItems.size(); first += PARALLEL_SAVE_BATCH_SIZE )
+    {
+        std::shared_ptr<BATCH> batch = std::make_shared<BATCH>();
+
+        batch->first = first;
+        batch->last = std::min( first + PARALLEL_SAVE_BATCH_SIZE, aItems.size() );
+        batches.push_back( std::move( batch ) );
+    }
+
+    thread_pool& tp = GetKiCadThreadPool();
+    size_t       submitted = 0;
+
+    // Only run a few batches ahead of the output, so that the text waiting to be written stays
+    // proportional to the number of threads rather than to the size of the board.
+    const size_t lookAhead = std::max<size_t>( 2, tp.get_thread_count() * 4 );
+
+    // This thread formats the batches nobody has started when it gets to them, so a task may find
+    // nothing left to do
+    auto submitUpTo =
+            [&]( size_t aCount )
+            {
+                for( ; submitted < std::min( aCount, batches.size() ); ++submitted )
+                {
+                    std::shared_ptr<BATCH> batch = batches[submitted];
+
+                    batch->done = tp.submit_task(
+                            [batch, &formatBatch]()
+                            {
+                                int owner = UNCLAIMED;
+
+                                if( batch->owner.compare_exchange_strong( owner, WORKER ) )
+                                    formatBatch( *batch );
+                            } );
+                }
+            };
+
+    try
+    {
+        for( size_t ii = 0; ii < batches.size(); ++ii )
+        {
+            submitUpTo( ii + lookAhead );
+
+            BATCH& batch = *batches[ii];
+            int    owner = UNCLAIMED;
+
+            if( batch.owner.compare_exchange_strong( owner, CALLER ) )
+                formatBatch( batch );
+            else
+                batch.done.wait();
+
+            if( batch.error )
+                std::rethrow_exception( batch.error );
+
+            m_out->Write( batch.text );
+            batch.text = std::string();
+        }
+    }
+    catch( ... )
+    {
+        // Make sure no worker is still formatting before the items can go away
+        for( const std::shared_ptr<BATCH>& batch : batches )
+        {
+            int owner = UNCLAIMED;
+
+            if( !batch->owner.compare_exchange_strong( owner, CALLER ) && owner == WORKER )
+                batch->done.wait();
+        }
+
+        throw;
+    }
+}
+
+
 void PCB_IO_KICAD_SEXPR::format( const PCB_DIMENSION_BASE* aDimension ) const
 {
     const PCB_DIM_ALIGNED*    aligned = dynamic_cast<const PCB_DIM_ALIGNED*>( aDimension );
@@ -2932,6 +3069,20 @@ void PCB_IO_KICAD_SEXPR::format( const ZONE* aZone ) const
         }
     }
 
+    // Save the hashes of the fill inputs so that unchanged fills needn't be recomputed
+    if( aZone->IsFilled() )
+    {
+        for( PCB_LAYER_ID layer : aZone->GetLayerSet().Seq() )
+        {
+            if( std::optional<HASH_128> hash = aZone->GetFillInputHash( layer ) )
+            {
+                m_out->Print( "(fill_hash (layer %s) %s)",
+                              m_out->Quotew( LSET::Name( layer ) ).c_str(),
+                              m_out->Quotes( hash->ToString() ).c_str() );
+            }
+        }
+    }
+
     m_out->Print( ")" );
 }
 
@@ -2975,10 +3126,6 @@ BOARD* PCB_IO_KICAD_SEXPR::LoadBoard( const wxString& aFileName, BOARD* aAppendT
                                       const std::map<std::string, UTF8>* aProperties,
                                       PROJECT* aProject )
 {
-    FILE_LINE_READER reader( aFileName );
-
-    unsigned lineCount = 0;
-
     fontconfig::FONTCONFIG::SetReporter( &WXLOG_REPORTER::GetInstance() );
 
     if( m_progressReporter )
@@ -2987,14 +3134,68 @@ BOARD* PCB_IO_KICAD_SEXPR::LoadBoard( const wxString& aFileName, BOARD* aAppendT
 
         if( !m_progressReporter->KeepRefreshing() )
             THROW_IO_ERROR( _( "Open canceled by user." ) );
+    }
+
+    MMAP_LINE_READER reader( aFileName );
+
+    // A board appended to another isn't parsed the same way, so only whole boards are
+    // replayed from (or recorded to) a snapshot
+    wxString                               snapshotFile;
+    std::unique_ptr<LEXER_SNAPSHOT>        snapshot;
+    std::unique_ptr<LEXER_SNAPSHOT_WRITER> recorder;
+
+    if( !aAppendToMe && LEXER_SNAPSHOT::IsEnabled() )
+        snapshotFile = LEXER_SNAPSHOT::GetSnapshotFileName( reader );
 
-        while( reader.ReadLine() )
-            lineCount++;
+    if( !snapshotFile.IsEmpty() )
+    {
+        snapshot = LEXER_SNAPSHOT::Open( snapshotFile, aFileName );
+
+        if( !snapshot )
+            recorder = std::make_unique<LEXER_SNAPSHOT_WRITER>();
+    }
+
+    BOARD* board = nullptr;
+
+    if( snapshot )
+    {
+        STRING_LINE_READER replayReader( std::string(), aFileName );
+
+        try
+        {
+            board = DoLoad( replayReader, aAppendToMe, aProperties, m_progressReporter,
+                            snapshot->GetLineCount(), snapshot.get() );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            // A replayed token has no line text or offset to report, so read the file as text
+            // to give the error in full.  Should the snapshot have been at fault, this also
+            // replaces it.
+            wxLogTrace( traceKicadPcbPlugin, wxT( "Replaying '%s' failed: %s" ), snapshotFile,
+                        ioe.What() );
 
-        reader.Rewind();
+            recorder = std::make_unique<LEXER_SNAPSHOT_WRITER>();
+        }
     }
 
-    BOARD* board = DoLoad( reader, aAppendToMe, aProperties, m_progressReporter, lineCount );
+    if( !board )
+    {
+        unsigned lineCount = 0;
+
+        if( m_progressReporter )
+        {
+            while( reader.ReadLine() )
+                lineCount++;
+
+            reader.Rewind();
+        }
+
+        board = DoLoad( reader, aAppendToMe, aProperties, m_progressReporter, lineCount, nullptr,
+                        recorder.get() );
+
+        if( recorder )
+            recorder->Save( snapshotFile );
+    }
 
     // Give the filename to the board if it's new
     if( !aAppendToMe )
@@ -3006,7 +3207,9 @@ BOARD* PCB_IO_KICAD_SEXPR::LoadBoard( const wxString& aFileName, BOARD* aAppendT
 
 BOARD* PCB_IO_KICAD_SEXPR::DoLoad( LINE_READER& aReader, BOARD* aAppendToMe,
                                    const std::map<std::string, UTF8>* aProperties,
-                                   PROGRESS_REPORTER* aProgressReporter, unsigned aLineCount)
+                                   PROGRESS_REPORTER* aProgressReporter, unsigned aLineCount,
+                                   const LEXER_SNAPSHOT* aReplay,
+                                   LEXER_SNAPSHOT_WRITER* aRecorder )
 {
     init( aProperties );
 
@@ -3014,6 +3217,11 @@ BOARD* PCB_IO_KICAD_SEXPR::DoLoad( LINE_READER& aReader, BOARD* aAppendToMe,
                                       aProgressReporter, aLineCount );
     BOARD* board;
 
+    if( aReplay )
+        parser.SetReplay( aReplay );
+
+    parser.SetRecorder( aRecorder );
+
     try
     {
         board = dynamic_cast<BOARD*>( parser.Parse() );
@@ -42,6 +42,8 @@
 class BOARD;
 class BOARD_ITEM;
 class FP_CACHE;
+class LEXER_SNAPSHOT;
+class LEXER_SNAPSHOT_WRITER;
 class LSET;
 class PCB_IO_KICAD_SEXPR_PARSER;
 class BOARD_DESIGN_SETTINGS;
@@ -197,7 +199,8 @@ class PCB_IO_KICAD_SEXPR;   // forward decl
 //#define SEXPR_BOARD_FILE_VERSION    20250926  // Split via types into blind/buried/through
 //#define SEXPR_BOARD_FILE_VERSION    20251027  // Store pad-to-die delays with correct scaling
 //#define SEXPR_BOARD_FILE_VERSION      20251028  // Stop writing netcodes; they're an internal implementation detail
-#define SEXPR_BOARD_FILE_VERSION      20251101  // Backdrill and tertiary drill support
+//#define SEXPR_BOARD_FILE_VERSION    20251101  // Backdrill and tertiary drill support
+#define SEXPR_BOARD_FILE_VERSION      20251116  // Zone fill input hashes
 
 #define BOARD_FILE_HOST_VERSION       20200825  ///< Earlier files than this include the host tag
 #define LEGACY_ARC_FORMATTING         20210925  ///< These were the last to use old arc formatting
@@ -351,8 +354,16 @@ public:
                       const std::map<std::string, UTF8>* aProperties = nullptr,
                       PROJECT* aProject = nullptr ) override;
 
+    /**
+     * Parse a board from \a aReader.
+     *
+     * @param aReplay is a snapshot of the file to read instead of \a aReader, if any.
+     * @param aRecorder collects the tokens read for a new snapshot, if not nullptr.
+     */
     BOARD* DoLoad( LINE_READER& aReader, BOARD* aAppendToMe, const std::map<std::string,
-                   UTF8>* aProperties, PROGRESS_REPORTER* aProgressReporter, unsigned aLineCount );
+                   UTF8>* aProperties, PROGRESS_REPORTER* aProgressReporter, unsigned aLineCount,
+                   const LEXER_SNAPSHOT* aReplay = nullptr,
+                   LEXER_SNAPSHOT_WRITER* aRecorder = nullptr );
 
     void FootprintEnumerate( wxArrayString& aFootprintNames, const wxString& aLibraryPath,
                              bool aBestEfforts, const std::map<std::string,
@@ -413,6 +424,12 @@ public:
 
     void SetOutputFormatter( OUTPUTFORMATTER* aFormatter ) { m_out = aFormatter; }
 
+    /**
+     * Set the board the items passed to Format() belong to, as SaveBoard() does.  The layer
+     * names and copper layer count are taken from it.
+     */
+    void SetBoard( BOARD* aBoard ) { m_board = aBoard; }
+
     BOARD_ITEM* Parse( const wxString& aClipboardSourceInput );
 
 protected:
@@ -444,6 +461,12 @@ protected:
 private:
     void format( const BOARD* aBoard ) const;
 
+    /**
+     * Format \a aItems in order.  Large sets are formatted in batches on the thread pool and
+     * written out in the same order, so the output doesn't depend on the number of threads.
+     */
+    void formatItems( const std::vector<const BOARD_ITEM*>& aItems ) const;
+
     void format( const PCB_DIMENSION_BASE* aDimension ) const;
 
     void format( const PCB_REFERENCE_IMAGE* aBitmap ) const;
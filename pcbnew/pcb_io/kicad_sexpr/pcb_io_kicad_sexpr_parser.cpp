@@ -28,8 +28,12 @@
  */
 
 #include "layer_ids.h"
+#include <atomic>
 #include <cerrno>
 #include <charconv>
+#include <deque>
+#include <future>
+#include <optional>
 #include <confirm.h>
 #include <macros.h>
 #include <fmt/format.h>
@@ -71,6 +75,7 @@
 #include <stroke_params_parser.h>
 #include <wx/log.h>
 #include <progress_reporter.h>
+#include <thread_pool.h>
 #include <board_stackup_manager/stackup_predefined_prms.h>
 #include <pgm_base.h>
 
@@ -102,6 +107,9 @@ void PCB_IO_KICAD_SEXPR_PARSER::init()
     m_layerIndices.clear();
     m_layerMasks.clear();
     m_resetKIIDMap.clear();
+    m_deferNets = false;
+    m_deferredNets.clear();
+    m_deferredComponentClasses.clear();
 
     // Add untranslated default (i.e. English) layernames.
     // Some may be overridden later if parsing a board rather than a footprint.
@@ -144,7 +152,7 @@ void PCB_IO_KICAD_SEXPR_PARSER::checkpoint()
     if( m_progressReporter )
     {
         TIME_PT curTime = CLOCK::now();
-        unsigned curLine = reader->LineNumber();
+        unsigned curLine = CurLineNumber();
         auto delta = std::chrono::duration_cast<TIMEOUT>( curTime - m_lastProgressTime );
 
         if( delta > std::chrono::milliseconds( 250 ) )
@@ -323,18 +331,63 @@ void PCB_IO_KICAD_SEXPR_PARSER::parseNet( BOARD_CONNECTED_ITEM* aItem )
         if( m_requiredVersion < 20210606 )
             netName = ConvertToNewOverbarNotation( netName );
 
-        NETINFO_ITEM* netinfo = m_board->FindNet( netName );
+        setNet( aItem, netName );
+    }
+
+    NeedRIGHT();
+}
 
-        if( !netinfo )
-        {
-            netinfo = new NETINFO_ITEM( m_board, netName );
-            m_board->Add( netinfo, ADD_MODE::INSERT, true );
-        }
 
+void PCB_IO_KICAD_SEXPR_PARSER::setNet( BOARD_CONNECTED_ITEM* aItem, const wxString& aNetName )
+{
+    if( !m_deferNets )
+    {
+        aItem->SetNet( findOrCreateNet( aNetName ) );
+    }
+    else if( NETINFO_ITEM* netinfo = m_board->FindNet( aNetName ) )
+    {
         aItem->SetNet( netinfo );
     }
+    else
+    {
+        m_deferredNets.push_back( { aItem, aNetName } );
+    }
+}
 
-    NeedRIGHT();
+
+NETINFO_ITEM* PCB_IO_KICAD_SEXPR_PARSER::findOrCreateNet( const wxString& aNetName )
+{
+    NETINFO_ITEM* netinfo = m_board->FindNet( aNetName );
+
+    if( !netinfo )
+    {
+        netinfo = new NETINFO_ITEM( m_board, aNetName );
+        m_board->Add( netinfo, ADD_MODE::INSERT, true );
+    }
+
+    return netinfo;
+}
+
+
+void PCB_IO_KICAD_SEXPR_PARSER::resolveDeferredNet( const DEFERRED_NET& aDeferred )
+{
+    NETINFO_ITEM* netinfo = m_board->FindNet( aDeferred.netName );
+
+    if( !netinfo && aDeferred.legacyZoneNet )
+    {
+        // Same as parseZONE() does for a zone net name missing from a legacy file
+        int newnetcode = m_board->GetNetCount();
+        netinfo = new NETINFO_ITEM( m_board, aDeferred.netName, newnetcode );
+        m_board->Add( netinfo, ADD_MODE::INSERT, true );
+
+        pushValueIntoMap( newnetcode, netinfo->GetNetCode() );
+    }
+    else if( !netinfo )
+    {
+        netinfo = findOrCreateNet( aDeferred.netName );
+    }
+
+    aDeferred.item->SetNet( netinfo );
 }
 
 
@@ -935,6 +988,463 @@ BOARD_ITEM* PCB_IO_KICAD_SEXPR_PARSER::Parse()
 }
 
 
+/// Footprints, tracks, vias and zones are handed to the thread pool in batches of about this
+/// many bytes of file text.
+static const size_t PARALLEL_LOAD_BATCH_SIZE = 512 * 1024;
+
+/// When replaying a #LEXER_SNAPSHOT, each token counts as this many bytes of text towards a
+/// batch, which is about what a token takes in a board file.
+static const size_t PARALLEL_LOAD_TOKEN_SIZE = 6;
+
+/// Older boards are parsed on one thread, as their zones can change board-wide settings
+/// (legacy teardrops) while they are read.
+static const int PARALLEL_LOAD_MIN_VERSION = 20230517;
+
+
+/**
+ * Read a top-level list cut out of a board file, reporting the line numbers it had there.
+ */
+class BOARD_CHUNK_LINE_READER : public STRING_LINE_READER
+{
+public:
+    BOARD_CHUNK_LINE_READER( const std::string& aText, const wxString& aSource,
+                             unsigned aFirstLine ) :
+            STRING_LINE_READER( aText, aSource )
+    {
+        m_lineNum = aFirstLine - 1;
+    }
+};
+
+
+/**
+ * Parse the footprints, tracks, vias and zones of a board on the thread pool.
+ *
+ * Tokenizing and building these items is where the time goes when loading a large board.  As
+ * the board parser reaches one of them it only scans for the matching closing parenthesis and
+ * keeps the text, which is parsed later by a worker with its own copy of the parser state.  The
+ * items are attached to the board in file order, after all the workers are done.
+ *
+ * Workers only read from the board.  Nets which don't exist yet are recorded by all the parsers
+ * (see #DEFERRED_NET) and created when attaching, in the order a sequential load would have
+ * created them; the component classes of footprints are also resolved then.  Sections the
+ * workers depend on (layers, setup, nets and net classes) wait for the batches in flight to be
+ * attached first.
+ */
+class PCB_IO_KICAD_SEXPR_PARSER::PARALLEL_LOADER
+{
+public:
+    PARALLEL_LOADER( PCB_IO_KICAD_SEXPR_PARSER& aParser ) :
+            m_parser( aParser ),
+            m_source( aParser.CurSource() ),
+            m_cancelled( false )
+    {
+    }
+
+    ~PARALLEL_LOADER()
+    {
+        // Only batches abandoned by an exception are left: make sure no worker is still using
+        // the board before it goes away.
+        m_cancelled = true;
+
+        for( const std::shared_ptr<BATCH>& batch : m_batches )
+        {
+            int owner = UNCLAIMED;
+
+            if( !batch->owner.compare_exchange_strong( owner, MAIN_THREAD ) && owner == WORKER )
+                batch->done.wait();
+        }
+    }
+
+    /// @return true if the list starting with \a aToken is parsed by a worker.
+    static bool Defers( T aToken )
+    {
+        return aToken == T_module || aToken == T_footprint || aToken == T_segment
+               || aToken == T_arc || aToken == T_via || aToken == T_zone;
+    }
+
+    /// @return true if workers can't run past the section starting with \a aToken.
+    static bool IsBarrier( T aToken )
+    {
+        return aToken == T_general || aToken == T_layers || aToken == T_setup
+               || aToken == T_net || aToken == T_net_class;
+    }
+
+    /**
+     * Take the text of the list the parser is in, whose keyword it has just read, and leave the
+     * parser after its closing parenthesis.  When replaying a snapshot, take its tokens instead.
+     */
+    void Capture()
+    {
+        PCB_IO_KICAD_SEXPR_PARSER& p = m_parser;
+        CHUNK                      chunk;
+
+        chunk.lineNumber = p.CurLineNumber();
+        chunk.mainNetsBefore = p.m_deferredNets.size();
+
+        if( p.IsReplaying() )
+        {
+            size_t size = captureTokens( chunk );
+            add( std::move( chunk ), size );
+            return;
+        }
+
+        // Keep the columns of the first line for error messages, but not whatever came before
+        // the opening parenthesis
+        std::string& text = chunk.text;
+        text.assign( p.start, p.next );
+
+        size_t open = text.rfind( '(' );
+
+        wxCHECK2( open != std::string::npos, open = 0 );
+        std::fill( text.begin(), text.begin() + open, ' ' );
+
+        const char* cur = p.next;
+        int         depth = 1;
+
+        while( true )
+        {
+            const char* lineStart = cur;
+            bool        inString = false;
+            bool        tokenStart = true;
+
+            for( ; cur < p.limit && depth > 0; ++cur )
+            {
+                char c = *cur;
+
+                if( inString )
+                {
+                    if( c == '\\' && cur + 1 < p.limit )
+                        ++cur;
+                    else if( c == '"' )
+                        inString = false;
+                }
+                else if( c == '"' && tokenStart )
+                {
+                    inString = true;
+                }
+                else if( c == '(' )
+                {
+                    ++depth;
+                }
+                else if( c == ')' )
+                {
+                    --depth;
+                }
+
+                tokenStart = !inString && ( c == '"' || c == '(' || c == ')' || isSpace( c ) );
+            }
+
+            text.append( lineStart, cur );
+
+            if( depth == 0 )
+                break;
+
+            if( !p.readLine() )
+            {
+                THROW_PARSE_ERROR( _( "Unexpected end of file" ), p.CurSource(), p.CurLine(),
+                                   p.CurLineNumber(), p.CurOffset() );
+            }
+
+            cur = p.start;
+
+            // Comment lines are skipped by the lexer, parentheses and all
+            const char* first = cur;
+
+            while( first < p.limit && isSpace( *first ) )
+                ++first;
+
+            if( first < p.limit && *first == '#' )
+                cur = p.limit;
+        }
+
+        p.next = cur;
+
+        size_t size = chunk.text.size();
+        add( std::move( chunk ), size );
+    }
+
+    /**
+     * Wait for all the batches captured so far to be parsed and attach their items to the board,
+     * along with the nets deferred by the board parser.
+     *
+     * @throw the first error met by a worker, in file order.
+     */
+    void Flush( std::vector<BOARD_ITEM*>& aBulkAddedItems )
+    {
+        submit();
+
+        for( const std::shared_ptr<BATCH>& batch : m_batches )
+        {
+            int owner = UNCLAIMED;
+
+            if( batch->owner.compare_exchange_strong( owner, MAIN_THREAD ) )
+            {
+                parse( *batch );
+            }
+            else
+            {
+                while( batch->done.wait_for( std::chrono::milliseconds( 100 ) )
+                       != std::future_status::ready )
+                {
+                    if( m_parser.m_progressReporter
+                        && !m_parser.m_progressReporter->KeepRefreshing() )
+                    {
+                        THROW_IO_ERROR( _( "Open canceled by user." ) );
+                    }
+                }
+            }
+        }
+
+        size_t mainNets = 0;
+
+        auto resolveMainNets =
+                [&]( size_t aCount )
+                {
+                    for( ; mainNets < aCount; ++mainNets )
+                    {
+                        m_parser.resolveDeferredNet( m_parser.m_deferredNets[mainNets] );
+                    }
+                };
+
+        while( !m_batches.empty() )
+        {
+            BATCH& batch = *m_batches.front();
+
+            m_parser.m_requiredVersion = std::max( m_parser.m_requiredVersion,
+                                                   batch.requiredVersion );
+            m_parser.m_tooRecent = ( m_parser.m_requiredVersion > SEXPR_BOARD_FILE_VERSION );
+
+            if( batch.error )
+                std::rethrow_exception( batch.error );
+
+            for( CHUNK& chunk : batch.chunks )
+            {
+                resolveMainNets( chunk.mainNetsBefore );
+
+                for( const DEFERRED_NET& deferred : chunk.nets )
+                    m_parser.resolveDeferredNet( deferred );
+
+                for( FOOTPRINT* footprint : chunk.componentClasses )
+                {
+                    footprint->ResolveComponentClassNames(
+                            m_parser.m_board, footprint->GetTransientComponentClassNames() );
+                }
+
+                if( chunk.item )
+                {
+                    BOARD_ITEM* item = chunk.item.release();
+
+                    m_parser.m_board->Add( item, ADD_MODE::BULK_APPEND, true );
+                    aBulkAddedItems.push_back( item );
+                }
+            }
+
+            for( GROUP_INFO& groupInfo : batch.groupInfos )
+                m_parser.m_groupInfos.push_back( std::move( groupInfo ) );
+
+            m_parser.m_undefinedLayers.insert( batch.undefinedLayers.begin(),
+                                               batch.undefinedLayers.end() );
+
+            m_batches.pop_front();
+        }
+
+        resolveMainNets( m_parser.m_deferredNets.size() );
+        m_parser.m_deferredNets.clear();
+
+        for( FOOTPRINT* footprint : m_parser.m_deferredComponentClasses )
+        {
+            footprint->ResolveComponentClassNames( m_parser.m_board,
+                                                   footprint->GetTransientComponentClassNames() );
+        }
+
+        m_parser.m_deferredComponentClasses.clear();
+    }
+
+private:
+    enum BATCH_OWNER
+    {
+        UNCLAIMED,
+        WORKER,
+        MAIN_THREAD
+    };
+
+    struct CHUNK
+    {
+        std::string                 text;
+        unsigned                    lineNumber;      ///< of the first line of text in the file
+        size_t                      firstToken = 0;  ///< when replaying, the tokens of the list
+        size_t                      lastToken = 0;
+        size_t                      mainNetsBefore;  ///< nets deferred by the board parser so far
+        std::unique_ptr<BOARD_ITEM> item;
+        std::vector<DEFERRED_NET>   nets;
+        std::vector<FOOTPRINT*>     componentClasses;  ///< footprints of item to resolve
+    };
+
+    struct BATCH
+    {
+        std::vector<CHUNK>      chunks;
+        size_t                  bytes = 0;
+        std::atomic<int>        owner = UNCLAIMED;
+        std::future<void>       done;
+
+        std::vector<GROUP_INFO> groupInfos;
+        std::set<wxString>      undefinedLayers;
+        int                     requiredVersion = 0;
+        std::exception_ptr      error;
+    };
+
+    static bool isSpace( char c )
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\0';
+    }
+
+    /// Add a captured chunk of about \a aSize bytes to the batch being captured.
+    void add( CHUNK&& aChunk, size_t aSize )
+    {
+        if( !m_current )
+            m_current = std::make_shared<BATCH>();
+
+        m_current->bytes += aSize;
+        m_current->chunks.push_back( std::move( aChunk ) );
+
+        if( m_current->bytes >= PARALLEL_LOAD_BATCH_SIZE )
+            submit();
+    }
+
+    /// Capture() when replaying a #LEXER_SNAPSHOT: the chunk is the range of tokens of the list.
+    size_t captureTokens( CHUNK& aChunk )
+    {
+        PCB_IO_KICAD_SEXPR_PARSER& p = m_parser;
+        size_t                     cur = p.m_replayNext;
+        int                        depth = 1;
+
+        // The opening parenthesis and the keyword were the last tokens replayed
+        aChunk.firstToken = cur - 2;
+
+        while( depth > 0 )
+        {
+            if( cur >= p.m_replayEnd )
+            {
+                THROW_PARSE_ERROR( _( "Unexpected end of file" ), p.CurSource(), p.CurLine(),
+                                   p.CurLineNumber(), p.CurOffset() );
+            }
+
+            int tok = p.m_replay->GetTok( cur++ );
+
+            if( tok == DSN_LEFT )
+                ++depth;
+            else if( tok == DSN_RIGHT )
+                --depth;
+        }
+
+        aChunk.lastToken = cur;
+        p.m_replayNext = cur;
+
+        return ( aChunk.lastToken - aChunk.firstToken ) * PARALLEL_LOAD_TOKEN_SIZE;
+    }
+
+    void submit()
+    {
+        if( !m_current )
+            return;
+
+        std::shared_ptr<BATCH> batch = std::move( m_current );
+
+        m_batches.push_back( batch );
+
+        // The main thread takes the batches nobody has started when it needs them, so the task
+        // may find nothing left to do (and this loader gone)
+        batch->done = GetKiCadThreadPool().submit_task(
+                [this, batch]()
+                {
+                    int owner = UNCLAIMED;
+
+                    if( batch->owner.compare_exchange_strong( owner, WORKER ) )
+                        parse( *batch );
+                } );
+    }
+
+    void parse( BATCH& aBatch )
+    {
+        const PCB_IO_KICAD_SEXPR_PARSER& boardParser = m_parser;
+
+        try
+        {
+            PCB_IO_KICAD_SEXPR_PARSER parser( nullptr, boardParser.m_board, nullptr );
+
+            parser.m_appendToExisting = false;
+            parser.m_layerIndices = boardParser.m_layerIndices;
+            parser.m_layerMasks = boardParser.m_layerMasks;
+            parser.m_netCodes = boardParser.m_netCodes;
+            parser.m_requiredVersion = boardParser.m_requiredVersion;
+            parser.m_tooRecent = boardParser.m_tooRecent;
+            parser.m_generatorVersion = boardParser.m_generatorVersion;
+            parser.m_deferNets = true;
+            parser.SetKnowsBar( boardParser.m_knowsBar );
+
+            for( CHUNK& chunk : aBatch.chunks )
+            {
+                if( m_cancelled )
+                    return;
+
+                std::optional<BOARD_CHUNK_LINE_READER> reader;
+                BOARD_ITEM*                            item = nullptr;
+
+                if( boardParser.m_replay )
+                {
+                    parser.SetReplay( boardParser.m_replay, chunk.firstToken, chunk.lastToken );
+                }
+                else
+                {
+                    reader.emplace( chunk.text, m_source, chunk.lineNumber );
+                    parser.PushReader( &*reader );
+                }
+
+                parser.NeedLEFT();
+
+                switch( parser.NextTok() )
+                {
+                case T_module:      // legacy token
+                case T_footprint: item = parser.parseFOOTPRINT();                 break;
+                case T_segment:   item = parser.parsePCB_TRACK();                 break;
+                case T_arc:       item = parser.parseARC();                       break;
+                case T_via:       item = parser.parsePCB_VIA();                   break;
+                case T_zone:      item = parser.parseZONE( boardParser.m_board ); break;
+                default:          parser.Expecting( "footprint, segment, arc, via or zone" );
+                }
+
+                if( reader )
+                    parser.PopReader();
+                else
+                    parser.SetReplay( nullptr );
+
+                chunk.item.reset( item );
+                chunk.nets = std::move( parser.m_deferredNets );
+                parser.m_deferredNets.clear();
+                chunk.componentClasses = std::move( parser.m_deferredComponentClasses );
+                parser.m_deferredComponentClasses.clear();
+
+                std::string().swap( chunk.text );
+            }
+
+            aBatch.groupInfos = std::move( parser.m_groupInfos );
+            aBatch.undefinedLayers = std::move( parser.m_undefinedLayers );
+            aBatch.requiredVersion = parser.m_requiredVersion;
+        }
+        catch( ... )
+        {
+            aBatch.error = std::current_exception();
+        }
+    }
+
+    PCB_IO_KICAD_SEXPR_PARSER&          m_parser;
+    wxString                            m_source;    ///< file name, for error messages
+    std::atomic<bool>                   m_cancelled;
+    std::shared_ptr<BATCH>              m_current;   ///< batch being captured
+    std::deque<std::shared_ptr<BATCH>>  m_batches;   ///< batches handed to the thread pool
+};
+
+
 BOARD* PCB_IO_KICAD_SEXPR_PARSER::parseBOARD()
 {
     try
@@ -971,6 +1481,15 @@ BOARD* PCB_IO_KICAD_SEXPR_PARSER::parseBOARD_unchecked()
     std::vector<BOARD_ITEM*> bulkAddedItems;
     BOARD_ITEM* item = nullptr;
 
+    std::unique_ptr<PARALLEL_LOADER> parallelLoader;
+
+    // A snapshot has to be recorded in the order the parser reads the file
+    if( !m_appendToExisting && !IsRecording() && m_requiredVersion >= PARALLEL_LOAD_MIN_VERSION )
+    {
+        parallelLoader = std::make_unique<PARALLEL_LOADER>( *this );
+        m_deferNets = true;
+    }
+
     for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
     {
         checkpoint();
@@ -983,6 +1502,18 @@ BOARD* PCB_IO_KICAD_SEXPR_PARSER::parseBOARD_unchecked()
         if( token == T_page && m_requiredVersion <= 20200119 )
             token = T_paper;
 
+        if( parallelLoader )
+        {
+            if( PARALLEL_LOADER::Defers( token ) )
+            {
+                parallelLoader->Capture();
+                continue;
+            }
+
+            if( PARALLEL_LOADER::IsBarrier( token ) )
+                parallelLoader->Flush( bulkAddedItems );
+        }
+
         switch( token )
         {
         case T_host:            // legacy token
@@ -1187,6 +1718,12 @@ BOARD* PCB_IO_KICAD_SEXPR_PARSER::parseBOARD_unchecked()
         }
     }
 
+    if( parallelLoader )
+    {
+        parallelLoader->Flush( bulkAddedItems );
+        m_deferNets = false;
+    }
+
     if( bulkAddedItems.size() > 0 )
         m_board->FinalizeBulkAdd( bulkAddedItems );
 
@@ -5332,7 +5869,11 @@ FOOTPRINT* PCB_IO_KICAD_SEXPR_PARSER::parseFOOTPRINT_unchecked( wxArrayString* a
 
             footprint->SetTransientComponentClassNames( componentClassNames );
 
-            if( m_board )
+            // The component class manager caches what it resolves, so workers leave it to the
+            // main thread
+            if( m_deferNets )
+                m_deferredComponentClasses.push_back( footprint.get() );
+            else if( m_board )
                 footprint->ResolveComponentClassNames( m_board, componentClassNames );
 
             break;
@@ -5785,15 +6326,7 @@ PAD* PCB_IO_KICAD_SEXPR_PARSER::parsePAD( FOOTPRINT* aParent )
                 }
                 else
                 {
-                    NETINFO_ITEM* netinfo = m_board->FindNet( netName );
-
-                    if( !netinfo )
-                    {
-                        netinfo = new NETINFO_ITEM( m_board, netName );
-                        m_board->Add( netinfo, ADD_MODE::INSERT, true );
-                    }
-
-                    pad->SetNet( netinfo );
+                    setNet( pad, netName );
                 }
             }
 
@@ -7543,6 +8076,7 @@ ZONE* PCB_IO_KICAD_SEXPR_PARSER::parseZONE( BOARD_ITEM_CONTAINER* aParent )
     // bigger scope since each filled_polygon is concatenated in here
     std::map<PCB_LAYER_ID, SHAPE_POLY_SET> pts;
     std::map<PCB_LAYER_ID, std::vector<SEG>> legacySegs;
+    std::map<PCB_LAYER_ID, HASH_128>         fillInputHashes;
     PCB_LAYER_ID filledLayer;
     bool         addedFilledPolygons = false;
 
@@ -8032,6 +8566,28 @@ ZONE* PCB_IO_KICAD_SEXPR_PARSER::parseZONE( BOARD_ITEM_CONTAINER* aParent )
 
             break;
 
+        case T_fill_hash:
+        {
+            // "(fill_hash (layer F.Cu) "0123...")"
+            NeedLEFT();
+            token = NextTok();
+
+            if( token != T_layer )
+                Expecting( T_layer );
+
+            PCB_LAYER_ID hashLayer = parseBoardItemLayer();
+            NeedRIGHT();
+
+            NeedSYMBOL();
+            HASH_128 hash;
+
+            if( hash.FromString( CurStr() ) )
+                fillInputHashes[hashLayer] = hash;
+
+            NeedRIGHT();
+            break;
+        }
+
         case T_fill_segments:
         {
             // Legacy segment fill
@@ -8157,7 +8713,7 @@ ZONE* PCB_IO_KICAD_SEXPR_PARSER::parseZONE( BOARD_ITEM_CONTAINER* aParent )
         }
 
         for( auto& [layer, polyset] : pts )
-            zone->SetFilledPolysList( layer, polyset );
+            zone->SetFilledPolysList( layer, std::move( polyset ) );
 
         zone->CalculateFilledArea();
     }
@@ -8194,11 +8750,18 @@ ZONE* PCB_IO_KICAD_SEXPR_PARSER::parseZONE( BOARD_ITEM_CONTAINER* aParent )
             }
 
 
-            zone->SetFilledPolysList( layer, layerFill );
+            zone->SetFilledPolysList( layer, std::move( layerFill ) );
             zone->CalculateFilledArea();
         }
     }
 
+    // The recorded fill inputs are only meaningful alongside the fill they produced
+    if( zone->IsFilled() )
+    {
+        for( const auto& [layer, hash] : fillInputHashes )
+            zone->SetFillInputHash( layer, hash );
+    }
+
 
     // Ensure keepout and non copper zones do not have a net
     // (which have no sense for these zones)
@@ -8220,6 +8783,11 @@ ZONE* PCB_IO_KICAD_SEXPR_PARSER::parseZONE( BOARD_ITEM_CONTAINER* aParent )
         {
             zone->SetNetCode( net->GetNetCode() );
         }
+        else if( m_deferNets )
+        {
+            // The net is added, and its code mapped, once the other threads are done
+            m_deferredNets.push_back( { zone.get(), legacyNetnameFromFile, true } );
+        }
         else    // Not existing net: add a new net to keep track of the zone netname
         {
             int newnetcode = m_board->GetNetCount();
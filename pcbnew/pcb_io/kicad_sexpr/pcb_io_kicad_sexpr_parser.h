@@ -51,6 +51,7 @@ class BOARD;
 class BOARD_ITEM;
 class ZONE_SETTINGS;
 class BOARD_CONNECTED_ITEM;
+class NETINFO_ITEM;
 class BOARD_ITEM_CONTAINER;
 class PAD;
 class BOARD_DESIGN_SETTINGS;
@@ -159,6 +160,19 @@ private:
         STRING_ANY_MAP properties;
     };
 
+    // Items parsed on the thread pool can't add nets to the board while other threads look
+    // them up, so a net which doesn't exist yet is recorded here and assigned afterwards.
+    struct DEFERRED_NET
+    {
+        BOARD_CONNECTED_ITEM* item;
+        wxString              netName;
+        bool                  legacyZoneNet = false;  ///< map the net code of a new net
+    };
+
+    /// Cuts footprints, tracks, vias and zones out of a board file and parses them on the
+    /// thread pool.
+    class PARALLEL_LOADER;
+
     ///< Convert net code using the mapping table if available,
     ///< otherwise returns unchanged net code if < 0 or if it's out of range
     inline int getNetCode( int aNetCode )
@@ -403,6 +417,18 @@ private:
 
     void parseNet( BOARD_CONNECTED_ITEM* aItem );
 
+    /**
+     * Assign the net named \a aNetName to \a aItem, adding the net to the board if it doesn't
+     * exist yet (or deferring that if #m_deferNets is set).
+     */
+    void setNet( BOARD_CONNECTED_ITEM* aItem, const wxString& aNetName );
+
+    /// @return the net named \a aNetName, which is added to the board if it doesn't exist yet.
+    NETINFO_ITEM* findOrCreateNet( const wxString& aNetName );
+
+    /// Assign a net recorded while #m_deferNets was set, as the item's parser would have.
+    void resolveDeferredNet( const DEFERRED_NET& aDeferred );
+
     /*
      * @return if m_appendToExisting, returns new KIID(), otherwise returns CurStr() as KIID.
      */
@@ -446,6 +472,12 @@ private:
     std::vector<GROUP_INFO>     m_groupInfos;
     std::vector<GENERATOR_INFO> m_generatorInfos;
 
+    /// Parsing on a worker thread: don't add nets to the board or resolve component classes,
+    /// which aren't safe to do while other threads read the board.
+    bool                      m_deferNets;
+    std::vector<DEFERRED_NET> m_deferredNets;             ///< nets to assign once parsing is done
+    std::vector<FOOTPRINT*>   m_deferredComponentClasses; ///< footprints to resolve afterwards
+
     std::function<bool( wxString aTitle, int aIcon, wxString aMsg, wxString aAction )> m_queryUserCallback;
 };
 
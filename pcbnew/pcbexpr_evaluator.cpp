@@ -530,6 +530,9 @@ LIBEVAL::FUNC_CALL_REF PCBEXPR_UCODE::CreateFuncCall( const wxString& aName )
 {
     PCBEXPR_BUILTIN_FUNCTIONS& registry = PCBEXPR_BUILTIN_FUNCTIONS::Instance();
 
+    if( aName.Lower() == wxT( "iscoupleddiffpair" ) )
+        m_itemRefs |= 0x3;
+
     return registry.Get( aName.Lower() );
 }
 
@@ -540,6 +543,13 @@ std::unique_ptr<LIBEVAL::VAR_REF> PCBEXPR_UCODE::CreateVarRef( const wxString& a
     PROPERTY_MANAGER& propMgr = PROPERTY_MANAGER::Instance();
     std::unique_ptr<PCBEXPR_VAR_REF> vref;
 
+    if( aVar == wxT( "A" ) )
+        m_itemRefs |= 0x1;
+    else if( aVar == wxT( "B" ) )
+        m_itemRefs |= 0x2;
+    else if( aVar == wxT( "AB" ) )
+        m_itemRefs |= 0x3;
+
     if( aVar.IsSameAs( wxT( "null" ), false ) )
     {
         vref = std::make_unique<PCBEXPR_VAR_REF>( 0 );
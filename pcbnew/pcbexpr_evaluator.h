@@ -42,12 +42,24 @@ class PCBEXPR_VAR_REF;
 class PCBEXPR_UCODE final : public LIBEVAL::UCODE
 {
 public:
-    PCBEXPR_UCODE() {};
+    PCBEXPR_UCODE() :
+            m_itemRefs( 0 )
+    {};
+
     virtual ~PCBEXPR_UCODE() {};
 
     virtual std::unique_ptr<LIBEVAL::VAR_REF> CreateVarRef( const wxString& aVar,
                                                             const wxString& aField ) override;
     virtual LIBEVAL::FUNC_CALL_REF CreateFuncCall( const wxString& aName ) override;
+
+    /**
+     * Items referenced by the compiled code: bit 0 for A, bit 1 for B.  Functions which
+     * implicitly compare both items set both bits.
+     */
+    int GetItemRefs() const { return m_itemRefs; }
+
+private:
+    int m_itemRefs;
 };
 
 
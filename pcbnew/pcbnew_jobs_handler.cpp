@@ -25,6 +25,7 @@
 #include <board_statistics_report.h>
 #include <drc/drc_item.h>
 #include <drc/drc_report.h>
+#include <drc/drc_shard_runner.h>
 #include <drawing_sheet/ds_data_model.h>
 #include <drawing_sheet/ds_proxy_view_item.h>
 #include <jobs/job_fp_export_svg.h>
@@ -46,6 +47,7 @@
 #include <jobs/job_export_pcb_3d.h>
 #include <jobs/job_pcb_render.h>
 #include <jobs/job_pcb_drc.h>
+#include <jobs/job_pcb_route.h>
 #include <jobs/job_pcb_upgrade.h>
 #include <eda_units.h>
 #include <lset.h>
@@ -104,6 +106,7 @@
 #include <tools/zone_filler_tool.h>
 
 #include "pcbnew_scripting_helpers.h"
+#include <router/pns_batch_router.h>
 #include <locale_io.h>
 #include <confirm.h>
 
@@ -149,6 +152,11 @@ PCBNEW_JOBS_HANDLER::PCBNEW_JOBS_HANDLER( KIWAY* aKiway ) :
               {
                   return true;
               } );
+    Register( "route", std::bind( &PCBNEW_JOBS_HANDLER::JobRoute, this, std::placeholders::_1 ),
+              []( JOB* job, wxWindow* aParent ) -> bool
+              {
+                  return true;
+              } );
     Register( "svg", std::bind( &PCBNEW_JOBS_HANDLER::JobExportSvg, this, std::placeholders::_1 ),
               [aKiway]( JOB* job, wxWindow* aParent ) -> bool
               {
@@ -2268,7 +2276,19 @@ int PCBNEW_JOBS_HANDLER::JobExportDrc( JOB* aJob )
     bool         checkParity = drcJob->m_parity;
     std::string  netlist_str;
 
-    if( checkParity )
+    // When sharding, the worker processes load the board and schematic themselves and this one
+    // only merges their results
+    bool sharded = drcJob->m_shardCount > 1 && drcJob->m_shardIndex < 0;
+    bool shardWorker = drcJob->m_shardIndex >= 0;
+
+    if( sharded && drcJob->m_saveBoard )
+    {
+        m_reporter->Report( _( "Saving the board is not supported when DRC is sharded.\n" ),
+                            RPT_SEVERITY_ERROR );
+        return CLI::EXIT_CODES::ERR_ARGS;
+    }
+
+    if( checkParity && !sharded )
     {
         wxString annotateMsg = _( "Schematic parity tests require a fully annotated schematic." );
         netlist_str = annotateMsg;
@@ -2312,7 +2332,7 @@ int PCBNEW_JOBS_HANDLER::JobExportDrc( JOB* aJob )
         }
     }
 
-    if( checkParity )
+    if( checkParity && !sharded )
     {
         try
         {
@@ -2332,7 +2352,7 @@ int PCBNEW_JOBS_HANDLER::JobExportDrc( JOB* aJob )
         drcEngine->SetSchematicNetlist( netlist.get() );
     }
 
-    if( drcJob->m_refillZones )
+    if( drcJob->m_refillZones && !sharded )
     {
         if( !toolManager->FindTool( ZONE_FILLER_TOOL_NAME ) )
             toolManager->RegisterTool( new ZONE_FILLER_TOOL );
@@ -2350,13 +2370,92 @@ int PCBNEW_JOBS_HANDLER::JobExportDrc( JOB* aJob )
                 commit.Add( marker );
             } );
 
+    drcEngine->SetProfilingEnabled( !drcJob->m_profileOutputPath.IsEmpty() );
+
     brd->RecordDRCExclusions();
     brd->DeleteMARKERs( true, true );
-    drcEngine->RunTests( units, drcJob->m_reportAllTrackErrors, checkParity );
+
+    if( sharded )
+    {
+        std::vector<wxString> workerArgs;
+
+        // The workers format the violation messages
+        workerArgs.push_back( wxS( "--units" ) );
+
+        switch( units )
+        {
+        case EDA_UNITS::INCH: workerArgs.push_back( wxS( "in" ) );   break;
+        case EDA_UNITS::MILS: workerArgs.push_back( wxS( "mils" ) ); break;
+        default:              workerArgs.push_back( wxS( "mm" ) );   break;
+        }
+
+        if( drcJob->m_refillZones )
+            workerArgs.push_back( wxS( "--refill-zones" ) );
+
+        if( drcJob->m_reportAllTrackErrors )
+            workerArgs.push_back( wxS( "--all-track-errors" ) );
+
+        for( const auto& [name, value] : drcJob->GetVarOverrides() )
+        {
+            workerArgs.push_back( wxS( "--define-var" ) );
+            workerArgs.push_back( name + wxS( "=" ) + value );
+        }
+
+        DRC_SHARD_RUNNER shardRunner( brd, m_reporter );
+
+        if( !shardRunner.Run( drcJob->m_filename, drcJob->m_shardCount, workerArgs, checkParity )
+            || !shardRunner.MergeResults( commit, drcJob->m_reportAllTrackErrors ) )
+        {
+            drcEngine->ClearViolationHandler();
+            return CLI::EXIT_CODES::ERR_UNKNOWN;
+        }
+    }
+    else if( shardWorker )
+    {
+        drcEngine->RunShardTests( units, drcJob->m_reportAllTrackErrors, checkParity,
+                                  drcJob->m_shardIndex, drcJob->m_shardCount );
+    }
+    else
+    {
+        drcEngine->RunTests( units, drcJob->m_reportAllTrackErrors, checkParity );
+    }
+
     drcEngine->ClearViolationHandler();
 
+    if( const DRC_PROFILE* profile = drcEngine->GetProfile() )
+    {
+        if( profile->WriteJsonReport( drcJob->m_profileOutputPath ) )
+        {
+            m_reporter->Report( wxString::Format( _( "Saved DRC profile to %s\n" ),
+                                                  drcJob->m_profileOutputPath ),
+                                RPT_SEVERITY_ACTION );
+        }
+        else
+        {
+            m_reporter->Report( wxString::Format( _( "Unable to save DRC profile to %s\n" ),
+                                                  drcJob->m_profileOutputPath ),
+                                RPT_SEVERITY_ERROR );
+        }
+
+        drcEngine->SetProfilingEnabled( false );
+    }
+
     commit.Push( _( "DRC" ), SKIP_UNDO | SKIP_SET_DIRTY );
 
+    // Exclusions are resolved (and the report written) by the process which started the worker
+    if( shardWorker )
+    {
+        if( !DRC_SHARD_RUNNER::WriteShard( brd, outPath ) )
+        {
+            m_reporter->Report( wxString::Format( _( "Unable to save DRC shard to %s\n" ),
+                                                  outPath ),
+                                RPT_SEVERITY_ERROR );
+            return CLI::EXIT_CODES::ERR_INVALID_OUTPUT_CONFLICT;
+        }
+
+        return CLI::EXIT_CODES::SUCCESS;
+    }
+
     // Update the exclusion status on any excluded markers that still exist.
     brd->ResolveDRCExclusions( false );
 
@@ -2657,6 +2756,80 @@ int PCBNEW_JOBS_HANDLER::JobUpgrade( JOB* aJob )
     return CLI::EXIT_CODES::SUCCESS;
 }
 
+
+int PCBNEW_JOBS_HANDLER::JobRoute( JOB* aJob )
+{
+    JOB_PCB_ROUTE* routeJob = dynamic_cast<JOB_PCB_ROUTE*>( aJob );
+
+    if( routeJob == nullptr )
+        return CLI::EXIT_CODES::ERR_UNKNOWN;
+
+    BOARD* brd = getBoard( routeJob->m_filename );
+
+    if( !brd )
+        return CLI::EXIT_CODES::ERR_INVALID_INPUT_FILE;
+
+    std::set<int> netCodes;
+
+    for( const wxString& netName : routeJob->m_nets )
+    {
+        NETINFO_ITEM* net = brd->FindNet( netName );
+
+        if( !net )
+        {
+            m_reporter->Report( wxString::Format( _( "Net '%s' not found.\n" ), netName ),
+                                RPT_SEVERITY_ERROR );
+            return CLI::EXIT_CODES::ERR_ARGS;
+        }
+
+        netCodes.insert( net->GetNetCode() );
+    }
+
+    // BOARD_COMMIT uses TOOL_MANAGER to grab the board internally so we must give it one
+    TOOL_MANAGER*    toolManager = getToolManager( brd );
+    PNS_BATCH_ROUTER router( brd, toolManager, m_reporter );
+
+    router.SetNets( netCodes );
+    router.SetMode( routeJob->m_mode == JOB_PCB_ROUTE::MODE::SHOVE ? PNS::RM_Shove
+                                                                   : PNS::RM_Walkaround );
+    router.SetOrder( routeJob->m_order == JOB_PCB_ROUTE::ORDER::SHORTEST_FIRST
+                             ? PNS_BATCH_ROUTER::ORDER::SHORTEST_FIRST
+                             : PNS_BATCH_ROUTER::ORDER::BOARD );
+    router.SetRetries( routeJob->m_retries );
+    router.SetParallel( routeJob->m_parallel );
+
+    PNS_BATCH_ROUTER::RESULT result = router.Run();
+
+    m_reporter->Report( wxString::Format( _( "Routed %d connections, %d could not be routed.\n" ),
+                                          result.m_Routed, result.m_Failed ),
+                        RPT_SEVERITY_INFO );
+
+    // Never overwrite the input unless asked to: the routed board goes next to it by default
+    if( routeJob->GetConfiguredOutputPath().IsEmpty() )
+    {
+        wxFileName fn = brd->GetFileName();
+        fn.SetName( fn.GetName() + wxS( "-routed" ) );
+
+        routeJob->SetWorkingOutputPath( fn.GetFullPath() );
+    }
+
+    wxString outPath = resolveJobOutputPath( aJob, brd );
+
+    if( !SaveBoard( outPath, brd, true ) )
+    {
+        m_reporter->Report( _( "Failed to save board.\n" ), RPT_SEVERITY_ERROR );
+        return CLI::EXIT_CODES::ERR_INVALID_OUTPUT_CONFLICT;
+    }
+
+    m_reporter->Report( wxString::Format( _( "Saved board to %s\n" ), outPath ),
+                        RPT_SEVERITY_ACTION );
+
+    if( routeJob->m_exitCodeUnrouted && result.m_Failed > 0 )
+        return CLI::EXIT_CODES::ERR_RC_VIOLATIONS;
+
+    return CLI::EXIT_CODES::SUCCESS;
+}
+
 // Most job handlers need to align the running job with the board before resolving any
 // output paths with variables in them like ${REVISION}.
 wxString PCBNEW_JOBS_HANDLER::resolveJobOutputPath( JOB* aJob, BOARD* aBoard, const wxString* aDrawingSheet )
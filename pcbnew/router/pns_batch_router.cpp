@@ -0,0 +1,679 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <future>
+#include <map>
+#include <mutex>
+#include <numeric>
+
+#include <base_units.h>
+#include <board.h>
+#include <board_commit.h>
+#include <board_design_settings.h>
+#include <connectivity/connectivity_data.h>
+#include <connectivity/connectivity_algo.h>
+#include <eda_units.h>
+#include <ratsnest/ratsnest_data.h>
+#include <reporter.h>
+#include <thread_pool.h>
+
+#include "pns_batch_router.h"
+#include "pns_kicad_iface.h"
+#include "pns_placement_algo.h"
+#include "pns_router.h"
+
+
+namespace
+{
+
+/**
+ * A router interface which has no view and records the changes of the router instead of
+ * committing them, so that they can be checked against other regions before they are applied.
+ */
+class BATCH_IFACE : public PNS_KICAD_IFACE
+{
+public:
+    BATCH_IFACE( BOARD* aBoard, TOOL_MANAGER* aToolMgr )
+    {
+        SetBoard( aBoard );
+        m_commit = std::make_unique<BOARD_COMMIT>( aToolMgr );
+    }
+
+    ~BATCH_IFACE() override
+    {
+        for( BOARD_CONNECTED_ITEM* item : m_added )
+            delete item;
+    }
+
+    void EraseView() override {}
+    bool IsAnyLayerVisible( const PNS_LAYER_RANGE& aLayer ) const override { return true; }
+    bool IsItemVisible( const PNS::ITEM* aItem ) const override { return true; }
+    void HideItem( PNS::ITEM* aItem ) override {}
+    void DisplayItem( const PNS::ITEM* aItem, int aClearance, bool aEdit = false,
+                      int aFlags = 0 ) override {}
+    void DisplayPathLine( const SHAPE_LINE_CHAIN& aLine, int aImportance ) override {}
+    void DisplayRatline( const SHAPE_LINE_CHAIN& aRatline, PNS::NET_HANDLE aNet ) override {}
+    EDA_UNITS GetUnits() const override { return EDA_UNITS::MM; }
+
+    // Changes are applied by Apply(), from the main thread
+    void Commit() override {}
+
+    void AddItem( PNS::ITEM* aItem ) override
+    {
+        // createBoardItem() re-parents the shared orphaned net for items without a net
+        static std::mutex           orphanedNetMutex;
+        std::unique_lock<std::mutex> lock( orphanedNetMutex, std::defer_lock );
+
+        if( GetNetCode( aItem->Net() ) <= 0 )
+            lock.lock();
+
+        BOARD_CONNECTED_ITEM* boardItem = createBoardItem( aItem );
+
+        if( !boardItem )
+            return;
+
+        aItem->SetParent( boardItem );
+        boardItem->ClearFlags();
+
+        m_added.push_back( boardItem );
+        m_changedArea.Merge( boardItem->GetBoundingBox() );
+    }
+
+    void RemoveItem( PNS::ITEM* aItem ) override
+    {
+        BOARD_ITEM* parent = aItem->Parent();
+
+        // Footprints are never moved by the batch router
+        if( !parent || aItem->OfKind( PNS::ITEM::SOLID_T ) )
+            return;
+
+        m_updated.erase( parent );
+        m_changedArea.Merge( parent->GetBoundingBox() );
+
+        auto it = std::find( m_added.begin(), m_added.end(), parent );
+
+        if( it != m_added.end() )
+        {
+            // Added and removed again before being applied (e.g. shoved by a later connection)
+            m_discarded.emplace_back( *it );
+            m_added.erase( it );
+            return;
+        }
+
+        m_removed.push_back( parent );
+    }
+
+    void UpdateItem( PNS::ITEM* aItem ) override
+    {
+        BOARD_ITEM* parent = aItem->Parent();
+
+        if( !parent || aItem->OfKind( PNS::ITEM::SOLID_T ) )
+            return;
+
+        m_changedArea.Merge( parent->GetBoundingBox() );
+        m_changedArea.Merge( aItem->Shape( -1 )->BBox() );
+        m_updated[parent] = PNS::Clone( *aItem );
+    }
+
+    /// The area touched by the recorded changes.  Invalid if there are none.
+    const BOX2I& ChangedArea() const { return m_changedArea; }
+
+    /**
+     * Stage the recorded changes in the commit.  Must be called from the main thread.
+     */
+    void Apply()
+    {
+        for( BOARD_CONNECTED_ITEM* item : m_added )
+            m_commit->Add( item );
+
+        // Updates of added items are made in place, which is what we want
+        for( const auto& [parent, item] : m_updated )
+            modifyBoardItem( item.get() );
+
+        for( BOARD_ITEM* item : m_removed )
+            m_commit->Remove( item );
+
+        m_added.clear();
+        m_updated.clear();
+        m_removed.clear();
+    }
+
+    /**
+     * Push the staged changes to the board.
+     *
+     * @return false if there was nothing to push.
+     */
+    bool Push( int aCommitFlags )
+    {
+        if( m_commit->Empty() )
+            return false;
+
+        m_commit->Push( _( "Autoroute" ), aCommitFlags );
+        return true;
+    }
+
+private:
+    std::vector<BOARD_CONNECTED_ITEM*>                   m_added;
+    std::vector<BOARD_ITEM*>                             m_removed;
+    std::map<BOARD_ITEM*, std::unique_ptr<PNS::ITEM>>    m_updated;
+    std::vector<std::unique_ptr<BOARD_CONNECTED_ITEM>>   m_discarded;
+    BOX2I                                                m_changedArea;
+};
+
+} // namespace
+
+
+struct PNS_BATCH_ROUTER::REGION
+{
+    std::vector<CONNECTION>          m_Connections;
+    std::vector<PNS::SIZES_SETTINGS> m_Sizes;
+    std::vector<int>                 m_Layers;
+    std::vector<size_t>              m_Failed;
+    int                              m_Routed = 0;
+
+    // The router must be deleted before the interface because the NODE destructor needs the
+    // rule resolver
+    std::unique_ptr<BATCH_IFACE>     m_Iface;
+    std::unique_ptr<PNS::ROUTER>     m_Router;
+};
+
+
+PNS_BATCH_ROUTER::PNS_BATCH_ROUTER( BOARD* aBoard, TOOL_MANAGER* aToolMgr, REPORTER* aReporter ) :
+        m_board( aBoard ),
+        m_toolMgr( aToolMgr ),
+        m_reporter( aReporter ? aReporter : &NULL_REPORTER::GetInstance() ),
+        m_settings( std::make_unique<PNS::ROUTING_SETTINGS>( nullptr, "" ) ),
+        m_mode( PNS::RM_Walkaround ),
+        m_order( ORDER::BOARD ),
+        m_retries( 2 ),
+        m_parallel( true ),
+        m_firstPush( true )
+{
+}
+
+
+PNS_BATCH_ROUTER::~PNS_BATCH_ROUTER()
+{
+}
+
+
+bool PNS_BATCH_ROUTER::isShorter( const CONNECTION& aLhs, const CONNECTION& aRhs )
+{
+    return ( aLhs.m_TargetPos - aLhs.m_SourcePos ).SquaredEuclideanNorm()
+           < ( aRhs.m_TargetPos - aRhs.m_SourcePos ).SquaredEuclideanNorm();
+}
+
+
+std::vector<PNS_BATCH_ROUTER::CONNECTION>
+PNS_BATCH_ROUTER::collectConnections( const std::set<int>& aNetCodes ) const
+{
+    std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board->GetConnectivity();
+    std::vector<CONNECTION>            conns;
+
+    for( NETINFO_ITEM* net : m_board->GetNetInfo() )
+    {
+        int netCode = net->GetNetCode();
+
+        if( netCode <= 0 || ( !aNetCodes.empty() && !aNetCodes.contains( netCode ) ) )
+            continue;
+
+        RN_NET* rnNet = connectivity->GetRatsnestForNet( netCode );
+
+        if( !rnNet )
+            continue;
+
+        for( const CN_EDGE& edge : rnNet->GetEdges() )
+        {
+            std::shared_ptr<const CN_ANCHOR> source = edge.GetSourceNode();
+            std::shared_ptr<const CN_ANCHOR> target = edge.GetTargetNode();
+
+            if( !source || source->Dirty() || !source->Valid()
+                || !target || target->Dirty() || !target->Valid() )
+            {
+                continue;
+            }
+
+            conns.push_back( { source->Parent(), target->Parent(), source->Pos(), target->Pos(),
+                               netCode } );
+        }
+    }
+
+    if( m_order == ORDER::SHORTEST_FIRST )
+    {
+        std::stable_sort( conns.begin(), conns.end(), isShorter );
+    }
+
+    return conns;
+}
+
+
+std::vector<std::vector<PNS_BATCH_ROUTER::CONNECTION>>
+PNS_BATCH_ROUTER::partition( const std::vector<CONNECTION>& aConns ) const
+{
+    int                clearance = m_board->GetMaxClearanceValue();
+    std::vector<BOX2I> areas;
+
+    for( const CONNECTION& conn : aConns )
+    {
+        BOX2I area( conn.m_SourcePos );
+        area.Merge( conn.m_TargetPos );
+        area.Merge( conn.m_Source->GetBoundingBox() );
+        area.Merge( conn.m_Target->GetBoundingBox() );
+
+        // Leave some room for detours.  Changes that stray further are caught when the results
+        // of the regions are merged.
+        area.Inflate( clearance + std::max( area.GetWidth(), area.GetHeight() ) / 4 );
+        areas.push_back( area );
+    }
+
+    // Union connections with overlapping areas, sweeping along X
+    std::vector<size_t> parent( aConns.size() );
+    std::iota( parent.begin(), parent.end(), 0 );
+
+    auto find =
+            [&]( size_t aIdx ) -> size_t
+            {
+                while( parent[aIdx] != aIdx )
+                    aIdx = parent[aIdx] = parent[parent[aIdx]];
+
+                return aIdx;
+            };
+
+    std::vector<size_t> byLeft( aConns.size() );
+    std::iota( byLeft.begin(), byLeft.end(), 0 );
+    std::sort( byLeft.begin(), byLeft.end(),
+               [&]( size_t a, size_t b )
+               {
+                   return areas[a].GetLeft() < areas[b].GetLeft();
+               } );
+
+    for( size_t ii = 0; ii < byLeft.size(); ++ii )
+    {
+        const BOX2I& area = areas[byLeft[ii]];
+
+        for( size_t jj = ii + 1; jj < byLeft.size(); ++jj )
+        {
+            const BOX2I& other = areas[byLeft[jj]];
+
+            if( other.GetLeft() > area.GetRight() )
+                break;
+
+            if( area.Intersects( other ) )
+                parent[find( byLeft[jj] )] = find( byLeft[ii] );
+        }
+    }
+
+    std::map<size_t, std::vector<CONNECTION>> groups;
+
+    for( size_t ii = 0; ii < aConns.size(); ++ii )
+        groups[find( ii )].push_back( aConns[ii] );
+
+    // Each region holds a copy of the world, so deal the groups out to no more regions than
+    // there are threads, largest first
+    thread_pool&                         tp = GetKiCadThreadPool();
+    size_t                               regionCount = std::min<size_t>( groups.size(),
+                                                                         tp.get_thread_count() );
+    std::vector<std::vector<CONNECTION>> regions( std::max<size_t>( regionCount, 1 ) );
+    std::vector<std::vector<CONNECTION>*> sorted;
+
+    for( auto& [root, group] : groups )
+        sorted.push_back( &group );
+
+    std::stable_sort( sorted.begin(), sorted.end(),
+                      []( const std::vector<CONNECTION>* a, const std::vector<CONNECTION>* b )
+                      {
+                          return a->size() > b->size();
+                      } );
+
+    for( std::vector<CONNECTION>* group : sorted )
+    {
+        auto smallest = std::min_element( regions.begin(), regions.end(),
+                                          []( const auto& a, const auto& b )
+                                          {
+                                              return a.size() < b.size();
+                                          } );
+
+        smallest->insert( smallest->end(), group->begin(), group->end() );
+    }
+
+    // Keep the requested order within each region
+    if( m_order == ORDER::SHORTEST_FIRST )
+    {
+        for( std::vector<CONNECTION>& region : regions )
+        {
+            std::stable_sort( region.begin(), region.end(), isShorter );
+        }
+    }
+
+    return regions;
+}
+
+
+std::unique_ptr<PNS_BATCH_ROUTER::REGION>
+PNS_BATCH_ROUTER::createRegion( std::vector<CONNECTION> aConns )
+{
+    std::unique_ptr<REGION> region = std::make_unique<REGION>();
+
+    region->m_Connections = std::move( aConns );
+    region->m_Iface = std::make_unique<BATCH_IFACE>( m_board, m_toolMgr );
+    region->m_Router = std::make_unique<PNS::ROUTER>( false );
+
+    PNS::ROUTER* router = region->m_Router.get();
+    BATCH_IFACE* iface = region->m_Iface.get();
+
+    PNS::ROUTER::SetThreadInstance( router );
+
+    router->SetInterface( iface );
+    router->ClearWorld();
+    router->SyncWorld();
+    router->LoadSettings( m_settings.get() );
+    router->SetMode( PNS::PNS_MODE_ROUTE_SINGLE );
+
+    // Regions are created one after the other on the calling thread and then routed
+    // concurrently, each with its own world and rule resolver.  Resolve the sizes here, where
+    // the netclass lookups which fill the board's caches can't race; while routing, the rule
+    // resolver only evaluates the DRC rules, which the DRC itself does from several threads.
+    for( const CONNECTION& conn : region->m_Connections )
+    {
+        PNS::ITEM*           startItem = router->GetWorld()->FindItemByParent( conn.m_Source );
+        PNS::ITEM*           endItem = router->GetWorld()->FindItemByParent( conn.m_Target );
+        PNS::SIZES_SETTINGS  sizes( router->Sizes() );
+        int                  layer = -1;
+
+        if( startItem && endItem )
+        {
+            // Prefer a layer both ends are on, so that the line can be finished without a via
+            if( startItem->Layers().Overlaps( endItem->Layers() ) )
+                layer = startItem->Layers().Intersection( endItem->Layers() ).Start();
+            else
+                layer = startItem->Layers().Start();
+
+            iface->SetStartLayerFromPNS( layer );
+            iface->ImportSizes( sizes, startItem, nullptr, conn.m_SourcePos );
+            sizes.AddLayerPair( 0, m_board->GetCopperLayerCount() - 1 );
+        }
+
+        region->m_Sizes.push_back( sizes );
+        region->m_Layers.push_back( layer );
+    }
+
+    PNS::ROUTER::SetThreadInstance( nullptr );
+
+    return region;
+}
+
+
+bool PNS_BATCH_ROUTER::routeConnection( REGION& aRegion, size_t aIndex )
+{
+    const CONNECTION& conn = aRegion.m_Connections[aIndex];
+    PNS::ROUTER*      router = aRegion.m_Router.get();
+    PNS::ITEM*        startItem = router->GetWorld()->FindItemByParent( conn.m_Source );
+    PNS::ITEM*        endItem = router->GetWorld()->FindItemByParent( conn.m_Target );
+    int               layer = aRegion.m_Layers[aIndex];
+
+    if( !startItem || !endItem || layer < 0 )
+        return false;
+
+    router->UpdateSizes( aRegion.m_Sizes[aIndex] );
+
+    if( !router->StartRouting( conn.m_SourcePos, startItem, layer ) )
+        return false;
+
+    // Same as ROUTER::Finish(): keep moving until the end stops changing
+    PNS::PLACEMENT_ALGO* placer = router->Placer();
+    int                  triesLeft = 5;
+    VECTOR2I             end;
+
+    do
+    {
+        end = placer->CurrentEnd();
+        router->Move( conn.m_TargetPos, endItem );
+        triesLeft--;
+    } while( placer->CurrentEnd() != end && triesLeft );
+
+    if( end == conn.m_TargetPos && endItem->Layers().Overlaps( router->GetCurrentLayer() )
+        && router->FixRoute( conn.m_TargetPos, endItem, false, false ) )
+    {
+        router->CommitRouting();
+        return true;
+    }
+
+    router->StopRouting();
+    return false;
+}
+
+
+void PNS_BATCH_ROUTER::routeRegion( REGION& aRegion )
+{
+    PNS::ROUTER::SetThreadInstance( aRegion.m_Router.get() );
+
+    std::vector<size_t> pending( aRegion.m_Connections.size() );
+    std::iota( pending.begin(), pending.end(), 0 );
+
+    // Connections that fail are retried once the others are in, as long as that keeps
+    // routing something: in shove mode the new tracks can push the ones that blocked them
+    for( int pass = 0; pass <= m_retries && !pending.empty(); ++pass )
+    {
+        std::vector<size_t> failed;
+
+        for( size_t idx : pending )
+        {
+            if( routeConnection( aRegion, idx ) )
+                aRegion.m_Routed++;
+            else
+                failed.push_back( idx );
+        }
+
+        bool progress = failed.size() < pending.size();
+        pending = std::move( failed );
+
+        if( !progress )
+            break;
+    }
+
+    aRegion.m_Failed = std::move( pending );
+
+    PNS::ROUTER::SetThreadInstance( nullptr );
+}
+
+
+PNS_BATCH_ROUTER::RESULT PNS_BATCH_ROUTER::Run()
+{
+    RESULT result;
+
+    m_settings->SetMode( m_mode );
+    m_firstPush = true;
+
+    std::vector<CONNECTION> conns = collectConnections( m_netCodes );
+
+    if( conns.empty() )
+        return result;
+
+    std::vector<std::unique_ptr<REGION>> regions;
+
+    if( m_parallel )
+    {
+        for( std::vector<CONNECTION>& group : partition( conns ) )
+        {
+            if( !group.empty() )
+                regions.push_back( createRegion( std::move( group ) ) );
+        }
+    }
+    else
+    {
+        regions.push_back( createRegion( conns ) );
+    }
+
+    if( regions.size() > 1 )
+    {
+        thread_pool&                   tp = GetKiCadThreadPool();
+        std::vector<std::future<void>> returns;
+
+        for( std::unique_ptr<REGION>& region : regions )
+        {
+            returns.emplace_back( tp.submit_task(
+                    [this, r = region.get()]()
+                    {
+                        routeRegion( *r );
+                    } ) );
+        }
+
+        for( const std::future<void>& ret : returns )
+            ret.wait();
+    }
+    else
+    {
+        routeRegion( *regions.front() );
+    }
+
+    auto reportFailure =
+            [&]( const CONNECTION& aConn )
+            {
+                NETINFO_ITEM* net = m_board->FindNet( aConn.m_NetCode );
+
+                m_reporter->Report( wxString::Format(
+                        _( "Could not route net %s from (%s, %s) to (%s, %s)." ),
+                        net ? net->GetNetname() : wxString(),
+                        EDA_UNIT_UTILS::UI::MessageTextFromValue( pcbIUScale, EDA_UNITS::MM,
+                                                                  aConn.m_SourcePos.x ),
+                        EDA_UNIT_UTILS::UI::MessageTextFromValue( pcbIUScale, EDA_UNITS::MM,
+                                                                  aConn.m_SourcePos.y ),
+                        EDA_UNIT_UTILS::UI::MessageTextFromValue( pcbIUScale, EDA_UNITS::MM,
+                                                                  aConn.m_TargetPos.x ),
+                        EDA_UNIT_UTILS::UI::MessageTextFromValue( pcbIUScale, EDA_UNITS::MM,
+                                                                  aConn.m_TargetPos.y ) ),
+                        RPT_SEVERITY_WARNING );
+            };
+
+    // Each region was routed against the original board, so the changes of a region are only
+    // valid if they stay clear of the changes of the regions accepted before it.  The others
+    // are routed again once the accepted changes are on the board.
+    int                     clearance = m_board->GetMaxClearanceValue();
+    std::vector<BOX2I>      acceptedAreas;
+    std::vector<REGION*>    accepted;
+    std::vector<CONNECTION> reported;
+    std::set<int>           reroutedNets;
+
+    for( std::unique_ptr<REGION>& region : regions )
+    {
+        BOX2I area = region->m_Iface->ChangedArea();
+        bool  conflict = false;
+
+        if( area.IsValid() )
+        {
+            area.Inflate( clearance );
+
+            for( const BOX2I& other : acceptedAreas )
+            {
+                if( area.Intersects( other ) )
+                {
+                    conflict = true;
+                    break;
+                }
+            }
+        }
+
+        if( conflict )
+        {
+            for( const CONNECTION& conn : region->m_Connections )
+                reroutedNets.insert( conn.m_NetCode );
+
+            continue;
+        }
+
+        if( area.IsValid() )
+            acceptedAreas.push_back( area );
+
+        accepted.push_back( region.get() );
+        result.m_Routed += region->m_Routed;
+
+        for( size_t idx : region->m_Failed )
+        {
+            reportFailure( region->m_Connections[idx] );
+            reported.push_back( region->m_Connections[idx] );
+        }
+
+        result.m_Failed += region->m_Failed.size();
+    }
+
+    // The worlds hold the board items which the commits are about to remove
+    for( std::unique_ptr<REGION>& region : regions )
+        region->m_Router.reset();
+
+    for( REGION* region : accepted )
+    {
+        region->m_Iface->Apply();
+
+        if( region->m_Iface->Push( m_firstPush ? 0 : APPEND_UNDO ) )
+            m_firstPush = false;
+    }
+
+    regions.clear();
+
+    if( reroutedNets.empty() )
+        return result;
+
+    // The items the connections of the rejected regions were collected from may have been
+    // shoved or deleted by the commits, so collect them again from the updated ratsnest,
+    // leaving out the connections which have already been reported as failed
+    std::vector<CONNECTION> rerouted;
+
+    for( const CONNECTION& conn : collectConnections( reroutedNets ) )
+    {
+        auto sameEnds =
+                [&]( const CONNECTION& aOther )
+                {
+                    if( aOther.m_NetCode != conn.m_NetCode )
+                        return false;
+
+                    return ( aOther.m_SourcePos == conn.m_SourcePos
+                             && aOther.m_TargetPos == conn.m_TargetPos )
+                           || ( aOther.m_SourcePos == conn.m_TargetPos
+                                && aOther.m_TargetPos == conn.m_SourcePos );
+                };
+
+        if( std::none_of( reported.begin(), reported.end(), sameEnds ) )
+            rerouted.push_back( conn );
+    }
+
+    if( !rerouted.empty() )
+    {
+        m_reporter->Report( wxString::Format( _( "Routing %d connections again after a conflict "
+                                                 "between regions." ),
+                                              (int) rerouted.size() ),
+                            RPT_SEVERITY_INFO );
+
+        std::unique_ptr<REGION> region = createRegion( std::move( rerouted ) );
+        routeRegion( *region );
+
+        result.m_Routed += region->m_Routed;
+
+        for( size_t idx : region->m_Failed )
+            reportFailure( region->m_Connections[idx] );
+
+        result.m_Failed += region->m_Failed.size();
+
+        region->m_Router.reset();
+        region->m_Iface->Apply();
+        region->m_Iface->Push( m_firstPush ? 0 : APPEND_UNDO );
+    }
+
+    return result;
+}
@@ -0,0 +1,121 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_BATCH_ROUTER_H
+#define __PNS_BATCH_ROUTER_H
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <math/box2.h>
+#include <math/vector2d.h>
+
+#include "pns_routing_settings.h"
+
+class BOARD;
+class BOARD_CONNECTED_ITEM;
+class REPORTER;
+class TOOL_MANAGER;
+
+/**
+ * Route the unrouted ratsnest connections of a board with the interactive router, without a
+ * view or an editor frame.
+ *
+ * Each connection is routed the way "Attempt Finish" routes it in the editor: a line is placed
+ * from one anchor towards the other and fixed if it reaches it.  Connections whose areas cannot
+ * interact are grouped into regions which are routed concurrently on the thread pool, each in
+ * its own copy of the world.  Changes are pushed to the board in a single undoable commit.
+ */
+class PNS_BATCH_ROUTER
+{
+public:
+    enum class ORDER
+    {
+        BOARD,          ///< Route connections in ratsnest order
+        SHORTEST_FIRST  ///< Route short connections first
+    };
+
+    struct RESULT
+    {
+        int m_Routed = 0;
+        int m_Failed = 0;
+    };
+
+    PNS_BATCH_ROUTER( BOARD* aBoard, TOOL_MANAGER* aToolMgr, REPORTER* aReporter );
+    ~PNS_BATCH_ROUTER();
+
+    /// Route only the given nets.  All nets are routed if the set is empty.
+    void SetNets( const std::set<int>& aNetCodes ) { m_netCodes = aNetCodes; }
+
+    /// Walkaround or shove.  Mark obstacles mode is not supported.
+    void SetMode( PNS::PNS_MODE aMode ) { m_mode = aMode; }
+
+    void SetOrder( ORDER aOrder ) { m_order = aOrder; }
+
+    /// Number of times connections that failed are retried after the others have been routed.
+    void SetRetries( int aRetries ) { m_retries = aRetries; }
+
+    void SetParallel( bool aParallel ) { m_parallel = aParallel; }
+
+    /**
+     * Route the connections and push the result to the board.
+     */
+    RESULT Run();
+
+private:
+    struct CONNECTION
+    {
+        BOARD_CONNECTED_ITEM* m_Source;
+        BOARD_CONNECTED_ITEM* m_Target;
+        VECTOR2I              m_SourcePos;
+        VECTOR2I              m_TargetPos;
+        int                   m_NetCode;
+    };
+
+    struct REGION;
+
+    static bool isShorter( const CONNECTION& aLhs, const CONNECTION& aRhs );
+
+    /// Collect the unrouted connections of the given nets, or of all nets if the set is empty.
+    std::vector<CONNECTION>              collectConnections( const std::set<int>& aNetCodes ) const;
+    std::vector<std::vector<CONNECTION>> partition( const std::vector<CONNECTION>& aConns ) const;
+
+    /// Build the world of a region.  Must be called from the main thread.
+    std::unique_ptr<REGION> createRegion( std::vector<CONNECTION> aConns );
+
+    /// Route the connections of a region.  Different regions may be routed concurrently.
+    void                    routeRegion( REGION& aRegion );
+    bool                    routeConnection( REGION& aRegion, size_t aIndex );
+
+    BOARD*        m_board;
+    TOOL_MANAGER* m_toolMgr;
+    REPORTER*     m_reporter;
+
+    std::unique_ptr<PNS::ROUTING_SETTINGS> m_settings;
+
+    std::set<int> m_netCodes;
+    PNS::PNS_MODE m_mode;
+    ORDER         m_order;
+    int           m_retries;
+    bool          m_parallel;
+    bool          m_firstPush;
+};
+
+#endif
@@ -25,6 +25,12 @@
 namespace PNS {
 
 
+INDEX::INDEX() :
+        m_allItems( std::make_shared<ITEM_SET>() )
+{
+}
+
+
 void INDEX::Add( ITEM* aItem )
 {
     const PNS_LAYER_RANGE& range = aItem->Layers();
@@ -32,18 +38,18 @@ void INDEX::Add( ITEM* aItem )
 
     if( m_subIndices.size() <= static_cast<size_t>( range.End() ) )
     {
-        for( int i = 0; i <= range.End(); ++i )
-            m_subIndices.emplace_back( std::make_unique<ITEM_SHAPE_INDEX>( i ) );
+        for( int i = m_subIndices.size(); i <= range.End(); ++i )
+            m_subIndices.emplace_back( std::make_shared<ITEM_SHAPE_INDEX>( i ) );
     }
 
     for( int i = range.Start(); i <= range.End(); ++i )
-        m_subIndices[i]->Add( aItem );
+        mutableSubIndex( i )->Add( aItem );
 
-    m_allItems.insert( aItem );
+    mutableItems()->insert( aItem );
     NET_HANDLE net = aItem->Net();
 
     if( net )
-        m_netMap[net].push_back( aItem );
+        mutableNetItems( net )->push_back( aItem );
 }
 
 
@@ -56,13 +62,13 @@ void INDEX::Remove( ITEM* aItem )
         return;
 
     for( int i = range.Start(); i <= range.End(); ++i )
-        m_subIndices[i]->Remove( aItem );
+        mutableSubIndex( i )->Remove( aItem );
 
-    m_allItems.erase( aItem );
+    mutableItems()->erase( aItem );
     NET_HANDLE net = aItem->Net();
 
     if( net && m_netMap.find( net ) != m_netMap.end() )
-        m_netMap[net].remove( aItem );
+        mutableNetItems( net )->remove( aItem );
 }
 
 
@@ -73,12 +79,54 @@ void INDEX::Replace( ITEM* aOldItem, ITEM* aNewItem )
 }
 
 
-INDEX::NET_ITEMS_LIST* INDEX::GetItemsForNet( NET_HANDLE aNet )
+const INDEX::NET_ITEMS_LIST* INDEX::GetItemsForNet( NET_HANDLE aNet ) const
 {
-    if( m_netMap.find( aNet ) == m_netMap.end() )
+    auto it = m_netMap.find( aNet );
+
+    if( it == m_netMap.end() )
         return nullptr;
 
-    return &m_netMap[aNet];
+    return it->second.get();
+}
+
+
+INDEX::ITEM_SHAPE_INDEX* INDEX::mutableSubIndex( int aLayer )
+{
+    std::shared_ptr<ITEM_SHAPE_INDEX>& subIndex = m_subIndices[aLayer];
+
+    if( subIndex.use_count() > 1 )
+    {
+        std::shared_ptr<ITEM_SHAPE_INDEX> copy = std::make_shared<ITEM_SHAPE_INDEX>( aLayer );
+
+        for( ITEM_SHAPE_INDEX::Iterator it = subIndex->Begin(); it.IsNotNull(); it++ )
+            copy->Add( *it );
+
+        subIndex = std::move( copy );
+    }
+
+    return subIndex.get();
+}
+
+
+INDEX::NET_ITEMS_LIST* INDEX::mutableNetItems( NET_HANDLE aNet )
+{
+    std::shared_ptr<NET_ITEMS_LIST>& items = m_netMap[aNet];
+
+    if( !items )
+        items = std::make_shared<NET_ITEMS_LIST>();
+    else if( items.use_count() > 1 )
+        items = std::make_shared<NET_ITEMS_LIST>( *items );
+
+    return items.get();
+}
+
+
+INDEX::ITEM_SET* INDEX::mutableItems()
+{
+    if( m_allItems.use_count() > 1 )
+        m_allItems = std::make_shared<ITEM_SET>( *m_allItems );
+
+    return m_allItems.get();
 }
 
 };
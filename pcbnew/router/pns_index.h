@@ -25,6 +25,7 @@
 #include <deque>
 #include <list>
 #include <map>
+#include <memory>
 #include <unordered_set>
 
 #include <layer_ids.h>
@@ -42,6 +43,10 @@ namespace PNS {
  * Custom spatial index, holding our board items and allowing for very fast searches. Items
  * are assigned to separate R-Tree subindices depending on their type and spanned layers, reducing
  * overlap and improving search time.
+ *
+ * Copies of an index share their subindices, net lists and item set; each of them is only
+ * duplicated when one of the copies modifies it.  This makes branching a NODE cheap no matter
+ * how many items its parent has, while each branch still answers a query with a single lookup.
  **/
 class INDEX
 {
@@ -50,7 +55,10 @@ public:
     typedef SHAPE_INDEX<ITEM*>          ITEM_SHAPE_INDEX;
     typedef std::unordered_set<ITEM*>   ITEM_SET;
 
-    INDEX(){};
+    INDEX();
+
+    INDEX( const INDEX& aOther ) = default;
+    INDEX& operator=( const INDEX& aOther ) = default;
 
     /**
      * Adds item to the spatial index.
@@ -98,7 +106,7 @@ public:
     /**
      * Returns list of all items in a given net.
      */
-    NET_ITEMS_LIST* GetItemsForNet( NET_HANDLE aNet );
+    const NET_ITEMS_LIST* GetItemsForNet( NET_HANDLE aNet ) const;
 
     /**
      * Function Contains()
@@ -107,25 +115,33 @@ public:
      */
     bool Contains( ITEM* aItem ) const
     {
-        return m_allItems.find( aItem ) != m_allItems.end();
+        return m_allItems->find( aItem ) != m_allItems->end();
     }
 
     /**
      * Returns number of items stored in the index.
      */
-    int Size() const { return m_allItems.size(); }
+    int Size() const { return m_allItems->size(); }
 
-    ITEM_SET::iterator begin() { return m_allItems.begin(); }
-    ITEM_SET::iterator end() { return m_allItems.end(); }
+    ITEM_SET::const_iterator begin() const { return m_allItems->begin(); }
+    ITEM_SET::const_iterator end() const { return m_allItems->end(); }
 
 private:
     template <class Visitor>
     int querySingle( std::size_t aIndex, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) const;
 
+    /**
+     * Return a subindex, net list or the item set for modification, first taking a private copy
+     * if it is shared with another index.
+     */
+    ITEM_SHAPE_INDEX* mutableSubIndex( int aLayer );
+    NET_ITEMS_LIST*   mutableNetItems( NET_HANDLE aNet );
+    ITEM_SET*         mutableItems();
+
 private:
-    std::deque<std::unique_ptr<ITEM_SHAPE_INDEX>> m_subIndices;
-    std::map<NET_HANDLE, NET_ITEMS_LIST> m_netMap;
-    ITEM_SET                             m_allItems;
+    std::deque<std::shared_ptr<ITEM_SHAPE_INDEX>>          m_subIndices;
+    std::map<NET_HANDLE, std::shared_ptr<NET_ITEMS_LIST>> m_netMap;
+    std::shared_ptr<ITEM_SET>                              m_allItems;
 };
 
 
@@ -60,7 +60,10 @@
 
 #include <wx/log.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 
 #include <advanced_config.h>
 #include <pcbnew_settings.h>
@@ -151,6 +154,8 @@ public:
     void ClearCaches() override;
     void ClearTemporaryCaches() override;
 
+    PNS::CLEARANCE_CACHE_STATS ClearanceCacheStats( bool aReset ) override;
+
 private:
     BOARD_ITEM* getBoardItem( const PNS::ITEM* aItem, PCB_LAYER_ID aBoardLayer, int aIdx = 0 );
 
@@ -162,8 +167,21 @@ private:
     PCB_VIA            m_dummyVias[2];
     int                m_clearanceEpsilon;
 
+    // The walkaround evaluates its policies concurrently, so the caches and the dummy items
+    // used for items without a parent must be protected.
+    std::mutex         m_dummyItemsLock;
+    std::shared_mutex  m_cacheLock;
+
     std::unordered_map<CLEARANCE_CACHE_KEY, int> m_clearanceCache;
     std::unordered_map<CLEARANCE_CACHE_KEY, int> m_tempClearanceCache;
+
+    ///< The m_clearanceCache keys involving each item, so they can be invalidated without
+    ///< scanning the whole cache
+    std::unordered_map<const PNS::ITEM*, std::vector<CLEARANCE_CACHE_KEY>> m_clearanceCacheKeys;
+
+    std::atomic<uint64_t> m_cacheHits;
+    std::atomic<uint64_t> m_cacheMisses;
+    uint64_t              m_cacheInvalidated;
 };
 
 
@@ -173,7 +191,10 @@ PNS_PCBNEW_RULE_RESOLVER::PNS_PCBNEW_RULE_RESOLVER( BOARD* aBoard,
     m_board( aBoard ),
     m_dummyTracks{ { aBoard }, { aBoard } },
     m_dummyArcs{ { aBoard }, { aBoard } },
-    m_dummyVias{ { aBoard }, { aBoard } }
+    m_dummyVias{ { aBoard }, { aBoard } },
+    m_cacheHits( 0 ),
+    m_cacheMisses( 0 ),
+    m_cacheInvalidated( 0 )
 {
     for( PCB_TRACK& track : m_dummyTracks )
         track.SetFlags( ROUTER_TRANSIENT );
@@ -269,6 +290,8 @@ bool PNS_PCBNEW_RULE_RESOLVER::IsKeepout( const PNS::ITEM* aObstacle, const PNS:
 
         if( zone->GetIsRuleArea() && zone->HasKeepoutParametersSet() )
         {
+            std::lock_guard<std::mutex> lock( m_dummyItemsLock );
+
             *aEnforce = checkKeepout( zone,
                                       getBoardItem( aItem, m_routerIface->GetBoardLayerFromPNSLayer(
                                                                    aObstacle->Layer() ) ) );
@@ -417,6 +440,11 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
     PCB_LAYER_ID   board_layer = m_routerIface->GetBoardLayerFromPNSLayer( aPNSLayer );
     DRC_CONSTRAINT hostConstraint;
 
+    std::unique_lock<std::mutex> dummyItemsLock( m_dummyItemsLock, std::defer_lock );
+
+    if( ( aItemA && !parentA ) || ( aItemB && !parentB ) )
+        dummyItemsLock.lock();
+
     // A track being routed may not have a BOARD_ITEM associated yet.
     if( aItemA && !parentA )
         parentA = getBoardItem( aItemA, board_layer, 0 );
@@ -427,6 +455,9 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
     if( parentA )
         hostConstraint = drcEngine->EvalRules( hostType, parentA, parentB, board_layer );
 
+    if( dummyItemsLock.owns_lock() )
+        dummyItemsLock.unlock();
+
     if( hostConstraint.IsNull() )
         return false;
 
@@ -468,60 +499,116 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
 
 void PNS_PCBNEW_RULE_RESOLVER::ClearCacheForItems( std::vector<const PNS::ITEM*>& aItems )
 {
-    int n_pruned = 0;
-    std::set<const PNS::ITEM*> remainingItems( aItems.begin(), aItems.end() );
+    std::unique_lock<std::shared_mutex> lock( m_cacheLock );
 
-/* We need to carefully check both A and B item pointers in the cache against dirty/invalidated
-   items in the set, as the clearance relation is commutative ( CL[a,b] == CL[b,a] ). The code
-   below is a bit ugly, but works in O(n*log(m)) and is run once or twice during ROUTER::Move() call
-   - so I hope it still gets better performance than no cache at all */
-    for( auto it = m_clearanceCache.begin(); it != m_clearanceCache.end(); )
+    // The clearance relation is commutative ( CL[a,b] == CL[b,a] ), so each cached entry is
+    // indexed under both of its items and must be dropped from the other item's list as well.
+    for( const PNS::ITEM* item : aItems )
     {
-        bool dirty = remainingItems.find( it->first.A ) != remainingItems.end();
-        dirty |= remainingItems.find( it->first.B) != remainingItems.end();
+        auto keysIt = m_clearanceCacheKeys.find( item );
+
+        if( keysIt == m_clearanceCacheKeys.end() )
+            continue;
+
+        std::vector<CLEARANCE_CACHE_KEY> keys = std::move( keysIt->second );
+        m_clearanceCacheKeys.erase( keysIt );
 
-        if( dirty )
+        for( const CLEARANCE_CACHE_KEY& key : keys )
         {
-            it = m_clearanceCache.erase( it );
-            n_pruned++;
-        } else
-            it++;
+            if( !m_clearanceCache.erase( key ) )
+                continue;
+
+            m_cacheInvalidated++;
+
+            const PNS::ITEM* other = ( key.A == item ) ? key.B : key.A;
+            auto             otherIt = m_clearanceCacheKeys.find( other );
+
+            if( otherIt == m_clearanceCacheKeys.end() )
+                continue;
+
+            std::vector<CLEARANCE_CACHE_KEY>& otherKeys = otherIt->second;
+            auto pos = std::find( otherKeys.begin(), otherKeys.end(), key );
+
+            if( pos != otherKeys.end() )
+            {
+                *pos = otherKeys.back();
+                otherKeys.pop_back();
+            }
+
+            if( otherKeys.empty() )
+                m_clearanceCacheKeys.erase( otherIt );
+        }
     }
-#if 0
-    printf("ClearCache : n_pruned %d\n", n_pruned );
-#endif
 }
 
 
 void PNS_PCBNEW_RULE_RESOLVER::ClearCaches()
 {
+    std::unique_lock<std::shared_mutex> lock( m_cacheLock );
+
     m_clearanceCache.clear();
     m_tempClearanceCache.clear();
+    m_clearanceCacheKeys.clear();
 }
 
 
 void PNS_PCBNEW_RULE_RESOLVER::ClearTemporaryCaches()
 {
+    std::unique_lock<std::shared_mutex> lock( m_cacheLock );
+
     m_tempClearanceCache.clear();
 }
 
 
+PNS::CLEARANCE_CACHE_STATS PNS_PCBNEW_RULE_RESOLVER::ClearanceCacheStats( bool aReset )
+{
+    std::unique_lock<std::shared_mutex> lock( m_cacheLock );
+    PNS::CLEARANCE_CACHE_STATS          stats;
+
+    stats.m_hits = m_cacheHits;
+    stats.m_misses = m_cacheMisses;
+    stats.m_invalidated = m_cacheInvalidated;
+    stats.m_size = m_clearanceCache.size();
+
+    if( aReset )
+    {
+        m_cacheHits = 0;
+        m_cacheMisses = 0;
+        m_cacheInvalidated = 0;
+    }
+
+    return stats;
+}
+
+
 int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* aB,
                                          bool aUseClearanceEpsilon )
 {
     CLEARANCE_CACHE_KEY key = { aA, aB, aUseClearanceEpsilon };
 
-    // Search cache (used for actual board items)
-    auto it = m_clearanceCache.find( key );
+    {
+        std::shared_lock<std::shared_mutex> lock( m_cacheLock );
+
+        // Search cache (used for actual board items)
+        auto it = m_clearanceCache.find( key );
+
+        if( it != m_clearanceCache.end() )
+        {
+            m_cacheHits++;
+            return it->second;
+        }
 
-    if( it != m_clearanceCache.end() )
-        return it->second;
+        // Search cache (used for temporary items within an algorithm)
+        it = m_tempClearanceCache.find( key );
 
-    // Search cache (used for temporary items within an algorithm)
-    it = m_tempClearanceCache.find( key );
+        if( it != m_tempClearanceCache.end() )
+        {
+            m_cacheHits++;
+            return it->second;
+        }
+    }
 
-    if( it != m_tempClearanceCache.end() )
-        return it->second;
+    m_cacheMisses++;
 
     PNS::CONSTRAINT constraint;
     int             rv = 0;
@@ -601,8 +688,18 @@ int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* a
      */
     if( aA && aB )
     {
+        std::unique_lock<std::shared_mutex> lock( m_cacheLock );
+
         if ( aA->Owner() && aB->Owner() )
-            m_clearanceCache[ key ] = rv;
+        {
+            if( m_clearanceCache.insert_or_assign( key, rv ).second )
+            {
+                m_clearanceCacheKeys[aA].push_back( key );
+
+                if( aB != aA )
+                    m_clearanceCacheKeys[aB].push_back( key );
+            }
+        }
         else
             m_tempClearanceCache[ key ] = rv;
     }
@@ -60,6 +60,7 @@ NODE::NODE()
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_ruleResolver = nullptr;
     m_index = new INDEX;
+    m_override = std::make_shared<std::unordered_set<ITEM*>>();
 
 #ifdef DEBUG
     allocNodes.insert( this );
@@ -144,6 +145,9 @@ NODE* NODE::Branch()
 {
     NODE* child = new NODE;
 
+    if( s_countStats.load( std::memory_order_relaxed ) )
+        s_branchCount.fetch_add( 1, std::memory_order_relaxed );
+
     m_children.insert( child );
 
     child->m_depth = m_depth + 1;
@@ -152,15 +156,11 @@ NODE* NODE::Branch()
     child->m_root = isRoot() ? this : m_root;
     child->m_maxClearance = m_maxClearance;
 
-    // Immediate offspring of the root branch needs not copy anything. For the rest, deep-copy
-    // joints, overridden item maps and pointers to stored items.
+    // Immediate offspring of the root branch needs not copy anything. For the rest, copy the
+    // joints and share the index and overridden item set (which are copied on write).
     if( !isRoot() )
     {
-        JOINT_MAP::iterator j;
-
-        for( ITEM* item : *m_index )
-            child->m_index->Add( item );
-
+        *child->m_index = *m_index;
         child->m_joints = m_joints;
         child->m_override = m_override;
     }
@@ -169,7 +169,7 @@ NODE* NODE::Branch()
     wxLogTrace( wxT( "PNS" ), wxT( "%d items, %d joints, %d overrides" ),
                 child->m_index->Size(),
                 (int) child->m_joints.size(),
-                (int) child->m_override.size() );
+                (int) child->m_override->size() );
 #endif
 
     return child;
@@ -257,6 +257,9 @@ int NODE::QueryColliding( const ITEM* aItem, NODE::OBSTACLES& aObstacles,
 {
     COLLISION_SEARCH_CONTEXT ctx( aObstacles, aOpts );
 
+    if( s_countStats.load( std::memory_order_relaxed ) )
+        s_queryCount.fetch_add( 1, std::memory_order_relaxed );
+
     /// By default, virtual items cannot collide
     if( aItem->IsVirtual() )
         return 0;
@@ -732,10 +735,13 @@ void NODE::doRemove( ITEM* aItem )
     // mark it as overridden, but do not remove
     if( aItem->BelongsTo( m_root ) && !isRoot() )
     {
-        m_override.insert( aItem );
+        if( m_override.use_count() > 1 )
+            m_override = std::make_shared<std::unordered_set<ITEM*>>( *m_override );
+
+        m_override->insert( aItem );
 
         if( aItem->HasHole() )
-            m_override.insert( aItem->Hole() );
+            m_override->insert( aItem->Hole() );
     }
 
     // case 2: the item belongs to this branch or a parent, non-root branch,
@@ -1471,13 +1477,13 @@ void NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
     if( isRoot() )
         return;
 
-    if( m_override.size() )
-        aRemoved.reserve( m_override.size() );
+    if( m_override->size() )
+        aRemoved.reserve( m_override->size() );
 
     if( m_index->Size() )
         aAdded.reserve( m_index->Size() );
 
-    for( ITEM* item : m_override )
+    for( ITEM* item : *m_override )
         aRemoved.push_back( item );
 
     for( ITEM* item : *m_index )
@@ -1526,7 +1532,7 @@ void NODE::Commit( NODE* aNode )
     if( aNode->isRoot() )
         return;
 
-    for( ITEM* item : aNode->m_override )
+    for( ITEM* item : *aNode->m_override )
         Remove( item );
 
     for( ITEM* item : *aNode->m_index )
@@ -1554,7 +1560,7 @@ void NODE::KillChildren()
 
 void NODE::AllItemsInNet( NET_HANDLE aNet, std::set<ITEM*>& aItems, int aKindMask )
 {
-    INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aNet );
+    const INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aNet );
 
     if( l_cur )
     {
@@ -1567,7 +1573,7 @@ void NODE::AllItemsInNet( NET_HANDLE aNet, std::set<ITEM*>& aItems, int aKindMas
 
     if( !isRoot() )
     {
-        INDEX::NET_ITEMS_LIST* l_root = m_root->m_index->GetItemsForNet( aNet );
+        const INDEX::NET_ITEMS_LIST* l_root = m_root->m_index->GetItemsForNet( aNet );
 
         if( l_root )
         {
@@ -1718,8 +1724,8 @@ ITEM *NODE::FindItemByParent( const BOARD_ITEM* aParent )
 {
     if( aParent && aParent->IsConnected() )
     {
-        const BOARD_CONNECTED_ITEM* cItem = static_cast<const BOARD_CONNECTED_ITEM*>( aParent );
-        INDEX::NET_ITEMS_LIST*      l_cur = m_index->GetItemsForNet( cItem->GetNet() );
+        const BOARD_CONNECTED_ITEM*  cItem = static_cast<const BOARD_CONNECTED_ITEM*>( aParent );
+        const INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( cItem->GetNet() );
 
         if( l_cur )
         {
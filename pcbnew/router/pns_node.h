@@ -23,6 +23,9 @@
 #ifndef __PNS_NODE_H
 #define __PNS_NODE_H
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <list>
 #include <set>
@@ -135,6 +138,18 @@ struct COLLISION_SEARCH_CONTEXT
 };
 
 
+/**
+ * Counters of a RULE_RESOLVER's clearance cache, for debug output.
+ */
+struct CLEARANCE_CACHE_STATS
+{
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_invalidated = 0;     ///< entries dropped by ClearCacheForItems()
+    size_t   m_size = 0;            ///< entries currently cached
+};
+
+
 class RULE_RESOLVER
 {
 public:
@@ -169,6 +184,11 @@ public:
     virtual void ClearCaches() {}
     virtual void ClearTemporaryCaches() {}
 
+    /**
+     * @return the clearance cache counters accumulated since the last reset.
+     */
+    virtual CLEARANCE_CACHE_STATS ClearanceCacheStats( bool aReset ) { return {}; }
+
     virtual int ClearanceEpsilon() const { return 0; }
 };
 
@@ -491,7 +511,7 @@ public:
     ///< Check if this branch contains an updated version of the m_item from the root branch.
     bool Overrides( ITEM* aItem ) const
     {
-        return m_override.find( aItem ) != m_override.end();
+        return m_override->find( aItem ) != m_override->end();
     }
 
     void FixupVirtualVias();
@@ -503,11 +523,31 @@ public:
 
     const std::unordered_set<ITEM*>& GetOverrides() const
     {
-        return m_override;
+        return *m_override;
     }
 
     VIA* FindViaByHandle ( const VIA_HANDLE& handle ) const;
 
+    /**
+     * Enable the global counters behind GetBranchCount() (bumped by every Branch()) and
+     * GetCollisionQueryCount() (bumped by every QueryColliding() call).
+     *
+     * The counters are never reset; PNS_LOG_PLAYER reports their difference across each event.
+     * Meant for the pns_benchmark tool only, so interactive routing doesn't pay for the
+     * atomic increments.
+     */
+    static void SetStatsCounting( bool aEnable )
+    {
+        s_countStats.store( aEnable, std::memory_order_relaxed );
+    }
+
+    static uint64_t GetBranchCount() { return s_branchCount.load( std::memory_order_relaxed ); }
+
+    static uint64_t GetCollisionQueryCount()
+    {
+        return s_queryCount.load( std::memory_order_relaxed );
+    }
+
 private:
     void add( ITEM* aItem, bool aAllowRedundant = false );
 
@@ -574,8 +614,9 @@ private:
     NODE*           m_root;             ///< root node of the whole hierarchy
     std::set<NODE*> m_children;         ///< list of nodes branched from this one
 
-    std::unordered_set<ITEM*> m_override;   ///< hash of root's items that have been changed
-                                            ///< in this node
+    ///< hash of root's items that have been changed in this node (shared with the parent
+    ///< until either of them changes it)
+    std::shared_ptr<std::unordered_set<ITEM*>> m_override;
 
     int             m_maxClearance;     ///< worst case item-item clearance
     RULE_RESOLVER*  m_ruleResolver;     ///< Design rules resolver
@@ -586,6 +627,10 @@ private:
     std::vector< std::unique_ptr<SHAPE> > m_edgeExclusions;
 
     std::unordered_set<ITEM*> m_garbageItems;
+
+    static inline std::atomic<bool>     s_countStats = false;
+    static inline std::atomic<uint64_t> s_branchCount = 0;
+    static inline std::atomic<uint64_t> s_queryCount = 0;
 };
 
 }
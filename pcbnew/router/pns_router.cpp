@@ -49,6 +49,7 @@
 #include "pns_meander_placer.h"
 #include "pns_meander_skew_placer.h"
 #include "pns_dp_meander_placer.h"
+#include "pns_debug_decorator.h"
 #include "router_preview_item.h"
 
 namespace PNS {
@@ -57,9 +58,14 @@ namespace PNS {
 // To be fixed sometime in the future.
 static ROUTER* theRouter;
 
-ROUTER::ROUTER()
+// routers that are not the global instance (e.g. batch routing regions) register themselves
+// per thread while they run
+static thread_local ROUTER* threadRouter = nullptr;
+
+ROUTER::ROUTER( bool aGlobalInstance )
 {
-    theRouter = this;
+    if( aGlobalInstance )
+        theRouter = this;
 
     m_state = IDLE;
     m_mode = PNS_MODE_ROUTE_SINGLE;
@@ -80,14 +86,25 @@ ROUTER::ROUTER()
 
 ROUTER* ROUTER::GetInstance()
 {
+    if( threadRouter )
+        return threadRouter;
+
     return theRouter;
 }
 
 
+void ROUTER::SetThreadInstance( ROUTER* aRouter )
+{
+    threadRouter = aRouter;
+}
+
+
 ROUTER::~ROUTER()
 {
     ClearWorld();
-    theRouter = nullptr;
+
+    if( theRouter == this )
+        theRouter = nullptr;
     delete m_logger;
 }
 
@@ -728,6 +745,18 @@ void ROUTER::updateView( NODE* aNode, ITEM_SET& aCurrent, bool aDragging )
     std::vector<const PNS::ITEM*> cacheCheckItems( added.begin(), added.end() );
     GetRuleResolver()->ClearCacheForItems( cacheCheckItems );
 
+    CLEARANCE_CACHE_STATS cacheStats = GetRuleResolver()->ClearanceCacheStats( true );
+    uint64_t              cacheLookups = cacheStats.m_hits + cacheStats.m_misses;
+
+    PNS_DBG( m_iface->GetDebugDecorator(), Message,
+             wxString::Format( wxT( "clearance cache: %llu hits, %llu misses (%.1f%% hit rate), "
+                                    "%llu invalidated, %llu entries" ),
+                               (unsigned long long) cacheStats.m_hits,
+                               (unsigned long long) cacheStats.m_misses,
+                               cacheLookups ? 100.0 * cacheStats.m_hits / cacheLookups : 0.0,
+                               (unsigned long long) cacheStats.m_invalidated,
+                               (unsigned long long) cacheStats.m_size ) );
+
     for( ITEM* item : added )
     {
         int clearance = GetRuleResolver()->Clearance( item, nullptr );
@@ -142,7 +142,11 @@ public:
     };
 
 public:
-    ROUTER();
+    /**
+     * @param aGlobalInstance if false, the router does not replace the instance returned by
+     *                        GetInstance(); use SetThreadInstance() while it is running instead.
+     */
+    explicit ROUTER( bool aGlobalInstance = true );
     ~ROUTER();
 
     void SetInterface( ROUTER_IFACE* aIface );
@@ -155,6 +159,12 @@ public:
 
     static ROUTER* GetInstance();
 
+    /**
+     * Override the instance returned by GetInstance() for the calling thread.  Pass nullptr to
+     * restore the global instance.
+     */
+    static void SetThreadInstance( ROUTER* aRouter );
+
     void ClearWorld();
     void SyncWorld();
 
@@ -43,6 +43,7 @@ ROUTING_SETTINGS::ROUTING_SETTINGS( JSON_SETTINGS* aParent, const std::string& a
     m_shoveIterationLimit = 250;
     m_shoveTimeLimit = 1000;
     m_walkaroundIterationLimit = 40;
+    m_walkaroundTimeLimit = 1000;
     m_jumpOverObstacles = false;
     m_smoothDraggedSegments = true;
     m_allowDRCViolations = false;
@@ -122,6 +123,12 @@ TIME_LIMIT ROUTING_SETTINGS::ShoveTimeLimit() const
 }
 
 
+TIME_LIMIT ROUTING_SETTINGS::WalkaroundTimeLimit() const
+{
+    return TIME_LIMIT ( m_walkaroundTimeLimit );
+}
+
+
 int ROUTING_SETTINGS::ShoveIterationLimit() const
 {
     return m_shoveIterationLimit;
@@ -23,7 +23,10 @@
 #include <advanced_config.h>
 #include <optional>
 
+#include <future>
+
 #include <geometry/shape_line_chain.h>
+#include <thread_pool.h>
 
 #include "pns_walkaround.h"
 #include "pns_optimizer.h"
@@ -36,7 +39,6 @@ namespace PNS {
 
 void WALKAROUND::start( const LINE& aInitialPath )
 {
-    m_iteration = 0;
     for( int pol = 0 ; pol < MaxWalkPolicies; pol++)
     {
         m_currentResult.status[ pol ] = ST_IN_PROGRESS;
@@ -101,39 +103,36 @@ static wxString policy2string ( WALKAROUND::WALK_POLICY policy )
     return wxT("?");
 }
 
-bool WALKAROUND::singleStep()
+void WALKAROUND::singleStep( int aPolicy )
 {
     TOPOLOGY topo( m_world );
-    TOPOLOGY::CLUSTER pendingClusters[MaxWalkPolicies];
-
-    for( int i = 0; i < MaxWalkPolicies; i++ )
-    {
-        if( !m_enabledPolicies[i] )
-            continue;
-
-        auto& line = m_currentResult.lines[ i ];
-        auto& status = m_currentResult.status[ i ];
-
-        PNS_DBG( Dbg(), AddItem, &line, WHITE, 10000, wxString::Format( "current (policy %d, stat %d)", i, status ) );
+    TOPOLOGY::CLUSTER pendingCluster;
 
-        if( status != ST_IN_PROGRESS )
-            continue;
+    auto& currentLine = m_currentResult.lines[ aPolicy ];
+    auto& status = m_currentResult.status[ aPolicy ];
 
-        auto obstacle = nearestObstacle( line );
-
-        if( !obstacle )
-        {
-
-            m_currentResult.status[ i ] = ST_DONE;
-            PNS_DBG( Dbg(), Message,  wxString::Format( "no-more-colls pol %d st %d", i, status ) );
-
-            continue;
-        }
+    PNS_DBG( Dbg(), AddItem, &currentLine, WHITE, 10000,
+             wxString::Format( "current (policy %d, stat %d)", aPolicy, status ) );
 
+    if( status != ST_IN_PROGRESS )
+        return;
 
-        pendingClusters[ i ] = topo.AssembleCluster( obstacle->m_item, line.Layer(), 0.0, line.Net() );
-        PNS_DBG( Dbg(), AddItem, obstacle->m_item, BLUE, 10000, wxString::Format( "col-item owner-depth %d cl-items=%d", static_cast<const NODE*>( obstacle->m_item->Owner() )->Depth(), (int) pendingClusters[i].m_items.size() ) );
+    auto obstacle = nearestObstacle( currentLine );
 
+    if( !obstacle )
+    {
+        m_currentResult.status[ aPolicy ] = ST_DONE;
+        PNS_DBG( Dbg(), Message,
+                 wxString::Format( "no-more-colls pol %d st %d", aPolicy, status ) );
+    }
+    else
+    {
+        pendingCluster = topo.AssembleCluster( obstacle->m_item, currentLine.Layer(), 0.0,
+                                               currentLine.Net() );
+        PNS_DBG( Dbg(), AddItem, obstacle->m_item, BLUE, 10000,
+                 wxString::Format( "col-item owner-depth %d cl-items=%d",
+                                   static_cast<const NODE*>( obstacle->m_item->Owner() )->Depth(),
+                                   (int) pendingCluster.m_items.size() ) );
     }
 
     DIRECTION_45::CORNER_MODE cornerMode = Settings().GetCornerMode();
@@ -198,27 +197,21 @@ bool WALKAROUND::singleStep()
         return true;
     };
 
-    if ( m_enabledPolicies[WP_CW] )
+    if( aPolicy == WP_CW || aPolicy == WP_CCW )
     {
-        bool stat = processCluster( pendingClusters[ WP_CW ], m_currentResult.lines[ WP_CW ], true );
-        if( !stat )
-            m_currentResult.status[ WP_CW ] = ST_STUCK;
-    }
+        bool stat = processCluster( pendingCluster, m_currentResult.lines[ aPolicy ],
+                                    aPolicy == WP_CW );
 
-    if ( m_enabledPolicies[WP_CCW] )
-    {
-        bool stat = processCluster( pendingClusters[ WP_CCW ], m_currentResult.lines[ WP_CCW ], false );
         if( !stat )
-            m_currentResult.status[ WP_CCW ] = ST_STUCK;
+            m_currentResult.status[ aPolicy ] = ST_STUCK;
     }
-
-    if( m_enabledPolicies[WP_SHORTEST] )
+    else if( aPolicy == WP_SHORTEST )
     {
         LINE& line = m_currentResult.lines[WP_SHORTEST];
         LINE  path_cw( line ), path_ccw( line );
 
-        auto st_cw = processCluster( pendingClusters[WP_SHORTEST], path_cw, true );
-        auto st_ccw = processCluster( pendingClusters[WP_SHORTEST], path_ccw, false );
+        auto st_cw = processCluster( pendingCluster, path_cw, true );
+        auto st_ccw = processCluster( pendingCluster, path_ccw, false );
 
         bool cw_coll = st_cw ? m_world->CheckColliding( &path_cw ).has_value() : false;
         bool ccw_coll = st_ccw ? m_world->CheckColliding( &path_ccw ).has_value() : false;
@@ -273,7 +266,11 @@ bool WALKAROUND::singleStep()
                 }
             }
 
-            PNS_DBG( Dbg(), Message, wxString::Format("check-back cc %d items %d coll %d", (int) pendingClusters[ WP_SHORTEST ].m_items.size(), (int) m_lastShortestCluster->m_items.size(), anyColliding ? 1: 0 ) );
+            PNS_DBG( Dbg(), Message,
+                     wxString::Format( "check-back cc %d items %d coll %d",
+                                       (int) pendingCluster.m_items.size(),
+                                       (int) m_lastShortestCluster->m_items.size(),
+                                       anyColliding ? 1 : 0 ) );
         }
 
         if ( anyColliding )
@@ -290,10 +287,40 @@ bool WALKAROUND::singleStep()
             m_currentResult.lines[WP_SHORTEST] = *shortest;
         }
 
-        m_lastShortestCluster = pendingClusters[ WP_SHORTEST ];
+        m_lastShortestCluster = pendingCluster;
     }
+}
+
+
+void WALKAROUND::walkPolicy( int aPolicy, const LINE& aInitialPath )
+{
+    TIME_LIMIT timeLimit = Settings().WalkaroundTimeLimit();
+    auto&      st = m_currentResult.status[aPolicy];
+    auto&      ln = m_currentResult.lines[aPolicy];
 
-    return ST_IN_PROGRESS;
+    for( int iteration = 0; iteration < m_iterationLimit; iteration++ )
+    {
+        singleStep( aPolicy );
+
+        double lengthFactor = (double) ln.CLine().Length()
+                                / (double) aInitialPath.CLine().Length();
+
+        // In some situations, there isn't a trivial path (or even a path at all).  Hitting the
+        // iteration limit causes lag, so we can exit out early if the walkaround path gets very
+        // long compared with the initial path.  If the length exceeds the initial length times
+        // this factor, fail out.
+        if( m_lengthLimitOn )
+        {
+            if( st != ST_DONE && lengthFactor > m_lengthExpansionFactor )
+                st = ST_ALMOST_DONE;
+        }
+
+        PNS_DBG( Dbg(), Message, wxString::Format( "check-wp iter %d st %d i %d lf %.1f",
+                                                   iteration, st, aPolicy, lengthFactor ) );
+
+        if( st != ST_IN_PROGRESS || timeLimit.Expired() )
+            break;
+    }
 }
 
 
@@ -323,41 +350,46 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
 
     PNS_DBG( Dbg(), AddItem, &aInitialPath, WHITE, 10000, wxT( "initial-path" ) );
 
-    while( m_iteration < m_iterationLimit )
-    {
-        singleStep();
+    std::vector<int> policies;
 
-        bool stillInProgress = false;
+    for( int pol = 0; pol < MaxWalkPolicies; pol++ )
+    {
+        if( m_enabledPolicies[pol] )
+            policies.push_back( pol );
+    }
 
-        for( int pol = 0; pol < MaxWalkPolicies; pol++ )
-        {
-            if (!m_enabledPolicies[pol])
-                continue;
-
-            auto& st = m_currentResult.status[pol];
-            auto& ln = m_currentResult.lines[pol];
-            double lengthFactor = (double) ln.CLine().Length() / (double) aInitialPath.CLine().Length();
-            // In some situations, there isn't a trivial path (or even a path at all).  Hitting the
-            // iteration limit causes lag, so we can exit out early if the walkaround path gets very long
-            // compared with the initial path.  If the length exceeds the initial length times this factor,
-            // fail out.
-            if( m_lengthLimitOn )
-            {
-                if( st != ST_DONE && lengthFactor > m_lengthExpansionFactor )
-                    st = ST_ALMOST_DONE;
-            }
+    // The policies don't depend on each other and only read the world, so they can be walked
+    // concurrently.  The debug decorator isn't thread-safe though, and a caller which is
+    // itself running on the thread pool mustn't block waiting for it.
+    bool parallel = m_useThreadPool && policies.size() > 1
+                    && !( Dbg() && Dbg()->IsDebugEnabled() )
+                    && !BS::this_thread::get_index().has_value();
 
-            PNS_DBG( Dbg(), Message, wxString::Format( "check-wp iter %d st %d i %d lf %.1f", m_iteration, st, pol, lengthFactor ) );
+    if( parallel )
+    {
+        thread_pool&                   tp = GetKiCadThreadPool();
+        std::vector<std::future<void>> returns;
 
-            if ( st == ST_IN_PROGRESS )
-                stillInProgress = true;
+        for( size_t ii = 1; ii < policies.size(); ++ii )
+        {
+            returns.emplace_back( tp.submit_task(
+                    [this, &aInitialPath, pol = policies[ii]]()
+                    {
+                        ROUTER::SetThreadInstance( Router() );
+                        walkPolicy( pol, aInitialPath );
+                        ROUTER::SetThreadInstance( nullptr );
+                    } ) );
         }
 
+        walkPolicy( policies[0], aInitialPath );
 
-        if( !stillInProgress )
-            break;
-
-        m_iteration++;
+        for( const std::future<void>& ret : returns )
+            ret.wait();
+    }
+    else
+    {
+        for( int pol : policies )
+            walkPolicy( pol, aInitialPath );
     }
 
 
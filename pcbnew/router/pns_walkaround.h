@@ -46,7 +46,6 @@ public:
         m_itemMask = ITEM::ANY_T;
 
         // Initialize other members, to avoid uninitialized variables.
-        m_iteration = 0;
         m_initialLength = 0.0;
         m_forceCw = false;
         m_forceLongerPath = false;
@@ -54,6 +53,7 @@ public:
         m_useShortestPath = false;
         m_lengthExpansionFactor = 10.0;
         m_iterationLimit = Settings().WalkaroundIterationLimit();
+        m_useThreadPool = true;
     }
 
     ~WALKAROUND() {};
@@ -135,14 +135,28 @@ public:
 
     void SetAllowedPolicies( std::vector<WALK_POLICY> aPolicies);
 
+    /**
+     * Walk the policies one after another rather than on the thread pool.  The results are the
+     * same either way.
+     */
+    void SetUseThreadPool( bool aEnabled )
+    {
+        m_useThreadPool = aEnabled;
+    }
+
 private:
     void start( const LINE& aInitialPath );
-    bool singleStep();
+
+    ///< Take one step around the nearest obstacle with the given policy.
+    void singleStep( int aPolicy );
+
+    ///< Step with the given policy until it's done, stuck or out of iterations or time.  Each
+    ///< policy only touches its own entries of m_currentResult so they can run concurrently.
+    void walkPolicy( int aPolicy, const LINE& aInitialPath );
 
     NODE::OPT_OBSTACLE nearestObstacle( const LINE& aPath );
     NODE* m_world;
 
-    int m_iteration;
     int m_iterationLimit;
     int m_itemMask;
     bool m_forceWinding;
@@ -155,6 +169,7 @@ private:
     bool m_lengthLimitOn;
     bool m_useShortestPath;
     double m_lengthExpansionFactor;
+    bool m_useThreadPool;
     bool m_enabledPolicies[ MaxWalkPolicies ];
     NODE::OPT_OBSTACLE m_currentObstacle[ MaxWalkPolicies ];
     TOPOLOGY::CLUSTER m_currentCluster[ MaxWalkPolicies ];
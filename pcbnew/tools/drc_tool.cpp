@@ -37,6 +37,7 @@
 #include <drc/drc_item.h>
 #include <netlist_reader/pcb_netlist.h>
 #include <macros.h>
+#include <advanced_config.h>
 #include <dialog_exchange_footprints.h>
 
 DRC_TOOL::DRC_TOOL() :
@@ -65,6 +66,8 @@ void DRC_TOOL::Reset( RESET_REASON aReason )
 
         m_pcb = m_editFrame->GetBoard();
         m_drcEngine = m_pcb->GetDesignSettings().m_DRCEngine;
+        m_queuedChangedItems.clear();
+        m_queuedRemovedItems.clear();
     }
 }
 
@@ -206,6 +209,85 @@ void DRC_TOOL::RunTests( PROGRESS_REPORTER* aProgressReporter, bool aRefillZones
 }
 
 
+void DRC_TOOL::RunIncrementalTests( const std::vector<BOARD_ITEM*>& aChangedItems,
+                                    const std::set<KIID>& aRemovedItems )
+{
+    if( m_drcRunning || !m_drcEngine->RulesValid() )
+        return;
+
+    if( aChangedItems.empty() && aRemovedItems.empty() )
+        return;
+
+    BOARD_COMMIT commit( m_editFrame );
+
+    m_drcRunning = true;
+
+    m_drcEngine->SetViolationHandler(
+            [&]( const std::shared_ptr<DRC_ITEM>& aItem, const VECTOR2I& aPos, int aLayer,
+                 const std::function<void( PCB_MARKER* )>& aPathGenerator )
+            {
+                PCB_MARKER* marker = new PCB_MARKER( aItem, aPos, aLayer );
+                aPathGenerator( marker );
+                commit.Add( marker );
+            } );
+
+    m_drcEngine->RunIncrementalTests( m_editFrame->GetUserUnits(), aChangedItems, aRemovedItems,
+                                      &commit );
+
+    m_drcEngine->ClearViolationHandler();
+
+    commit.Push( _( "DRC" ), SKIP_UNDO | SKIP_SET_DIRTY );
+
+    m_drcRunning = false;
+
+    updatePointers( false );
+}
+
+
+bool DRC_TOOL::CanRunIncrementalTests() const
+{
+    return ADVANCED_CFG::GetCfg().m_LiveIncrementalDRC && !m_drcRunning && m_drcEngine
+                && m_drcEngine->HasIncrementalTree();
+}
+
+
+void DRC_TOOL::QueueIncrementalTests( const std::vector<BOARD_ITEM*>& aChangedItems,
+                                      const std::set<KIID>& aRemovedItems )
+{
+    for( BOARD_ITEM* item : aChangedItems )
+    {
+        if( item->Type() != PCB_MARKER_T )
+            m_queuedChangedItems.insert( item->m_Uuid );
+    }
+
+    m_queuedRemovedItems.insert( aRemovedItems.begin(), aRemovedItems.end() );
+}
+
+
+int DRC_TOOL::RunQueuedIncrementalTests( const TOOL_EVENT& aEvent )
+{
+    std::vector<BOARD_ITEM*> changedItems;
+    std::set<KIID>           removedItems = std::move( m_queuedRemovedItems );
+
+    // Several commits may have been queued; anything deleted since it was queued is removed
+    for( const KIID& id : m_queuedChangedItems )
+    {
+        if( BOARD_ITEM* item = m_pcb->ResolveItem( id, true ) )
+            changedItems.push_back( item );
+        else
+            removedItems.insert( id );
+    }
+
+    m_queuedChangedItems.clear();
+    m_queuedRemovedItems.clear();
+
+    if( CanRunIncrementalTests() )
+        RunIncrementalTests( changedItems, removedItems );
+
+    return 0;
+}
+
+
 void DRC_TOOL::updatePointers( bool aDRCWasCancelled )
 {
     // update my pointers, m_editFrame is the only unchangeable one
@@ -392,6 +474,7 @@ void DRC_TOOL::FixDRCError( const std::shared_ptr<RC_ITEM>& aDRCItem )
 void DRC_TOOL::setTransitions()
 {
     Go( &DRC_TOOL::ShowDRCDialog,              PCB_ACTIONS::runDRC.MakeEvent() );
+    Go( &DRC_TOOL::RunQueuedIncrementalTests,  PCB_ACTIONS::runIncrementalDRC.MakeEvent() );
     Go( &DRC_TOOL::PrevMarker,                 ACTIONS::prevMarker.MakeEvent() );
     Go( &DRC_TOOL::NextMarker,                 ACTIONS::nextMarker.MakeEvent() );
     Go( &DRC_TOOL::ExcludeMarker,              ACTIONS::excludeMarker.MakeEvent() );
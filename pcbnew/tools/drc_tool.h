@@ -85,6 +85,32 @@ public:
     void RunTests( PROGRESS_REPORTER* aProgressReporter, bool aRefillZones,
                    bool aReportAllTrackErrors, bool aTestFootprints );
 
+    /**
+     * Re-check only the items touched by a commit, replacing their existing markers.
+     *
+     * @param aChangedItems and aRemovedItems are as gathered by BOARD_COMMIT::GetStagedItems()
+     *                      before the commit was pushed.
+     * @see DRC_ENGINE::RunIncrementalTests()
+     */
+    void RunIncrementalTests( const std::vector<BOARD_ITEM*>& aChangedItems,
+                              const std::set<KIID>& aRemovedItems );
+
+    /**
+     * @return true if live incremental DRC is enabled and a DRC run has left a tree for the
+     *         incremental tests to patch.
+     */
+    bool CanRunIncrementalTests() const;
+
+    /**
+     * Queue the items of a commit for the next #PCB_ACTIONS::runIncrementalDRC.
+     *
+     * The items are held by id, so items deleted before the action runs are treated as removed.
+     */
+    void QueueIncrementalTests( const std::vector<BOARD_ITEM*>& aChangedItems,
+                                const std::set<KIID>& aRemovedItems );
+
+    int RunQueuedIncrementalTests( const TOOL_EVENT& aEvent );
+
     int PrevMarker( const TOOL_EVENT& aEvent );
     int NextMarker( const TOOL_EVENT& aEvent );
     int CrossProbe( const TOOL_EVENT& aEvent );
@@ -117,6 +143,9 @@ private:
     DIALOG_DRC*                 m_drcDialog;
     bool                        m_drcRunning;
     std::shared_ptr<DRC_ENGINE> m_drcEngine;
+
+    std::set<KIID>              m_queuedChangedItems;
+    std::set<KIID>              m_queuedRemovedItems;
 };
 
 
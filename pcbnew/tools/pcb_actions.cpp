@@ -465,6 +465,10 @@ TOOL_ACTION PCB_ACTIONS::runDRC( TOOL_ACTION_ARGS()
         .Tooltip( _( "Show the design rules checker window" ) )
         .Icon( BITMAPS::erc ) );
 
+TOOL_ACTION PCB_ACTIONS::runIncrementalDRC( TOOL_ACTION_ARGS()
+        .Name( "pcbnew.DRCTool.runIncrementalDRC" )
+        .Scope( AS_CONTEXT ) );
+
 // PCB_DESIGN_BLOCK_CONTROL
 TOOL_ACTION PCB_ACTIONS::placeDesignBlock( TOOL_ACTION_ARGS()
         .Name( "pcbnew.InteractiveDrawing.placeDesignBlock" )
@@ -459,6 +459,7 @@ public:
     static TOOL_ACTION removeUnusedPads;
 
     static TOOL_ACTION runDRC;
+    static TOOL_ACTION runIncrementalDRC;  ///< Re-check the items queued by board commits
 
     static TOOL_ACTION editFpInFpEditor;
     static TOOL_ACTION editLibFpInFpEditor;
@@ -63,6 +63,29 @@ void ZONE_FILLER_TOOL::Reset( RESET_REASON aReason )
 }
 
 
+void ZONE_FILLER_TOOL::DirtyZone( ZONE* aZone, const std::optional<BOX2I>& aDamage )
+{
+    bool alreadyDirty = !m_dirtyZoneIDs.insert( aZone->m_Uuid ).second;
+
+    if( !aDamage )
+    {
+        m_dirtyZoneAreas.erase( aZone->m_Uuid );
+    }
+    else if( !alreadyDirty )
+    {
+        m_dirtyZoneAreas[ aZone->m_Uuid ] = *aDamage;
+    }
+    else
+    {
+        auto it = m_dirtyZoneAreas.find( aZone->m_Uuid );
+
+        // Otherwise the zone is already scheduled for a full refill
+        if( it != m_dirtyZoneAreas.end() )
+            it->second.Merge( *aDamage );
+    }
+}
+
+
 void ZONE_FILLER_TOOL::CheckAllZones( wxWindow* aCaller, PROGRESS_REPORTER* aReporter )
 {
     if( !getEditFrame<PCB_EDIT_FRAME>()->m_ZoneFillsDirty || m_fillInProgress )
@@ -233,6 +256,16 @@ int ZONE_FILLER_TOOL::ZoneFillDirty( const TOOL_EVENT& aEvent )
 
     m_filler = std::make_unique<ZONE_FILLER>( board(), &commit );
 
+    for( ZONE* zone : toFill )
+    {
+        auto it = m_dirtyZoneAreas.find( zone->m_Uuid );
+
+        if( it != m_dirtyZoneAreas.end() )
+            m_filler->SetDirtyArea( zone, it->second );
+    }
+
+    m_dirtyZoneAreas.clear();
+
     if( !board()->GetDesignSettings().m_DRCEngine->RulesValid() )
     {
         WX_INFOBAR* infobar = frame->GetInfoBar();
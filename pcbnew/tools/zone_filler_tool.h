@@ -63,10 +63,13 @@ public:
 
     PROGRESS_REPORTER* GetProgressReporter();
 
-    void DirtyZone( ZONE* aZone )
-    {
-        m_dirtyZoneIDs.insert( aZone->m_Uuid );
-    }
+    /**
+     * Mark a zone as needing a refill.
+     *
+     * @param aDamage is the area of the zone affected by the change, or std::nullopt if the
+     *                whole zone must be refilled.
+     */
+    void DirtyZone( ZONE* aZone, const std::optional<BOX2I>& aDamage = std::nullopt );
 
     static bool IsZoneFillAction( const TOOL_EVENT* aEvent );
 
@@ -85,6 +88,7 @@ private:
     bool                         m_fillInProgress;
 
     std::set<KIID>               m_dirtyZoneIDs;
+    std::map<KIID, BOX2I>        m_dirtyZoneAreas;   ///< Zones which only need a partial refill
 };
 
 #endif
@@ -29,6 +29,7 @@
 using namespace std::placeholders;
 #include <macros.h>
 #include <pcb_edit_frame.h>
+#include <board_design_settings.h>
 #include <pcb_track.h>
 #include <pcb_group.h>
 #include <pcb_shape.h>
@@ -44,6 +45,8 @@ using namespace std::placeholders;
 #include <tools/pcb_selection_tool.h>
 #include <tools/pcb_control.h>
 #include <tools/board_editor_control.h>
+#include <tools/drc_tool.h>
+#include <drc/drc_engine.h>
 #include <board_commit.h>
 #include <drawing_sheet/ds_proxy_undo_item.h>
 #include <wx/msgdlg.h>
@@ -658,8 +661,38 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList )
 
     GetToolManager()->PostAction( PCB_ACTIONS::rehatchShapes );
 
+    // Undo and redo don't go through BOARD_COMMIT, so hand their items to live DRC here (its
+    // copper tree only learns about the items it is told of).
+    DRC_TOOL* drcTool = IsType( FRAME_PCB_EDITOR ) ? m_toolManager->GetTool<DRC_TOOL>() : nullptr;
+
+    if( drcTool && drcTool->CanRunIncrementalTests() )
+    {
+        std::vector<BOARD_ITEM*> drcItems( added_items );
+        std::set<KIID>           removedIds;
+
+        drcItems.insert( drcItems.end(), changed_items.begin(), changed_items.end() );
+
+        for( BOARD_ITEM* item : deleted_items )
+        {
+            removedIds.insert( item->m_Uuid );
+
+            item->RunOnChildren(
+                    [&]( BOARD_ITEM* child )
+                    {
+                        removedIds.insert( child->m_Uuid );
+                    },
+                    RECURSE_MODE::RECURSE );
+        }
+
+        drcTool->QueueIncrementalTests( drcItems, removedIds );
+        GetToolManager()->PostAction( PCB_ACTIONS::runIncrementalDRC );
+    }
+
     if( added_items.size() > 0 || deleted_items.size() > 0 || changed_items.size() > 0 )
         GetBoard()->OnItemsCompositeUpdate( added_items, deleted_items, changed_items );
+
+    if( std::shared_ptr<DRC_ENGINE> drcEngine = GetBoard()->GetDesignSettings().m_DRCEngine )
+        drcEngine->InvalidateRuleCache();
 }
 
 
@@ -197,6 +197,11 @@ void ZONE::InitDataFromSrcInCopyCtor( const ZONE& aZone, PCB_LAYER_ID aLayer )
 
                 m_filledPolysHash[layer]  = aZone.m_filledPolysHash.at( layer );
                 m_insulatedIslands[layer] = aZone.m_insulatedIslands.at( layer );
+
+                if( std::optional<HASH_128> inputHash = aZone.GetFillInputHash( layer ) )
+                    m_fillInputHashes[layer] = *inputHash;
+                else
+                    m_fillInputHashes.erase( layer );
             } );
 
     m_layerProperties         = aZone.m_layerProperties;
@@ -464,6 +469,7 @@ bool ZONE::UnFill()
 
     m_isFilled = false;
     m_fillFlags.reset();
+    m_fillInputHashes.clear();
 
     return change;
 }
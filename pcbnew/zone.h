@@ -29,6 +29,7 @@
 #include <mutex>
 #include <vector>
 #include <map>
+#include <optional>
 #include <gr_basic.h>
 #include <board_item.h>
 #include <board_connected_item.h>
@@ -619,6 +620,19 @@ public:
         m_FilledPolysList[aLayer] = std::make_shared<SHAPE_POLY_SET>( aPolysList );
     }
 
+    /**
+     * Set the list of filled polygons, taking over the storage of \a aPolysList.  As it isn't
+     * copied, the spare capacity left over by the fill computation is released.
+     */
+    void SetFilledPolysList( PCB_LAYER_ID aLayer, SHAPE_POLY_SET&& aPolysList )
+    {
+        std::shared_ptr<SHAPE_POLY_SET> fill = std::make_shared<SHAPE_POLY_SET>();
+
+        *fill = std::move( aPolysList );
+        fill->ShrinkToFit();
+        m_FilledPolysList[aLayer] = std::move( fill );
+    }
+
     /**
      * Check if a given filled polygon is an insulated island.
      *
@@ -777,6 +791,30 @@ public:
      */
     HASH_128 GetHashValue( PCB_LAYER_ID aLayer );
 
+    /**
+     * Set the hash of everything the fill of \a aLayer was computed from (the zone outline and
+     * settings, and the items around it).  If it still matches when the zone is next filled,
+     * the existing fill is kept.
+     */
+    void SetFillInputHash( PCB_LAYER_ID aLayer, const HASH_128& aHash )
+    {
+        m_fillInputHashes[aLayer] = aHash;
+    }
+
+    /**
+     * @return the hash set by SetFillInputHash(), or std::nullopt if the fill of \a aLayer
+     *         wasn't produced by the zone filler (or has since been cleared).
+     */
+    std::optional<HASH_128> GetFillInputHash( PCB_LAYER_ID aLayer ) const
+    {
+        auto it = m_fillInputHashes.find( aLayer );
+
+        if( it == m_fillInputHashes.end() )
+            return std::nullopt;
+
+        return it->second;
+    }
+
     double Similarity( const BOARD_ITEM& aOther ) const override;
 
     bool operator==( const ZONE& aOther ) const;
@@ -897,6 +935,9 @@ protected:
     /// A hash value used in zone filling calculations to see if the filled areas are up to date
     std::map<PCB_LAYER_ID, HASH_128>       m_filledPolysHash;
 
+    /// Hash of the inputs to the fill of each layer (see SetFillInputHash())
+    std::map<PCB_LAYER_ID, HASH_128>       m_fillInputHashes;
+
     ZONE_BORDER_DISPLAY_STYLE m_borderStyle;       // border display style, see enum above
     int                       m_borderHatchPitch;  // for DIAGONAL_EDGE, distance between 2 lines
     std::vector<SEG>          m_borderHatchLines;  // hatch lines
@@ -23,7 +23,11 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <atomic>
+#include <cmath>
 #include <future>
+#include <latch>
+#include <thread>
 #include <core/kicad_algo.h>
 #include <advanced_config.h>
 #include <board.h>
@@ -49,6 +53,7 @@
 #include <kidialog.h>
 #include <thread_pool.h>
 #include <math/util.h>      // for KiROUND
+#include <mmh3_hash.h>
 #include "zone_filler.h"
 #include "project.h"
 #include "project/project_local_settings.h"
@@ -197,6 +202,128 @@ private:
 };
 
 
+/// Below this many holes a subtraction is done in one go, as tiling it costs more than it saves
+static const int TILED_SUBTRACT_MIN_HOLES = 1000;
+
+
+void ZONE_FILLER::SubtractTiled( SHAPE_POLY_SET& aFill, const SHAPE_POLY_SET& aHoles )
+{
+    thread_pool& tp = GetKiCadThreadPool();
+    int          threads = (int) tp.get_thread_count();
+    BOX2I        bbox = aFill.BBox();
+
+    if( aHoles.OutlineCount() < TILED_SUBTRACT_MIN_HOLES || threads < 2 || bbox.GetArea() <= 0 )
+    {
+        aFill.BooleanSubtract( aHoles );
+        return;
+    }
+
+    // A few tiles per thread, as squarish as the fill allows
+    int    tileCount = std::min( 4 * threads, 256 );
+    double aspect = (double) bbox.GetWidth() / bbox.GetHeight();
+    int    cols = std::clamp( KiROUND( std::sqrt( tileCount * aspect ) ), 1, tileCount );
+    int    rows = std::max( 1, ( tileCount + cols - 1 ) / cols );
+
+    struct TILING
+    {
+        TILING( int aTileCount ) :
+                tiles( aTileCount ),
+                tileHoles( aTileCount ),
+                results( aTileCount ),
+                done( aTileCount )
+        {}
+
+        std::vector<BOX2I>            tiles;
+        std::vector<std::vector<int>> tileHoles;
+        std::vector<SHAPE_POLY_SET>   results;
+        std::atomic<size_t>           next = 0;
+        std::latch                    done;       ///< counted down as each tile is finished
+    };
+
+    auto tiling = std::make_shared<TILING>( rows * cols );
+
+    // Tile edges are shared by neighbours, so both of them cut the fill at the same place
+    auto edge =
+            []( int aMin, int aSize, int aIdx, int aCount )
+            {
+                return (int) ( aMin + (int64_t) aSize * aIdx / aCount );
+            };
+
+    for( int row = 0; row < rows; ++row )
+    {
+        for( int col = 0; col < cols; ++col )
+        {
+            VECTOR2I tileMin( edge( bbox.GetX(), bbox.GetWidth(), col, cols ),
+                              edge( bbox.GetY(), bbox.GetHeight(), row, rows ) );
+            VECTOR2I tileMax( edge( bbox.GetX(), bbox.GetWidth(), col + 1, cols ),
+                              edge( bbox.GetY(), bbox.GetHeight(), row + 1, rows ) );
+
+            tiling->tiles[row * cols + col] = BOX2I( tileMin, tileMax - tileMin );
+        }
+    }
+
+    for( int ii = 0; ii < aHoles.OutlineCount(); ++ii )
+    {
+        BOX2I holeBox = aHoles.COutline( ii ).BBox();
+
+        for( size_t tile = 0; tile < tiling->tiles.size(); ++tile )
+        {
+            if( tiling->tiles[tile].Intersects( holeBox ) )
+                tiling->tileHoles[tile].push_back( ii );
+        }
+    }
+
+    // Late helpers find no tile left and return without touching aFill or aHoles, which may
+    // be gone by then
+    auto work =
+            [tiling, &aFill, &aHoles]()
+            {
+                for( size_t tile = tiling->next++; tile < tiling->tiles.size();
+                     tile = tiling->next++ )
+                {
+                    const BOX2I&    box = tiling->tiles[tile];
+                    SHAPE_POLY_SET& result = tiling->results[tile];
+                    SHAPE_POLY_SET  holes;
+
+                    result = SHAPE_POLY_SET( BOX2D( VECTOR2D( box.GetPosition() ),
+                                                   VECTOR2D( box.GetSize() ) ) );
+                    result.BooleanIntersection( aFill );
+
+                    if( !result.IsEmpty() )
+                    {
+                        for( int ii : tiling->tileHoles[tile] )
+                            holes.AddPolygon( aHoles.CPolygon( ii ) );
+
+                        result.BooleanSubtract( holes );
+                    }
+
+                    tiling->done.count_down();
+                }
+            };
+
+    for( int ii = 1; ii < std::min<int>( threads, tiling->tiles.size() ); ++ii )
+        tp.detach_task( work );
+
+    work();
+
+    // Our own loop only ends once every tile has been taken, so the tiles still missing are
+    // being worked on by running threads.  Don't wait on the queued tasks themselves: they may
+    // be stuck behind fill tasks which are waiting here too.
+    tiling->done.wait();
+
+    SHAPE_POLY_SET stitched;
+
+    for( const SHAPE_POLY_SET& result : tiling->results )
+    {
+        for( const SHAPE_POLY_SET::POLYGON& poly : result.CPolygons() )
+            stitched.AddPolygon( poly );
+    }
+
+    stitched.Simplify();
+    aFill = std::move( stitched );
+}
+
+
 ZONE_FILLER::ZONE_FILLER( BOARD* aBoard, COMMIT* aCommit ) :
         m_board( aBoard ),
         m_brdOutlinesValid( false ),
@@ -211,6 +338,12 @@ ZONE_FILLER::ZONE_FILLER( BOARD* aBoard, COMMIT* aCommit ) :
 }
 
 
+void ZONE_FILLER::SetDirtyArea( ZONE* aZone, const BOX2I& aDirtyArea )
+{
+    m_dirtyAreas[ aZone ] = aDirtyArea;
+}
+
+
 ZONE_FILLER::~ZONE_FILLER()
 {
 }
@@ -239,6 +372,8 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE*>& aZones, bool aCheck, wxWindow*
 
     std::vector<std::pair<ZONE*, PCB_LAYER_ID>>               toFill;
     std::map<std::pair<ZONE*, PCB_LAYER_ID>, HASH_128>        oldFillHashes;
+    std::map<std::pair<ZONE*, PCB_LAYER_ID>, SHAPE_POLY_SET>  cachedFills;
+    std::map<std::pair<ZONE*, PCB_LAYER_ID>, HASH_128>        cachedFillInputHashes;
     std::map<ZONE*, std::map<PCB_LAYER_ID, ISOLATED_ISLANDS>> isolatedIslandsMap;
 
     std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board->GetConnectivity();
@@ -252,6 +387,8 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE*>& aZones, bool aCheck, wxWindow*
     connectivity->Build( m_board, m_progressReporter );
 
     m_worstClearance = m_board->GetMaxClearanceValue();
+    m_refillAreas.clear();
+    m_previousFills.clear();
 
     if( m_progressReporter )
     {
@@ -477,10 +614,43 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE*>& aZones, bool aCheck, wxWindow*
         if( m_commit )
             m_commit->Modify( zone );
 
+        // Keep the existing fill of zones which only need refilling around a dirty area.  The
+        // refill area is inflated far enough that its edges aren't affected by knockouts, thermal
+        // spokes or min-width pruning of anything inside the dirty area.
+        auto dirtyArea = m_dirtyAreas.find( zone );
+
+        if( dirtyArea != m_dirtyAreas.end() && !aCheck && !m_debugZoneFiller && zone->IsFilled()
+                && zone->IsOnCopperLayer() && zone->GetFillMode() != ZONE_FILL_MODE::HATCH_PATTERN )
+        {
+            BOX2I refillArea = dirtyArea->second;
+            refillArea.Inflate( m_worstClearance + zone->GetThermalReliefGap()
+                                + 2 * std::max( zone->GetMinThickness(),
+                                                zone->GetThermalReliefSpokeWidth() ) );
+
+            m_refillAreas[ zone ] = refillArea;
+
+            for( PCB_LAYER_ID layer : zone->GetLayerSet() )
+            {
+                m_previousFills[ { zone, layer } ] =
+                        zone->GetFilledPolysList( layer )->CloneDropTriangulation();
+            }
+        }
+
         // calculate the hash value for filled areas. it will be used later to know if the
         // current filled areas are up to date
         for( PCB_LAYER_ID layer : zone->GetLayerSet() )
         {
+            // Keep fills which were saved along with the hash of their inputs; if the inputs
+            // haven't changed they can be reused as-is.
+            std::optional<HASH_128> fillInputHash = zone->GetFillInputHash( layer );
+
+            if( fillInputHash && zone->IsFilled() && !m_debugZoneFiller )
+            {
+                cachedFills[ { zone, layer } ] =
+                        zone->GetFilledPolysList( layer )->CloneDropTriangulation();
+                cachedFillInputHashes[ { zone, layer } ] = *fillInputHash;
+            }
+
             zone->BuildHashValue( layer );
             oldFillHashes[ { zone, layer } ] = zone->GetHashValue( layer );
 
@@ -536,46 +706,97 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE*>& aZones, bool aCheck, wxWindow*
                 return aZone->Outline()->Collide( aOtherZone->Outline(), m_worstClearance );
             };
 
-    auto fill_lambda =
-            [&]( std::pair<ZONE*, PCB_LAYER_ID> aFillItem ) -> int
-            {
-                PCB_LAYER_ID layer = aFillItem.second;
-                ZONE*        zone = aFillItem.first;
-                bool         canFill = true;
+    // Build the fill dependency graph.  A zone layer has to wait for the higher-priority zones
+    // it knocks out to be filled (and tesselated) first; zones which don't interact have no
+    // edges between them and are filled fully in parallel.
+    std::vector<std::vector<size_t>>            successors( toFill.size() );
+    std::vector<std::atomic<size_t>>            pendingPredecessors( toFill.size() );
+    std::map<PCB_LAYER_ID, std::vector<size_t>> fillItemsByLayer;
 
-                // Check for any fill dependencies.  If our zone needs to be clipped by
-                // another zone then we can't fill until that zone is filled.
-                for( ZONE* otherZone : aZones )
-                {
-                    if( otherZone == zone )
-                        continue;
+    for( size_t ii = 0; ii < toFill.size(); ++ii )
+        fillItemsByLayer[ toFill[ii].second ].push_back( ii );
 
-                    if( check_fill_dependency( zone, layer, otherZone ) )
-                    {
-                        canFill = false;
-                        break;
-                    }
+    for( const auto& [ layer, fillItems ] : fillItemsByLayer )
+    {
+        for( size_t ii : fillItems )
+        {
+            for( size_t jj : fillItems )
+            {
+                if( ii != jj && check_fill_dependency( toFill[ii].first, layer, toFill[jj].first ) )
+                {
+                    successors[jj].push_back( ii );
+                    pendingPredecessors[ii]++;
                 }
+            }
+        }
+    }
 
-                if( m_progressReporter && m_progressReporter->IsCancelled() )
-                    return 0;
+    thread_pool& tp = GetKiCadThreadPool();
+
+    // Hash the inputs of each fill.  A stored fill can be reused when its inputs are unchanged
+    // and so are the fills of all the higher-priority zones it knocks out.
+    std::vector<HASH_128>     fillInputHashes( toFill.size() );
+    std::vector<uint8_t>      useCachedFill( toFill.size(), 0 );
+    PACKED_RTREE<BOARD_ITEM*> fillInputItems;
+
+    indexFillInputItems( fillInputItems );
+
+    auto hashFutures = tp.submit_loop( (size_t) 0, toFill.size(),
+            [&]( size_t ii )
+            {
+                fillInputHashes[ii] = computeFillInputHash( toFill[ii].first, toFill[ii].second,
+                                                            fillInputItems );
+            } );
 
-                if( !canFill )
+    for( auto& ret : hashFutures )
+        ret.wait();
+
+    std::vector<size_t> cacheMisses;
+
+    for( size_t ii = 0; ii < toFill.size(); ++ii )
+    {
+        auto cachedHash = cachedFillInputHashes.find( toFill[ii] );
+
+        if( cachedHash != cachedFillInputHashes.end() && cachedHash->second == fillInputHashes[ii] )
+            useCachedFill[ii] = 1;
+        else
+            cacheMisses.push_back( ii );
+    }
+
+    while( !cacheMisses.empty() )
+    {
+        size_t ii = cacheMisses.back();
+        cacheMisses.pop_back();
+
+        for( size_t successor : successors[ii] )
+        {
+            if( useCachedFill[successor] )
+            {
+                useCachedFill[successor] = 0;
+                cacheMisses.push_back( successor );
+            }
+        }
+    }
+
+    auto fill_lambda =
+            [&]( size_t aIdx ) -> int
+            {
+                PCB_LAYER_ID layer = toFill[aIdx].second;
+                ZONE*        zone = toFill[aIdx].first;
+
+                if( m_progressReporter && m_progressReporter->IsCancelled() )
                     return 0;
 
-                // Now we're ready to fill.
+                // Other layers of the same zone may be filling concurrently
                 {
-                    std::unique_lock<std::mutex> zoneLock( zone->GetLock(), std::try_to_lock );
-
-                    if( !zoneLock.owns_lock() )
-                        return 0;
+                    std::lock_guard<std::mutex> zoneLock( zone->GetLock() );
 
                     SHAPE_POLY_SET fillPolys;
 
-                    if( !fillSingleZone( zone, layer, fillPolys ) )
-                        return 0;
-
-                    zone->SetFilledPolysList( layer, fillPolys );
+                    if( useCachedFill[aIdx] )
+                        zone->SetFilledPolysList( layer, cachedFills.at( toFill[aIdx] ) );
+                    else if( fillSingleZone( zone, layer, fillPolys ) )
+                        zone->SetFilledPolysList( layer, std::move( fillPolys ) );
                 }
 
                 if( m_progressReporter )
@@ -594,10 +815,7 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE*>& aZones, bool aCheck, wxWindow*
                 ZONE*        zone = aFillItem.first;
 
                 {
-                    std::unique_lock<std::mutex> zoneLock( zone->GetLock(), std::try_to_lock );
-
-                    if( !zoneLock.owns_lock() )
-                        return 0;
+                    std::lock_guard<std::mutex> zoneLock( zone->GetLock() );
 
                     zone->CacheTriangulation( layer );
                     zone->SetFillFlag( layer, true );
@@ -608,67 +826,45 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE*>& aZones, bool aCheck, wxWindow*
 
     // Calculate the copper fills (NB: this is multi-threaded)
     //
-    std::vector<std::pair<std::future<int>, int>> returns;
-    returns.reserve( toFill.size() );
-    size_t finished = 0;
-    bool cancelled = false;
+    // Each fill item is queued as soon as its last predecessor completes, starting with the
+    // items which have no predecessors at all.
+    std::atomic<size_t> finished( 0 );
+    std::atomic<size_t> inFlight( 0 );
+    bool                cancelled = false;
+
+    std::function<void( size_t )> queueFillItem =
+            [&]( size_t aIdx )
+            {
+                inFlight++;
 
-    thread_pool& tp = GetKiCadThreadPool();
+                tp.detach_task(
+                        [&, aIdx]()
+                        {
+                            if( fill_lambda( aIdx ) && tesselate_lambda( toFill[aIdx] ) )
+                            {
+                                finished++;
 
-    for( const std::pair<ZONE*, PCB_LAYER_ID>& fillItem : toFill )
+                                for( size_t successor : successors[aIdx] )
+                                {
+                                    if( --pendingPredecessors[successor] == 0 )
+                                        queueFillItem( successor );
+                                }
+                            }
+
+                            inFlight--;
+                        } );
+            };
+
+    for( size_t ii = 0; ii < toFill.size(); ++ii )
     {
-        returns.emplace_back( std::make_pair( tp.submit_task(
-                [&, fillItem]()
-                {
-                    return fill_lambda( fillItem );
-                } ), 0 ) );
+        if( pendingPredecessors[ii] == 0 )
+            queueFillItem( ii );
     }
 
-    while( !cancelled && finished != 2 * toFill.size() )
+    while( !cancelled && finished != toFill.size() )
     {
-        for( size_t ii = 0; ii < returns.size(); ++ii )
-        {
-            auto& ret = returns[ii];
-
-            if( ret.second > 1 )
-                continue;
-
-            std::future_status status = ret.first.wait_for( std::chrono::seconds( 0 ) );
-
-            if( status == std::future_status::ready )
-            {
-                if( ret.first.get() )   // lambda completed
-                {
-                    ++finished;
-                    ret.second++;       // go to next step
-                }
-
-                if( !cancelled )
-                {
-                    // Queue the next step (will re-queue the existing step if it didn't complete)
-                    if( ret.second == 0 )
-                    {
-                        returns[ii].first = tp.submit_task(
-                                [&, idx = ii]()
-                                {
-                                    return fill_lambda( toFill[idx] );
-                                } );
-                    }
-                    else if( ret.second == 1 )
-                    {
-                        returns[ii].first = tp.submit_task(
-                                [&, idx = ii]()
-                                {
-                                    return tesselate_lambda( toFill[idx] );
-                                } );
-                    }
-                }
-            }
-        }
-
         std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
 
-
         if( m_progressReporter )
         {
             m_progressReporter->KeepRefreshing();
@@ -678,22 +874,14 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE*>& aZones, bool aCheck, wxWindow*
         }
     }
 
-    // Make sure that all futures have finished.
+    // Make sure that all queued fills have finished.
     // This can happen when the user cancels the above operation
-    for( auto& ret : returns )
+    while( inFlight > 0 )
     {
-        if( ret.first.valid() )
-        {
-            std::future_status status = ret.first.wait_for( std::chrono::seconds( 0 ) );
-
-            while( status != std::future_status::ready )
-            {
-                if( m_progressReporter )
-                    m_progressReporter->KeepRefreshing();
+        if( m_progressReporter )
+            m_progressReporter->KeepRefreshing();
 
-                status = ret.first.wait_for( std::chrono::milliseconds( 100 ) );
-            }
-        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
     }
 
     // Now update the connectivity to check for isolated copper islands
@@ -894,6 +1082,8 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE*>& aZones, bool aCheck, wxWindow*
     for( ZONE* zone : aZones )
         zone->CalculateFilledArea();
 
+    for( size_t ii = 0; ii < toFill.size(); ++ii )
+        toFill[ii].first->SetFillInputHash( toFill[ii].second, fillInputHashes[ii] );
 
     if( aCheck )
     {
@@ -1121,7 +1311,7 @@ void ZONE_FILLER::knockoutThermalReliefs( const ZONE* aZone, PCB_LAYER_ID aLayer
             BOX2I padBBox = pad->GetBoundingBox();
             padBBox.Inflate( m_worstClearance );
 
-            if( !padBBox.Intersects( aZone->GetBoundingBox() ) )
+            if( !padBBox.Intersects( getFillArea( aZone ) ) )
                 continue;
 
             bool noConnection = pad->GetNetCode() != aZone->GetNetCode();
@@ -1239,7 +1429,7 @@ void ZONE_FILLER::knockoutThermalReliefs( const ZONE* aZone, PCB_LAYER_ID aLayer
                 BOX2I viaBBox = via->GetBoundingBox();
                 viaBBox.Inflate( m_worstClearance );
 
-                if( !viaBBox.Intersects( aZone->GetBoundingBox() ) )
+                if( !viaBBox.Intersects( getFillArea( aZone ) ) )
                     continue;
 
                 bool noConnection = via->GetNetCode() != aZone->GetNetCode()
@@ -1322,7 +1512,7 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLa
     // A small extra clearance to be sure actual track clearances are not smaller than
     // requested clearance due to many approximations in calculations, like arc to segment
     // approx, rounding issues, etc.
-    BOX2I zone_boundingbox = aZone->GetBoundingBox();
+    BOX2I zone_boundingbox = getFillArea( aZone );
     int   extra_margin = pcbIUScale.mmToIU( ADVANCED_CFG::GetCfg().m_ExtraClearance );
 
     // Items outside the zone bounding box are skipped, so it needs to be inflated by the
@@ -1779,7 +1969,7 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLa
 void ZONE_FILLER::subtractHigherPriorityZones( const ZONE* aZone, PCB_LAYER_ID aLayer,
                                                SHAPE_POLY_SET& aRawFill )
 {
-    BOX2I zoneBBox = aZone->GetBoundingBox();
+    BOX2I zoneBBox = getFillArea( aZone );
 
     auto knockoutZoneOutline =
             [&]( ZONE* aKnockout )
@@ -1982,7 +2172,7 @@ bool ZONE_FILLER::fillCopperZone( const ZONE* aZone, PCB_LAYER_ID aLayer, PCB_LA
     // because the "real" subtract-clearance-holes has to be done after the spokes are added.
     static const bool USE_BBOX_CACHES = true;
     SHAPE_POLY_SET testAreas = aFillPolys.CloneDropTriangulation();
-    testAreas.BooleanSubtract( clearanceHoles );
+    SubtractTiled( testAreas, clearanceHoles );
     DUMP_POLYS_TO_COPPER_LAYER( testAreas, In4_Cu, wxT( "minus-clearance-holes" ) );
 
     // Prune features that don't meet minimum-width criteria
@@ -2050,7 +2240,7 @@ bool ZONE_FILLER::fillCopperZone( const ZONE* aZone, PCB_LAYER_ID aLayer, PCB_LA
     if( m_progressReporter && m_progressReporter->IsCancelled() )
         return false;
 
-    aFillPolys.BooleanSubtract( clearanceHoles );
+    SubtractTiled( aFillPolys, clearanceHoles );
     DUMP_POLYS_TO_COPPER_LAYER( aFillPolys, In8_Cu, wxT( "after-spoke-trimming" ) );
 
     /* -------------------------------------------------------------------------------------
@@ -2135,7 +2325,7 @@ bool ZONE_FILLER::fillCopperZone( const ZONE* aZone, PCB_LAYER_ID aLayer, PCB_LA
 
     aFillPolys.BooleanIntersection( aMaxExtents );
     DUMP_POLYS_TO_COPPER_LAYER( aFillPolys, In16_Cu, wxT( "after-trim-to-outline" ) );
-    aFillPolys.BooleanSubtract( clearanceHoles );
+    SubtractTiled( aFillPolys, clearanceHoles );
     DUMP_POLYS_TO_COPPER_LAYER( aFillPolys, In17_Cu, wxT( "after-trim-to-clearance-holes" ) );
 
     /* -------------------------------------------------------------------------------------
@@ -2150,6 +2340,318 @@ bool ZONE_FILLER::fillCopperZone( const ZONE* aZone, PCB_LAYER_ID aLayer, PCB_LA
 }
 
 
+void ZONE_FILLER::indexFillInputItems( PACKED_RTREE<BOARD_ITEM*>& aCandidates ) const
+{
+    auto addItem =
+            [&]( BOARD_ITEM* aItem )
+            {
+                aCandidates.Add( aItem->GetBoundingBox(), aItem );
+            };
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+        addItem( track );
+
+    for( BOARD_ITEM* item : m_board->Drawings() )
+        addItem( item );
+
+    for( ZONE* zone : m_board->Zones() )
+        addItem( zone );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+        footprint->RunOnChildren( addItem, RECURSE_MODE::RECURSE );
+
+    aCandidates.Build();
+}
+
+
+HASH_128 ZONE_FILLER::computeFillInputHash( const ZONE* aZone, PCB_LAYER_ID aLayer,
+                                            const PACKED_RTREE<BOARD_ITEM*>& aCandidates )
+{
+    // Bump this whenever the fill algorithm changes so that stored fills get recomputed
+    static const int FILL_ALGORITHM_VERSION = 1;
+
+    BOARD_DESIGN_SETTINGS& bds = m_board->GetDesignSettings();
+    MMH3_HASH              hash( FILL_ALGORITHM_VERSION );
+
+    auto addHash =
+            [&]( MMH3_HASH& aHash, const HASH_128& aValue )
+            {
+                for( uint32_t value : aValue.Value32 )
+                    aHash.add( static_cast<int32_t>( value ) );
+            };
+
+    // MMH3_HASH can't mix variable-length data with integers, so strings are hashed on
+    // their own and folded in as a digest.
+    auto addString =
+            [&]( MMH3_HASH& aHash, const std::string& aString )
+            {
+                MMH3_HASH strHash;
+                strHash.add( aString );
+                strHash.add( static_cast<int32_t>( aString.length() ) );
+                addHash( aHash, strHash.digest() );
+            };
+
+    auto addBox =
+            [&]( MMH3_HASH& aHash, const BOX2I& aBox )
+            {
+                aHash.add( aBox.GetX() );
+                aHash.add( aBox.GetY() );
+                aHash.add( static_cast<int32_t>( aBox.GetWidth() ) );
+                aHash.add( static_cast<int32_t>( aBox.GetHeight() ) );
+            };
+
+    // The zone itself
+    addHash( hash, aZone->Outline()->GetHash() );
+    addString( hash, std::string( aZone->GetNetname().ToUTF8() ) );
+    addString( hash, std::string( LSET::Name( aLayer ).ToUTF8() ) );
+    hash.add( static_cast<int32_t>( aZone->GetAssignedPriority() ) );
+    hash.add( static_cast<int32_t>( aZone->GetTeardropAreaType() ) );
+    hash.add( aZone->GetMinThickness() );
+    hash.add( aZone->GetLocalClearance().value_or( 0 ) );
+    hash.add( static_cast<int32_t>( aZone->GetPadConnection() ) );
+    hash.add( aZone->GetThermalReliefGap() );
+    hash.add( aZone->GetThermalReliefSpokeWidth() );
+    hash.add( aZone->GetCornerSmoothingType() );
+    hash.add( static_cast<int32_t>( aZone->GetCornerRadius() ) );
+    hash.add( static_cast<int32_t>( aZone->GetIslandRemovalMode() ) );
+    hash.add( static_cast<int32_t>( aZone->GetMinIslandArea() / pcbIUScale.IU_PER_MM ) );
+    hash.add( static_cast<int32_t>( aZone->GetFillMode() ) );
+
+    if( aZone->GetFillMode() == ZONE_FILL_MODE::HATCH_PATTERN )
+    {
+        VECTOR2I hatchOffset;
+
+        if( bds.m_ZoneLayerProperties.contains( aLayer ) )
+        {
+            const ZONE_LAYER_PROPERTIES& props = bds.m_ZoneLayerProperties.at( aLayer );
+            hatchOffset = props.hatching_offset.value_or( VECTOR2I() );
+        }
+
+        if( aZone->LayerProperties().contains( aLayer ) )
+        {
+            const ZONE_LAYER_PROPERTIES& props = aZone->LayerProperties().at( aLayer );
+            hatchOffset = props.hatching_offset.value_or( hatchOffset );
+        }
+
+        hash.add( aZone->GetHatchThickness() );
+        hash.add( aZone->GetHatchGap() );
+        hash.add( KiROUND( aZone->GetHatchOrientation().AsDegrees() * 1000 ) );
+        hash.add( aZone->GetHatchSmoothingLevel() );
+        hash.add( KiROUND( aZone->GetHatchSmoothingValue() * 1000 ) );
+        hash.add( aZone->GetHatchBorderAlgorithm() );
+        hash.add( KiROUND( aZone->GetHatchHoleMinArea() * 1000 ) );
+        hash.add( hatchOffset.x );
+        hash.add( hatchOffset.y );
+    }
+
+    // Board-level inputs
+    if( m_brdOutlinesValid )
+        addHash( hash, m_boardOutline.GetHash() );
+
+    hash.add( m_maxError );
+    hash.add( m_worstClearance );
+    hash.add( bds.m_CopperEdgeClearance );
+    hash.add( m_board->GetProject()
+              && m_board->GetProject()->GetLocalSettings().m_PrototypeZoneFill );
+
+    // Everything close enough to the zone to affect its fill.  The individual item hashes are
+    // summed so that the result doesn't depend on the order of the board's item lists.
+    BOX2I zoneBBox = aZone->GetBoundingBox();
+    zoneBBox.Inflate( m_worstClearance
+                      + pcbIUScale.mmToIU( ADVANCED_CFG::GetCfg().m_ExtraClearance ) );
+
+    LSET     relevantLayers = LSET( { aLayer, Edge_Cuts, Margin } );
+    HASH_128 itemsHash;
+
+    auto addItem =
+            [&]( BOARD_ITEM* aItem )
+            {
+                if( aItem == aZone || !aItem->GetBoundingBox().Intersects( zoneBBox ) )
+                    return;
+
+                if( !( aItem->GetLayerSet() & relevantLayers ).any() && !aItem->HasHole() )
+                    return;
+
+                MMH3_HASH itemHash;
+
+                itemHash.add( static_cast<int32_t>( aItem->Type() ) );
+                itemHash.add( static_cast<int32_t>( aItem->m_Uuid.Hash() ) );
+                addBox( itemHash, aItem->GetBoundingBox() );
+
+                if( aItem->IsConnected() )
+                {
+                    auto connectedItem = static_cast<BOARD_CONNECTED_ITEM*>( aItem );
+                    addString( itemHash, std::string( connectedItem->GetNetname().ToUTF8() ) );
+                }
+
+                if( aItem->Type() == PCB_ZONE_T )
+                {
+                    ZONE* zone = static_cast<ZONE*>( aItem );
+
+                    addHash( itemHash, zone->Outline()->GetHash() );
+                    itemHash.add( static_cast<int32_t>( zone->GetAssignedPriority() ) );
+                    itemHash.add( zone->GetIsRuleArea() );
+                    itemHash.add( zone->GetDoNotAllowZoneFills() );
+                }
+                else if( aItem->IsOnLayer( aLayer ) )
+                {
+                    SHAPE_POLY_SET shape;
+                    aItem->TransformShapeToPolygon( shape, aLayer, 0, m_maxError, ERROR_OUTSIDE );
+                    addHash( itemHash, shape.GetHash() );
+                }
+
+                // Conditional flashing was resolved above and depends on zone outlines.  Thermal
+                // spokes start from the centre of the pad shape and follow its orientation and
+                // spoke angle, none of which show in the shape of a round pad; custom pads can
+                // also route their spokes along proxy segments.
+                if( aItem->Type() == PCB_PAD_T )
+                {
+                    PAD*     pad = static_cast<PAD*>( aItem );
+                    VECTOR2I shapePos = pad->ShapePos( aLayer );
+                    VECTOR2I size = pad->GetSize( aLayer );
+
+                    itemHash.add( pad->FlashLayer( aLayer ) );
+                    itemHash.add( static_cast<int32_t>( pad->GetShape( aLayer ) ) );
+                    itemHash.add( size.x );
+                    itemHash.add( size.y );
+                    itemHash.add( shapePos.x );
+                    itemHash.add( shapePos.y );
+                    itemHash.add( KiROUND( pad->GetOrientation().AsDegrees() * 1000 ) );
+                    itemHash.add( KiROUND( pad->GetThermalSpokeAngle().AsDegrees() * 1000 ) );
+
+                    if( pad->GetShape( aLayer ) == PAD_SHAPE::CUSTOM )
+                    {
+                        for( const std::shared_ptr<PCB_SHAPE>& primitive :
+                             pad->GetPrimitives( aLayer ) )
+                        {
+                            if( !primitive->IsProxyItem() )
+                                continue;
+
+                            itemHash.add( static_cast<int32_t>( primitive->GetShape() ) );
+                            itemHash.add( primitive->GetStart().x );
+                            itemHash.add( primitive->GetStart().y );
+                            itemHash.add( primitive->GetEnd().x );
+                            itemHash.add( primitive->GetEnd().y );
+                        }
+                    }
+                }
+                else if( aItem->Type() == PCB_VIA_T )
+                {
+                    PCB_VIA* via = static_cast<PCB_VIA*>( aItem );
+
+                    itemHash.add( via->FlashLayer( aLayer ) );
+                    itemHash.add( via->GetWidth( aLayer ) );
+                    itemHash.add( via->GetPosition().x );
+                    itemHash.add( via->GetPosition().y );
+                }
+
+                if( aItem->HasHole() )
+                {
+                    std::shared_ptr<SHAPE_SEGMENT> hole = aItem->GetEffectiveHoleShape();
+                    addString( itemHash, hole->Format() );
+                }
+
+                if( aItem->IsConnected() && bds.m_DRCEngine )
+                {
+                    for( DRC_CONSTRAINT_T type : { CLEARANCE_CONSTRAINT, HOLE_CLEARANCE_CONSTRAINT,
+                                                   PHYSICAL_CLEARANCE_CONSTRAINT,
+                                                   PHYSICAL_HOLE_CLEARANCE_CONSTRAINT,
+                                                   THERMAL_RELIEF_GAP_CONSTRAINT,
+                                                   THERMAL_SPOKE_WIDTH_CONSTRAINT } )
+                    {
+                        DRC_CONSTRAINT c = bds.m_DRCEngine->EvalRules( type, aZone, aItem, aLayer );
+
+                        itemHash.add( c.m_Value.HasMin() ? c.m_Value.Min() : -1 );
+                        itemHash.add( c.m_Value.HasOpt() ? c.m_Value.Opt() : -1 );
+                    }
+
+                    DRC_CONSTRAINT zc = bds.m_DRCEngine->EvalZoneConnection( aItem, aZone, aLayer );
+                    itemHash.add( static_cast<int32_t>( zc.m_ZoneConnection ) );
+                }
+
+                HASH_128 digest = itemHash.digest();
+                itemsHash.Value64[0] += digest.Value64[0];
+                itemsHash.Value64[1] += digest.Value64[1];
+            };
+
+    int searchMin[2] = { zoneBBox.GetX(), zoneBBox.GetY() };
+    int searchMax[2] = { zoneBBox.GetRight(), zoneBBox.GetBottom() };
+
+    aCandidates.Search( searchMin, searchMax,
+            [&]( BOARD_ITEM* aItem ) -> bool
+            {
+                addItem( aItem );
+                return true;
+            } );
+
+    addHash( hash, itemsHash );
+
+    return hash.digest();
+}
+
+
+BOX2I ZONE_FILLER::getFillArea( const ZONE* aZone ) const
+{
+    BOX2I bbox = aZone->GetBoundingBox();
+    auto  refillArea = m_refillAreas.find( aZone );
+
+    if( refillArea != m_refillAreas.end() )
+    {
+        // Knockouts are built a margin beyond the refill area so that the fill at its edges
+        // comes out the same as a full refill would.
+        BOX2I workArea = refillArea->second;
+        workArea.Inflate( m_worstClearance + 2 * aZone->GetMinThickness() );
+
+        bbox = bbox.Intersect( workArea );
+    }
+
+    return bbox;
+}
+
+
+bool ZONE_FILLER::refillCopperZoneArea( const ZONE* aZone, PCB_LAYER_ID aLayer,
+                                        const SHAPE_POLY_SET& aSmoothedOutline,
+                                        const SHAPE_POLY_SET& aMaxExtents,
+                                        const SHAPE_POLY_SET& aPreviousFill,
+                                        SHAPE_POLY_SET& aFillPolys )
+{
+    auto toPolySet =
+            []( const BOX2I& aBox )
+            {
+                SHAPE_POLY_SET poly;
+                poly.NewOutline();
+                poly.Append( aBox.GetLeft(), aBox.GetTop() );
+                poly.Append( aBox.GetRight(), aBox.GetTop() );
+                poly.Append( aBox.GetRight(), aBox.GetBottom() );
+                poly.Append( aBox.GetLeft(), aBox.GetBottom() );
+                return poly;
+            };
+
+    SHAPE_POLY_SET refillArea = toPolySet( m_refillAreas.at( aZone ) );
+    SHAPE_POLY_SET workArea = toPolySet( getFillArea( aZone ) );
+
+    // Fill the zone as if its outline was clipped to the work area...
+    SHAPE_POLY_SET smoothedOutline = aSmoothedOutline.CloneDropTriangulation();
+    smoothedOutline.BooleanIntersection( workArea );
+
+    SHAPE_POLY_SET maxExtents = aMaxExtents.CloneDropTriangulation();
+    maxExtents.BooleanIntersection( workArea );
+
+    if( !fillCopperZone( aZone, aLayer, UNDEFINED_LAYER, smoothedOutline, maxExtents, aFillPolys ) )
+        return false;
+
+    // ... and splice the part inside the refill area into the previous fill.
+    SHAPE_POLY_SET keptFill = aPreviousFill.CloneDropTriangulation();
+    keptFill.BooleanSubtract( refillArea );
+
+    aFillPolys.BooleanIntersection( refillArea );
+    aFillPolys.BooleanAdd( keptFill );
+    aFillPolys.Fracture();
+
+    return true;
+}
+
+
 bool ZONE_FILLER::fillNonCopperZone( const ZONE* aZone, PCB_LAYER_ID aLayer,
                                      const SHAPE_POLY_SET& aSmoothedOutline,
                                      SHAPE_POLY_SET& aFillPolys )
@@ -2195,7 +2697,7 @@ bool ZONE_FILLER::fillNonCopperZone( const ZONE* aZone, PCB_LAYER_ID aLayer,
     }
 
     aFillPolys = aSmoothedOutline;
-    aFillPolys.BooleanSubtract( clearanceHoles );
+    SubtractTiled( aFillPolys, clearanceHoles );
 
     auto subtractKeepout =
             [&]( ZONE* candidate )
@@ -2291,8 +2793,20 @@ bool ZONE_FILLER::fillSingleZone( ZONE* aZone, PCB_LAYER_ID aLayer, SHAPE_POLY_S
 
     if( aZone->IsOnCopperLayer() )
     {
-        if( fillCopperZone( aZone, aLayer, debugLayer, smoothedPoly, maxExtents, aFillPolys ) )
+        auto previousFill = m_previousFills.find( { aZone, aLayer } );
+
+        if( previousFill != m_previousFills.end() )
+        {
+            if( refillCopperZoneArea( aZone, aLayer, smoothedPoly, maxExtents, previousFill->second,
+                                      aFillPolys ) )
+            {
+                aZone->SetNeedRefill( false );
+            }
+        }
+        else if( fillCopperZone( aZone, aLayer, debugLayer, smoothedPoly, maxExtents, aFillPolys ) )
+        {
             aZone->SetNeedRefill( false );
+        }
     }
     else
     {
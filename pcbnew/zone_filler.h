@@ -26,8 +26,10 @@
 #ifndef ZONE_FILLER_H
 #define ZONE_FILLER_H
 
+#include <map>
 #include <vector>
 #include <zone.h>
+#include <geometry/packed_rtree.h>
 
 class PROGRESS_REPORTER;
 class BOARD;
@@ -57,8 +59,32 @@ public:
      */
     bool Fill( const std::vector<ZONE*>& aZones, bool aCheck = false, wxWindow* aParent = nullptr );
 
+    /**
+     * Limit the next refill of \a aZone to the area around \a aDirtyArea (typically the bounding
+     * boxes of the changed items which damaged the zone).  Knockouts are only rebuilt inside
+     * that area and the result is spliced into the existing fill.
+     *
+     * Zones which aren't currently filled, and hatched zones (whose pattern is anchored to the
+     * whole zone), are always refilled in full.
+     */
+    void SetDirtyArea( ZONE* aZone, const BOX2I& aDirtyArea );
+
     bool IsDebug() const { return m_debugZoneFiller; }
 
+    /**
+     * Subtract \a aHoles from \a aFill, cutting the work into tiles which are run on the thread
+     * pool when there are enough holes for it to pay off.
+     *
+     * Each tile clips the fill to its rectangle and subtracts only the holes whose bounding
+     * boxes reach it.  The holes don't need clipping as (A & T) - B == (A - B) & T.  Neighbouring
+     * tiles share their edges exactly, so a final union merges the pieces back together without
+     * seams.
+     *
+     * This is normally called from a fill task which is itself running on the thread pool, so
+     * it takes tiles itself too and only waits for the tiles other threads have started.
+     */
+    static void SubtractTiled( SHAPE_POLY_SET& aFill, const SHAPE_POLY_SET& aHoles );
+
 private:
 
     void addKnockout( BOARD_ITEM* aItem, PCB_LAYER_ID aLayer, int aGap, SHAPE_POLY_SET& aHoles );
@@ -94,6 +120,38 @@ private:
                          const SHAPE_POLY_SET& aSmoothedOutline,
                          const SHAPE_POLY_SET& aMaxExtents, SHAPE_POLY_SET& aFillPolys );
 
+    /**
+     * Refill only the dirty area of a copper zone, keeping \a aPreviousFill elsewhere.
+     */
+    bool refillCopperZoneArea( const ZONE* aZone, PCB_LAYER_ID aLayer,
+                               const SHAPE_POLY_SET& aSmoothedOutline,
+                               const SHAPE_POLY_SET& aMaxExtents,
+                               const SHAPE_POLY_SET& aPreviousFill, SHAPE_POLY_SET& aFillPolys );
+
+    /**
+     * Hash everything the fill of \a aZone on \a aLayer depends on: the zone outline and
+     * settings, the board outline, and the geometry, net and resolved constraints of every
+     * item which could knock out (or connect to) the fill, including the pad orientations and
+     * spoke angles the thermal spokes are built from.  The result is independent of the
+     * order in which items are stored, and of net codes (which aren't saved).
+     *
+     * Fills of higher-priority zones are not included; the caller must refill a zone if any
+     * zone it depends on is refilled.
+     *
+     * @param aCandidates indexes the board items (footprint children included) by bounding box;
+     *                    it is built once per fill by indexFillInputItems().
+     */
+    HASH_128 computeFillInputHash( const ZONE* aZone, PCB_LAYER_ID aLayer,
+                                   const PACKED_RTREE<BOARD_ITEM*>& aCandidates );
+
+    void indexFillInputItems( PACKED_RTREE<BOARD_ITEM*>& aCandidates ) const;
+
+    /**
+     * @return the area of \a aZone in which knockouts need to be built; the zone's bounding box
+     *         unless the zone is being refilled by area.
+     */
+    BOX2I getFillArea( const ZONE* aZone ) const;
+
     bool fillNonCopperZone( const ZONE* candidate, PCB_LAYER_ID aLayer,
                             const SHAPE_POLY_SET& aSmoothedOutline, SHAPE_POLY_SET& aFillPolys );
     /**
@@ -144,6 +202,10 @@ private:
     int                   m_maxError;
     int                   m_worstClearance;
 
+    std::map<const ZONE*, BOX2I>                                   m_dirtyAreas;
+    std::map<const ZONE*, BOX2I>                                   m_refillAreas;
+    std::map<std::pair<const ZONE*, PCB_LAYER_ID>, SHAPE_POLY_SET> m_previousFills;
+
     bool                  m_debugZoneFiller;
 };
 
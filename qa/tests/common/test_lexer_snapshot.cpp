@@ -0,0 +1,160 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for recording and replaying lexer snapshots
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+// Code under test
+#include <dsnlexer.h>
+#include <lexer_snapshot.h>
+
+#include <tuple>
+
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+
+/**
+ * A keywordless lexer which lets the test parse numbers.
+ */
+class TEST_LEXER : public DSNLEXER
+{
+public:
+    TEST_LEXER( const std::string& aText ) :
+            DSNLEXER( aText, wxS( "test" ) )
+    {}
+
+    using DSNLEXER::parseDouble;
+};
+
+
+static const std::string TEST_TEXT = "(kicad_pcb (version 20240108)\n"
+                                     "  (at 1.5 -2.25 90)\n"
+                                     "\n"
+                                     "  (name \"a b\") (at 1.5 3))\n";
+
+
+BOOST_AUTO_TEST_SUITE( LexerSnapshot )
+
+
+/**
+ * Replaying a snapshot must give back the tokens, line numbers and numbers which were read
+ * when it was recorded.
+ */
+BOOST_AUTO_TEST_CASE( RecordAndReplay )
+{
+    wxString snapshotFile = wxFileName::CreateTempFileName( wxS( "lexer_snapshot" ) );
+
+    std::vector<std::tuple<int, std::string, int>> tokens;
+    std::vector<double>                            numbers;
+
+    {
+        LEXER_SNAPSHOT_WRITER writer;
+        TEST_LEXER            lexer( TEST_TEXT );
+
+        lexer.SetRecorder( &writer );
+
+        for( int tok = lexer.NextTok(); tok != DSN_EOF; tok = lexer.NextTok() )
+        {
+            tokens.emplace_back( tok, lexer.CurStr(), lexer.CurLineNumber() );
+
+            if( tok == DSN_NUMBER )
+                numbers.push_back( lexer.parseDouble() );
+        }
+
+        BOOST_REQUIRE( writer.Save( snapshotFile ) );
+    }
+
+    std::unique_ptr<LEXER_SNAPSHOT> snapshot = LEXER_SNAPSHOT::Open( snapshotFile,
+                                                                     wxS( "source" ) );
+
+    BOOST_REQUIRE( snapshot );
+    BOOST_CHECK_EQUAL( snapshot->GetTokenCount(), tokens.size() );
+    BOOST_CHECK_EQUAL( snapshot->GetLineCount(), 4u );
+
+    TEST_LEXER lexer( std::string() );
+    size_t     ii = 0;
+    size_t     jj = 0;
+
+    lexer.SetReplay( snapshot.get() );
+
+    for( int tok = lexer.NextTok(); tok != DSN_EOF; tok = lexer.NextTok(), ++ii )
+    {
+        BOOST_REQUIRE( ii < tokens.size() );
+        BOOST_CHECK_EQUAL( tok, std::get<0>( tokens[ii] ) );
+        BOOST_CHECK_EQUAL( lexer.CurStr(), std::get<1>( tokens[ii] ) );
+        BOOST_CHECK_EQUAL( lexer.CurLineNumber(), std::get<2>( tokens[ii] ) );
+
+        if( tok == DSN_NUMBER )
+            BOOST_CHECK_EQUAL( lexer.parseDouble(), numbers[jj++] );
+    }
+
+    BOOST_CHECK_EQUAL( ii, tokens.size() );
+    BOOST_CHECK_EQUAL( jj, numbers.size() );
+    BOOST_CHECK( lexer.CurSource() == wxS( "source" ) );
+
+    // Replay the "(at 1.5 -2.25 90)" list alone
+    lexer.SetReplay( snapshot.get(), 6, 12 );
+
+    lexer.NeedLEFT();
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_SYMBOL );
+    BOOST_CHECK_EQUAL( lexer.CurStr(), "at" );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_NUMBER );
+    BOOST_CHECK_EQUAL( lexer.parseDouble(), 1.5 );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_NUMBER );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_NUMBER );
+    lexer.NeedRIGHT();
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_EOF );
+
+    snapshot.reset();
+    wxRemoveFile( snapshotFile );
+}
+
+
+/**
+ * Files which aren't snapshots written by this build must be ignored.
+ */
+BOOST_AUTO_TEST_CASE( RejectInvalid )
+{
+    wxString fileName = wxFileName::CreateTempFileName( wxS( "lexer_snapshot" ) );
+
+    {
+        wxFFile file( fileName, wxS( "wb" ) );
+        std::string contents = "KICADTOK and not much else";
+
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( contents.data(), contents.size() ) == contents.size() );
+    }
+
+    BOOST_CHECK( !LEXER_SNAPSHOT::Open( fileName, wxS( "source" ) ) );
+    BOOST_CHECK( !LEXER_SNAPSHOT::Open( fileName + wxS( ".missing" ), wxS( "source" ) ) );
+
+    wxRemoveFile( fileName );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
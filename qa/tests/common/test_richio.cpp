@@ -31,10 +31,88 @@
 // Code under test
 #include <richio.h>
 
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
 /**
  * Declare the test suite
  */
 BOOST_AUTO_TEST_SUITE( RichIO )
 
 
+/**
+ * Write aContents to a temporary file and return its name.
+ */
+static wxString writeTempFile( const std::string& aContents )
+{
+    wxString fileName = wxFileName::CreateTempFileName( wxS( "richio" ) );
+    wxFFile  file( fileName, wxS( "wb" ) );
+
+    BOOST_REQUIRE( file.IsOpened() );
+    BOOST_REQUIRE( file.Write( aContents.data(), aContents.size() ) == aContents.size() );
+
+    return fileName;
+}
+
+
+/**
+ * The lines of a mapped file must match those read from a string, with the last one terminated.
+ */
+BOOST_AUTO_TEST_CASE( MmapLineReader )
+{
+    const std::vector<std::string> cases = {
+        "",
+        "\n",
+        "(kicad_pcb)",
+        "(kicad_pcb\n  (version 20240108)\n)\n",
+        "(kicad_pcb\r\n\r\n  (title \"\\x41\")\r\n) ",
+    };
+
+    for( const std::string& contents : cases )
+    {
+        BOOST_TEST_CONTEXT( "Contents: " << contents )
+        {
+            wxString fileName = writeTempFile( contents );
+
+            {
+                MMAP_LINE_READER reader( fileName );
+
+                BOOST_CHECK_EQUAL( reader.FileLength(), (long int) contents.size() );
+
+                for( int pass = 0; pass < 2; ++pass )
+                {
+                    STRING_LINE_READER expected( contents, fileName );
+
+                    while( char* line = reader.ReadLine() )
+                    {
+                        BOOST_REQUIRE( expected.ReadLine() );
+                        BOOST_CHECK_EQUAL( reader.LineNumber(), expected.LineNumber() );
+                        BOOST_CHECK_EQUAL( std::string( line, reader.Length() ),
+                                           std::string( expected.Line(), expected.Length() ) );
+
+                        if( line[reader.Length() - 1] != '\n' )
+                            BOOST_CHECK_EQUAL( line[reader.Length()], '\0' );
+                    }
+
+                    BOOST_CHECK( !expected.ReadLine() );
+
+                    reader.Rewind();
+                }
+            }
+
+            wxRemoveFile( fileName );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( MmapLineReaderMissingFile )
+{
+    wxString fileName = wxFileName::CreateTempFileName( wxS( "richio" ) );
+    wxRemoveFile( fileName );
+
+    BOOST_CHECK_THROW( MMAP_LINE_READER reader( fileName ), IO_ERROR );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
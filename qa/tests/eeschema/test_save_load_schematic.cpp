@@ -29,6 +29,10 @@
 #include <boost/test/unit_test.hpp>
 #include <eeschema_test_utils.h>
 
+#include <advanced_config.h>
+#include <dsnlexer.h>
+#include <lexer_snapshot.h>
+#include <richio.h>
 #include <sch_io/kicad_sexpr/sch_io_kicad_sexpr.h>
 #include <sch_screen.h>
 #include <sch_sheet.h>
@@ -38,6 +42,9 @@
 #include <sch_file_versions.h>
 #include <qa_utils/wx_utils/unit_test_utils.h>
 
+#include <fstream>
+#include <sstream>
+
 #include <wx/filename.h>
 #include <wx/stdpaths.h>
 
@@ -388,4 +395,71 @@ BOOST_AUTO_TEST_CASE( TestLoadLegacyHierarchicalSchematic )
 }
 
 
+/**
+ * A schematic replayed from a lexer snapshot must load the same as when it is read as text.  A
+ * snapshot which can't be replayed gives way to reading the file as text, and is replaced.
+ */
+BOOST_AUTO_TEST_CASE( TestLoadFromLexerSnapshot )
+{
+    ADVANCED_CFG& cfg = const_cast<ADVANCED_CFG&>( ADVANCED_CFG::GetCfg() );
+    bool          snapshotsEnabled = cfg.m_EnableLexerSnapshots;
+
+    wxString fileName = KI_TEST::GetEeschemaTestDataDir() + "issue16223.kicad_sch";
+    wxString snapshotFile = LEXER_SNAPSHOT::GetSnapshotFileName( MMAP_LINE_READER( fileName ) );
+
+    BOOST_REQUIRE( !snapshotFile.IsEmpty() );
+
+    if( wxFileExists( snapshotFile ) )
+        wxRemoveFile( snapshotFile );
+
+    auto loadAndSave =
+            [&]( bool aSnapshots ) -> std::string
+            {
+                cfg.m_EnableLexerSnapshots = aSnapshots;
+
+                SCH_IO_KICAD_SEXPR io;
+
+                m_schematic->Reset();
+                m_schematic->SetRoot( io.LoadSchematicFile( fileName, m_schematic.get() ) );
+
+                wxString saveFile = GetTempFileName( "snapshot_resave" );
+                saveFile += "." + FILEEXT::KiCadSchematicFileExtension;
+                m_tempFiles.push_back( saveFile );
+
+                io.SaveSchematicFile( saveFile, m_schematic->GetTopLevelSheets()[0],
+                                      m_schematic.get() );
+
+                std::ifstream     in( saveFile.fn_str() );
+                std::stringstream saved;
+                saved << in.rdbuf();
+                return saved.str();
+            };
+
+    std::string text = loadAndSave( false );
+    std::string recorded = loadAndSave( true );
+
+    BOOST_REQUIRE( wxFileExists( snapshotFile ) );
+
+    std::string replayed = loadAndSave( true );
+
+    BOOST_CHECK( recorded == text );
+    BOOST_CHECK( replayed == text );
+
+    {
+        LEXER_SNAPSHOT_WRITER writer;
+        writer.Add( DSN_RIGHT, ")", 1 );
+        BOOST_REQUIRE( writer.Save( snapshotFile ) );
+    }
+
+    BOOST_CHECK( loadAndSave( true ) == text );
+
+    std::unique_ptr<LEXER_SNAPSHOT> snapshot = LEXER_SNAPSHOT::Open( snapshotFile, fileName );
+
+    BOOST_REQUIRE( snapshot );
+    BOOST_CHECK_GT( snapshot->GetTokenCount(), 1u );
+
+    cfg.m_EnableLexerSnapshots = snapshotsEnabled;
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,133 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <geometry/packed_rtree.h>
+
+#include <random>
+
+
+BOOST_AUTO_TEST_SUITE( PackedRTree )
+
+
+BOOST_AUTO_TEST_CASE( Empty )
+{
+    PACKED_RTREE<int> tree;
+    tree.Build();
+
+    int visited = 0;
+
+    tree.Search( BOX2I( VECTOR2I( -100, -100 ), VECTOR2I( 200, 200 ) ),
+                 [&]( int )
+                 {
+                     visited++;
+                     return true;
+                 } );
+
+    BOOST_CHECK_EQUAL( visited, 0 );
+}
+
+
+/**
+ * Check searches against a brute-force scan, for sizes around the node size (where the
+ * last node of each level is partially filled).
+ */
+BOOST_AUTO_TEST_CASE( MatchesBruteForce )
+{
+    std::mt19937                       rng( 1234 );
+    std::uniform_int_distribution<int> pos( -100000, 100000 );
+    std::uniform_int_distribution<int> size( 0, 5000 );
+
+    for( int count : { 1, 2, 15, 16, 17, 255, 256, 257, 5000 } )
+    {
+        std::vector<BOX2I> boxes;
+        PACKED_RTREE<int>  tree;
+
+        for( int ii = 0; ii < count; ++ii )
+        {
+            boxes.emplace_back( VECTOR2I( pos( rng ), pos( rng ) ),
+                                VECTOR2I( size( rng ), size( rng ) ) );
+            tree.Add( boxes.back(), ii );
+        }
+
+        tree.Build();
+        BOOST_CHECK_EQUAL( tree.size(), (size_t) count );
+
+        for( int query = 0; query < 100; ++query )
+        {
+            BOX2I queryBox( VECTOR2I( pos( rng ), pos( rng ) ),
+                            VECTOR2I( size( rng ) * 4, size( rng ) * 4 ) );
+
+            std::vector<int> expected;
+            std::vector<int> found;
+
+            for( int ii = 0; ii < count; ++ii )
+            {
+                const BOX2I& box = boxes[ii];
+
+                if( box.GetX() <= queryBox.GetRight() && box.GetRight() >= queryBox.GetX()
+                    && box.GetY() <= queryBox.GetBottom() && box.GetBottom() >= queryBox.GetY() )
+                {
+                    expected.push_back( ii );
+                }
+            }
+
+            tree.Search( queryBox,
+                         [&]( int aItem )
+                         {
+                             found.push_back( aItem );
+                             return true;
+                         } );
+
+            std::sort( found.begin(), found.end() );
+
+            BOOST_CHECK_EQUAL_COLLECTIONS( found.begin(), found.end(), expected.begin(),
+                                           expected.end() );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( StopsWhenVisitorReturnsFalse )
+{
+    PACKED_RTREE<int> tree;
+
+    for( int ii = 0; ii < 100; ++ii )
+        tree.Add( BOX2I( VECTOR2I( ii * 10, 0 ), VECTOR2I( 5, 5 ) ), ii );
+
+    tree.Build();
+
+    int  visited = 0;
+    bool completed = tree.Search( BOX2I( VECTOR2I( 0, 0 ), VECTOR2I( 1000, 10 ) ),
+                                  [&]( int )
+                                  {
+                                      return ++visited < 3;
+                                  } );
+
+    BOOST_CHECK( !completed );
+    BOOST_CHECK_EQUAL( visited, 3 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,334 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <geometry/seg_batch.h>
+#include <geometry/shape_line_chain.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace KIGEOM;
+
+
+namespace
+{
+
+/**
+ * Restore the instruction set selected when the test started.
+ */
+struct SIMD_LEVEL_GUARD
+{
+    SIMD_LEVEL_GUARD() : m_level( GetSimdLevel() ) {}
+    ~SIMD_LEVEL_GUARD() { SetSimdLevel( m_level ); }
+
+    SIMD_LEVEL m_level;
+};
+
+
+std::vector<SIMD_LEVEL> supportedLevels()
+{
+    std::vector<SIMD_LEVEL> levels;
+
+    for( SIMD_LEVEL level : { SIMD_LEVEL::SCALAR, SIMD_LEVEL::SSE4_1, SIMD_LEVEL::AVX2 } )
+    {
+        if( level <= GetSupportedSimdLevel() )
+            levels.push_back( level );
+    }
+
+    return levels;
+}
+
+
+SHAPE_LINE_CHAIN randomChain( std::mt19937& aRng, int aPoints, int aRange, int aStep )
+{
+    std::uniform_int_distribution<int> start( -aRange, aRange );
+    std::uniform_int_distribution<int> step( -aStep, aStep );
+    SHAPE_LINE_CHAIN                   chain;
+    VECTOR2I                           pt( start( aRng ), start( aRng ) );
+
+    for( int ii = 0; ii < aPoints; ++ii )
+    {
+        chain.Append( pt, true );
+        pt.x = std::clamp<int64_t>( int64_t( pt.x ) + step( aRng ), -aRange, aRange );
+        pt.y = std::clamp<int64_t>( int64_t( pt.y ) + step( aRng ), -aRange, aRange );
+    }
+
+    return chain;
+}
+
+
+/**
+ * The segment loop of SHAPE_LINE_CHAIN::Collide( SEG ), without any rejection.
+ */
+bool bruteForceCollide( const SHAPE_LINE_CHAIN& aChain, const SEG& aSeg, int aClearance,
+                        int* aActual, VECTOR2I* aLocation )
+{
+    if( aChain.IsClosed() && aChain.PointInside( aSeg.A ) )
+    {
+        if( aLocation )
+            *aLocation = aSeg.A;
+
+        if( aActual )
+            *aActual = 0;
+
+        return true;
+    }
+
+    SEG::ecoord closest_dist_sq = VECTOR2I::ECOORD_MAX;
+    VECTOR2I    nearest;
+
+    for( size_t i = 0; i < aChain.GetSegmentCount(); i++ )
+    {
+        const SEG   s = aChain.GetSegment( i );
+        SEG::ecoord dist_sq = s.SquaredDistance( aSeg );
+
+        if( dist_sq < closest_dist_sq )
+        {
+            if( aLocation )
+                nearest = s.NearestPoint( aSeg );
+
+            closest_dist_sq = dist_sq;
+
+            if( closest_dist_sq == 0 )
+                break;
+
+            if( closest_dist_sq < SEG::Square( aClearance ) && !aActual )
+                break;
+        }
+    }
+
+    if( closest_dist_sq == 0 || closest_dist_sq < SEG::Square( aClearance ) )
+    {
+        if( aLocation )
+            *aLocation = nearest;
+
+        if( aActual )
+            *aActual = sqrt( closest_dist_sq );
+
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace
+
+
+BOOST_AUTO_TEST_SUITE( SegBatch )
+
+
+BOOST_AUTO_TEST_CASE( SetLevelIsClamped )
+{
+    SIMD_LEVEL_GUARD guard;
+
+    SetSimdLevel( SIMD_LEVEL::AVX2 );
+    BOOST_CHECK( GetSimdLevel() == GetSupportedSimdLevel() );
+
+    SetSimdLevel( SIMD_LEVEL::SCALAR );
+    BOOST_CHECK( GetSimdLevel() == SIMD_LEVEL::SCALAR );
+}
+
+
+/**
+ * Every instruction set must reject exactly the same segments, for every batch length (the
+ * vector kernels finish with scalar tails) and near the limits of the coordinate range.
+ */
+BOOST_AUTO_TEST_CASE( LevelsAgree )
+{
+    SIMD_LEVEL_GUARD                   guard;
+    std::mt19937                       rng( 1234 );
+    std::uniform_int_distribution<int> clearance( -1000, 200000 );
+    const int                          big = std::numeric_limits<int>::max() - 1000;
+
+    for( int range : { 1000000, big } )
+    {
+        SHAPE_LINE_CHAIN chain = randomChain( rng, int( SEG_BATCH_SIZE ) + 1, range, range / 20 );
+        SEG_BOXES        boxes;
+
+        for( int ii = 0; ii < chain.SegmentCount(); ++ii )
+            boxes.Add( chain.CSegment( ii ) );
+
+        for( int query = 0; query < 200; ++query )
+        {
+            SEG           seg = randomChain( rng, 2, range, range / 10 ).CSegment( 0 );
+            SEG_QUERY_BOX box( seg, clearance( rng ) );
+
+            for( size_t count = 0; count <= SEG_BATCH_SIZE; ++count )
+            {
+                SetSimdLevel( SIMD_LEVEL::SCALAR );
+                uint64_t expectedPoly = PolylineSegmentsNear( &chain.CPoint( 0 ), count, box );
+                uint64_t expectedBoxes = boxes.Near( 0, count, box );
+
+                BOOST_CHECK_EQUAL( expectedPoly, expectedBoxes );
+
+                for( SIMD_LEVEL level : supportedLevels() )
+                {
+                    SetSimdLevel( level );
+                    BOOST_CHECK_EQUAL( PolylineSegmentsNear( &chain.CPoint( 0 ), count, box ),
+                                       expectedPoly );
+                    BOOST_CHECK_EQUAL( boxes.Near( 0, count, box ), expectedBoxes );
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * SHAPE_LINE_CHAIN::Collide( SEG ) must give the same answers as the unfiltered loop.
+ */
+BOOST_AUTO_TEST_CASE( ChainCollideMatchesBruteForce )
+{
+    SIMD_LEVEL_GUARD                   guard;
+    std::mt19937                       rng( 5678 );
+    std::uniform_int_distribution<int> clearance( 0, 50000 );
+
+    for( SIMD_LEVEL level : supportedLevels() )
+    {
+        SetSimdLevel( level );
+
+        for( int points : { 2, 3, 64, 65, 66, 300 } )
+        {
+            for( bool closed : { false, true } )
+            {
+                SHAPE_LINE_CHAIN chain = randomChain( rng, points, 1000000, 100000 );
+                chain.SetClosed( closed );
+
+                for( int query = 0; query < 100; ++query )
+                {
+                    SEG seg = randomChain( rng, 2, 1000000, 200000 ).CSegment( 0 );
+                    int cl = clearance( rng );
+
+                    BOOST_CHECK_EQUAL( chain.Collide( seg, cl ),
+                                       bruteForceCollide( chain, seg, cl, nullptr, nullptr ) );
+
+                    int      actual = -1, expectedActual = -1;
+                    VECTOR2I location, expectedLocation;
+                    bool     hit = chain.Collide( seg, cl, &actual, &location );
+                    bool     expectedHit = bruteForceCollide( chain, seg, cl, &expectedActual,
+                                                              &expectedLocation );
+
+                    BOOST_CHECK_EQUAL( hit, expectedHit );
+
+                    if( hit && expectedHit )
+                    {
+                        BOOST_CHECK_EQUAL( actual, expectedActual );
+                        BOOST_CHECK_EQUAL( location, expectedLocation );
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * Not a test: time finding the segments of a long polyline within a clearance of many short
+ * segments, the way the router and DRC query track outlines, with and without the batched
+ * rejection.  SHAPE_LINE_CHAIN indexes chains this long, so the kernels are called directly.
+ */
+BOOST_AUTO_TEST_CASE( Benchmark )
+{
+    using clock = std::chrono::steady_clock;
+
+    const int                    clearance = 10000;
+    SIMD_LEVEL_GUARD             guard;
+    std::mt19937                 rng( 42 );
+    SHAPE_LINE_CHAIN             chain = randomChain( rng, 20000, 10000000, 50000 );
+    const std::vector<VECTOR2I>& pts = chain.CPoints();
+    const size_t                 segCount = pts.size() - 1;
+    std::vector<SEG>             queries;
+
+    for( int ii = 0; ii < 2000; ++ii )
+        queries.push_back( randomChain( rng, 2, 10000000, 100000 ).CSegment( 0 ) );
+
+    auto run =
+            [&]( auto&& aCountHits )
+            {
+                int  hits = 0;
+                auto start = clock::now();
+
+                for( const SEG& seg : queries )
+                    hits += aCountHits( seg );
+
+                double ms = std::chrono::duration<double, std::milli>( clock::now() - start )
+                                    .count();
+                return std::make_pair( hits, ms );
+            };
+
+    auto isHit =
+            [&]( size_t aIndex, const SEG& aSeg )
+            {
+                return SEG( pts[aIndex], pts[aIndex + 1] ).SquaredDistance( aSeg )
+                       < SEG::Square( clearance );
+            };
+
+    auto [bruteHits, bruteMs] = run(
+            [&]( const SEG& aSeg )
+            {
+                int hits = 0;
+
+                for( size_t ii = 0; ii < segCount; ++ii )
+                    hits += isHit( ii, aSeg ) ? 1 : 0;
+
+                return hits;
+            } );
+
+    BOOST_TEST_MESSAGE( "brute force: " << bruteMs << " ms" );
+
+    for( SIMD_LEVEL level : supportedLevels() )
+    {
+        SetSimdLevel( level );
+
+        auto [hits, ms] = run(
+                [&]( const SEG& aSeg )
+                {
+                    SEG_QUERY_BOX query( aSeg, clearance );
+                    int           hits = 0;
+
+                    for( size_t base = 0; base < segCount; base += SEG_BATCH_SIZE )
+                    {
+                        size_t   count = std::min( SEG_BATCH_SIZE, segCount - base );
+                        uint64_t candidates = PolylineSegmentsNear( &pts[base], count, query );
+
+                        for( ; candidates; candidates &= candidates - 1 )
+                            hits += isHit( base + std::countr_zero( candidates ), aSeg ) ? 1 : 0;
+                    }
+
+                    return hits;
+                } );
+
+        BOOST_CHECK_EQUAL( hits, bruteHits );
+        BOOST_TEST_MESSAGE( "level " << static_cast<int>( level ) << ": " << ms << " ms ("
+                                     << bruteMs / ms << "x)" );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
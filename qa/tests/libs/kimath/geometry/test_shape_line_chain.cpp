@@ -1251,4 +1251,49 @@ BOOST_AUTO_TEST_CASE( ReplaceChain )
 }
 
 
+BOOST_AUTO_TEST_CASE( CompactShapes )
+{
+    // Chains without arcs don't store their shapes; check that going back and forth between
+    // compact and arc-carrying chains keeps the chain consistent.
+    SHAPE_LINE_CHAIN chain( { VECTOR2I( 0, 0 ), VECTOR2I( 1000, 0 ), VECTOR2I( 1000, 1000 ) } );
+
+    chain.Append( VECTOR2I( 0, 1000 ) );
+    chain.Insert( 1, VECTOR2I( 500, 0 ) );
+    chain.Remove( 1 );
+
+    BOOST_CHECK_EQUAL( chain.PointCount(), 4 );
+    BOOST_CHECK_EQUAL( chain.StoredShapeCount(), 0 );
+    BOOST_CHECK( !chain.IsArcSegment( 0 ) );
+    BOOST_CHECK( GEOM_TEST::IsOutlineValid( chain ) );
+
+    chain.ShrinkToFit();
+
+    // Nothing but the points themselves once the spare capacity is gone
+    BOOST_CHECK_EQUAL( chain.ReservedBytes(), chain.PointCount() * sizeof( VECTOR2I ) );
+
+    SHAPE_ARC arc( VECTOR2I( 0, 1000 ), VECTOR2I( -500, 500 ), VECTOR2I( 0, 0 ), 0 );
+    chain.Append( arc );
+
+    BOOST_CHECK_EQUAL( chain.ArcCount(), 1 );
+    BOOST_CHECK_EQUAL( chain.StoredShapeCount(), chain.CPoints().size() );
+    BOOST_CHECK( GEOM_TEST::IsOutlineValid( chain ) );
+
+    chain.ClearArcs();
+
+    BOOST_CHECK_EQUAL( chain.ArcCount(), 0 );
+    BOOST_CHECK_EQUAL( chain.StoredShapeCount(), 0 );
+    BOOST_CHECK( GEOM_TEST::IsOutlineValid( chain ) );
+
+    chain.ShrinkToFit();
+
+    BOOST_CHECK_EQUAL( chain.ReservedBytes(), chain.PointCount() * sizeof( VECTOR2I ) );
+
+    chain.Append( VECTOR2I( 0, 0 ) );
+    chain.Simplify();
+
+    BOOST_CHECK_EQUAL( chain.StoredShapeCount(), 0 );
+    BOOST_CHECK( GEOM_TEST::IsOutlineValid( chain ) );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
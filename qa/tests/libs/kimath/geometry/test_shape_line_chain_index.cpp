@@ -0,0 +1,241 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <geometry/shape_line_chain.h>
+
+#include <cmath>
+#include <random>
+
+
+namespace
+{
+
+/**
+ * A closed, star shaped chain: simple, but with many edges crossing each horizontal line.
+ */
+SHAPE_LINE_CHAIN starChain( std::mt19937& aRng, int aPoints )
+{
+    std::uniform_int_distribution<int> radius( 200000, 1000000 );
+    SHAPE_LINE_CHAIN                   chain;
+
+    for( int ii = 0; ii < aPoints; ++ii )
+    {
+        double angle = 2 * M_PI * ii / aPoints;
+        int    r = radius( aRng );
+
+        chain.Append( VECTOR2I( r * std::cos( angle ), r * std::sin( angle ) ) );
+    }
+
+    chain.SetClosed( true );
+    return chain;
+}
+
+
+/**
+ * An open, self-intersecting random walk.
+ */
+SHAPE_LINE_CHAIN walkChain( std::mt19937& aRng, int aPoints )
+{
+    std::uniform_int_distribution<int> step( -20000, 20000 );
+    SHAPE_LINE_CHAIN                   chain;
+    VECTOR2I                           pt;
+
+    for( int ii = 0; ii < aPoints; ++ii )
+    {
+        chain.Append( pt );
+        pt += VECTOR2I( step( aRng ), step( aRng ) );
+    }
+
+    return chain;
+}
+
+
+/**
+ * Query a chain enough times for it to be indexed.
+ */
+void warmUp( const SHAPE_LINE_CHAIN& aChain )
+{
+    for( int ii = 0; ii < 20 && !aChain.GetSegmentIndex(); ++ii )
+        aChain.NearestSegment( VECTOR2I( 0, 0 ) );
+}
+
+
+/**
+ * Check every indexed query against a copy of the chain, which scans it.
+ */
+void checkQueries( const SHAPE_LINE_CHAIN& aChain, std::mt19937& aRng )
+{
+    BOX2I                              bbox = aChain.BBox( 100000 );
+    std::uniform_int_distribution<int> x( bbox.GetLeft(), bbox.GetRight() );
+    std::uniform_int_distribution<int> y( bbox.GetTop(), bbox.GetBottom() );
+    std::uniform_int_distribution<int> clearance( 0, 30000 );
+
+    BOOST_REQUIRE( aChain.GetSegmentIndex() );
+
+    for( int query = 0; query < 300; ++query )
+    {
+        VECTOR2I pt( x( aRng ), y( aRng ) );
+        SEG      seg( pt, pt + VECTOR2I( clearance( aRng ) * 3, clearance( aRng ) * 3 ) );
+        int      cl = clearance( aRng );
+
+        // Snap some queries to a vertex, where neighbouring segments tie
+        if( query % 10 == 0 )
+            pt = aChain.CPoint( query % aChain.PointCount() );
+
+        int      actual = -1, scanActual = -1;
+        VECTOR2I location, scanLocation;
+
+        BOOST_CHECK_EQUAL( aChain.Collide( pt, cl, &actual, &location ),
+                           SHAPE_LINE_CHAIN( aChain ).Collide( pt, cl, &scanActual,
+                                                               &scanLocation ) );
+        BOOST_CHECK_EQUAL( actual, scanActual );
+        BOOST_CHECK_EQUAL( location, scanLocation );
+
+        BOOST_CHECK_EQUAL( aChain.Collide( seg, cl, &actual, &location ),
+                           SHAPE_LINE_CHAIN( aChain ).Collide( seg, cl, &scanActual,
+                                                               &scanLocation ) );
+        BOOST_CHECK_EQUAL( actual, scanActual );
+        BOOST_CHECK_EQUAL( location, scanLocation );
+
+        BOOST_CHECK_EQUAL( aChain.Collide( seg, cl ),
+                           SHAPE_LINE_CHAIN( aChain ).Collide( seg, cl ) );
+
+        BOOST_CHECK_EQUAL( aChain.PointInside( pt ), SHAPE_LINE_CHAIN( aChain ).PointInside( pt ) );
+        BOOST_CHECK_EQUAL( aChain.PointInside( pt, cl ),
+                           SHAPE_LINE_CHAIN( aChain ).PointInside( pt, cl ) );
+        BOOST_CHECK_EQUAL( aChain.EdgeContainingPoint( pt, cl ),
+                           SHAPE_LINE_CHAIN( aChain ).EdgeContainingPoint( pt, cl ) );
+        BOOST_CHECK_EQUAL( aChain.SquaredDistance( pt ),
+                           SHAPE_LINE_CHAIN( aChain ).SquaredDistance( pt ) );
+        BOOST_CHECK_EQUAL( aChain.NearestSegment( pt ),
+                           SHAPE_LINE_CHAIN( aChain ).NearestSegment( pt ) );
+        BOOST_CHECK_EQUAL( aChain.NearestPoint( pt ),
+                           SHAPE_LINE_CHAIN( aChain ).NearestPoint( pt ) );
+    }
+}
+
+} // namespace
+
+
+BOOST_AUTO_TEST_SUITE( ShapeLineChainIndex )
+
+
+BOOST_AUTO_TEST_CASE( OnlyLongChainsAreIndexed )
+{
+    std::mt19937 rng( 1 );
+
+    SHAPE_LINE_CHAIN shortChain = walkChain( rng, 20 );
+    warmUp( shortChain );
+    BOOST_CHECK( !shortChain.GetSegmentIndex() );
+
+    SHAPE_LINE_CHAIN longChain = walkChain( rng, 2000 );
+    BOOST_CHECK( !longChain.GetSegmentIndex() );
+    warmUp( longChain );
+    BOOST_CHECK( longChain.GetSegmentIndex() );
+
+    // Copies start from scratch, moves keep the index
+    SHAPE_LINE_CHAIN copy( longChain );
+    BOOST_CHECK( !copy.GetSegmentIndex() );
+
+    SHAPE_LINE_CHAIN moved;
+    moved = std::move( longChain );
+    BOOST_CHECK( moved.GetSegmentIndex() );
+}
+
+
+BOOST_AUTO_TEST_CASE( ModificationsDropTheIndex )
+{
+    std::mt19937     rng( 2 );
+    SHAPE_LINE_CHAIN chain = walkChain( rng, 2000 );
+
+    auto checkDropped =
+            [&]( const std::function<void( SHAPE_LINE_CHAIN& )>& aModify )
+            {
+                warmUp( chain );
+                BOOST_REQUIRE( chain.GetSegmentIndex() );
+
+                aModify( chain );
+                BOOST_CHECK( !chain.GetSegmentIndex() );
+            };
+
+    checkDropped( []( SHAPE_LINE_CHAIN& c ) { c.Append( VECTOR2I( 1, 2 ) ); } );
+    checkDropped( []( SHAPE_LINE_CHAIN& c ) { c.SetPoint( 10, VECTOR2I( 3, 4 ) ); } );
+    checkDropped( []( SHAPE_LINE_CHAIN& c ) { c.Move( VECTOR2I( 5, 6 ) ); } );
+    checkDropped( []( SHAPE_LINE_CHAIN& c ) { c.Remove( 5, 7 ); } );
+    checkDropped( []( SHAPE_LINE_CHAIN& c ) { c.Insert( 5, VECTOR2I( 7, 8 ) ); } );
+    checkDropped( []( SHAPE_LINE_CHAIN& c ) { c.Rotate( ANGLE_90 ); } );
+    checkDropped( []( SHAPE_LINE_CHAIN& c ) { c.SetClosed( !c.IsClosed() ); } );
+    checkDropped( []( SHAPE_LINE_CHAIN& c ) { c.Simplify(); } );
+}
+
+
+BOOST_AUTO_TEST_CASE( QueriesMatchScans )
+{
+    std::mt19937 rng( 3 );
+
+    SHAPE_LINE_CHAIN star = starChain( rng, 3000 );
+    warmUp( star );
+    checkQueries( star, rng );
+
+    SHAPE_LINE_CHAIN walk = walkChain( rng, 3000 );
+    warmUp( walk );
+    checkQueries( walk, rng );
+
+    // Results must still be right once the index has been rebuilt after a modification
+    walk.SetPoint( 100, walk.CPoint( 2000 ) );
+    warmUp( walk );
+    checkQueries( walk, rng );
+}
+
+
+BOOST_AUTO_TEST_CASE( SelfIntersectingMatchesScan )
+{
+    std::mt19937 rng( 4 );
+
+    for( int ii = 0; ii < 5; ++ii )
+    {
+        SHAPE_LINE_CHAIN walk = walkChain( rng, 1000 );
+        warmUp( walk );
+
+        auto indexed = walk.SelfIntersecting();
+        auto scanned = SHAPE_LINE_CHAIN( walk ).SelfIntersecting();
+
+        BOOST_REQUIRE_EQUAL( indexed.has_value(), scanned.has_value() );
+
+        if( indexed )
+        {
+            BOOST_CHECK_EQUAL( indexed->index_our, scanned->index_our );
+            BOOST_CHECK_EQUAL( indexed->index_their, scanned->index_their );
+            BOOST_CHECK_EQUAL( indexed->p, scanned->p );
+        }
+    }
+
+    SHAPE_LINE_CHAIN star = starChain( rng, 1000 );
+    warmUp( star );
+    BOOST_CHECK( !star.SelfIntersecting() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -22,6 +22,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <random>
 #include <tuple>
 #include <qa_utils/wx_utils/unit_test_utils.h>
 
@@ -257,4 +258,118 @@ BOOST_AUTO_TEST_CASE( CollideSegments )
     }
 }
 
+/**
+ * Check that the contour index built by BuildBBoxCaches() gives the same answers as scanning
+ * every contour, on polygons with many holes.
+ */
+BOOST_AUTO_TEST_CASE( BBoxCachesMatchScan )
+{
+    std::mt19937                       rng( 7 );
+    std::uniform_int_distribution<int> coord( -500, 10500 );
+    std::uniform_int_distribution<int> clearance( 0, 60 );
+    SHAPE_POLY_SET                     polySet;
+
+    // Two square polygons, each with a grid of square holes
+    for( int polyIdx = 0; polyIdx < 2; ++polyIdx )
+    {
+        int x0 = polyIdx * 5500;
+
+        polySet.NewOutline();
+        polySet.Append( x0, 0 );
+        polySet.Append( x0 + 5000, 0 );
+        polySet.Append( x0 + 5000, 10000 );
+        polySet.Append( x0, 10000 );
+
+        for( int hx = 100; hx < 4900; hx += 200 )
+        {
+            for( int hy = 100; hy < 9900; hy += 200 )
+            {
+                int hole = polySet.NewHole( polyIdx );
+                polySet.Append( x0 + hx, hy, polyIdx, hole );
+                polySet.Append( x0 + hx + 100, hy, polyIdx, hole );
+                polySet.Append( x0 + hx + 100, hy + 100, polyIdx, hole );
+                polySet.Append( x0 + hx, hy + 100, polyIdx, hole );
+            }
+        }
+    }
+
+    polySet.BuildBBoxCaches();
+
+    for( int ii = 0; ii < 2000; ++ii )
+    {
+        VECTOR2I pt( coord( rng ), coord( rng ) );
+        int      cl = clearance( rng );
+
+        // Snap some points to a vertex
+        if( ii % 10 == 0 )
+            pt = polySet.CVertex( ii % polySet.TotalVertices() );
+
+        BOOST_TEST_INFO( "Point {" << pt.x << ", " << pt.y << "}, clearance " << cl );
+
+        BOOST_CHECK_EQUAL( polySet.Contains( pt, -1, 0, true ), polySet.Contains( pt ) );
+        BOOST_CHECK_EQUAL( polySet.Contains( pt, -1, cl, true ), polySet.Contains( pt, -1, cl ) );
+
+        SHAPE_POLY_SET::VERTEX_INDEX indexed, scanned;
+
+        BOOST_CHECK_EQUAL( polySet.CollideVertex( pt, &indexed, cl, true ),
+                           polySet.CollideVertex( pt, &scanned, cl ) );
+        BOOST_CHECK_EQUAL( indexed.m_polygon, scanned.m_polygon );
+        BOOST_CHECK_EQUAL( indexed.m_contour, scanned.m_contour );
+        BOOST_CHECK_EQUAL( indexed.m_vertex, scanned.m_vertex );
+
+        BOOST_CHECK_EQUAL( polySet.CollideEdge( pt, &indexed, cl, true ),
+                           polySet.CollideEdge( pt, &scanned, cl ) );
+        BOOST_CHECK_EQUAL( indexed.m_polygon, scanned.m_polygon );
+        BOOST_CHECK_EQUAL( indexed.m_contour, scanned.m_contour );
+        BOOST_CHECK_EQUAL( indexed.m_vertex, scanned.m_vertex );
+    }
+}
+
+/**
+ * Check that editing a set after BuildBBoxCaches() drops the contour index instead of leaving
+ * it pointing at the old contours.
+ */
+BOOST_AUTO_TEST_CASE( BBoxCachesDroppedByEdits )
+{
+    auto square =
+            []( int x, int y, int size )
+            {
+                return SHAPE_LINE_CHAIN( { VECTOR2I( x, y ), VECTOR2I( x + size, y ),
+                                           VECTOR2I( x + size, y + size ),
+                                           VECTOR2I( x, y + size ) },
+                                         true );
+            };
+
+    SHAPE_POLY_SET polySet;
+    polySet.AddOutline( square( 0, 0, 1000 ) );
+    polySet.AddHole( square( 400, 400, 200 ) );
+
+    polySet.BuildBBoxCaches();
+    BOOST_CHECK( polySet.Contains( VECTOR2I( 100, 100 ), -1, 0, true ) );
+
+    polySet.Move( VECTOR2I( 5000, 0 ) );
+
+    BOOST_CHECK( polySet.Contains( VECTOR2I( 5100, 100 ), -1, 0, true ) );
+    BOOST_CHECK( !polySet.Contains( VECTOR2I( 5500, 500 ), -1, 0, true ) );
+    BOOST_CHECK( !polySet.Contains( VECTOR2I( 100, 100 ), -1, 0, true ) );
+    BOOST_CHECK( polySet.CollideVertex( VECTOR2I( 5000, 0 ), nullptr, 0, true ) );
+    BOOST_CHECK( polySet.CollideEdge( VECTOR2I( 5500, 0 ), nullptr, 0, true ) );
+
+    polySet.BuildBBoxCaches();
+    polySet.AddOutline( square( 20000, 0, 1000 ) );
+
+    BOOST_CHECK( polySet.Contains( VECTOR2I( 20100, 100 ), -1, 0, true ) );
+    BOOST_CHECK( polySet.CollideVertex( VECTOR2I( 21000, 1000 ), nullptr, 0, true ) );
+    BOOST_CHECK( polySet.CollideEdge( VECTOR2I( 20500, 0 ), nullptr, 0, true ) );
+
+    // Rebuilt in place, as BOARD::UpdateBoardOutline() does
+    polySet.BuildBBoxCaches();
+    polySet.RemoveAllContours();
+    polySet.AddOutline( square( -10000, 0, 1000 ) );
+
+    BOOST_CHECK( polySet.Contains( VECTOR2I( -9900, 100 ), -1, 0, true ) );
+    BOOST_CHECK( !polySet.Contains( VECTOR2I( 5100, 100 ), -1, 0, true ) );
+    BOOST_CHECK( !polySet.Contains( VECTOR2I( 20100, 100 ), -1, 0, true ) );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
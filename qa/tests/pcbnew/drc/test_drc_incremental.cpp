@@ -0,0 +1,337 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <pcbnew_utils/board_test_utils.h>
+#include <board.h>
+#include <board_commit.h>
+#include <board_design_settings.h>
+#include <footprint.h>
+#include <pcb_track.h>
+#include <pcb_marker.h>
+#include <reporter.h>
+#include <zone.h>
+#include <drc/drc_engine.h>
+#include <drc/drc_item.h>
+#include <drc/drc_rtree.h>
+#include <drc/drc_shard_runner.h>
+#include <drc/drc_test_provider.h>
+#include <settings/settings_manager.h>
+#include <tool/tool_manager.h>
+
+#include <wx/filename.h>
+
+
+struct DRC_INCREMENTAL_TEST_FIXTURE
+{
+    DRC_INCREMENTAL_TEST_FIXTURE()
+    { }
+
+    SETTINGS_MANAGER       m_settingsManager;
+    std::unique_ptr<BOARD> m_board;
+};
+
+
+BOOST_FIXTURE_TEST_CASE( DRCIncrementalMatchesFullRun, DRC_INCREMENTAL_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, wxT( "test_copper_graphics" ), m_board );
+
+    using VIOLATION = std::pair<int, std::vector<KIID>>;
+
+    BOARD_DESIGN_SETTINGS&      bds = m_board->GetDesignSettings();
+    std::shared_ptr<DRC_ENGINE> drcEngine = bds.m_DRCEngine;
+    std::set<int>               incrementalCodes;
+    std::set<VIOLATION>         fullViolations;
+    std::set<VIOLATION>         incrementalViolations;
+
+    for( DRC_TEST_PROVIDER* provider : drcEngine->GetTestProviders() )
+    {
+        std::set<int> codes = provider->GetIncrementalErrorCodes();
+        incrementalCodes.insert( codes.begin(), codes.end() );
+    }
+
+    BOOST_REQUIRE( !incrementalCodes.empty() );
+
+    auto collect =
+            [&]( std::set<VIOLATION>& aViolations )
+            {
+                aViolations.clear();
+
+                drcEngine->SetViolationHandler(
+                        [&]( const std::shared_ptr<DRC_ITEM>& aItem, const VECTOR2I& aPos,
+                             int aLayer, const std::function<void( PCB_MARKER* )>& aPathGenerator )
+                        {
+                            if( incrementalCodes.count( aItem->GetErrorCode() ) )
+                            {
+                                std::vector<KIID> ids = aItem->GetIDs();
+                                std::sort( ids.begin(), ids.end() );
+                                aViolations.insert( { aItem->GetErrorCode(), ids } );
+                            }
+                        } );
+            };
+
+    collect( fullViolations );
+    drcEngine->RunTests( EDA_UNITS::MM, true, false );
+
+    BOOST_REQUIRE( !fullViolations.empty() );
+
+    // Marking everything as changed must reproduce the full run's results
+    std::vector<BOARD_ITEM*> allItems;
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+        allItems.push_back( track );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+        allItems.push_back( footprint );
+
+    for( BOARD_ITEM* drawing : m_board->Drawings() )
+        allItems.push_back( drawing );
+
+    for( ZONE* zone : m_board->Zones() )
+        allItems.push_back( zone );
+
+    collect( incrementalViolations );
+    drcEngine->RunIncrementalTests( EDA_UNITS::MM, allItems, {}, nullptr );
+
+    BOOST_CHECK( incrementalViolations == fullViolations );
+
+    // Marking a single violating item as changed must report exactly the full run's
+    // violations which involve it
+    BOARD_ITEM* violator = m_board->ResolveItem( fullViolations.begin()->second.front(), true );
+
+    BOOST_REQUIRE( violator );
+
+    std::set<VIOLATION> expected;
+
+    for( const VIOLATION& violation : fullViolations )
+    {
+        const std::vector<KIID>& ids = violation.second;
+
+        if( std::find( ids.begin(), ids.end(), violator->m_Uuid ) != ids.end() )
+            expected.insert( violation );
+    }
+
+    collect( incrementalViolations );
+    drcEngine->RunIncrementalTests( EDA_UNITS::MM, { violator }, {}, nullptr );
+
+    BOOST_CHECK( incrementalViolations == expected );
+
+    // ... and must only have tested the copper near it
+    const std::unordered_set<const BOARD_ITEM*>& scope = drcEngine->GetIncrementalScope();
+    BOX2I reach = violator->GetBoundingBox();
+    int   farTracks = 0;
+
+    reach.Inflate( 2 * m_board->m_DRCMaxClearance );
+
+    BOOST_CHECK( scope.count( violator ) );
+    BOOST_CHECK_LT( scope.size(), allItems.size() );
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+    {
+        if( track != violator && !track->GetBoundingBox().Intersects( reach ) )
+        {
+            BOOST_CHECK( !scope.count( track ) );
+            farTracks++;
+        }
+    }
+
+    BOOST_CHECK_GT( farTracks, 0 );
+
+    drcEngine->ClearViolationHandler();
+}
+
+
+BOOST_AUTO_TEST_CASE( DRCShardIndexCoversBoard )
+{
+    BOX2I boardBox( VECTOR2I( -1000, 2000 ), VECTOR2I( 7000, 5000 ) );
+
+    for( int shardCount : { 1, 2, 3, 4, 5, 7, 16 } )
+    {
+        std::set<int> used;
+
+        for( int x = -2000; x <= 7000; x += 250 )
+        {
+            for( int y = 1000; y <= 8000; y += 250 )
+            {
+                int shard = DRC_ENGINE::GetShardIndex( boardBox, VECTOR2I( x, y ), shardCount );
+
+                BOOST_REQUIRE( shard >= 0 && shard < shardCount );
+                used.insert( shard );
+            }
+        }
+
+        BOOST_CHECK_EQUAL( (int) used.size(), shardCount );
+    }
+}
+
+
+BOOST_FIXTURE_TEST_CASE( DRCShardsMatchFullRun, DRC_INCREMENTAL_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, wxT( "test_copper_graphics" ), m_board );
+
+    using VIOLATION = std::pair<int, std::vector<KIID>>;
+
+    std::shared_ptr<DRC_ENGINE> drcEngine = m_board->GetDesignSettings().m_DRCEngine;
+    std::set<VIOLATION>         fullViolations;
+    std::set<VIOLATION>         shardViolations;
+
+    auto addViolation =
+            []( std::set<VIOLATION>& aViolations, const std::shared_ptr<RC_ITEM>& aItem )
+            {
+                std::vector<KIID> ids = aItem->GetIDs();
+                std::sort( ids.begin(), ids.end() );
+                aViolations.insert( { aItem->GetErrorCode(), ids } );
+            };
+
+    drcEngine->SetViolationHandler(
+            [&]( const std::shared_ptr<DRC_ITEM>& aItem, const VECTOR2I& aPos, int aLayer,
+                 const std::function<void( PCB_MARKER* )>& aPathGenerator )
+            {
+                addViolation( fullViolations, aItem );
+            } );
+
+    drcEngine->RunTests( EDA_UNITS::MM, true, false );
+
+    BOOST_REQUIRE( !fullViolations.empty() );
+
+    // Each shard reports the violations of the items in its tile and writes them to a shard
+    // file, as a worker process would; between them they must find everything the full run
+    // does (and nothing else) once merged
+    TOOL_MANAGER toolMgr;
+    toolMgr.SetEnvironment( m_board.get(), nullptr, nullptr, nullptr, nullptr );
+
+    KI_TEST::DUMMY_TOOL* dummyTool = new KI_TEST::DUMMY_TOOL();
+    toolMgr.RegisterTool( dummyTool );
+
+    DRC_SHARD_RUNNER shardRunner( m_board.get(), &NULL_REPORTER::GetInstance() );
+
+    drcEngine->SetViolationHandler(
+            [&]( const std::shared_ptr<DRC_ITEM>& aItem, const VECTOR2I& aPos, int aLayer,
+                 const std::function<void( PCB_MARKER* )>& aPathGenerator )
+            {
+                m_board->Add( new PCB_MARKER( aItem, aPos, aLayer ) );
+            } );
+
+    for( int shard = 0; shard < 4; ++shard )
+    {
+        wxString shardFile = wxFileName::CreateTempFileName( wxT( "kicad_drc_shard" ) );
+
+        drcEngine->RunShardTests( EDA_UNITS::MM, true, false, shard, 4 );
+
+        BOOST_REQUIRE( DRC_SHARD_RUNNER::WriteShard( m_board.get(), shardFile ) );
+        shardRunner.AddShardFile( shardFile );
+
+        m_board->DeleteMARKERs();
+    }
+
+    drcEngine->ClearViolationHandler();
+
+    BOARD_COMMIT             commit( dummyTool );
+    std::vector<BOARD_ITEM*> merged;
+    std::set<KIID>           removed;
+
+    BOOST_REQUIRE( shardRunner.MergeResults( commit, true ) );
+    commit.GetStagedItems( merged, removed );
+
+    for( BOARD_ITEM* item : merged )
+    {
+        BOOST_REQUIRE( item->Type() == PCB_MARKER_T );
+        addViolation( shardViolations, static_cast<PCB_MARKER*>( item )->GetRCItem() );
+        delete item;
+    }
+
+    BOOST_CHECK( shardViolations == fullViolations );
+}
+
+
+BOOST_FIXTURE_TEST_CASE( DRCIncrementalPatchesCommittedItems, DRC_INCREMENTAL_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, wxT( "test_copper_graphics" ), m_board );
+
+    std::shared_ptr<DRC_ENGINE> drcEngine = m_board->GetDesignSettings().m_DRCEngine;
+    BOARD_ITEM*                 moved = nullptr;
+    PCB_TRACK*                  removed = nullptr;
+
+    for( BOARD_ITEM* item : m_board->Drawings() )
+    {
+        if( item->Type() == PCB_TEXT_T && item->IsOnLayer( B_Cu ) )
+            moved = item;
+    }
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+    {
+        if( track->Type() == PCB_TRACE_T )
+            removed = track;
+    }
+
+    BOOST_REQUIRE( moved );
+    BOOST_REQUIRE( removed );
+
+    drcEngine->RunTests( EDA_UNITS::MM, true, false );
+
+    std::map<ZONE*, DRC_RTREE*> zoneTrees;
+
+    for( auto& [ zone, rtree ] : m_board->m_CopperZoneRTreeCache )
+        zoneTrees[ zone ] = rtree.get();
+
+    BOOST_REQUIRE( !zoneTrees.empty() );
+
+    auto indexedAt =
+            [&]( const BOARD_ITEM* aItem, PCB_LAYER_ID aLayer, const BOX2I& aBox ) -> bool
+            {
+                for( DRC_RTREE::ITEM_WITH_SHAPE* entry :
+                        m_board->m_CopperItemRTreeCache->Overlapping( aLayer, aBox ) )
+                {
+                    if( entry->parent == aItem )
+                        return true;
+                }
+
+                return false;
+            };
+
+    // Move an item and hand it to the engine as a commit would; its entries must follow it
+    BOX2I oldBox = moved->GetBoundingBox();
+    moved->Move( VECTOR2I( 0, pcbIUScale.mmToIU( 100 ) ) );
+    BOX2I newBox = moved->GetBoundingBox();
+
+    drcEngine->RunIncrementalTests( EDA_UNITS::MM, { moved }, {}, nullptr );
+
+    BOOST_CHECK( !indexedAt( moved, B_Cu, oldBox ) );
+    BOOST_CHECK( indexedAt( moved, B_Cu, newBox ) );
+
+    // Nothing touched the zones, so their trees are reused rather than rebuilt
+    for( auto& [ zone, rtree ] : zoneTrees )
+        BOOST_CHECK( m_board->m_CopperZoneRTreeCache[ zone ].get() == rtree );
+
+    // A removed item is only known by its id, and must be dropped from the tree
+    PCB_LAYER_ID removedLayer = removed->GetLayer();
+    BOX2I        removedBox = removed->GetBoundingBox();
+
+    BOOST_REQUIRE( indexedAt( removed, removedLayer, removedBox ) );
+
+    m_board->Remove( removed );
+    drcEngine->RunIncrementalTests( EDA_UNITS::MM, {}, { removed->m_Uuid }, nullptr );
+
+    BOOST_CHECK( !indexedAt( removed, removedLayer, removedBox ) );
+
+    delete removed;
+}
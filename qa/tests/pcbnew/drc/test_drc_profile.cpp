@@ -0,0 +1,108 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <pcbnew_utils/board_test_utils.h>
+#include <board.h>
+#include <board_design_settings.h>
+#include <drc/drc_engine.h>
+#include <drc/drc_profile.h>
+#include <settings/settings_manager.h>
+#include <json_common.h>
+
+#include <fstream>
+
+#include <wx/filename.h>
+
+
+struct DRC_PROFILE_TEST_FIXTURE
+{
+    DRC_PROFILE_TEST_FIXTURE()
+    { }
+
+    SETTINGS_MANAGER       m_settingsManager;
+    std::unique_ptr<BOARD> m_board;
+};
+
+
+BOOST_FIXTURE_TEST_CASE( DRCProfileCollectsStats, DRC_PROFILE_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, wxT( "multinetclasses_drc" ), m_board );
+
+    std::shared_ptr<DRC_ENGINE> drcEngine = m_board->GetDesignSettings().m_DRCEngine;
+
+    drcEngine->RunTests( EDA_UNITS::MM, true, false );
+    BOOST_CHECK( drcEngine->GetProfile() == nullptr );
+
+    drcEngine->SetProfilingEnabled( true );
+    drcEngine->RunTests( EDA_UNITS::MM, true, false );
+
+    const DRC_PROFILE* profile = drcEngine->GetProfile();
+
+    BOOST_REQUIRE( profile );
+    BOOST_CHECK_EQUAL( profile->m_Providers.size(), drcEngine->GetTestProviders().size() );
+    BOOST_CHECK_GT( profile->m_Total.m_WallMs, 0.0 );
+    BOOST_CHECK_GT( profile->m_Total.m_RTreeQueries, 0u );
+    BOOST_CHECK_GT( profile->m_EvalRulesCalls.load(), 0u );
+
+    bool foundCustomRule = false;
+
+    for( const DRC_PROFILE::RULE_STATS* rule : profile->GetRules() )
+    {
+        if( rule->m_Name == wxT( "rule_1" ) )
+        {
+            foundCustomRule = true;
+            BOOST_CHECK( !rule->m_Implicit );
+            BOOST_CHECK_EQUAL( rule->m_Condition, wxT( "A.hasNetclass('CLASS2')" ) );
+            BOOST_CHECK_GT( rule->m_Checks.load(), 0u );
+            BOOST_CHECK_GT( rule->m_ConditionEvals.load(), 0u );
+        }
+    }
+
+    BOOST_CHECK( foundCustomRule );
+
+    // Every cached resolution checks at least one rule, and a hit must count the checks of the
+    // resolution it reuses just as a miss does
+    uint64_t totalChecks = 0;
+
+    for( const DRC_PROFILE::RULE_STATS* rule : profile->GetRules() )
+        totalChecks += rule->m_Checks.load();
+
+    BOOST_CHECK_GT( profile->m_RuleCacheHits, 0u );
+    BOOST_CHECK_GE( totalChecks, profile->m_RuleCacheHits + profile->m_RuleCacheMisses );
+
+    wxString path = wxFileName::CreateTempFileName( wxT( "drc_profile" ) );
+
+    BOOST_REQUIRE( profile->WriteJsonReport( path ) );
+
+    std::ifstream  stream( path.fn_str() );
+    nlohmann::json json = nlohmann::json::parse( stream );
+
+    BOOST_CHECK( json.contains( "providers" ) );
+    BOOST_CHECK_EQUAL( json["providers"].size(), profile->m_Providers.size() );
+    BOOST_CHECK( json.contains( "rules" ) );
+    BOOST_CHECK( json.contains( "conditions" ) );
+
+    wxRemoveFile( path );
+
+    drcEngine->SetProfilingEnabled( false );
+}
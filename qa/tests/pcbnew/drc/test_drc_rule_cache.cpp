@@ -0,0 +1,180 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <pcbnew_utils/board_test_utils.h>
+#include <board.h>
+#include <board_design_settings.h>
+#include <pcb_track.h>
+#include <zone.h>
+#include <drc/drc_engine.h>
+#include <settings/settings_manager.h>
+
+
+struct DRC_RULE_CACHE_TEST_FIXTURE
+{
+    DRC_RULE_CACHE_TEST_FIXTURE()
+    { }
+
+    SETTINGS_MANAGER       m_settingsManager;
+    std::unique_ptr<BOARD> m_board;
+};
+
+
+BOOST_FIXTURE_TEST_CASE( DRCRuleCacheMatchesUncached, DRC_RULE_CACHE_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, wxT( "multinetclasses_drc" ), m_board );
+
+    std::shared_ptr<DRC_ENGINE> drcEngine = m_board->GetDesignSettings().m_DRCEngine;
+    std::vector<PCB_TRACK*>     tracks( m_board->Tracks().begin(), m_board->Tracks().end() );
+
+    BOOST_REQUIRE( tracks.size() >= 2 );
+
+    auto resolve =
+            [&]( DRC_CONSTRAINT_T aType, const BOARD_ITEM* a, const BOARD_ITEM* b )
+            {
+                DRC_CONSTRAINT c = drcEngine->EvalRules( aType, a, b, a->GetLayer() );
+
+                return std::make_tuple( c.GetName(), c.m_Value.HasMin() ? c.m_Value.Min() : -1,
+                                        c.m_Value.HasOpt() ? c.m_Value.Opt() : -1,
+                                        c.m_Value.HasMax() ? c.m_Value.Max() : -1 );
+            };
+
+    for( DRC_CONSTRAINT_T type : { CLEARANCE_CONSTRAINT, TRACK_WIDTH_CONSTRAINT } )
+    {
+        for( PCB_TRACK* a : tracks )
+        {
+            for( PCB_TRACK* b : { tracks.front(), tracks.back() } )
+            {
+                auto uncached = resolve( type, a, b );
+
+                drcEngine->SetRuleCacheEnabled( true );
+                auto cachedFirst = resolve( type, a, b );
+                auto cachedSecond = resolve( type, a, b );
+                drcEngine->SetRuleCacheEnabled( false );
+
+                BOOST_CHECK( uncached == cachedFirst );
+                BOOST_CHECK( uncached == cachedSecond );
+            }
+        }
+    }
+
+    // Repeated lookups must be served from the cache
+    drcEngine->SetRuleCacheEnabled( true );
+
+    for( int pass = 0; pass < 2; ++pass )
+    {
+        for( PCB_TRACK* a : tracks )
+            resolve( TRACK_WIDTH_CONSTRAINT, a, nullptr );
+    }
+
+    DRC_ENGINE::RULE_CACHE_STATS stats = drcEngine->GetRuleCacheStats();
+    drcEngine->SetRuleCacheEnabled( false );
+
+    BOOST_CHECK_GE( stats.m_Hits, tracks.size() );
+    BOOST_CHECK_LE( stats.m_Misses, tracks.size() );
+}
+
+
+BOOST_FIXTURE_TEST_CASE( DRCRuleCacheFollowsEdits, DRC_RULE_CACHE_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, wxT( "connection_width_rules" ), m_board );
+
+    std::shared_ptr<DRC_ENGINE> drcEngine = m_board->GetDesignSettings().m_DRCEngine;
+    PCB_TRACK*                  inArea = nullptr;       // on net_1, inside the 'high_current' area
+    PCB_TRACK*                  outside = nullptr;      // on net_2, outside it
+    ZONE*                       ruleArea = nullptr;
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+    {
+        if( track->GetNetname() == wxT( "net_1" ) )
+            inArea = track;
+        else if( track->GetNetname() == wxT( "net_2" ) )
+            outside = track;
+    }
+
+    for( ZONE* zone : m_board->Zones() )
+    {
+        if( zone->GetIsRuleArea() && zone->GetZoneName() == wxT( "high_current" ) )
+            ruleArea = zone;
+    }
+
+    BOOST_REQUIRE( inArea && outside && ruleArea );
+
+    auto resolve =
+            [&]( const BOARD_ITEM* a )
+            {
+                DRC_CONSTRAINT c = drcEngine->EvalRules( CONNECTION_WIDTH_CONSTRAINT, a, nullptr,
+                                                         a->GetLayer() );
+
+                return std::make_tuple( c.GetName(), c.m_Value.HasMin() ? c.m_Value.Min() : -1 );
+            };
+
+    // Resolve with the cache enabled before and after an edit; the result after the edit must
+    // match an uncached resolution
+    auto checkEdit =
+            [&]( const BOARD_ITEM* a, const std::function<void()>& aEdit, bool aExpectChange )
+            {
+                drcEngine->SetRuleCacheEnabled( true );
+                auto before = resolve( a );
+
+                aEdit();
+
+                // As a commit would
+                drcEngine->InvalidateRuleCache();
+
+                auto cached = resolve( a );
+                drcEngine->SetRuleCacheEnabled( false );
+                auto uncached = resolve( a );
+
+                BOOST_CHECK( cached == uncached );
+
+                if( aExpectChange )
+                    BOOST_CHECK( before != cached );
+            };
+
+    // Netclass: moving the track to the High_current net brings in the netclass rule
+    checkEdit( outside,
+               [&]()
+               {
+                   outside->SetNetCode( m_board->FindNet( wxT( "net_HC" ) )->GetNetCode() );
+               },
+               true );
+
+    // Rule area: moving the area away drops the area rule
+    checkEdit( inArea,
+               [&]()
+               {
+                   ruleArea->Move( VECTOR2I( 0, pcbIUScale.mmToIU( 10 ) ) );
+                   m_board->IncrementTimeStamp();
+               },
+               true );
+
+    ruleArea->Move( VECTOR2I( 0, -pcbIUScale.mmToIU( 10 ) ) );
+    m_board->IncrementTimeStamp();
+
+    // Layer: the area is only on F.Cu
+    checkEdit( inArea,
+               [&]()
+               {
+                   inArea->SetLayer( B_Cu );
+               },
+               false );
+}
@@ -22,6 +22,9 @@
  */
 
 #include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
 #include <string>
 
 #include <pcbnew_utils/board_test_utils.h>
@@ -29,8 +32,19 @@
 #include <qa_utils/wx_utils/unit_test_utils.h>
 
 #include <pcbnew/pcb_io/kicad_sexpr/pcb_io_kicad_sexpr.h>
+#include <pcbnew/pcb_io/kicad_sexpr/pcb_io_kicad_sexpr_parser.h>
 
+#include <advanced_config.h>
 #include <board.h>
+#include <dsnlexer.h>
+#include <footprint.h>
+#include <lexer_snapshot.h>
+#include <pad.h>
+#include <pcb_generator.h>
+#include <pcb_group.h>
+#include <pcb_point.h>
+#include <pcb_track.h>
+#include <richio.h>
 #include <zone.h>
 
 
@@ -101,4 +115,274 @@ BOOST_AUTO_TEST_CASE( Issue19775_ZoneLayerWildcards )
 }
 
 
+/**
+ * Zones filled with the legacy segment fill have no filled polygons; their segments must still
+ * be converted to a fill, and the saved fill hash kept alongside it.
+ */
+BOOST_AUTO_TEST_CASE( LegacySegmentZoneFill )
+{
+    std::string boardText =
+            "(kicad_pcb (version 20251116) (generator \"pcbnew\")\n"
+            "  (net 0 \"\")\n"
+            "  (net 1 \"GND\")\n"
+            "  (zone (net 1) (net_name \"GND\") (layer \"F.Cu\") (hatch edge 0.5)\n"
+            "    (connect_pads (clearance 0.5))\n"
+            "    (min_thickness 0.25)\n"
+            "    (fill yes (thermal_gap 0.5) (thermal_bridge_width 0.5))\n"
+            "    (polygon (pts (xy 0 0) (xy 10 0) (xy 10 10) (xy 0 10)))\n"
+            "    (fill_hash (layer \"F.Cu\") \"0123456789abcdef0123456789abcdef\")\n"
+            "    (fill_segments (pts (xy 1 5) (xy 9 5)) (pts (xy 5 1) (xy 5 9)))\n"
+            "  )\n"
+            ")\n";
+
+    STRING_LINE_READER        reader( boardText, "segment fill" );
+    PCB_IO_KICAD_SEXPR_PARSER parser( &reader, nullptr, nullptr );
+    std::unique_ptr<BOARD>    testBoard;
+
+    BOOST_CHECK_NO_THROW( testBoard.reset( dynamic_cast<BOARD*>( parser.Parse() ) ) );
+    BOOST_REQUIRE( testBoard );
+    BOOST_REQUIRE( testBoard->Zones().size() == 1 );
+
+    ZONE* z = testBoard->Zones()[0];
+
+    BOOST_CHECK( z->IsFilled() );
+    BOOST_REQUIRE( z->HasFilledPolysForLayer( F_Cu ) );
+    BOOST_CHECK( z->GetFilledPolysList( F_Cu )->TotalVertices() > 0 );
+    BOOST_CHECK( z->GetFillInputHash( F_Cu ).has_value() );
+}
+
+
+/**
+ * Footprints, tracks, vias and zones of a new board are parsed on the thread pool.  Check they
+ * end up in the same order, with the same nets, as when appending to a board (which is parsed
+ * on one thread).
+ */
+BOOST_AUTO_TEST_CASE( ParallelLoadMatchesSequential )
+{
+    std::string path = KI_TEST::GetPcbnewTestDataDir() + "issue11814.kicad_pcb";
+
+    std::unique_ptr<BOARD> sequential = std::make_unique<BOARD>();
+    kicadPlugin.LoadBoard( path, sequential.get() );
+
+    std::unique_ptr<BOARD> parallel( kicadPlugin.LoadBoard( path, nullptr ) );
+
+    BOOST_REQUIRE_EQUAL( parallel->GetNetCount(), sequential->GetNetCount() );
+
+    for( unsigned net = 0; net < parallel->GetNetCount(); ++net )
+    {
+        BOOST_CHECK_EQUAL( parallel->FindNet( net )->GetNetname(),
+                           sequential->FindNet( net )->GetNetname() );
+    }
+
+    BOOST_REQUIRE_EQUAL( parallel->Footprints().size(), sequential->Footprints().size() );
+
+    for( size_t ii = 0; ii < parallel->Footprints().size(); ++ii )
+    {
+        FOOTPRINT* expected = sequential->Footprints()[ii];
+        FOOTPRINT* actual = parallel->Footprints()[ii];
+
+        BOOST_CHECK_EQUAL( actual->GetReference(), expected->GetReference() );
+        BOOST_CHECK_EQUAL( actual->GetPosition(), expected->GetPosition() );
+        BOOST_REQUIRE_EQUAL( actual->Pads().size(), expected->Pads().size() );
+
+        for( size_t jj = 0; jj < actual->Pads().size(); ++jj )
+        {
+            BOOST_CHECK_EQUAL( actual->Pads()[jj]->GetNetCode(),
+                               expected->Pads()[jj]->GetNetCode() );
+        }
+    }
+
+    BOOST_REQUIRE_EQUAL( parallel->Tracks().size(), sequential->Tracks().size() );
+
+    for( size_t ii = 0; ii < parallel->Tracks().size(); ++ii )
+    {
+        PCB_TRACK* expected = sequential->Tracks()[ii];
+        PCB_TRACK* actual = parallel->Tracks()[ii];
+
+        BOOST_CHECK_EQUAL( actual->Type(), expected->Type() );
+        BOOST_CHECK_EQUAL( actual->GetStart(), expected->GetStart() );
+        BOOST_CHECK_EQUAL( actual->GetEnd(), expected->GetEnd() );
+        BOOST_CHECK_EQUAL( actual->GetNetCode(), expected->GetNetCode() );
+    }
+
+    BOOST_REQUIRE_EQUAL( parallel->Zones().size(), sequential->Zones().size() );
+
+    for( size_t ii = 0; ii < parallel->Zones().size(); ++ii )
+    {
+        BOOST_CHECK_EQUAL( parallel->Zones()[ii]->GetNetCode(),
+                           sequential->Zones()[ii]->GetNetCode() );
+        BOOST_CHECK_EQUAL( parallel->Zones()[ii]->Outline()->TotalVertices(),
+                           sequential->Zones()[ii]->Outline()->TotalVertices() );
+    }
+}
+
+
+/**
+ * Errors in items parsed on the thread pool must still report where they are in the file.
+ */
+BOOST_AUTO_TEST_CASE( ParallelLoadErrorLocation )
+{
+    std::ifstream     in( KI_TEST::GetPcbnewTestDataDir() + "issue7325.kicad_pcb" );
+    std::stringstream out;
+    std::string       line;
+    int               lineNumber = 0;
+    int               badLine = 0;
+
+    while( std::getline( in, line ) )
+    {
+        out << line << '\n';
+        ++lineNumber;
+
+        // Break the first footprint
+        if( !badLine && line.find( "(footprint" ) != std::string::npos )
+        {
+            out << "\t\t(bogus_token yes)\n";
+            badLine = ++lineNumber;
+        }
+    }
+
+    BOOST_REQUIRE( badLine > 0 );
+
+    auto tmpBoard = std::filesystem::temp_directory_path() / "ParallelLoadErrorLocation.kicad_pcb";
+
+    {
+        std::ofstream tmp( tmpBoard );
+        tmp << out.str();
+    }
+
+    try
+    {
+        std::unique_ptr<BOARD> board( kicadPlugin.LoadBoard( tmpBoard.string(), nullptr ) );
+        BOOST_ERROR( "Broken footprint was loaded" );
+    }
+    catch( const PARSE_ERROR& error )
+    {
+        BOOST_CHECK_EQUAL( error.lineNumber, badLine );
+    }
+}
+
+
+/**
+ * Large boards are formatted on the thread pool.  The items must come out exactly as they do
+ * when formatted one at a time, in the same order.
+ */
+BOOST_AUTO_TEST_CASE( ParallelSaveMatchesSequential )
+{
+    std::unique_ptr<BOARD> board( kicadPlugin.LoadBoard( KI_TEST::GetPcbnewTestDataDir()
+                                                                 + "issue6284.kicad_pcb",
+                                                         nullptr ) );
+
+    // Enough items to be formatted in parallel
+    BOOST_REQUIRE_GT( board->Footprints().size() + board->Tracks().size(), 1000u );
+
+    kicadPlugin.SetBoard( board.get() );
+    kicadPlugin.Format( board.get() );
+    kicadPlugin.SetBoard( nullptr );
+    std::string formatted = kicadPlugin.GetStringOutput( true );
+
+    std::set<BOARD_ITEM*, BOARD_ITEM::ptr_cmp>  footprints( board->Footprints().begin(),
+                                                            board->Footprints().end() );
+    std::set<BOARD_ITEM*, BOARD_ITEM::ptr_cmp>  drawings( board->Drawings().begin(),
+                                                          board->Drawings().end() );
+    std::set<PCB_POINT*, BOARD_ITEM::ptr_cmp>   points( board->Points().begin(),
+                                                        board->Points().end() );
+    std::set<PCB_TRACK*, PCB_TRACK::cmp_tracks> tracks( board->Tracks().begin(),
+                                                        board->Tracks().end() );
+    std::set<BOARD_ITEM*, BOARD_ITEM::ptr_cmp>  zones( board->Zones().begin(),
+                                                       board->Zones().end() );
+    std::set<BOARD_ITEM*, BOARD_ITEM::ptr_cmp>  groups( board->Groups().begin(),
+                                                        board->Groups().end() );
+    std::set<BOARD_ITEM*, BOARD_ITEM::ptr_cmp>  generators( board->Generators().begin(),
+                                                            board->Generators().end() );
+
+    PCB_IO_KICAD_SEXPR sequential;
+    sequential.SetBoard( board.get() );
+
+    for( BOARD_ITEM* item : footprints )
+        sequential.Format( item );
+
+    for( BOARD_ITEM* item : drawings )
+        sequential.Format( item );
+
+    for( PCB_POINT* item : points )
+        sequential.Format( item );
+
+    for( PCB_TRACK* item : tracks )
+        sequential.Format( item );
+
+    for( BOARD_ITEM* item : zones )
+        sequential.Format( item );
+
+    for( BOARD_ITEM* item : groups )
+        sequential.Format( item );
+
+    for( BOARD_ITEM* item : generators )
+        sequential.Format( item );
+
+    std::string expected = sequential.GetStringOutput( true );
+
+    BOOST_CHECK( formatted.find( expected ) != std::string::npos );
+}
+
+
+/**
+ * A board replayed from a lexer snapshot, which is loaded in parallel by ranges of tokens, must
+ * come out the same as when it is read as text.  A snapshot which can't be replayed gives way
+ * to reading the file as text, and is replaced.
+ */
+BOOST_AUTO_TEST_CASE( SnapshotLoadMatchesTextLoad )
+{
+    ADVANCED_CFG& cfg = const_cast<ADVANCED_CFG&>( ADVANCED_CFG::GetCfg() );
+    bool          snapshotsEnabled = cfg.m_EnableLexerSnapshots;
+
+    // Large enough to be loaded in several batches
+    wxString fileName = KI_TEST::GetPcbnewTestDataDir() + "issue6284.kicad_pcb";
+    wxString snapshotFile = LEXER_SNAPSHOT::GetSnapshotFileName( MMAP_LINE_READER( fileName ) );
+
+    BOOST_REQUIRE( !snapshotFile.IsEmpty() );
+
+    if( wxFileExists( snapshotFile ) )
+        wxRemoveFile( snapshotFile );
+
+    auto loadAndFormat =
+            [&]( bool aSnapshots ) -> std::string
+            {
+                cfg.m_EnableLexerSnapshots = aSnapshots;
+
+                std::unique_ptr<BOARD> board( kicadPlugin.LoadBoard( fileName, nullptr ) );
+
+                kicadPlugin.SetBoard( board.get() );
+                kicadPlugin.Format( board.get() );
+                kicadPlugin.SetBoard( nullptr );
+
+                return kicadPlugin.GetStringOutput( true );
+            };
+
+    std::string text = loadAndFormat( false );
+    std::string recorded = loadAndFormat( true );
+
+    BOOST_REQUIRE( wxFileExists( snapshotFile ) );
+
+    std::string replayed = loadAndFormat( true );
+
+    BOOST_CHECK( recorded == text );
+    BOOST_CHECK( replayed == text );
+
+    {
+        LEXER_SNAPSHOT_WRITER writer;
+        writer.Add( DSN_RIGHT, ")", 1 );
+        BOOST_REQUIRE( writer.Save( snapshotFile ) );
+    }
+
+    BOOST_CHECK( loadAndFormat( true ) == text );
+
+    std::unique_ptr<LEXER_SNAPSHOT> snapshot = LEXER_SNAPSHOT::Open( snapshotFile, fileName );
+
+    BOOST_REQUIRE( snapshot );
+    BOOST_CHECK_GT( snapshot->GetTokenCount(), 1u );
+
+    cfg.m_EnableLexerSnapshots = snapshotsEnabled;
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
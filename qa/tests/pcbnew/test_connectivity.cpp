@@ -0,0 +1,88 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <pcbnew_utils/board_test_utils.h>
+#include <board.h>
+#include <pcb_track.h>
+#include <connectivity/connectivity_data.h>
+#include <settings/settings_manager.h>
+
+
+struct CONNECTIVITY_TEST_FIXTURE
+{
+    CONNECTIVITY_TEST_FIXTURE()
+    { }
+
+    SETTINGS_MANAGER       m_settingsManager;
+    std::unique_ptr<BOARD> m_board;
+};
+
+
+BOOST_FIXTURE_TEST_CASE( IncrementalRatsnestMatchesFullBuild, CONNECTIVITY_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, "complex_hierarchy", m_board );
+
+    std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board->GetConnectivity();
+    std::vector<PCB_TRACK*>            tracks( m_board->Tracks().begin(), m_board->Tracks().end() );
+
+    auto checkAgainstFullBuild =
+            [&]()
+            {
+                CONNECTIVITY_DATA fullBuild;
+                fullBuild.Build( m_board.get() );
+
+                BOOST_CHECK_EQUAL( connectivity->GetUnconnectedCount( false ),
+                                   fullBuild.GetUnconnectedCount( false ) );
+            };
+
+    // Removing tracks splits clusters; adding them back merges them again
+    for( size_t ii = 0; ii < tracks.size(); ii += std::max<size_t>( 1, tracks.size() / 20 ) )
+    {
+        PCB_TRACK* track = tracks[ii];
+
+        m_board->Remove( track );
+        connectivity->RecalculateRatsnest();
+        checkAgainstFullBuild();
+
+        m_board->Add( track );
+        connectivity->RecalculateRatsnest();
+        checkAgainstFullBuild();
+    }
+
+    // Moving a track off its net's copper and back again
+    if( !tracks.empty() )
+    {
+        PCB_TRACK* track = tracks.front();
+
+        track->Move( VECTOR2I( pcbIUScale.mmToIU( 1.5 ), pcbIUScale.mmToIU( 1.5 ) ) );
+        connectivity->Update( track );
+        connectivity->RecalculateRatsnest();
+        checkAgainstFullBuild();
+
+        track->Move( VECTOR2I( -pcbIUScale.mmToIU( 1.5 ), -pcbIUScale.mmToIU( 1.5 ) ) );
+        connectivity->Update( track );
+        connectivity->RecalculateRatsnest();
+        checkAgainstFullBuild();
+    }
+}
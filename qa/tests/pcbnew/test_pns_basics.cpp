@@ -33,7 +33,12 @@
 #include <router/pns_router.h>
 #include <router/pns_item.h>
 #include <router/pns_via.h>
+#include <router/pns_solid.h>
+#include <router/pns_line.h>
+#include <router/pns_walkaround.h>
+#include <router/pns_routing_settings.h>
 #include <router/pns_kicad_iface.h>
+#include <geometry/shape_circle.h>
 
 static bool isCopper( const PNS::ITEM* aItem )
 {
@@ -416,6 +421,60 @@ BOOST_FIXTURE_TEST_CASE( PNSHoleCollisions, PNS_TEST_FIXTURE )
 }
 
 
+BOOST_FIXTURE_TEST_CASE( PNSBranchCopyOnWrite, PNS_TEST_FIXTURE )
+{
+    PNS::VIA* probe = new PNS::VIA( VECTOR2I( 0, 1000000 ), PNS_LAYER_RANGE( F_Cu, B_Cu ), 50000, 10000 );
+
+    std::unique_ptr<PNS::NODE> world ( new PNS::NODE );
+
+    probe->SetNet( (PNS::NET_HANDLE) 1 );
+
+    world->SetMaxClearance( 10000000 );
+    world->SetRuleResolver( &m_ruleResolver );
+    world->AddRaw( probe );
+
+    m_ruleResolver.m_defaultClearance = 1000000;
+
+    auto countObstacles =
+            [&]( PNS::NODE* aNode )
+            {
+                PNS::NODE::OBSTACLES obstacles;
+                return aNode->QueryColliding( probe, obstacles );
+            };
+
+    PNS::NODE*                branch = world->Branch();
+    std::unique_ptr<PNS::VIA> via = std::make_unique<PNS::VIA>( VECTOR2I( 0, 2000000 ),
+                                                                PNS_LAYER_RANGE( F_Cu, B_Cu ),
+                                                                50000, 10000 );
+    PNS::VIA*                 branchVia = via.get();
+
+    branchVia->SetNet( (PNS::NET_HANDLE) 2 );
+    branch->Add( std::move( via ) );
+
+    BOOST_CHECK_EQUAL( countObstacles( world.get() ), 0 );
+    BOOST_CHECK_EQUAL( countObstacles( branch ), 1 );
+
+    // Nested branches share their parent's index until they modify it
+    std::vector<PNS::NODE*> chain = { branch };
+
+    for( int i = 0; i < 100; ++i )
+        chain.push_back( chain.back()->Branch() );
+
+    PNS::NODE* leaf = chain.back();
+
+    BOOST_CHECK_EQUAL( leaf->Depth(), 101 );
+    BOOST_CHECK_EQUAL( countObstacles( leaf ), 1 );
+
+    leaf->Remove( branchVia );
+
+    BOOST_CHECK_EQUAL( countObstacles( leaf ), 0 );
+    BOOST_CHECK_EQUAL( countObstacles( chain[50] ), 1 );
+    BOOST_CHECK_EQUAL( countObstacles( branch ), 1 );
+
+    world->KillChildren();
+}
+
+
 BOOST_FIXTURE_TEST_CASE( PNSViaBackdrillRetention, PNS_TEST_FIXTURE )
 {
     PNS::VIA via( VECTOR2I( 1000, 2000 ), PNS_LAYER_RANGE( F_Cu, B_Cu ), 40000, 20000, nullptr,
@@ -505,3 +564,73 @@ BOOST_AUTO_TEST_CASE( PCBViaBackdrillCloneRetainsData )
     checkVia( *viaClone );
 }
 
+
+
+BOOST_FIXTURE_TEST_CASE( PNSWalkaroundParallelMatchesSerial, PNS_TEST_FIXTURE )
+{
+    PNS::ROUTING_SETTINGS settings( nullptr, "" );
+    m_router->LoadSettings( &settings );
+
+    std::unique_ptr<PNS::NODE> world( new PNS::NODE );
+
+    world->SetMaxClearance( 10000000 );
+    world->SetRuleResolver( &m_ruleResolver );
+
+    // A staggered field of round pads across the path of the line
+    for( int row = 0; row < 5; row++ )
+    {
+        for( int col = 0; col < 8; col++ )
+        {
+            VECTOR2I    pos( 2000000 + col * 2500000,
+                             ( row - 2 ) * 2500000 + ( col % 2 ) * 1250000 );
+            PNS::SOLID* solid = new PNS::SOLID;
+
+            solid->SetShape( new SHAPE_CIRCLE( pos, 500000 ) );
+            solid->SetPos( pos );
+            solid->SetLayer( F_Cu );
+            solid->SetNet( (PNS::NET_HANDLE) 2 );
+            world->AddRaw( solid );
+        }
+    }
+
+    PNS::LINE line;
+
+    line.SetShape( SHAPE_LINE_CHAIN( { VECTOR2I( 0, 0 ), VECTOR2I( 22000000, 0 ) } ) );
+    line.SetWidth( 250000 );
+    line.SetLayer( F_Cu );
+    line.SetNet( (PNS::NET_HANDLE) 1 );
+
+    auto walk =
+            [&]( bool aUseThreadPool )
+            {
+                PNS::WALKAROUND walkaround( world.get(), m_router );
+
+                walkaround.SetAllowedPolicies( { PNS::WALKAROUND::WP_CW, PNS::WALKAROUND::WP_CCW,
+                                                 PNS::WALKAROUND::WP_SHORTEST } );
+                walkaround.SetIterationLimit( 50 );
+                walkaround.SetUseThreadPool( aUseThreadPool );
+
+                return walkaround.Route( line );
+            };
+
+    PNS::WALKAROUND::RESULT serial = walk( false );
+    PNS::WALKAROUND::RESULT parallel = walk( true );
+    bool                    walkedAround = false;
+
+    for( PNS::WALKAROUND::WALK_POLICY policy : { PNS::WALKAROUND::WP_CW, PNS::WALKAROUND::WP_CCW,
+                                                 PNS::WALKAROUND::WP_SHORTEST } )
+    {
+        BOOST_TEST_CONTEXT( "Policy " << policy )
+        {
+            BOOST_CHECK_EQUAL( serial.status[policy], parallel.status[policy] );
+            BOOST_CHECK( serial.lines[policy].CLine().CPoints()
+                         == parallel.lines[policy].CLine().CPoints() );
+        }
+
+        if( serial.lines[policy].PointCount() > 2 )
+            walkedAround = true;
+    }
+
+    // The field must actually be in the way
+    BOOST_CHECK( walkedAround );
+}
@@ -0,0 +1,99 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <pcbnew_utils/board_test_utils.h>
+#include <board.h>
+#include <board_commit.h>
+#include <connectivity/connectivity_data.h>
+#include <pcb_track.h>
+#include <reporter.h>
+#include <settings/settings_manager.h>
+#include <tool/tool_manager.h>
+
+#include <router/pns_batch_router.h>
+
+
+struct PNS_BATCH_ROUTER_TEST_FIXTURE
+{
+    PNS_BATCH_ROUTER_TEST_FIXTURE()
+    { }
+
+    SETTINGS_MANAGER       m_settingsManager;
+    std::unique_ptr<BOARD> m_board;
+};
+
+
+BOOST_FIXTURE_TEST_CASE( PNSBatchRouterRoutesUnroutedNets, PNS_BATCH_ROUTER_TEST_FIXTURE )
+{
+    for( bool parallel : { false, true } )
+    {
+        BOOST_TEST_CONTEXT( ( parallel ? "parallel" : "sequential" ) )
+        {
+            // Two resistor pairs, each joined by a single track
+            KI_TEST::LoadBoard( m_settingsManager, wxT( "multinetclasses_drc" ), m_board );
+
+            TOOL_MANAGER toolMgr;
+            toolMgr.SetEnvironment( m_board.get(), nullptr, nullptr, nullptr, nullptr );
+
+            KI_TEST::DUMMY_TOOL* dummyTool = new KI_TEST::DUMMY_TOOL();
+            toolMgr.RegisterTool( dummyTool );
+
+            std::set<int> netCodes;
+
+            {
+                BOARD_COMMIT commit( dummyTool );
+
+                for( PCB_TRACK* track : m_board->Tracks() )
+                {
+                    netCodes.insert( track->GetNetCode() );
+                    commit.Remove( track );
+                }
+
+                commit.Push( wxT( "Unroute" ) );
+            }
+
+            BOOST_REQUIRE( m_board->Tracks().empty() );
+
+            std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board->GetConnectivity();
+            unsigned int unrouted = connectivity->GetUnconnectedCount( false );
+
+            BOOST_REQUIRE_EQUAL( unrouted, netCodes.size() );
+
+            PNS_BATCH_ROUTER router( m_board.get(), &toolMgr, &NULL_REPORTER::GetInstance() );
+            router.SetParallel( parallel );
+
+            PNS_BATCH_ROUTER::RESULT result = router.Run();
+
+            BOOST_CHECK_EQUAL( result.m_Routed, (int) unrouted );
+            BOOST_CHECK_EQUAL( result.m_Failed, 0 );
+            BOOST_CHECK_EQUAL( m_board->GetConnectivity()->GetUnconnectedCount( false ), 0u );
+
+            // Nothing but the nets which were unrouted gets new copper
+            BOOST_CHECK( !m_board->Tracks().empty() );
+
+            for( PCB_TRACK* track : m_board->Tracks() )
+                BOOST_CHECK( netCodes.contains( track->GetNetCode() ) );
+        }
+    }
+}
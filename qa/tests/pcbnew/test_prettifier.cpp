@@ -139,3 +139,59 @@ BOOST_FIXTURE_TEST_CASE( BoardAndFootprintPrettifier, PRETTIFIER_TEST_FIXTURE )
 
     std::filesystem::remove_all( tempLibPath );
 }
+
+
+BOOST_AUTO_TEST_CASE( StreamingPrettifier )
+{
+    std::vector<wxString> cases = {
+        "Reverb_BTDR-1V.kicad_mod",
+        "group_and_image.kicad_pcb"
+    };
+
+    for( const wxString& testCase : cases )
+    {
+        std::string testCaseName = testCase.ToStdString();
+
+        BOOST_TEST_CONTEXT( testCaseName )
+        {
+            std::string inPath = fmt::format( "{}prettifier/{}", KI_TEST::GetPcbnewTestDataDir(),
+                                              testCaseName );
+
+            std::ifstream inFp;
+            inFp.open( inPath );
+            BOOST_REQUIRE( inFp.is_open() );
+
+            std::stringstream inBuf;
+            inBuf << inFp.rdbuf();
+            std::string inData = inBuf.str();
+
+            using KICAD_FORMAT::FORMAT_MODE;
+
+            for( FORMAT_MODE mode : { FORMAT_MODE::NORMAL, FORMAT_MODE::COMPACT_TEXT_PROPERTIES } )
+            {
+                std::string expected = inData;
+                KICAD_FORMAT::Prettify( expected, mode );
+
+                // Chunks small enough to split whitespace runs and keywords
+                for( size_t chunkSize : { 1, 3, 7, 4096 } )
+                {
+                    KICAD_FORMAT::PRETTIFIER prettifier( mode );
+                    std::string              streamed;
+
+                    for( size_t pos = 0; pos < inData.length(); pos += chunkSize )
+                    {
+                        prettifier.Process( inData.data() + pos,
+                                            std::min( chunkSize, inData.length() - pos ),
+                                            streamed );
+                    }
+
+                    prettifier.Finish( streamed );
+
+                    BOOST_CHECK_MESSAGE( streamed == expected,
+                                         "Streamed formatting differs with chunks of "
+                                                 << chunkSize );
+                }
+            }
+        }
+    }
+}
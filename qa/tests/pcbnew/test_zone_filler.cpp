@@ -31,6 +31,8 @@
 #include <pcb_track.h>
 #include <footprint.h>
 #include <zone.h>
+#include <zone_filler.h>
+#include <convert_basic_shapes_to_polygon.h>
 #include <drc/drc_item.h>
 #include <settings/settings_manager.h>
 
@@ -167,6 +169,248 @@ BOOST_FIXTURE_TEST_CASE( NotchedZones, ZONE_FILL_TEST_FIXTURE )
 }
 
 
+BOOST_FIXTURE_TEST_CASE( AreaRefillMatchesFullFill, ZONE_FILL_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, "zone_filler", m_board );
+    KI_TEST::FillZones( m_board.get() );
+
+    std::vector<ZONE*> zones( m_board->Zones().begin(), m_board->Zones().end() );
+    PCB_TRACK*         movedTrack = nullptr;
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+    {
+        if( track->Type() == PCB_ARC_T )
+            movedTrack = track;
+    }
+
+    BOOST_REQUIRE( movedTrack );
+
+    BOX2I damage = movedTrack->GetBoundingBox();
+    movedTrack->Move( VECTOR2I( delta, delta ) );
+    damage.Merge( movedTrack->GetBoundingBox() );
+
+    auto fillAreas =
+            [&]( bool aAreaRefill )
+            {
+                ZONE_FILLER                  filler( m_board.get(), nullptr );
+                std::map<KIID, double>       areas;
+
+                if( aAreaRefill )
+                {
+                    for( ZONE* zone : zones )
+                        filler.SetDirtyArea( zone, damage );
+                }
+
+                BOOST_REQUIRE( filler.Fill( zones ) );
+
+                for( ZONE* zone : zones )
+                {
+                    for( PCB_LAYER_ID layer : zone->GetLayerSet() )
+                        areas[ zone->m_Uuid ] += zone->GetFilledPolysList( layer )->Area();
+                }
+
+                return areas;
+            };
+
+    std::map<KIID, double> areaRefill = fillAreas( true );
+    std::map<KIID, double> fullFill = fillAreas( false );
+
+    for( const auto& [ id, area ] : fullFill )
+        BOOST_CHECK_CLOSE( areaRefill[ id ], area, 0.01 );
+}
+
+
+BOOST_FIXTURE_TEST_CASE( CachedFillMatchesFullFill, ZONE_FILL_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, "zone_filler", m_board );
+    KI_TEST::FillZones( m_board.get() );
+
+    std::vector<ZONE*> zones( m_board->Zones().begin(), m_board->Zones().end() );
+
+    for( ZONE* zone : zones )
+    {
+        for( PCB_LAYER_ID layer : zone->GetLayerSet() )
+            BOOST_CHECK( zone->GetFillInputHash( layer ).has_value() );
+    }
+
+    PCB_TRACK* movedTrack = nullptr;
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+    {
+        if( track->Type() == PCB_ARC_T )
+            movedTrack = track;
+    }
+
+    BOOST_REQUIRE( movedTrack );
+    movedTrack->Move( VECTOR2I( delta, delta ) );
+
+    auto fillAreas =
+            [&]( bool aUseCache )
+            {
+                ZONE_FILLER            filler( m_board.get(), nullptr );
+                std::map<KIID, double> areas;
+
+                if( !aUseCache )
+                {
+                    for( ZONE* zone : zones )
+                        zone->UnFill();
+                }
+
+                BOOST_REQUIRE( filler.Fill( zones ) );
+
+                for( ZONE* zone : zones )
+                {
+                    for( PCB_LAYER_ID layer : zone->GetLayerSet() )
+                        areas[ zone->m_Uuid ] += zone->GetFilledPolysList( layer )->Area();
+                }
+
+                return areas;
+            };
+
+    std::map<KIID, double> cachedFill = fillAreas( true );
+    std::map<KIID, double> fullFill = fillAreas( false );
+
+    for( const auto& [ id, area ] : fullFill )
+        BOOST_CHECK_CLOSE( cachedFill[ id ], area, 0.01 );
+}
+
+
+BOOST_FIXTURE_TEST_CASE( CachedFillTracksThermalInputs, ZONE_FILL_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, "zone_filler", m_board );
+
+    std::vector<ZONE*> zones( m_board->Zones().begin(), m_board->Zones().end() );
+    ZONE*              zone = nullptr;
+    PAD*               pad = nullptr;
+    PCB_LAYER_ID       layer = UNDEFINED_LAYER;
+
+    // Find a pad which the fill of a zone connects to (or knocks out)
+    for( ZONE* candidate : zones )
+    {
+        if( candidate->GetIsRuleArea() || pad )
+            continue;
+
+        for( FOOTPRINT* footprint : m_board->Footprints() )
+        {
+            for( PAD* candidatePad : footprint->Pads() )
+            {
+                for( PCB_LAYER_ID candidateLayer : candidate->GetLayerSet() )
+                {
+                    if( !pad && candidatePad->IsOnLayer( candidateLayer )
+                            && candidatePad->GetBoundingBox().Intersects( candidate->GetBoundingBox() ) )
+                    {
+                        zone = candidate;
+                        pad = candidatePad;
+                        layer = candidateLayer;
+                    }
+                }
+            }
+        }
+    }
+
+    BOOST_REQUIRE( pad );
+
+    auto fill =
+            [&]() -> HASH_128
+            {
+                ZONE_FILLER filler( m_board.get(), nullptr );
+
+                BOOST_REQUIRE( filler.Fill( zones ) );
+                BOOST_REQUIRE( zone->GetFillInputHash( layer ).has_value() );
+
+                return *zone->GetFillInputHash( layer );
+            };
+
+    HASH_128 original = fill();
+
+    // Nothing has changed, so the fill is reused
+    BOOST_CHECK( fill() == original );
+
+    auto checkEdit =
+            [&]( const std::function<void()>& aEdit, const std::function<void()>& aUndo )
+            {
+                aEdit();
+                BOOST_CHECK( !( fill() == original ) );
+
+                aUndo();
+                BOOST_CHECK( fill() == original );
+            };
+
+    EDA_ANGLE spokeAngle = pad->GetThermalSpokeAngle();
+    EDA_ANGLE orientation = pad->GetOrientation();
+    VECTOR2I  offset = pad->GetOffset( PADSTACK::ALL_LAYERS );
+
+    checkEdit( [&]() { pad->SetThermalSpokeAngle( spokeAngle + ANGLE_45 ); },
+               [&]() { pad->SetThermalSpokeAngle( spokeAngle ); } );
+
+    checkEdit( [&]() { pad->SetOrientation( orientation + ANGLE_90 ); },
+               [&]() { pad->SetOrientation( orientation ); } );
+
+    checkEdit( [&]() { pad->SetOffset( PADSTACK::ALL_LAYERS, offset + VECTOR2I( delta, 0 ) ); },
+               [&]() { pad->SetOffset( PADSTACK::ALL_LAYERS, offset ); } );
+}
+
+
+BOOST_AUTO_TEST_CASE( TiledSubtractMatchesBooleanSubtract )
+{
+    const int mm = pcbIUScale.mmToIU( 1 );
+
+    SHAPE_POLY_SET fill;
+    fill.NewOutline();
+    fill.Append( 0, 0 );
+    fill.Append( 100 * mm, 0 );
+    fill.Append( 100 * mm, 80 * mm );
+    fill.Append( 0, 80 * mm );
+
+    // Enough via-sized holes to be tiled, on a pitch which doesn't line up with the tiles so
+    // that some of them straddle tile edges.  The holes of every other row are large enough to
+    // run into each other, cutting the fill into strips.
+    SHAPE_POLY_SET holes;
+
+    for( int row = 0; row < 40; ++row )
+    {
+        for( int col = 0; col < 40; ++col )
+        {
+            VECTOR2I center( KiROUND( ( col * 2.57 + ( row % 2 ) * 1.2 ) * mm ),
+                             KiROUND( ( row * 2.03 + 1.0 ) * mm ) );
+            int      radius = pcbIUScale.mmToIU( row % 2 ? 1.4 : 0.6 );
+
+            TransformCircleToPolygon( holes, center, radius, pcbIUScale.mmToIU( 0.005 ),
+                                      ERROR_OUTSIDE );
+        }
+    }
+
+    BOOST_REQUIRE_GT( holes.OutlineCount(), 1000 );
+
+    SHAPE_POLY_SET plain = fill;
+    plain.BooleanSubtract( holes );
+
+    SHAPE_POLY_SET tiled = fill;
+    ZONE_FILLER::SubtractTiled( tiled, holes );
+
+    auto holeCount =
+            []( const SHAPE_POLY_SET& aSet )
+            {
+                int count = 0;
+
+                for( int ii = 0; ii < aSet.OutlineCount(); ++ii )
+                    count += aSet.HoleCount( ii );
+
+                return count;
+            };
+
+    BOOST_CHECK_EQUAL( tiled.OutlineCount(), plain.OutlineCount() );
+    BOOST_CHECK_EQUAL( holeCount( tiled ), holeCount( plain ) );
+    BOOST_CHECK_CLOSE( tiled.Area(), plain.Area(), 1e-4 );
+
+    // The outlines cover the same copper, give or take rounding where tile edges cut them
+    SHAPE_POLY_SET diff = tiled;
+    diff.BooleanXor( plain );
+
+    BOOST_CHECK_LT( diff.Area(), 1e-6 * plain.Area() );
+}
+
+
 static const std::vector<wxString> RegressionZoneFillTests_tests = {
     "issue18",
     "issue2568",
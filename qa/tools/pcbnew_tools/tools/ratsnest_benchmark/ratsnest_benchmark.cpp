@@ -0,0 +1,193 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/utility_registry.h>
+#include <pcbnew_utils/board_file_utils.h>
+
+#include <board.h>
+#include <footprint.h>
+#include <connectivity/connectivity_algo.h>
+#include <connectivity/connectivity_data.h>
+#include <core/profile.h>
+
+#include <wx/cmdline.h>
+#include <wx/msgout.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+
+using BENCH_DURATION = std::chrono::microseconds;
+
+
+struct BENCH_RESULT
+{
+    BENCH_DURATION m_Min = BENCH_DURATION::max();
+    BENCH_DURATION m_Total{};
+    int            m_Runs = 0;
+
+    void Add( BENCH_DURATION aDuration )
+    {
+        m_Min = std::min( m_Min, aDuration );
+        m_Total += aDuration;
+        m_Runs++;
+    }
+
+    void Print( const std::string& aName ) const
+    {
+        if( m_Runs == 0 )
+            return;
+
+        std::cout << "  " << std::left << std::setw( 24 ) << aName
+                  << " min " << std::right << std::setw( 10 ) << m_Min.count() << "us"
+                  << "   avg " << std::setw( 10 ) << ( m_Total / m_Runs ).count() << "us"
+                  << std::endl;
+    }
+};
+
+
+/**
+ * Time ratsnest rebuilds on a board:
+ *  - a full connectivity build,
+ *  - recomputing the ratsnest of every net,
+ *  - the incremental update after moving a single footprint.
+ */
+static bool benchmarkBoard( const std::string& aFilename, int aIterations )
+{
+    std::unique_ptr<BOARD> board = KI_TEST::ReadBoardFromFileOrStream( aFilename );
+
+    if( !board )
+    {
+        std::cerr << "Failed to load " << aFilename << std::endl;
+        return false;
+    }
+
+    std::shared_ptr<CONNECTIVITY_DATA> connectivity = board->GetConnectivity();
+
+    BENCH_RESULT fullBuild;
+    BENCH_RESULT allNets;
+    BENCH_RESULT footprintMove;
+
+    FOOTPRINT* movedFootprint = nullptr;
+
+    // Move the footprint with the most pads; that's the worst case for an interactive drag
+    for( FOOTPRINT* footprint : board->Footprints() )
+    {
+        if( !movedFootprint || footprint->Pads().size() > movedFootprint->Pads().size() )
+            movedFootprint = footprint;
+    }
+
+    for( int ii = 0; ii < aIterations; ++ii )
+    {
+        {
+            PROF_TIMER timer;
+            connectivity->Build( board.get() );
+            fullBuild.Add( timer.SinceStart<BENCH_DURATION>() );
+        }
+
+        {
+            std::shared_ptr<CN_CONNECTIVITY_ALGO> algo = connectivity->GetConnectivityAlgo();
+
+            for( int net = 0; net < algo->NetCount(); ++net )
+                algo->MarkNetAsDirty( net );
+
+            PROF_TIMER timer;
+            connectivity->RecalculateRatsnest();
+            allNets.Add( timer.SinceStart<BENCH_DURATION>() );
+        }
+
+        if( movedFootprint )
+        {
+            VECTOR2I delta( pcbIUScale.mmToIU( ( ii % 2 ) ? -1 : 1 ), 0 );
+
+            PROF_TIMER timer;
+            movedFootprint->Move( delta );
+            connectivity->Update( movedFootprint );
+            connectivity->RecalculateRatsnest();
+            footprintMove.Add( timer.SinceStart<BENCH_DURATION>() );
+        }
+    }
+
+    std::cout << aFilename << ": " << board->GetNetCount() << " nets, "
+              << connectivity->GetNodeCount() << " nodes, "
+              << connectivity->GetUnconnectedCount( false ) << " unconnected" << std::endl;
+
+    fullBuild.Print( "full build" );
+    allNets.Print( "all nets dirty" );
+    footprintMove.Print( "footprint move" );
+
+    return true;
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "i", "iterations", _( "number of runs per board (default 5)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "input file" ).mb_str(), wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum RATSNEST_BENCHMARK_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+int ratsnest_benchmark_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program times connectivity and ratsnest rebuilds on the "
+                               "given PCB files (for instance the demo boards)." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long iterations = 5;
+    cl_parser.Found( "iterations", &iterations );
+
+    bool ok = true;
+
+    for( unsigned ii = 0; ii < cl_parser.GetParamCount(); ii++ )
+        ok &= benchmarkBoard( cl_parser.GetParam( ii ).ToStdString(), std::max( 1L, iterations ) );
+
+    if( !ok )
+        return RATSNEST_BENCHMARK_RET_CODES::LOAD_FAILED;
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( { "ratsnest_benchmark",
+                                                       "Time ratsnest rebuilds on PCB files",
+                                                       ratsnest_benchmark_main_func } );
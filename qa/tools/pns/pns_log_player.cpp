@@ -25,13 +25,15 @@
 #include "pns_log_file.h"
 #include "pns_log_player.h"
 
+#include <core/profile.h>
 #include <pcbnew_utils/board_test_utils.h>
 
 #define PNSLOGINFO PNS::DEBUG_DECORATOR::SRC_LOCATION_INFO( __FILE__, __FUNCTION__, __LINE__ )
 
 using namespace PNS;
 
-PNS_LOG_PLAYER::PNS_LOG_PLAYER()
+PNS_LOG_PLAYER::PNS_LOG_PLAYER() :
+        m_debugEnabled( true )
 {
     SetReporter( &NULL_REPORTER::GetInstance() );
 }
@@ -58,6 +60,7 @@ void PNS_LOG_PLAYER::createRouter()
 
     m_debugDecorator = new PNS_TEST_DEBUG_DECORATOR( m_reporter );
     m_debugDecorator->Clear();
+    m_debugDecorator->SetDebugEnabled( m_debugEnabled );
     m_iface->SetDebugDecorator( m_debugDecorator );
 }
 
@@ -104,6 +107,8 @@ void PNS_LOG_PLAYER::ReplayLog( PNS_LOG_FILE* aLog, int aStartEventIndex, int aF
 
     m_router->SetMode( aLog->GetMode() );
 
+    m_eventStats.clear();
+
     for( auto evt : aLog->Events() )
     {
         if( eventIdx < aFrom || ( aTo >= 0 && eventIdx > aTo ) )
@@ -112,7 +117,7 @@ void PNS_LOG_PLAYER::ReplayLog( PNS_LOG_FILE* aLog, int aStartEventIndex, int aF
         auto  items = aLog->ItemsById( evt );
         PNS::ITEM_SET ritems;
 
-        printf("items: %zu\n", items.size() );
+        m_reporter->Report( wxString::Format( "items: %zu", items.size() ) );
         ITEM* ritem = nullptr;
 
         if( items.size() && items[0] )
@@ -128,6 +133,13 @@ void PNS_LOG_PLAYER::ReplayLog( PNS_LOG_FILE* aLog, int aStartEventIndex, int aF
 
         eventIdx++;
 
+        EVENT_STATS stats;
+        stats.m_Type = evt.type;
+        stats.m_Branches = PNS::NODE::GetBranchCount();
+        stats.m_CollisionQueries = PNS::NODE::GetCollisionQueryCount();
+
+        PROF_TIMER timer;
+
         switch( evt.type )
         {
         case LOGGER::EVT_START_ROUTE:
@@ -179,7 +191,8 @@ void PNS_LOG_PLAYER::ReplayLog( PNS_LOG_FILE* aLog, int aStartEventIndex, int aF
             m_viewTracker->SetStage( m_debugDecorator->GetStageCount() - 1 );
             m_debugDecorator->Message( wxString::Format( "fix (%d, %d)", evt.p.x, evt.p.y ) );
             bool rv = m_router->FixRoute( evt.p, ritem, false, false );
-            printf( "  fix -> (%d, %d) ret %d\n", evt.p.x, evt.p.y, rv ? 1 : 0 );
+            m_reporter->Report( wxString::Format( "  fix -> (%d, %d) ret %d", evt.p.x, evt.p.y,
+                                                  rv ? 1 : 0 ) );
             break;
         }
 
@@ -188,7 +201,7 @@ void PNS_LOG_PLAYER::ReplayLog( PNS_LOG_FILE* aLog, int aStartEventIndex, int aF
             m_debugDecorator->NewStage( "unfix", 0, PNSLOGINFO );
             m_viewTracker->SetStage( m_debugDecorator->GetStageCount() - 1 );
             m_debugDecorator->Message( wxString::Format( "unfix (%d, %d)", evt.p.x, evt.p.y ) );
-            printf( "  unfix\n" );
+            m_reporter->Report( wxT( "  unfix" ) );
             m_router->UndoLastSegment();
             break;
         }
@@ -225,6 +238,13 @@ void PNS_LOG_PLAYER::ReplayLog( PNS_LOG_FILE* aLog, int aStartEventIndex, int aF
         default: break;
         }
 
+        timer.Stop();
+
+        stats.m_TimeMs = timer.msecs();
+        stats.m_Branches = PNS::NODE::GetBranchCount() - stats.m_Branches;
+        stats.m_CollisionQueries = PNS::NODE::GetCollisionQueryCount() - stats.m_CollisionQueries;
+        m_eventStats.push_back( stats );
+
         PNS::NODE* node = nullptr;
 
 #if 0
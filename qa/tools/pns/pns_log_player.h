@@ -28,6 +28,7 @@
 
 #include <router/pns_routing_settings.h>
 #include <router/pns_kicad_iface.h>
+#include <router/pns_logger.h>
 #include <router/pns_router.h>
 
 
@@ -93,6 +94,18 @@ private:
 class PNS_LOG_PLAYER
 {
 public:
+    /**
+     * Cost of replaying a single log event.  The branch and collision query counts are only
+     * collected while PNS::NODE::SetStatsCounting() is enabled.
+     */
+    struct EVENT_STATS
+    {
+        PNS::LOGGER::EVENT_TYPE m_Type;
+        double                  m_TimeMs = 0.0;
+        uint64_t                m_Branches = 0;
+        uint64_t                m_CollisionQueries = 0;
+    };
+
     PNS_LOG_PLAYER();
     ~PNS_LOG_PLAYER();
 
@@ -106,6 +119,17 @@ public:
 
     void SetTimeLimit( uint64_t microseconds ) { m_timeLimitUs = microseconds; }
 
+    /**
+     * Enable or disable the router's debug output (on by default).  Debug output is costly
+     * and serializes the walkaround, so it should be disabled when timing the router.
+     */
+    void SetDebugEnabled( bool aEnabled ) { m_debugEnabled = aEnabled; }
+
+    /**
+     * @return the stats of each event replayed by the last call to ReplayLog().
+     */
+    const std::vector<EVENT_STATS>& GetEventStats() const { return m_eventStats; }
+
     bool CompareResults( PNS_LOG_FILE* aLog );
     const PNS_LOG_FILE::COMMIT_STATE GetRouterUpdatedItems();
 
@@ -119,7 +143,10 @@ private:
     std::unique_ptr<PNS::ROUTER>                m_router;
     std::unique_ptr<PNS::ROUTING_SETTINGS>      m_routingSettings;
     uint64_t m_timeLimitUs;
+    bool      m_debugEnabled;
     REPORTER* m_reporter;
+
+    std::vector<EVENT_STATS> m_eventStats;
 };
 
 #endif
@@ -0,0 +1,495 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Headless router benchmark.  Replays recorded router sessions (the same logs as used by
+ * qa_pns_regressions) a number of times, reports the latency percentiles of each kind of event
+ * and the number of NODE branches and collision queries, and optionally compares the results
+ * against a baseline written by an earlier run.
+ *
+ * Usage: qa_pns_benchmark [-n repeats] [-o results.json] [-b baseline.json] [-t tolerance]
+ *                         [case directory...]
+ *
+ * Without any case directories, the cases listed in qa/data/pcbnew/pns_regressions/tests.lst
+ * are run.  The exit code is non-zero if any case regressed against the baseline.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+#include <wx/cmdline.h>
+#include <wx/textfile.h>
+
+#include <json_common.h>
+#include <reporter.h>
+#include <qa_utils/utility_registry.h>
+#include <pcbnew_utils/board_file_utils.h>
+
+#include "pns_log_file.h"
+#include "pns_log_player.h"
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            "displays help on the command line parameters",
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "n",
+            "repeat",
+            "number of times each case is replayed (default 5)",
+            wxCMD_LINE_VAL_NUMBER,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "o",
+            "output",
+            "write the results as JSON (usable as a baseline)",
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "b",
+            "baseline",
+            "compare the results against a baseline JSON file",
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "t",
+            "tolerance",
+            "allowed slowdown against the baseline, in percent (default 25)",
+            wxCMD_LINE_VAL_NUMBER,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            "cases",
+            "cases",
+            "directories holding the recorded sessions (the 'pns' log files)",
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+
+// Latency changes smaller than this are within the timer noise of a single event
+static const double MIN_LATENCY_DELTA_MS = 0.05;
+
+
+struct BENCHMARK_CASE
+{
+    wxString m_Name;
+    wxString m_Path;
+};
+
+
+struct LATENCY_STATS
+{
+    size_t m_Count = 0;
+    double m_P50 = 0.0;
+    double m_P95 = 0.0;
+    double m_P99 = 0.0;
+    double m_Max = 0.0;
+};
+
+
+static const char* eventName( PNS::LOGGER::EVENT_TYPE aType )
+{
+    switch( aType )
+    {
+    case PNS::LOGGER::EVT_START_ROUTE:     return "route_start";
+    case PNS::LOGGER::EVT_START_DRAG:      return "drag_start";
+    case PNS::LOGGER::EVT_START_MULTIDRAG: return "multidrag_start";
+    case PNS::LOGGER::EVT_FIX:             return "fix";
+    case PNS::LOGGER::EVT_UNFIX:           return "unfix";
+    case PNS::LOGGER::EVT_MOVE:            return "move";
+    case PNS::LOGGER::EVT_ABORT:           return "abort";
+    case PNS::LOGGER::EVT_TOGGLE_VIA:      return "toggle_via";
+    }
+
+    return "unknown";
+}
+
+
+static const char* modeName( PNS::ROUTER_MODE aMode )
+{
+    switch( aMode )
+    {
+    case PNS::RM_MarkObstacles: return "highlight";
+    case PNS::RM_Shove:         return "shove";
+    case PNS::RM_Walkaround:    return "walkaround";
+    }
+
+    return "unknown";
+}
+
+
+/**
+ * Nearest-rank percentile of a sorted sample.
+ */
+static double percentile( const std::vector<double>& aSorted, double aPercent )
+{
+    if( aSorted.empty() )
+        return 0.0;
+
+    size_t rank = (size_t) std::ceil( aPercent / 100.0 * aSorted.size() );
+
+    return aSorted[std::clamp<size_t>( rank, 1, aSorted.size() ) - 1];
+}
+
+
+static LATENCY_STATS latencyStats( std::vector<double>& aTimes )
+{
+    LATENCY_STATS stats;
+
+    std::sort( aTimes.begin(), aTimes.end() );
+
+    stats.m_Count = aTimes.size();
+    stats.m_P50 = percentile( aTimes, 50 );
+    stats.m_P95 = percentile( aTimes, 95 );
+    stats.m_P99 = percentile( aTimes, 99 );
+    stats.m_Max = aTimes.empty() ? 0.0 : aTimes.back();
+
+    return stats;
+}
+
+
+static std::vector<BENCHMARK_CASE> loadCaseList( REPORTER* aReporter )
+{
+    std::vector<BENCHMARK_CASE> cases;
+    wxString   dataDir = KI_TEST::GetPcbnewTestDataDir() + std::string( "/pns_regressions" );
+    wxTextFile fp( dataDir + wxT( "/tests.lst" ) );
+
+    if( !fp.Open() )
+    {
+        aReporter->Report( wxString::Format( "Failed to load test list from '%s'.",
+                                             fp.GetName() ),
+                           RPT_SEVERITY_ERROR );
+        return cases;
+    }
+
+    for( size_t ii = 0; ii < fp.GetLineCount(); ++ii )
+    {
+        wxString line = fp[ii];
+        line.Trim().Trim( false );
+
+        if( !line.IsEmpty() )
+            cases.push_back( { line, dataDir + wxT( "/" ) + line + wxT( "/pns" ) } );
+    }
+
+    return cases;
+}
+
+
+/**
+ * Replay a case aRepeat times and return its results, or an empty object if it couldn't
+ * be loaded.
+ */
+static nlohmann::ordered_json runCase( const BENCHMARK_CASE& aCase, int aRepeat,
+                                       REPORTER* aReporter )
+{
+    PNS_LOG_FILE logFile;
+
+    if( !logFile.Load( wxFileName( aCase.m_Path ), &NULL_REPORTER::GetInstance() ) )
+    {
+        aReporter->Report( wxString::Format( "Failed to load case '%s' from '%s'.",
+                                             aCase.m_Name, aCase.m_Path ),
+                           RPT_SEVERITY_ERROR );
+        return nlohmann::ordered_json();
+    }
+
+    std::map<std::string, std::vector<double>> times;
+    std::vector<double>                         allTimes;
+    uint64_t                                    branches = 0;
+    uint64_t                                    queries = 0;
+
+    for( int ii = 0; ii < aRepeat; ++ii )
+    {
+        PNS_LOG_PLAYER player;
+
+        player.SetDebugEnabled( false );
+        player.ReplayLog( &logFile, 0 );
+
+        branches = 0;
+        queries = 0;
+
+        for( const PNS_LOG_PLAYER::EVENT_STATS& evt : player.GetEventStats() )
+        {
+            times[eventName( evt.m_Type )].push_back( evt.m_TimeMs );
+            allTimes.push_back( evt.m_TimeMs );
+            branches += evt.m_Branches;
+            queries += evt.m_CollisionQueries;
+        }
+    }
+
+    auto latencyJson =
+            []( std::vector<double>& aTimes )
+            {
+                LATENCY_STATS          stats = latencyStats( aTimes );
+                nlohmann::ordered_json json;
+
+                json["count"] = stats.m_Count;
+                json["p50_ms"] = stats.m_P50;
+                json["p95_ms"] = stats.m_P95;
+                json["p99_ms"] = stats.m_P99;
+                json["max_ms"] = stats.m_Max;
+
+                return json;
+            };
+
+    nlohmann::ordered_json result;
+    nlohmann::ordered_json events;
+
+    for( auto& [name, eventTimes] : times )
+        events[name] = latencyJson( eventTimes );
+
+    // Counts are per replay; they only vary between replays if a router time limit is hit
+    result["mode"] = modeName( logFile.GetMode() );
+    result["branches"] = branches;
+    result["collision_queries"] = queries;
+    result["all"] = latencyJson( allTimes );
+    result["events"] = events;
+
+    return result;
+}
+
+
+static void reportCase( const wxString& aName, const nlohmann::ordered_json& aResult,
+                        REPORTER* aReporter )
+{
+    auto line =
+            []( const std::string& aLabel, const nlohmann::ordered_json& aStats )
+            {
+                return wxString::Format( "    %-16s n=%-6d p50 %8.3f ms  p95 %8.3f ms  "
+                                         "p99 %8.3f ms",
+                                         aLabel, aStats["count"].get<int>(),
+                                         aStats["p50_ms"].get<double>(),
+                                         aStats["p95_ms"].get<double>(),
+                                         aStats["p99_ms"].get<double>() );
+            };
+
+    aReporter->Report( wxString::Format( "%s (%s): %llu branches, %llu collision queries",
+                                         aName, aResult["mode"].get<std::string>(),
+                                         (unsigned long long) aResult["branches"].get<uint64_t>(),
+                                         (unsigned long long)
+                                                 aResult["collision_queries"].get<uint64_t>() ),
+                       RPT_SEVERITY_INFO );
+
+    for( const auto& [name, stats] : aResult["events"].items() )
+        aReporter->Report( line( name, stats ), RPT_SEVERITY_INFO );
+
+    aReporter->Report( line( "all", aResult["all"] ), RPT_SEVERITY_INFO );
+}
+
+
+/**
+ * Compare a case against its baseline.  Latencies regress if they're slower by more than the
+ * tolerance (and by more than the timer noise); the counters regress if they grow by more
+ * than the tolerance.
+ *
+ * @return the number of regressions found.
+ */
+static int compareCase( const wxString& aName, const nlohmann::ordered_json& aResult,
+                        const nlohmann::json& aBaseline, double aTolerance, REPORTER* aReporter )
+{
+    int regressions = 0;
+
+    auto check =
+            [&]( const wxString& aWhat, double aValue, double aBase, double aMinDelta )
+            {
+                if( aValue > aBase * ( 1.0 + aTolerance ) && aValue - aBase > aMinDelta )
+                {
+                    // A zero baseline has no meaningful relative change
+                    wxString change;
+
+                    if( aBase > 0.0 )
+                        change = wxString::Format( "+%.0f%%", ( aValue / aBase - 1.0 ) * 100.0 );
+                    else
+                        change = wxString::Format( "+%.3f", aValue - aBase );
+
+                    aReporter->Report( wxString::Format( "REGRESSION: %s %s: %.3f (baseline "
+                                                         "%.3f, %s)",
+                                                         aName, aWhat, aValue, aBase, change ),
+                                       RPT_SEVERITY_ERROR );
+                    regressions++;
+                }
+            };
+
+    check( "branches", aResult["branches"].get<double>(),
+           aBaseline.value( "branches", 0.0 ), 0.0 );
+    check( "collision queries", aResult["collision_queries"].get<double>(),
+           aBaseline.value( "collision_queries", 0.0 ), 0.0 );
+
+    if( !aBaseline.contains( "events" ) )
+        return regressions;
+
+    for( const auto& [name, stats] : aResult["events"].items() )
+    {
+        if( !aBaseline["events"].contains( name ) )
+            continue;
+
+        const nlohmann::json& base = aBaseline["events"][name];
+
+        for( const char* key : { "p50_ms", "p95_ms", "p99_ms" } )
+        {
+            check( wxString::Format( "%s %s", name, key ), stats[key].get<double>(),
+                   base.value( key, 0.0 ), MIN_LATENCY_DELTA_MS );
+        }
+    }
+
+    return regressions;
+}
+
+
+int main( int argc, char* argv[] )
+{
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( "P&S router benchmark. Replays recorded router sessions and "
+                            "reports the latency of each event." );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    long     repeat = 5;
+    long     tolerance = 25;
+    wxString outputPath;
+    wxString baselinePath;
+
+    cl_parser.Found( "repeat", &repeat );
+    cl_parser.Found( "tolerance", &tolerance );
+    cl_parser.Found( "output", &outputPath );
+    cl_parser.Found( "baseline", &baselinePath );
+
+    if( repeat < 1 || tolerance < 0 )
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    STDOUT_REPORTER             reporter;
+    std::vector<BENCHMARK_CASE> cases;
+
+    for( size_t ii = 0; ii < cl_parser.GetParamCount(); ++ii )
+    {
+        wxFileName dir = wxFileName::DirName( cl_parser.GetParam( ii ) );
+        wxString   name = dir.GetDirCount() ? dir.GetDirs().Last() : cl_parser.GetParam( ii );
+
+        cases.push_back( { name, dir.GetPath() + wxFileName::GetPathSeparator() + wxT( "pns" ) } );
+    }
+
+    if( cases.empty() )
+        cases = loadCaseList( &reporter );
+
+    if( cases.empty() )
+        return KI_TEST::RET_CODES::TOOL_SPECIFIC;
+
+    nlohmann::json baseline;
+
+    if( !baselinePath.IsEmpty() )
+    {
+        try
+        {
+            std::ifstream stream( baselinePath.fn_str() );
+            baseline = nlohmann::json::parse( stream ).at( "cases" );
+        }
+        catch( const std::exception& )
+        {
+            reporter.Report( wxString::Format( "Failed to read baseline '%s'.", baselinePath ),
+                             RPT_SEVERITY_ERROR );
+            return KI_TEST::RET_CODES::TOOL_SPECIFIC;
+        }
+    }
+
+    PNS::NODE::SetStatsCounting( true );
+
+    nlohmann::ordered_json results;
+    int                    failed = 0;
+    int                    regressions = 0;
+
+    for( const BENCHMARK_CASE& benchCase : cases )
+    {
+        nlohmann::ordered_json result = runCase( benchCase, repeat, &reporter );
+
+        if( result.is_null() )
+        {
+            failed++;
+            continue;
+        }
+
+        reportCase( benchCase.m_Name, result, &reporter );
+
+        std::string key( benchCase.m_Name.ToUTF8() );
+
+        if( baseline.contains( key ) )
+        {
+            regressions += compareCase( benchCase.m_Name, result, baseline[key],
+                                        tolerance / 100.0, &reporter );
+        }
+        else if( !baselinePath.IsEmpty() )
+        {
+            reporter.Report( wxString::Format( "%s: not in the baseline.", benchCase.m_Name ),
+                             RPT_SEVERITY_WARNING );
+        }
+
+        results[key] = result;
+    }
+
+    PNS::NODE::SetStatsCounting( false );
+
+    if( !outputPath.IsEmpty() )
+    {
+        std::ofstream stream( outputPath.fn_str() );
+
+        if( !stream.is_open() )
+        {
+            reporter.Report( wxString::Format( "Failed to write '%s'.", outputPath ),
+                             RPT_SEVERITY_ERROR );
+            return KI_TEST::RET_CODES::TOOL_SPECIFIC;
+        }
+
+        nlohmann::ordered_json root;
+        root["repeat"] = repeat;
+        root["cases"] = results;
+
+        stream << std::setw( 4 ) << root << std::endl;
+    }
+
+    reporter.Report( wxString::Format( "SUMMARY: %d cases, %d failed to load, %d regressions",
+                                       (int) cases.size(), failed, regressions ),
+                     RPT_SEVERITY_INFO );
+
+    return ( failed || regressions ) ? KI_TEST::RET_CODES::TOOL_SPECIFIC : KI_TEST::RET_CODES::OK;
+}